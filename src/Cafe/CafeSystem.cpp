@@ -88,6 +88,8 @@ bool isLaunchTypeELF = false;
 
 MPTR _entryPoint = MPTR_NULL;
 
+std::atomic_bool g_isGPUInitFinished = false;
+
 uint32 generateHashFromRawRPXData(uint8* rpxData, sint32 size)
 {
 	uint32 h = 0x3416DCBF;
@@ -410,6 +412,8 @@ void cemu_initForGame()
 	// load graphic packs
 	cemuLog_log(LogType::Force, "------- Activate graphic packs -------");
 	GraphicPack2::ActivateForCurrentTitle();
+	// the cached recompiler functions can only be validated once the code is patched
+	PPCRecompiler_notifyPatchesApplied();
 	// print audio log
 	IAudioAPI::PrintLogging();
 	IAudioInputAPI::PrintLogging();
@@ -1000,6 +1004,7 @@ namespace CafeSystem
 			(*it)->TitleStop();
         // reset Cemu subsystems
         PPCRecompiler_Shutdown();
+        PPCInterpreter_clearDecodeCache();
         GraphicPack2::Reset();
         UnmountCurrentTitle();
         MlcStorageUnmountAllTitles();
@@ -606,6 +606,8 @@ bool fsc_isWritable(FSCVirtualFile* fscFile)
  */
 uint32 fsc_readFile(FSCVirtualFile* fscFile, void* buffer, uint32 size)
 {
+	if (fscFile->fscSupportsConcurrentReads())
+		return fscFile->fscReadData(buffer, size);
 	fscEnter();
 	uint32 fscStatus = fscFile->fscReadData(buffer, size);
 	fscLeave();
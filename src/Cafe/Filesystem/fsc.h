@@ -135,6 +135,13 @@ struct FSCVirtualFile
 		cemu_assert_unimplemented();
 	}
 
+	// true if reading only touches state owned by this file object, in which case reads don't need to hold the global fsc lock
+	// the same file object must still not be used by multiple threads at once
+	virtual bool fscSupportsConcurrentReads()
+	{
+		return false;
+	}
+
 	virtual uint64 fscGetSeek()
 	{
 		cemu_assert_unimplemented();
@@ -96,6 +96,11 @@ void FSCVirtualFile_Host::fscSetSeek(uint64 seek)
 	m_fs->SetPosition(seek);
 }
 
+bool FSCVirtualFile_Host::fscSupportsConcurrentReads()
+{
+	return m_type == FSC_TYPE_FILE; // every file has its own FileStream
+}
+
 uint64 FSCVirtualFile_Host::fscGetSeek()
 {
 	if (m_type != FSC_TYPE_FILE)
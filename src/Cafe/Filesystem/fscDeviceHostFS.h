@@ -14,6 +14,7 @@ public:
 	uint32 fscWriteData(void* buffer, uint32 size) override;
 	uint32 fscReadData(void* buffer, uint32 size) override;
 	void fscSetSeek(uint64 seek) override;
+	bool fscSupportsConcurrentReads() override;
 	uint64 fscGetSeek() override;
 	void fscSetFileLength(uint64 endOffset) override;
 	bool fscDirNext(FSCDirEntry* dirEntry) override;
@@ -173,9 +173,15 @@ void gameProfile_load()
 
 	// apply some settings immediately
 	ppcThreadQuantum = g_current_game_profile->GetThreadQuantum();
+	ppcThreadWorkStealing = g_current_game_profile->GetWorkStealing();
+	ppcThreadQuantumAdaptive = g_current_game_profile->GetAdaptiveThreadQuantum();
 
 	if (ppcThreadQuantum != GameProfile::kThreadQuantumDefault)
 		cemuLog_log(LogType::Force, "Thread quantum set to {}", ppcThreadQuantum);
+	if (ppcThreadWorkStealing)
+		cemuLog_log(LogType::Force, "Thread work stealing enabled");
+	if (ppcThreadQuantumAdaptive)
+		cemuLog_log(LogType::Force, "Adaptive thread quantum enabled");
 }
 
 bool GameProfile::Load(uint64_t title_id)
@@ -240,6 +246,8 @@ bool GameProfile::Load(uint64_t title_id)
 			}
 			else
 				m_precompiledShaders = PrecompiledShaderOption::Auto;
+
+			gameProfile_loadBooleanOption2(iniParser, "bufferCacheWriteTracking", m_bufferCacheWriteTracking);
 		}
 		else if (boost::iequals(iniParser.GetCurrentSectionName(), "Audio"))
 		{
@@ -248,6 +256,8 @@ bool GameProfile::Load(uint64_t title_id)
 		else if (boost::iequals(iniParser.GetCurrentSectionName(), "CPU"))
 		{
 			gameProfile_loadIntegerOption(iniParser, "threadQuantum", m_threadQuantum, 1000U, 536870912U);
+			gameProfile_loadBooleanOption2(iniParser, "workStealing", m_workStealing);
+			gameProfile_loadBooleanOption2(iniParser, "adaptiveThreadQuantum", m_adaptiveThreadQuantum);
 			if (!gameProfile_loadEnumOption(iniParser, "cpuMode", m_cpuMode))
 			{
 				// try to load the old enum value strings
@@ -303,6 +313,8 @@ void GameProfile::Save(uint64_t title_id)
 	fs->writeLine("[CPU]");
 	WRITE_OPTIONAL_ENTRY(cpuMode);
 	WRITE_ENTRY(threadQuantum);
+	WRITE_ENTRY(workStealing);
+	WRITE_ENTRY(adaptiveThreadQuantum);
 
 	fs->writeLine("");
 
@@ -310,6 +322,7 @@ void GameProfile::Save(uint64_t title_id)
 	WRITE_ENTRY(accurateShaderMul);
 	WRITE_OPTIONAL_ENTRY(precompiledShaders);
 	WRITE_OPTIONAL_ENTRY(graphics_api);
+	WRITE_ENTRY(bufferCacheWriteTracking);
 	fs->writeLine("");
 
 	fs->writeLine("[Controller]");
@@ -337,8 +350,11 @@ void GameProfile::ResetOptional()
 
 	// graphic settings
 	m_accurateShaderMul = AccurateShaderMulOption::True;
+	m_bufferCacheWriteTracking = false;
 	// cpu settings
 	m_threadQuantum = kThreadQuantumDefault;
+	m_workStealing = false;
+	m_adaptiveThreadQuantum = false;
 	m_cpuMode.reset(); // CPUModeOption::kSingleCoreRecompiler;
 	// audio
 	m_disableAudio = false;
@@ -358,8 +374,11 @@ void GameProfile::Reset()
 	// graphic settings
 	m_accurateShaderMul = AccurateShaderMulOption::True;
 	m_precompiledShaders = PrecompiledShaderOption::Auto;
+	m_bufferCacheWriteTracking = false;
 	// cpu settings
 	m_threadQuantum = kThreadQuantumDefault;
+	m_workStealing = false;
+	m_adaptiveThreadQuantum = false;
 	m_cpuMode = CPUMode::Auto;
 	// audio
 	m_disableAudio = false;
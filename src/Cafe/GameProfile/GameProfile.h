@@ -32,8 +32,11 @@ public:
 	[[nodiscard]] const std::optional<GraphicAPI>& GetGraphicsAPI() const { return m_graphics_api; }
 	[[nodiscard]] const AccurateShaderMulOption& GetAccurateShaderMul() const { return m_accurateShaderMul; }
 	[[nodiscard]] const std::optional<PrecompiledShaderOption>& GetPrecompiledShadersState() const { return m_precompiledShaders; }
+	[[nodiscard]] bool GetBufferCacheWriteTracking() const { return m_bufferCacheWriteTracking; }
 
 	[[nodiscard]] uint32 GetThreadQuantum() const { return m_threadQuantum; }
+	[[nodiscard]] bool GetWorkStealing() const { return m_workStealing; }
+	[[nodiscard]] bool GetAdaptiveThreadQuantum() const { return m_adaptiveThreadQuantum; }
 	[[nodiscard]] const std::optional<CPUMode>& GetCPUMode() const { return m_cpuMode; }
 
 	[[nodiscard]] bool IsAudioDisabled() const { return m_disableAudio; }
@@ -55,8 +58,11 @@ private:
 	std::optional<GraphicAPI> m_graphics_api{};
 	AccurateShaderMulOption m_accurateShaderMul = AccurateShaderMulOption::True;
 	std::optional<PrecompiledShaderOption> m_precompiledShaders{};
+	bool m_bufferCacheWriteTracking = false; // detect guest writes to cached buffers via page protection instead of hashing
 	// cpu settings
 	uint32 m_threadQuantum = kThreadQuantumDefault; // values: 20000 45000 60000 80000 100000
+	bool m_workStealing = false; // idle cores may run threads created without explicit affinity, multi-core only
+	bool m_adaptiveThreadQuantum = false; // extend the quantum of threads which rarely yield, up to 4x threadQuantum
 	std::optional<CPUMode> m_cpuMode{}; // = CPUModeOption::kSingleCoreRecompiler;
 	// audio
 	bool m_disableAudio = false;
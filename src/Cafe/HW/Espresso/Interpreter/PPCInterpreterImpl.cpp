@@ -440,6 +440,8 @@ public:
 #include "PPCInterpreterLoadStore.hpp"
 #include "PPCInterpreterALU.hpp"
 
+	typedef void(*InstructionHandler)(PPCInterpreter_t* hCPU, uint32 opcode);
+
 	static void executeInstruction(PPCInterpreter_t* hCPU)
 	{
 		if constexpr(ppcItpCtrl::allowSupervisorMode)
@@ -452,10 +454,33 @@ public:
 #endif
 
 		uint32 opcode = ppcItpCtrl::memory_readCodeU32(hCPU, hCPU->instructionPointer);
+		dispatchInstruction<false>(hCPU, opcode);
+	}
 
+	// runs an already fetched opcode through the full decoder
+	static void executeOpcode(PPCInterpreter_t* hCPU, uint32 opcode)
+	{
+		dispatchInstruction<false>(hCPU, opcode);
+	}
+
+	// returns the handler for an opcode without executing it
+	// opcodes which are unknown or need extra work around the handler call are mapped to executeOpcode
+	static InstructionHandler decodeInstruction(uint32 opcode)
+	{
+		return dispatchInstruction<true>(nullptr, opcode);
+	}
+
+// in decode mode the handler is returned instead of called
+#define PPCITP_DISPATCH(__handler) if constexpr (TDecodeOnly) { return __handler; } else { __handler(hCPU, opcode); }
+#define PPCITP_DECODE_FALLBACK() if constexpr (TDecodeOnly) { return executeOpcode; }
+
+	template<bool TDecodeOnly>
+	FORCE_INLINE static InstructionHandler dispatchInstruction(PPCInterpreter_t* hCPU, uint32 opcode)
+	{
 		switch ((opcode >> 26))
 		{
 		case 0:
+			PPCITP_DECODE_FALLBACK();
 			debug_printf("ZERO[NOP] | 0x%08X\n", (unsigned int)hCPU->instructionPointer);
 	#ifdef CEMU_DEBUG_ASSERT		
 			assert_dbg();
@@ -464,7 +489,7 @@ public:
 			hCPU->instructionPointer += 4;
 			break;
 		case 1: // virtual HLE
-			PPCInterpreter_virtualHLE(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_virtualHLE);
 			break;
 		case 4:
 			switch (PPC_getBits(opcode, 30, 5))
@@ -473,158 +498,163 @@ public:
 				switch (PPC_getBits(opcode, 25, 5))
 				{
 				case 0: // Sonic All Stars Racing
-					PPCInterpreter_PS_CMPU0(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_PS_CMPU0);
 					break;
 				case 1:
-					PPCInterpreter_PS_CMPO0(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_PS_CMPO0);
 					break;
 				case 2: // Assassin's Creed 3, Sonic All Stars Racing
-					PPCInterpreter_PS_CMPU1(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_PS_CMPU1);
 					break;
 				default:
+					PPCITP_DECODE_FALLBACK();
 					debug_printf("Unknown execute %04X as [4->0] at %08X\n", PPC_getBits(opcode, 25, 5), hCPU->instructionPointer);
 					cemu_assert_unimplemented();
 					break;
 				}
 				break;
 			case 6:
-				PPCInterpreter_PSQ_LX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PSQ_LX);
 				break;
 			case 7:
-				PPCInterpreter_PSQ_STX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PSQ_STX);
 				break;
 			case 8:
 				switch (PPC_getBits(opcode, 25, 5))
 				{
 				case 1:
-					PPCInterpreter_PS_NEG(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_PS_NEG);
 					break;
 				case 2:
-					PPCInterpreter_PS_MR(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_PS_MR);
 					break;
 				case 4:
-					PPCInterpreter_PS_NABS(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_PS_NABS);
 					break;
 				case 8:
-					PPCInterpreter_PS_ABS(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_PS_ABS);
 					break;
 				default:
+					PPCITP_DECODE_FALLBACK();
 					debug_printf("Unknown execute %04X as [4->8] at %08X\n", PPC_getBits(opcode, 25, 5), hCPU->instructionPointer);
 					cemu_assert_unimplemented();
 					break;
 				}
 				break;
 			case 10:
-				PPCInterpreter_PS_SUM0(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_SUM0);
 				break;
 			case 11:
-				PPCInterpreter_PS_SUM1(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_SUM1);
 				break;
 			case 12:
-				PPCInterpreter_PS_MULS0(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_MULS0);
 				break;
 			case 13:
-				PPCInterpreter_PS_MULS1(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_MULS1);
 				break;
 			case 14:
-				PPCInterpreter_PS_MADDS0(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_MADDS0);
 				break;
 			case 15:
-				PPCInterpreter_PS_MADDS1(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_MADDS1);
 				break;
 			case 16: // sub category - merge
 				switch (PPC_getBits(opcode, 25, 5))
 				{
 				case 16:
-					PPCInterpreter_PS_MERGE00(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_PS_MERGE00);
 					break;
 				case 17:
-					PPCInterpreter_PS_MERGE01(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_PS_MERGE01);
 					break;
 				case 18:
-					PPCInterpreter_PS_MERGE10(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_PS_MERGE10);
 					break;
 				case 19:
-					PPCInterpreter_PS_MERGE11(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_PS_MERGE11);
 					break;
 				default:
+					PPCITP_DECODE_FALLBACK();
 					debug_printf("Unknown execute %04X as [4->16] at %08X\n", PPC_getBits(opcode, 25, 5), hCPU->instructionPointer);
 					debugBreakpoint();
 					break;
 				}
 				break;
 			case 18:
-				PPCInterpreter_PS_DIV(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_DIV);
 				break;
 			case 20:
-				PPCInterpreter_PS_SUB(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_SUB);
 				break;
 			case 21:
-				PPCInterpreter_PS_ADD(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_ADD);
 				break;
 			case 22:
-				PPCInterpreter_DCBZL(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_DCBZL);
 				break;
 			case 23:
-				PPCInterpreter_PS_SEL(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_SEL);
 				break;
 			case 24:
-				PPCInterpreter_PS_RES(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_RES);
 				break;
 			case 25:
-				PPCInterpreter_PS_MUL(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_MUL);
 				break;
 			case 26: // sub category with only one entry - RSQRTE
-				PPCInterpreter_PS_RSQRTE(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_RSQRTE);
 				break;
 			case 28:
-				PPCInterpreter_PS_MSUB(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_MSUB);
 				break;
 			case 29:
-				PPCInterpreter_PS_MADD(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_MADD);
 				break;
 			case 30:
-				PPCInterpreter_PS_NMSUB(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_NMSUB);
 				break;
 			case 31:
-				PPCInterpreter_PS_NMADD(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_PS_NMADD);
 				break;
 			default:
+				PPCITP_DECODE_FALLBACK();
 				debug_printf("Unknown execute %04X as [4] at %08X\n", PPC_getBits(opcode, 30, 5), hCPU->instructionPointer);
 				cemu_assert_unimplemented();
 				break;
 			}
 			break;
 		case 7:
-			PPCInterpreter_MULLI(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_MULLI);
 			break;
 		case 8:
-			PPCInterpreter_SUBFIC(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_SUBFIC);
 			break;
 		case 10:
-			PPCInterpreter_CMPLI(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_CMPLI);
 			break;
 		case 11:
-			PPCInterpreter_CMPI(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_CMPI);
 			break;
 		case 12:
-			PPCInterpreter_ADDIC(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_ADDIC);
 			break;
 		case 13:
-			PPCInterpreter_ADDIC_(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_ADDIC_);
 			break;
 		case 14:
-			PPCInterpreter_ADDI(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_ADDI);
 			break;
 		case 15:
-			PPCInterpreter_ADDIS(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_ADDIS);
 			break;
 		case 16:
-			PPCInterpreter_BCX(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_BCX);
 			break;
 		case 17:
+			PPCITP_DECODE_FALLBACK();
 			if (PPC_getBits(opcode, 30, 1) == 1) {
-				PPCInterpreter_SC(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_SC);
 			}
 			else {
 				debug_printf("Unsupported Opcode [0x17 --> 0x0]\n");
@@ -632,372 +662,375 @@ public:
 			}
 			break;
 		case 18:
-			PPCInterpreter_BX(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_BX);
 			break;
 		case 19: // opcode category
 			switch (PPC_getBits(opcode, 30, 10))
 			{
 			case 0:
-				PPCInterpreter_MCRF(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_MCRF);
 				break;
 			case 16:
-				PPCInterpreter_BCLRX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_BCLRX);
 				break;
 			case 33:
-				PPCInterpreter_CRNOR(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_CRNOR);
 				break;
 			case 50:
-				PPCInterpreter_RFI(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_RFI);
 				break;
 			case 129:
-				PPCInterpreter_CRANDC(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_CRANDC);
 				break;
 			case 150:
-				PPCInterpreter_ISYNC(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_ISYNC);
 				break;
 			case 193:
-				PPCInterpreter_CRXOR(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_CRXOR);
 				break;
 			case 257:
-				PPCInterpreter_CRAND(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_CRAND);
 				break;
 			case 289:
-				PPCInterpreter_CREQV(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_CREQV);
 				break;
 			case 417:
-				PPCInterpreter_CRORC(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_CRORC);
 				break;
 			case 449:
-				PPCInterpreter_CROR(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_CROR);
 				break;
 			case 528:
-				PPCInterpreter_BCCTR(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_BCCTR);
 				break;
 			default:
+				PPCITP_DECODE_FALLBACK();
 				debug_printf("Unknown execute %04X as [19] at %08X\n", PPC_getBits(opcode, 30, 10), hCPU->instructionPointer);
 				cemu_assert_unimplemented();
 				break;
 			}
 			break;
 		case 20:
-			PPCInterpreter_RLWIMI(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_RLWIMI);
 			break;
 		case 21:
-			PPCInterpreter_RLWINM(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_RLWINM);
 			break;
 		case 23:
-			PPCInterpreter_RLWNM(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_RLWNM);
 			break;
 		case 24:
-			PPCInterpreter_ORI(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_ORI);
 			break;
 		case 25:
-			PPCInterpreter_ORIS(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_ORIS);
 			break;
 		case 26:
-			PPCInterpreter_XORI(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_XORI);
 			break;
 		case 27:
-			PPCInterpreter_XORIS(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_XORIS);
 			break;
 		case 28:
-			PPCInterpreter_ANDI_(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_ANDI_);
 			break;
 		case 29:
-			PPCInterpreter_ANDIS_(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_ANDIS_);
 			break;
 		case 31: // opcode category
 			switch (PPC_getBits(opcode, 30, 10))
 			{
 			case 0:
-				PPCInterpreter_CMP(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_CMP);
 				break;
 			case 4:
+				PPCITP_DECODE_FALLBACK();
 	#ifdef CEMU_DEBUG_ASSERT
 				debug_printf("TW instruction executed at %08x\n", hCPU->instructionPointer);
 	#endif
-				PPCInterpreter_TW(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_TW);
 				break;
 			case 8:
-				PPCInterpreter_SUBFC(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_SUBFC);
 				break;
 			case 10:
-				PPCInterpreter_ADDC(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_ADDC);
 				break;
 			case 11:
-				PPCInterpreter_MULHWU_(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_MULHWU_);
 				break;
 			case 19:
-				PPCInterpreter_MFCR(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_MFCR);
 				break;
 			case 20:
-				PPCInterpreter_LWARX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LWARX);
 				break;
 			case 23:
-				PPCInterpreter_LWZX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LWZX);
 				break;
 			case 24:
-				PPCInterpreter_SLWX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_SLWX);
 				break;
 			case 26:
-				PPCInterpreter_CNTLZW(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_CNTLZW);
 				break;
 			case 28:
-				PPCInterpreter_ANDX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_ANDX);
 				break;
 			case 32:
-				PPCInterpreter_CMPL(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_CMPL);
 				break;
 			case 40:
-				PPCInterpreter_SUBF(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_SUBF);
 				break;
 			case 54:
-				PPCInterpreter_DCBST(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_DCBST);
 				break;
 			case 55:
-				PPCInterpreter_LWZXU(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LWZXU);
 				break;
 			case 60:
-				PPCInterpreter_ANDCX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_ANDCX);
 				break;
 			case 75:
-				PPCInterpreter_MULHW_(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_MULHW_);
 				break;
 			case 83:
-				PPCInterpreter_MFMSR(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_MFMSR);
 				break;
 			case 86:
-				PPCInterpreter_DCBF(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_DCBF);
 				break;
 			case 87:
-				PPCInterpreter_LBZX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LBZX);
 				break;
 			case 104:
-				PPCInterpreter_NEG(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_NEG);
 				break;
 			case 119: // Sonic Lost World
-				PPCInterpreter_LBZXU(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LBZXU);
 				break;
 			case 124:
-				PPCInterpreter_NORX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_NORX);
 				break;
 			case 136:
-				PPCInterpreter_SUBFE(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_SUBFE);
 				break;
 			case 138:
-				PPCInterpreter_ADDE(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_ADDE);
 				break;
 			case 144:
-				PPCInterpreter_MTCRF(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_MTCRF);
 				break;
 			case 146:
-				PPCInterpreter_MTMSR(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_MTMSR);
 				break;
 			case 150:
-				PPCInterpreter_STWCX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_STWCX);
 				break;
 			case 151:
-				PPCInterpreter_STWX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_STWX);
 				break;
 			case 183:
-				PPCInterpreter_STWUX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_STWUX);
 				break;
 			case 200:
-				PPCInterpreter_SUBFZE(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_SUBFZE);
 				break;
 			case 202:
-				PPCInterpreter_ADDZE(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_ADDZE);
 				break;
 			case 210:
-				PPCInterpreter_MTSR(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_MTSR);
 				break;
 			case 215:
-				PPCInterpreter_STBX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_STBX);
 				break;
 			case 232: // Trine 2
-				PPCInterpreter_SUBFME(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_SUBFME);
 				break;
 			case 234:
-				PPCInterpreter_ADDME(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_ADDME);
 				break;
 			case 235:
-				PPCInterpreter_MULLW(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_MULLW);
 				break;
 			case 247:
-				PPCInterpreter_STBUX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_STBUX);
 				break;
 			case 266:
-				PPCInterpreter_ADD(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_ADD);
 				break;
 			case 278:
-				PPCInterpreter_DCBT(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_DCBT);
 				break;
 			case 279:
-				PPCInterpreter_LHZX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LHZX);
 				break;
 			case 284:
-				PPCInterpreter_EQV(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_EQV);
 				break;
 			case 306:
-				PPCInterpreter_TLBIE(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_TLBIE);
 				break;
 			case 311: // Wii U Menu v177 (US)
-				PPCInterpreter_LHZUX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LHZUX);
 				break;
 			case 316:
-				PPCInterpreter_XOR(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_XOR);
 				break;
 			case 339:
-				PPCInterpreter_MFSPR(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_MFSPR);
 				break;
 			case 343:
-				PPCInterpreter_LHAX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LHAX);
 				break;
 			case 371:
-				PPCInterpreter_MFTB(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_MFTB);
 				break;
 			case 375: // Wii U Menu v177 (US)
-				PPCInterpreter_LHAUX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LHAUX);
 				break;
 			case 407:
-				PPCInterpreter_STHX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_STHX);
 				break;
 			case 412:
-				PPCInterpreter_ORC(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_ORC);
 				break;
 			case 439:
-				PPCInterpreter_STHUX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_STHUX);
 				break;
 			case 444:
-				PPCInterpreter_OR(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_OR);
 				break;
 			case 459:
-				PPCInterpreter_DIVWU(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_DIVWU);
 				break;
 			case 467:
-				PPCInterpreter_MTSPR(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_MTSPR);
 				break;
 			case 470:
-				PPCInterpreter_DCBI(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_DCBI);
 				break;
 			case 476:
-				PPCInterpreter_NANDX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_NANDX);
 				break;
 			case 491:
-				PPCInterpreter_DIVW(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_DIVW);
 				break;
 			case 512:
-				PPCInterpreter_MCRXR(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_MCRXR);
 				break;
 			case 520: // Affordable Space Adventures + other Unity games
-				PPCInterpreter_SUBFCO(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_SUBFCO);
 				break;
 			case 522:
-				PPCInterpreter_ADDCO(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_ADDCO);
 				break;
 			case 534:
-				PPCInterpreter_LWBRX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LWBRX);
 				break;
 			case 535:
-				PPCInterpreter_LFSX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LFSX);
 				break;
 			case 536:
-				PPCInterpreter_SRWX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_SRWX);
 				break;
 			case 552:
-				PPCInterpreter_SUBFO(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_SUBFO);
 				break;
 			case 566:
-				PPCInterpreter_TLBSYNC(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_TLBSYNC);
 				break;
 			case 567:
-				PPCInterpreter_LFSUX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LFSUX);
 				break;
 			case 595:
-				PPCInterpreter_MFSR(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_MFSR);
 				break;
 			case 597:
-				PPCInterpreter_LSWI(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LSWI);
 				break;
 			case 598:
-				PPCInterpreter_SYNC(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_SYNC);
 				break;
 			case 599:
-				PPCInterpreter_LFDX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LFDX);
 				break;
 			case 616:
-				PPCInterpreter_NEGO(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_NEGO);
 				break;
 			case 631:
-				PPCInterpreter_LFDUX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LFDUX);
 				break;
 			case 648: // 136 | OE
-				PPCInterpreter_SUBFEO(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_SUBFEO);
 				break;
 			case 650: // 138 | OE
-				PPCInterpreter_ADDEO(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_ADDEO);
 				break;
 			case 662:
-				PPCInterpreter_STWBRX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_STWBRX);
 				break;
 			case 663:
-				PPCInterpreter_STFSX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_STFSX);
 				break;
 			case 695:
-				PPCInterpreter_STFSUX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_STFSUX);
 				break;
 			case 725:
-				PPCInterpreter_STSWI(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_STSWI);
 				break;
 			case 727:
-				PPCInterpreter_STFDX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_STFDX);
 				break;
 			case 747:
-				PPCInterpreter_MULLWO(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_MULLWO);
 				break;
 			case 759:
-				PPCInterpreter_STFDUX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_STFDUX);
 				break;
 			case 778:
-				PPCInterpreter_ADDO(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_ADDO);
 				break;
 			case 790:
-				PPCInterpreter_LHBRX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_LHBRX);
 				break;
 			case 792:
-				PPCInterpreter_SRAW(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_SRAW);
 				break;
 			case 824:
-				PPCInterpreter_SRAWI(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_SRAWI);
 				break;
 			case 854:
-				PPCInterpreter_EIEIO(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_EIEIO);
 				break;
 			case 918:
-				PPCInterpreter_STHBRX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_STHBRX);
 				break;
 			case 922:
-				PPCInterpreter_EXTSH(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_EXTSH);
 				break;
 			case 954:
-				PPCInterpreter_EXTSB(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_EXTSB);
 				break;
 			case 971:
-				PPCInterpreter_DIVWUO(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_DIVWUO);
 				break;
 			case 982:
-				PPCInterpreter_ICBI(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_ICBI);
 				break;
 			case 983:
-				PPCInterpreter_STFIWX(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_STFIWX);
 				break;
 			case 1003:
-				PPCInterpreter_DIVWO(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_DIVWO);
 				break;
 			case 1014:
-				PPCInterpreter_DCBZ(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_DCBZ);
 				break;
 			default:
+				PPCITP_DECODE_FALLBACK();
 				debug_printf("Unknown execute %04X as [31] at %08X\n", PPC_getBits(opcode, 30, 10), hCPU->instructionPointer);
 	#ifdef CEMU_DEBUG_ASSERT
 				assert_dbg();
@@ -1007,198 +1040,200 @@ public:
 			}
 			break;
 		case 32:
-			PPCInterpreter_LWZ(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_LWZ);
 			break;
 		case 33:
-			PPCInterpreter_LWZU(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_LWZU);
 			break;
 		case 34:
-			PPCInterpreter_LBZ(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_LBZ);
 			break;
 		case 35:
-			PPCInterpreter_LBZU(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_LBZU);
 			break;
 		case 36:
-			PPCInterpreter_STW(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_STW);
 			break;
 		case 37:
-			PPCInterpreter_STWU(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_STWU);
 			break;
 		case 38:
-			PPCInterpreter_STB(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_STB);
 			break;
 		case 39:
-			PPCInterpreter_STBU(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_STBU);
 			break;
 		case 40:
-			PPCInterpreter_LHZ(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_LHZ);
 			break;
 		case 41:
-			PPCInterpreter_LHZU(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_LHZU);
 			break;
 		case 42:
-			PPCInterpreter_LHA(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_LHA);
 			break;
 		case 43:
-			PPCInterpreter_LHAU(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_LHAU);
 			break;
 		case 44:
-			PPCInterpreter_STH(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_STH);
 			break;
 		case 45:
-			PPCInterpreter_STHU(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_STHU);
 			break;
 		case 46:
-			PPCInterpreter_LMW(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_LMW);
 			break;
 		case 47:
-			PPCInterpreter_STMW(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_STMW);
 			break;
 		case 48:
-			PPCInterpreter_LFS(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_LFS);
 			break;
 		case 49:
-			PPCInterpreter_LFSU(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_LFSU);
 			break;
 		case 50:
-			PPCInterpreter_LFD(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_LFD);
 			break;
 		case 51:
-			PPCInterpreter_LFDU(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_LFDU);
 			break;
 		case 52:
-			PPCInterpreter_STFS(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_STFS);
 			break;
 		case 53:
-			PPCInterpreter_STFSU(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_STFSU);
 			break;
 		case 54:
-			PPCInterpreter_STFD(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_STFD);
 			break;
 		case 55:
-			PPCInterpreter_STFDU(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_STFDU);
 			break;
 		case 56:
-			PPCInterpreter_PSQ_L(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_PSQ_L);
 			break;
 		case 57:
-			PPCInterpreter_PSQ_LU(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_PSQ_LU);
 			break;
 		case 59: //Opcode category
 			switch (PPC_getBits(opcode, 30, 5))
 			{
 			case 18:
-				PPCInterpreter_FDIVS(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FDIVS);
 				break;
 			case 20:
-				PPCInterpreter_FSUBS(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FSUBS);
 				break;
 			case 21:
-				PPCInterpreter_FADDS(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FADDS);
 				break;
 			case 24:
-				PPCInterpreter_FRES(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FRES);
 				break;
 			case 25:
-				PPCInterpreter_FMULS(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FMULS);
 				break;
 			case 28:
-				PPCInterpreter_FMSUBS(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FMSUBS);
 				break;
 			case 29:
-				PPCInterpreter_FMADDS(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FMADDS);
 				break;
 			case 30:
-				PPCInterpreter_FNMSUBS(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FNMSUBS);
 				break;
 			case 31:
-				PPCInterpreter_FNMADDS(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FNMADDS);
 				break;
 			default:
+				PPCITP_DECODE_FALLBACK();
 				debug_printf("Unknown execute %04X as [59] at %08X\n", PPC_getBits(opcode, 30, 10), hCPU->instructionPointer);
 				cemu_assert_unimplemented();
 				break;
 			}
 			break;
 		case 60:
-			PPCInterpreter_PSQ_ST(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_PSQ_ST);
 			break;
 		case 61:
-			PPCInterpreter_PSQ_STU(hCPU, opcode);
+			PPCITP_DISPATCH(PPCInterpreter_PSQ_STU);
 			break;
 		case 63: // opcode category
 			switch (PPC_getBits(opcode, 30, 5))
 			{
 			case 0:
-				PPCInterpreter_FCMPU(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FCMPU);
 				break;
 			case 12:
-				PPCInterpreter_FRSP(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FRSP);
 				break;
 			case 15:
-				PPCInterpreter_FCTIWZ(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FCTIWZ);
 				break;
 			case 18:
-				PPCInterpreter_FDIV(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FDIV);
 				break;
 			case 20:
-				PPCInterpreter_FSUB(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FSUB);
 				break;
 			case 21:
-				PPCInterpreter_FADD(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FADD);
 				break;
 			case 23:
-				PPCInterpreter_FSEL(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FSEL);
 				break;
 			case 25:
-				PPCInterpreter_FMUL(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FMUL);
 				break;
 			case 26:
-				PPCInterpreter_FRSQRTE(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FRSQRTE);
 				break;
 			case 28:
-				PPCInterpreter_FMSUB(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FMSUB);
 				break;
 			case 29:
-				PPCInterpreter_FMADD(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FMADD);
 				break;
 			case 30:
-				PPCInterpreter_FNMSUB(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FNMSUB);
 				break;
 			case 31:
-				PPCInterpreter_FNMADD(hCPU, opcode);
+				PPCITP_DISPATCH(PPCInterpreter_FNMADD);
 				break;
 			default:
 				switch (PPC_getBits(opcode, 30, 10))
 				{
 				case 14:
-					PPCInterpreter_FCTIW(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_FCTIW);
 					break;
 				case 32:
-					PPCInterpreter_FCMPO(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_FCMPO);
 					break;
 				case 38:
-					PPCInterpreter_MTFSB1X(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_MTFSB1X);
 					break;
 				case 40:
-					PPCInterpreter_FNEG(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_FNEG);
 					break;
 				case 72:
-					PPCInterpreter_FMR(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_FMR);
 					break;
 				case 136: // Darksiders 2
-					PPCInterpreter_FNABS(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_FNABS);
 					break;
 				case 264:
-					PPCInterpreter_FABS(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_FABS);
 					break;
 				case 583:
-					PPCInterpreter_MFFS(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_MFFS);
 					break;
 				case 711: // IBM documentation has this wrong as 771?
-					PPCInterpreter_MTFSF(hCPU, opcode);
+					PPCITP_DISPATCH(PPCInterpreter_MTFSF);
 					break;
 				default:
+					PPCITP_DECODE_FALLBACK();
 					debug_printf("Unknown execute %04X as [63] at %08X\n", PPC_getBits(opcode, 30, 10), hCPU->instructionPointer);
 					cemu_assert_unimplemented();
 					break;
@@ -1206,12 +1241,106 @@ public:
 			}
 			break;
 		default:
+			PPCITP_DECODE_FALLBACK();
 			debug_printf("Unknown execute %04X at %08X\n", PPC_getBits(opcode, 5, 6), (unsigned int)hCPU->instructionPointer);
 			cemu_assert_unimplemented();
 		}
+		return executeOpcode;
 	}
+
+#undef PPCITP_DISPATCH
+#undef PPCITP_DECODE_FALLBACK
 };
 
+#define PPC_ITP_DECODE_AREA_END			(0x10000000) // same upper bound as the recompiler code area
+#define PPC_ITP_DECODE_PAGE_SHIFT		(12)
+#define PPC_ITP_DECODE_PAGE_ENTRIES		(1 << (PPC_ITP_DECODE_PAGE_SHIFT - 2))
+#define PPC_ITP_DECODE_PAGE_COUNT		(PPC_ITP_DECODE_AREA_END >> PPC_ITP_DECODE_PAGE_SHIFT)
+#define PPC_ITP_DECODE_MAX_HANDLERS		(1024)
+
+using PPCInterpreterSlim = PPCInterpreterContainer<PPCItpCafeOSUsermode>;
+
+struct
+{
+	std::atomic<std::atomic<uint64>*> pages[PPC_ITP_DECODE_PAGE_COUNT]{};
+	// handler table, entries are only appended and never modified
+	PPCInterpreterSlim::InstructionHandler handlers[PPC_ITP_DECODE_MAX_HANDLERS]{};
+	uint32 handlerCount{ 1 }; // index 0 is reserved to mark entries as empty
+	std::unordered_map<PPCInterpreterSlim::InstructionHandler, uint32> handlerIndexMap;
+	std::mutex handlerMutex;
+}s_decodeCache;
+
+uint32 PPCInterpreter_getDecodeHandlerIndex(PPCInterpreterSlim::InstructionHandler handler)
+{
+	std::unique_lock _l(s_decodeCache.handlerMutex);
+	auto it = s_decodeCache.handlerIndexMap.find(handler);
+	if (it != s_decodeCache.handlerIndexMap.end())
+		return it->second;
+	if (s_decodeCache.handlerCount >= PPC_ITP_DECODE_MAX_HANDLERS)
+		return 0;
+	uint32 handlerIndex = s_decodeCache.handlerCount;
+	s_decodeCache.handlers[handlerIndex] = handler;
+	s_decodeCache.handlerCount++;
+	s_decodeCache.handlerIndexMap.emplace(handler, handlerIndex);
+	return handlerIndex;
+}
+
+std::atomic<uint64>* PPCInterpreter_getDecodePage(uint32 pageIndex)
+{
+	std::atomic<uint64>* page = s_decodeCache.pages[pageIndex].load(std::memory_order_acquire);
+	if (page)
+		return page;
+	std::atomic<uint64>* newPage = new std::atomic<uint64>[PPC_ITP_DECODE_PAGE_ENTRIES]();
+	if (s_decodeCache.pages[pageIndex].compare_exchange_strong(page, newPage))
+		return newPage;
+	// another thread allocated the page first
+	delete[] newPage;
+	return page;
+}
+
+void PPCInterpreter_decodeAndExecute(PPCInterpreter_t* hCPU, uint32 instructionPointer)
+{
+	uint32 opcode = PPCItpCafeOSUsermode::memory_readCodeU32(hCPU, instructionPointer);
+	PPCInterpreterSlim::InstructionHandler handler = PPCInterpreterSlim::decodeInstruction(opcode);
+	uint32 handlerIndex = PPCInterpreter_getDecodeHandlerIndex(handler);
+	if (handlerIndex != 0)
+	{
+		std::atomic<uint64>& entry = PPCInterpreter_getDecodePage(instructionPointer >> PPC_ITP_DECODE_PAGE_SHIFT)[(instructionPointer >> 2) & (PPC_ITP_DECODE_PAGE_ENTRIES - 1)];
+		uint64 newEntry = ((uint64)handlerIndex << 32) | opcode;
+		entry.store(newEntry);
+		// if the instruction was overwritten while it was decoded then the invalidation may have happened before our store
+		if (PPCItpCafeOSUsermode::memory_readCodeU32(hCPU, instructionPointer) != opcode)
+			entry.compare_exchange_strong(newEntry, 0);
+	}
+	handler(hCPU, opcode);
+}
+
+void PPCInterpreter_invalidateDecodeCache(uint32 startAddr, uint32 endAddr)
+{
+	if (startAddr >= PPC_ITP_DECODE_AREA_END)
+		return;
+	endAddr = std::min<uint32>(endAddr, PPC_ITP_DECODE_AREA_END);
+	for (uint32 addr = startAddr & ~3; addr < endAddr; addr += 4)
+	{
+		std::atomic<uint64>* page = s_decodeCache.pages[addr >> PPC_ITP_DECODE_PAGE_SHIFT].load(std::memory_order_acquire);
+		if (!page)
+		{
+			// skip to next page
+			addr = (addr | ((1 << PPC_ITP_DECODE_PAGE_SHIFT) - 1)) - 3;
+			continue;
+		}
+		page[(addr >> 2) & (PPC_ITP_DECODE_PAGE_ENTRIES - 1)].store(0);
+	}
+}
+
+// drops all decoded instructions, the next title may place different code at the same addresses
+// all CPU threads must be stopped
+void PPCInterpreter_clearDecodeCache()
+{
+	for (auto& page : s_decodeCache.pages)
+		delete[] page.exchange(nullptr);
+}
+
 // Slim interpreter, trades some features for extra performance
 // Used when emulator runs in CafeOS HLE mode
 // Assumes the following:
@@ -1219,7 +1348,31 @@ public:
 // - No interrupts
 // - Always runs in user mode
 // - Paired single mode is always enabled
+// Instructions are executed via a pre-decoded instruction cache. Each 4KB page of the code area maps to an array of
+// entries which pack the handler index (upper 32 bits) and the opcode (lower 32 bits). An entry value of 0 means the instruction was not decoded yet
 void PPCInterpreterSlim_executeInstruction(PPCInterpreter_t* hCPU)
+{
+	uint32 instructionPointer = hCPU->instructionPointer;
+	if (instructionPointer < PPC_ITP_DECODE_AREA_END) [[likely]]
+	{
+		std::atomic<uint64>* page = s_decodeCache.pages[instructionPointer >> PPC_ITP_DECODE_PAGE_SHIFT].load(std::memory_order_acquire);
+		if (page) [[likely]]
+		{
+			uint64 entry = page[(instructionPointer >> 2) & (PPC_ITP_DECODE_PAGE_ENTRIES - 1)].load(std::memory_order_acquire);
+			if (entry) [[likely]]
+			{
+				s_decodeCache.handlers[entry >> 32](hCPU, (uint32)entry);
+				return;
+			}
+		}
+		PPCInterpreter_decodeAndExecute(hCPU, instructionPointer);
+		return;
+	}
+	PPCInterpreterContainer<PPCItpCafeOSUsermode>::executeInstruction(hCPU);
+}
+
+// bypasses the decode cache, used for measuring the cache speedup
+void PPCInterpreterSlim_executeInstructionUncached(PPCInterpreter_t* hCPU)
 {
 	PPCInterpreterContainer<PPCItpCafeOSUsermode>::executeInstruction(hCPU);
 }
@@ -1230,3 +1383,38 @@ void PPCInterpreterFull_executeInstruction(PPCInterpreter_t* hCPU)
 {
 	PPCInterpreterContainer<PPCItpSupervisorWithMMU>::executeInstruction(hCPU);
 }
+
+// compares the pre-decoded interpreter against the switch decoder on a synthetic integer loop
+// scratchAddress must point to at least 0x200 bytes of writable guest memory within the code area. Used by the interpreter suite of CemuBenchmark
+void PPCInterpreter_benchmarkDecodeCache(MPTR scratchAddress, uint32 instructionCount, double& switchMIPS, double& cachedMIPS)
+{
+	const uint32 loopCode[] =
+	{
+		(14 << 26) | (3 << 21) | (3 << 16) | 1, // addi r3, r3, 1
+		(21 << 26) | (3 << 21) | (4 << 16) | (3 << 11) | (0 << 6) | (28 << 1), // rlwinm r4, r3, 3, 0, 28
+		(31 << 26) | (5 << 21) | (4 << 16) | (3 << 11) | (266 << 1), // add r5, r4, r3
+		(31 << 26) | (5 << 21) | (6 << 16) | (4 << 11) | (316 << 1), // xor r6, r5, r4
+		(31 << 26) | (0 << 21) | (6 << 16) | (3 << 11) | (0 << 1), // cmpw r6, r3
+		(31 << 26) | (7 << 21) | (3 << 16) | (5 << 11) | (40 << 1), // subf r7, r3, r5
+		(36 << 26) | (7 << 21) | (8 << 16) | 0x100, // stw r7, 0x100(r8)
+		(32 << 26) | (9 << 21) | (8 << 16) | 0x100, // lwz r9, 0x100(r8)
+		(18 << 26) | ((uint32)(-8 * 4) & 0x3FFFFFC), // b loop
+	};
+	for (uint32 i = 0; i < std::size(loopCode); i++)
+		memory_writeU32(scratchAddress + i * 4, loopCode[i]);
+	PPCInterpreter_invalidateDecodeCache(scratchAddress, scratchAddress + 0x200);
+
+	auto measure = [&](void (*executeInstruction)(PPCInterpreter_t* hCPU)) -> double
+	{
+		auto hCPU = std::make_unique<PPCInterpreter_t>();
+		hCPU->instructionPointer = scratchAddress;
+		hCPU->gpr[8] = scratchAddress;
+		auto startTime = std::chrono::steady_clock::now();
+		for (uint32 i = 0; i < instructionCount; i++)
+			executeInstruction(hCPU.get());
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		return seconds > 0.0 ? ((double)instructionCount / seconds / 1000000.0) : 0.0;
+	};
+	switchMIPS = measure(PPCInterpreterSlim_executeInstructionUncached);
+	cachedMIPS = measure(PPCInterpreterSlim_executeInstruction);
+}
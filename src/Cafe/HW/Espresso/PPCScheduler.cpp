@@ -8,6 +8,8 @@
 #include "Cafe/CafeSystem.h"
 
 uint32 ppcThreadQuantum = 45000; // execute 45000 instructions before thread reschedule happens, this value can be overwritten by game profiles
+bool ppcThreadWorkStealing = false; // allow idle cores to run threads without explicit affinity which are queued on a busy core, set by game profiles
+bool ppcThreadQuantumAdaptive = false; // scale the quantum of each thread based on how often it exhausts its timeslice, set by game profiles
 
 void PPCInterpreter_relinquishTimeslice()
 {
@@ -38,11 +40,11 @@ namespace coreinit
 
 void PPCCore_switchToScheduler()
 {
-	cemu_assert_debug(__OSHasSchedulerLock() == false); // scheduler lock must not be hold past thread time slice
+	cemu_assert_debug(__OSHasAnySchedulerLock() == false); // scheduler lock must not be hold past thread time slice
 	cemu_assert_debug(PPCInterpreter_getCurrentInstance()->coreInterruptMask != 0 || CafeSystem::GetForegroundTitleId() == 0x000500001019e600);
-	__OSLockScheduler();
+	coreinit::__OSLockSchedulerForThreadSwitch(coreinit::OSGetCurrentThread());
 	coreinit::__OSThreadSwitchToNext();
-	__OSUnlockScheduler();
+	__OSUnlockSchedulerHeld();
 }
 
 void PPCCore_switchToSchedulerWithLock()
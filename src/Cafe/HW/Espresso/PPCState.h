@@ -11,6 +11,8 @@ enum
 
 #define PPC_LWARX_RESERVATION_MAX	(4)
 
+struct PPCRecompilerCodeHeapCallSite;
+
 union FPR_t
 {
 	double fpr;
@@ -101,6 +103,10 @@ struct PPCInterpreter_t
 
 	// extra variables for recompiler
 	void* rspTemp;
+	uint32 codeHeapDepth{}; // nesting depth of recompiled code, see PPCRecompilerCodeHeap_enter
+	uint32 codeHeapEpochSlot{};
+	bool codeHeapParked{}; // switched out while inside recompiled code, see PPCRecompilerCodeHeap_park
+	PPCRecompilerCodeHeapCallSite* codeHeapCallSite{}; // innermost HLE call made from recompiled code
 };
 
 // parameter access (legacy C style)
@@ -157,8 +163,13 @@ void PPCInterpreter_nextInstruction(PPCInterpreter_t* cpuInterpreter);
 void PPCInterpreter_jumpToInstruction(PPCInterpreter_t* cpuInterpreter, uint32 newIP);
 
 void PPCInterpreterSlim_executeInstruction(PPCInterpreter_t* hCPU);
+void PPCInterpreterSlim_executeInstructionUncached(PPCInterpreter_t* hCPU);
 void PPCInterpreterFull_executeInstruction(PPCInterpreter_t* hCPU);
 
+void PPCInterpreter_invalidateDecodeCache(uint32 startAddr, uint32 endAddr);
+void PPCInterpreter_clearDecodeCache();
+void PPCInterpreter_benchmarkDecodeCache(MPTR scratchAddress, uint32 instructionCount, double& switchMIPS, double& cachedMIPS);
+
 // misc
 
 uint32 PPCInterpreter_getXER(PPCInterpreter_t* hCPU);
@@ -212,6 +223,8 @@ void PPCTimer_start();
 
 // core info and control
 extern uint32 ppcThreadQuantum;
+extern bool ppcThreadWorkStealing;
+extern bool ppcThreadQuantumAdaptive;
 
 uint8* PPCInterpreter_PushAndReturnStackPointer(sint32 offset);
 uint8* PPCInterpreterGetStackPointer();
@@ -3,6 +3,9 @@
 #include "PPCRecompiler.h"
 #include "PPCRecompilerIml.h"
 #include "PPCRecompilerX64.h"
+#include "PPCRecompilerAArch64.h"
+#include "PPCRecompilerStats.h"
+#include "PPCRecompilerCodeHeap.h"
 #include "Cafe/OS/RPL/rpl.h"
 #include "util/containers/RangeStore.h"
 #include "Cafe/OS/libs/coreinit/coreinit_CodeGen.h"
@@ -11,24 +14,79 @@
 #include "Common/ExceptionHandler/ExceptionHandler.h"
 #include "Common/cpu_features.h"
 #include "util/helpers/fspinlock.h"
+#include "util/helpers/Semaphore.h"
 #include "util/helpers/helpers.h"
 #include "util/MemMapper/MemMapper.h"
+#include "util/helpers/Serializer.h"
+#include "Cemu/FileCache/FileCache.h"
+#include "Cafe/CafeSystem.h"
+#include "util/highresolutiontimer/HighResolutionTimer.h"
+
+// bump this whenever a change to the function boundary tracker or the IML generator alters which ranges get compiled
+#define PPC_RECOMPILER_CACHE_VERSION	(1)
 
 struct PPCInvalidationRange
 {
 	MPTR startAddress;
 	uint32 size;
+	uint64 sequence;
+
+	PPCInvalidationRange(MPTR _startAddress, uint32 _size, uint64 _sequence) : startAddress(_startAddress), size(_size), sequence(_sequence) {};
+};
+
+struct PPCRecompilerQueueEntry
+{
+	MPTR address;
+	uint32 hitCount; // number of interpreter hits at the time the entry was pushed
+	uint64 sequence; // entries with the same hit count are processed in FIFO order
 
-	PPCInvalidationRange(MPTR _startAddress, uint32 _size) : startAddress(_startAddress), size(_size) {};
+	bool operator<(const PPCRecompilerQueueEntry& other) const
+	{
+		if (hitCount != other.hitCount)
+			return hitCount < other.hitCount;
+		return sequence > other.sequence;
+	}
+};
+
+struct PPCRecompilerTierUpEntry
+{
+	PPCRecFunction_t* function;
+	MPTR entryAddress; // address the function was originally compiled for
+	uint32 counterIndex; // slot in tierUpCounterOwner, stays valid after the function is deleted
 };
 
 struct
 {
 	FSpinlock recompilerSpinlock;
-	std::queue<MPTR> targetQueue;
+	// addresses waiting to be recompiled, ordered by how often the interpreter hit them
+	// the hit count of each queued address is tracked in targetHitCount. Whenever it reaches a power of two the address is pushed again with the higher priority and older entries become stale
+	std::priority_queue<PPCRecompilerQueueEntry> targetQueue;
+	std::unordered_map<MPTR, uint32> targetHitCount;
+	uint64 targetQueueSequence{};
+	// invalidated ranges are kept until every compilation that was in-flight at the time of the invalidation has finished
 	std::vector<PPCInvalidationRange> invalidationRanges;
+	uint64 invalidationSequence{};
+	std::multiset<uint64> activeCompileSequences; // value of invalidationSequence at the start of each in-flight compilation
+	// patchable branch sites of all active functions, indexed by ppc target address
+	std::multimap<MPTR, std::pair<PPCRecFunction_t*, uint32>> branchSites;
+	// tier-up counters. Each active tier 0 function owns one slot in PPCRecompilerInstanceData_t::tierUpCounter
+	std::vector<uint32> freeTierUpCounters;
+	std::vector<PPCRecompilerTierUpEntry> tierUpCounterOwner; // indexed by counter, function is nullptr while the slot is free or the function is not active yet
+	std::deque<PPCRecompilerTierUpEntry> tierUpQueue; // hot tier 0 functions waiting to be recompiled at tier 1
+	uint32 tierUpCount{}; // number of functions promoted to tier 1
+	// deleted and replaced functions. In-flight compilations can still reference them (tier-up), so they are kept until every compilation that started before their removal has finished
+	std::vector<std::pair<PPCRecFunction_t*, uint64>> retiredFunctions; // function and invalidationSequence at the time of removal
 }PPCRecompilerState;
 
+struct
+{
+	std::atomic<uint32> registeredSites{};
+	std::atomic<uint32> linkedSites{};
+	std::atomic<uint64> patchCount{};
+}s_branchLinkStats;
+
+Semaphore s_recompilerQueueSemaphore;
+
 RangeStore<PPCRecFunction_t*, uint32, 7703, 0x2000> rangeStore_ppcRanges;
 
 void ATTR_MS_ABI (*PPCRecompiler_enterRecompilerCode)(uint64 codeMem, uint64 ppcInterpreterInstance);
@@ -39,6 +97,78 @@ PPCRecompilerInstanceData_t* ppcRecompilerInstanceData;
 
 bool ppcRecompilerEnabled = false;
 
+// persistent translation cache
+// for every function that was successfully recompiled we remember the entry address and the hash of the PPC code it covers
+// on the next boot the entries are validated against the loaded modules and queued for recompilation right away, without waiting for the interpreter to discover them again
+// validation has to wait until game patches and graphic pack patches were applied. Modules linked during boot are only remembered and validated in PPCRecompiler_notifyPatchesApplied()
+// entries are queued in the order they were first compiled in the previous session, so code that runs early in the boot gets compiled first
+struct PPCRecompilerCacheEntry
+{
+	MPTR entryAddress;
+	uint64 codeHash;
+	std::vector<std::pair<MPTR, uint32>> ranges;
+};
+
+struct
+{
+	std::mutex mutex;
+	bool isInitialized{false};
+	FileCache* fileCache{nullptr};
+	std::vector<PPCRecompilerCacheEntry> pendingEntries; // loaded from the cache file but not yet matched against a loaded module
+	std::unordered_set<MPTR> knownEntryAddresses;
+	bool patchesApplied{false};
+	std::vector<std::pair<MPTR, uint32>> unvalidatedModules; // text sections of modules linked before the patches were applied
+}s_translationCache;
+
+// add address to the recompilation queue and flag it as visited
+// assumes PPCRecompilerState.recompilerSpinlock is already held. The caller has to notify s_recompilerQueueSemaphore after releasing the lock
+void PPCRecompiler_queueAddress(uint32 enterAddress)
+{
+	cemu_assert_debug(PPCRecompilerState.recompilerSpinlock.is_locked());
+	PPCRecompilerState.targetHitCount[enterAddress] = 1;
+	PPCRecompilerState.targetQueue.push({ enterAddress, 1, PPCRecompilerState.targetQueueSequence++ });
+	ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[enterAddress / 4] = PPCRecompiler_leaveRecompilerCode_visited;
+}
+
+// take the queued address with the highest priority
+// assumes PPCRecompilerState.recompilerSpinlock is already held
+bool PPCRecompiler_popQueuedAddress(uint32& enterAddress)
+{
+	while (!PPCRecompilerState.targetQueue.empty())
+	{
+		PPCRecompilerQueueEntry entry = PPCRecompilerState.targetQueue.top();
+		PPCRecompilerState.targetQueue.pop();
+		auto it = PPCRecompilerState.targetHitCount.find(entry.address);
+		if (it == PPCRecompilerState.targetHitCount.end())
+			continue; // already taken
+		if (std::bit_floor(it->second) != entry.hitCount)
+			continue; // stale, a newer entry with higher priority exists
+		PPCRecompilerState.targetHitCount.erase(it);
+		// only recompile functions if marked as visited
+		if (ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[entry.address / 4] != PPCRecompiler_leaveRecompilerCode_visited)
+			continue;
+		enterAddress = entry.address;
+		return true;
+	}
+	return false;
+}
+
+// called when the interpreter hits an address that is queued but not yet recompiled
+// like PPCRecompiler_visitAddressNoBlock this never blocks, a missed update only affects ordering
+void PPCRecompiler_bumpQueuePriority(uint32 enterAddress)
+{
+	if (!PPCRecompilerState.recompilerSpinlock.try_lock())
+		return;
+	auto it = PPCRecompilerState.targetHitCount.find(enterAddress);
+	if (it != PPCRecompilerState.targetHitCount.end() && it->second < 0x80000000)
+	{
+		it->second++;
+		if (std::has_single_bit(it->second))
+			PPCRecompilerState.targetQueue.push({ enterAddress, it->second, PPCRecompilerState.targetQueueSequence++ });
+	}
+	PPCRecompilerState.recompilerSpinlock.unlock();
+}
+
 // this function does never block and can fail if the recompiler lock cannot be acquired immediately
 void PPCRecompiler_visitAddressNoBlock(uint32 enterAddress)
 {
@@ -56,10 +186,11 @@ void PPCRecompiler_visitAddressNoBlock(uint32 enterAddress)
 		return;
 	}
 	// add to recompilation queue and flag as visited
-	PPCRecompilerState.targetQueue.emplace(enterAddress);
-	ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[enterAddress / 4] = PPCRecompiler_leaveRecompilerCode_visited;
+	PPCRecompiler_queueAddress(enterAddress);
 
 	PPCRecompilerState.recompilerSpinlock.unlock();
+	// wake the recompiler thread only after the lock was released, otherwise it may wake up just to spin on the lock
+	s_recompilerQueueSemaphore.notify();
 }
 
 void PPCRecompiler_recompileIfUnvisited(uint32 enterAddress)
@@ -71,26 +202,20 @@ void PPCRecompiler_recompileIfUnvisited(uint32 enterAddress)
 
 void PPCRecompiler_enter(PPCInterpreter_t* hCPU, PPCREC_JUMP_ENTRY funcPtr)
 {
+	cemu_assert_debug(hCPU->codeHeapDepth != 0);
 #if BOOST_OS_WINDOWS
 	uint32 prevState = _controlfp(0, 0);
 	_controlfp(_RC_NEAR, _MCW_RC);
 	PPCRecompiler_enterRecompilerCode((uint64)funcPtr, (uint64)hCPU);
 	_controlfp(prevState, _MCW_RC);
-	// debug recompiler exit - useful to find frequently executed functions which couldn't be recompiled
-	#ifdef CEMU_DEBUG_ASSERT
-	if (hCPU->remainingCycles > 0 && GetAsyncKeyState(VK_F4))
-	{
-		auto t = std::chrono::high_resolution_clock::now();
-		auto dur = std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
-		cemuLog_log(LogType::Force, "Recompiler exit: 0x{:08x} LR: 0x{:08x} Timestamp {}.{:04}", hCPU->instructionPointer, hCPU->spr.LR, dur / 1000LL, (dur % 1000LL));
-	}
-	#endif
 #else
 	PPCRecompiler_enterRecompilerCode((uint64)funcPtr, (uint64)hCPU);
 #endif
 	// after leaving recompiler prematurely attempt to recompile the code at the new location
 	if (hCPU->remainingCycles > 0)
 	{
+		// sampled, useful to find frequently executed functions which couldn't be recompiled
+		PPCRecompilerStats_recordExit(hCPU->instructionPointer);
 		PPCRecompiler_visitAddressNoBlock(hCPU->instructionPointer);
 	}
 }
@@ -100,12 +225,15 @@ void PPCRecompiler_attemptEnterWithoutRecompile(PPCInterpreter_t* hCPU, uint32 e
 	cemu_assert_debug(hCPU->instructionPointer == enterAddress);
 	if (ppcRecompilerEnabled == false)
 		return;
+	// the thread has to be marked as active before reading the jump table, otherwise the code could be freed in between
+	PPCRecompilerCodeHeap_enter(hCPU);
 	auto funcPtr = ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[enterAddress / 4];
 	if (funcPtr != PPCRecompiler_leaveRecompilerCode_unvisited && funcPtr != PPCRecompiler_leaveRecompilerCode_visited)
 	{
 		cemu_assert_debug(ppcRecompilerInstanceData != nullptr);
 		PPCRecompiler_enter(hCPU, funcPtr);
 	}
+	PPCRecompilerCodeHeap_leave(hCPU);
 }
 
 void PPCRecompiler_attemptEnter(PPCInterpreter_t* hCPU, uint32 enterAddress)
@@ -115,20 +243,26 @@ void PPCRecompiler_attemptEnter(PPCInterpreter_t* hCPU, uint32 enterAddress)
 		return;
 	if (hCPU->remainingCycles <= 0)
 		return;
+	PPCRecompilerCodeHeap_enter(hCPU);
 	auto funcPtr = ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[enterAddress / 4];
 	if (funcPtr == PPCRecompiler_leaveRecompilerCode_unvisited)
 	{
 		PPCRecompiler_visitAddressNoBlock(enterAddress);
 	}
-	else if (funcPtr != PPCRecompiler_leaveRecompilerCode_visited)
+	else if (funcPtr == PPCRecompiler_leaveRecompilerCode_visited)
+	{
+		PPCRecompiler_bumpQueuePriority(enterAddress);
+	}
+	else
 	{
 		// enter
 		cemu_assert_debug(ppcRecompilerInstanceData != nullptr);
 		PPCRecompiler_enter(hCPU, funcPtr);
 	}
+	PPCRecompilerCodeHeap_leave(hCPU);
 }
 
-PPCRecFunction_t* PPCRecompiler_recompileFunction(PPCFunctionBoundaryTracker::PPCRange_t range, std::set<uint32>& entryAddresses, std::vector<std::pair<MPTR, uint32>>& entryPointsOut)
+PPCRecFunction_t* PPCRecompiler_recompileFunction(PPCFunctionBoundaryTracker::PPCRange_t range, std::set<uint32>& entryAddresses, std::vector<std::pair<MPTR, uint32>>& entryPointsOut, uint8 tier, uint32 tierUpCounterIndex)
 {
 	if (range.startAddress >= PPC_REC_CODE_AREA_END)
 	{
@@ -150,9 +284,12 @@ PPCRecFunction_t* PPCRecompiler_recompileFunction(PPCFunctionBoundaryTracker::PP
 		}
 	}
 
+	HRTick compileStartTick = HighResolutionTimer::now().getTick();
 	PPCRecFunction_t* ppcRecFunc = new PPCRecFunction_t();
 	ppcRecFunc->ppcAddress = range.startAddress;
 	ppcRecFunc->ppcSize = range.length;
+	ppcRecFunc->tier = tier;
+	ppcRecFunc->tierUpCounterIndex = tierUpCounterIndex;
 	// generate intermediate code
 	ppcImlGenContext_t ppcImlGenContext = { 0 };
 	bool compiledSuccessfully = PPCRecompiler_generateIntermediateCode(ppcImlGenContext, ppcRecFunc, entryAddresses);
@@ -161,13 +298,22 @@ PPCRecFunction_t* PPCRecompiler_recompileFunction(PPCFunctionBoundaryTracker::PP
 		// todo: Free everything
 		PPCRecompiler_freeContext(&ppcImlGenContext);
 		delete ppcRecFunc;
+		PPCRecompilerStats_recordCompile(range.startAddress, 0, 0, false);
 		return NULL;
 	}
-	// emit x64 code
+	// emit host code
+#if defined(ARCH_AARCH64)
+	bool x64GenerationSuccess = PPCRecompiler_generateAArch64Code(ppcRecFunc, &ppcImlGenContext);
+#else
 	bool x64GenerationSuccess = PPCRecompiler_generateX64Code(ppcRecFunc, &ppcImlGenContext);
+#endif
 	if (x64GenerationSuccess == false)
 	{
+		// also the common path once the code cache is full. Branch sites are only registered when the function is published in PPCRecompiler_finishCompilation, so the function can be deleted right away
+		cemu_assert_debug(ppcRecFunc->x86Code == nullptr);
 		PPCRecompiler_freeContext(&ppcImlGenContext);
+		delete ppcRecFunc;
+		PPCRecompilerStats_recordCompile(range.startAddress, 0, 0, false);
 		return nullptr;
 	}
 
@@ -186,19 +332,270 @@ PPCRecFunction_t* PPCRecompiler_recompileFunction(PPCFunctionBoundaryTracker::PP
 	}
 
 	PPCRecompiler_freeContext(&ppcImlGenContext);
+	PPCRecompilerStats_recordCompile(range.startAddress, HighResolutionTimer::ticksToMicroseconds(HighResolutionTimer::now().getTick() - compileStartTick), (uint32)ppcRecFunc->x86Size, true);
 	return ppcRecFunc;
 }
 
-bool PPCRecompiler_makeRecompiledFunctionActive(uint32 initialEntryPoint, PPCFunctionBoundaryTracker::PPCRange_t& range, PPCRecFunction_t* ppcRecFunc, std::vector<std::pair<MPTR, uint32>>& entryPoints)
+// remove a finished compilation from the in-flight list and drop invalidation ranges that are no longer needed
+// assumes PPCRecompilerState.recompilerSpinlock is already held
+void PPCRecompiler_finishCompilation(uint64 invalidationSequence)
+{
+	cemu_assert_debug(PPCRecompilerState.recompilerSpinlock.is_locked());
+	auto it = PPCRecompilerState.activeCompileSequences.find(invalidationSequence);
+	cemu_assert_debug(it != PPCRecompilerState.activeCompileSequences.end());
+	if (it != PPCRecompilerState.activeCompileSequences.end())
+		PPCRecompilerState.activeCompileSequences.erase(it);
+	if (PPCRecompilerState.activeCompileSequences.empty())
+	{
+		PPCRecompilerState.invalidationRanges.clear();
+		for (auto& it : PPCRecompilerState.retiredFunctions)
+			delete it.first;
+		PPCRecompilerState.retiredFunctions.clear();
+		return;
+	}
+	uint64 oldestSequence = *PPCRecompilerState.activeCompileSequences.begin();
+	std::erase_if(PPCRecompilerState.invalidationRanges, [oldestSequence](const PPCInvalidationRange& r) { return r.sequence <= oldestSequence; });
+	std::erase_if(PPCRecompilerState.retiredFunctions, [oldestSequence](const std::pair<PPCRecFunction_t*, uint64>& r)
+	{
+		if (r.second > oldestSequence)
+			return false;
+		delete r.first;
+		return true;
+	});
+}
+
+// free the function object of a function that is no longer reachable from the jump table, branch sites or tier-up counters. Its code has to be released separately
+// assumes PPCRecompilerState.recompilerSpinlock is already held
+void PPCRecompiler_releaseFunctionObject(PPCRecFunction_t* func)
+{
+	cemu_assert_debug(PPCRecompilerState.recompilerSpinlock.is_locked());
+	if (PPCRecompilerState.activeCompileSequences.empty())
+	{
+		delete func;
+		return;
+	}
+	PPCRecompilerState.retiredFunctions.emplace_back(func, ++PPCRecompilerState.invalidationSequence);
+}
+
+// overwrite the 8 byte jump instruction of a branch site. Sites are 8 byte aligned so threads executing the code concurrently see either the old or the new instruction
+void PPCRecompiler_patchBranchSite(PPCRecFunction_t* func, ppcRecBranchSite_t& branchSite, uint64 instruction)
+{
+	// written through the writable view, the executable view observes the store since both map the same memory
+	uint64* site = (uint64*)((uint8*)func->x86CodeWritable + branchSite.x64Offset);
+	cemu_assert_debug(((uintptr_t)site & 7) == 0);
+	std::atomic_ref<uint64>(*site).store(instruction, std::memory_order_release);
+	s_branchLinkStats.patchCount++;
+}
+
+void PPCRecompiler_unlinkBranchSite(PPCRecFunction_t* func, ppcRecBranchSite_t& branchSite);
+
+// replace the jump table lookup of a branch site with a direct jump to the given code
+// assumes PPCRecompilerState.recompilerSpinlock is already held
+void PPCRecompiler_linkBranchSite(PPCRecFunction_t* func, ppcRecBranchSite_t& branchSite, PPCREC_JUMP_ENTRY target)
+{
+	cemu_assert_debug(PPCRecompilerState.recompilerSpinlock.is_locked());
+	sint64 distance = (sint64)((uintptr_t)target - ((uintptr_t)func->x86Code + branchSite.x64Offset + 5));
+	if (distance < (sint64)INT32_MIN || distance > (sint64)INT32_MAX)
+	{
+		// out of range, use the jump table. The site must not keep pointing to code that might get freed
+		PPCRecompiler_unlinkBranchSite(func, branchSite);
+		return;
+	}
+	// JMP rel32 + 3 byte NOP
+	uint64 instruction = 0xE9ULL;
+	instruction |= (uint64)(uint32)(sint32)distance << 8;
+	instruction |= 0x001F0FULL << 40;
+	if (!branchSite.isLinked)
+		s_branchLinkStats.linkedSites++;
+	else if (std::atomic_ref<uint64>(*(uint64*)((uint8*)func->x86Code + branchSite.x64Offset)).load() == instruction)
+		return;
+	branchSite.isLinked = true;
+	PPCRecompiler_patchBranchSite(func, branchSite, instruction);
+}
+
+// assumes PPCRecompilerState.recompilerSpinlock is already held
+void PPCRecompiler_unlinkBranchSite(PPCRecFunction_t* func, ppcRecBranchSite_t& branchSite)
+{
+	cemu_assert_debug(PPCRecompilerState.recompilerSpinlock.is_locked());
+	if (!branchSite.isLinked)
+		return;
+	branchSite.isLinked = false;
+	s_branchLinkStats.linkedSites--;
+	PPCRecompiler_patchBranchSite(func, branchSite, branchSite.unlinkedInstruction);
+}
+
+// restore the jump table lookup for all branch sites targeting the range
+// assumes PPCRecompilerState.recompilerSpinlock is already held
+void PPCRecompiler_unlinkBranchSitesInRange(uint32 startAddr, uint32 endAddr)
+{
+	auto it = PPCRecompilerState.branchSites.lower_bound(startAddr);
+	while (it != PPCRecompilerState.branchSites.end() && it->first < endAddr)
+	{
+		PPCRecFunction_t* func = it->second.first;
+		PPCRecompiler_unlinkBranchSite(func, func->list_branchSites[it->second.second]);
+		++it;
+	}
+}
+
+// link the branch sites of a newly activated function and relink every site that targets one of its entry points
+// assumes PPCRecompilerState.recompilerSpinlock is already held
+void PPCRecompiler_registerBranchSites(PPCRecFunction_t* ppcRecFunc, std::vector<std::pair<MPTR, uint32>>& entryPoints)
+{
+	for (uint32 i = 0; i < (uint32)ppcRecFunc->list_branchSites.size(); i++)
+	{
+		auto& branchSite = ppcRecFunc->list_branchSites[i];
+		PPCRecompilerState.branchSites.emplace(branchSite.ppcTarget, std::make_pair(ppcRecFunc, i));
+		s_branchLinkStats.registeredSites++;
+		auto funcPtr = ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[branchSite.ppcTarget / 4];
+		if (funcPtr != PPCRecompiler_leaveRecompilerCode_unvisited && funcPtr != PPCRecompiler_leaveRecompilerCode_visited)
+			PPCRecompiler_linkBranchSite(ppcRecFunc, branchSite, funcPtr);
+	}
+	for (auto& itr : entryPoints)
+	{
+		auto funcPtr = ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[itr.first / 4];
+		auto range = PPCRecompilerState.branchSites.equal_range(itr.first);
+		for (auto it = range.first; it != range.second; ++it)
+			PPCRecompiler_linkBranchSite(it->second.first, it->second.first->list_branchSites[it->second.second], funcPtr);
+	}
+}
+
+// assumes PPCRecompilerState.recompilerSpinlock is already held
+void PPCRecompiler_unregisterBranchSites(PPCRecFunction_t* func)
+{
+	for (uint32 i = 0; i < (uint32)func->list_branchSites.size(); i++)
+	{
+		auto& branchSite = func->list_branchSites[i];
+		PPCRecompiler_unlinkBranchSite(func, branchSite);
+		auto range = PPCRecompilerState.branchSites.equal_range(branchSite.ppcTarget);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (it->second.first == func && it->second.second == i)
+			{
+				PPCRecompilerState.branchSites.erase(it);
+				s_branchLinkStats.registeredSites--;
+				break;
+			}
+		}
+	}
+}
+
+PPCRecompilerBranchLinkStats PPCRecompiler_getBranchLinkStats()
+{
+	PPCRecompilerBranchLinkStats stats;
+	stats.registeredSites = s_branchLinkStats.registeredSites;
+	stats.linkedSites = s_branchLinkStats.linkedSites;
+	stats.patchCount = s_branchLinkStats.patchCount;
+	return stats;
+}
+
+// reserve a tier-up counter for a function that is about to be compiled at tier 0
+// assumes PPCRecompilerState.recompilerSpinlock is already held
+uint32 PPCRecompiler_allocateTierUpCounter()
+{
+	cemu_assert_debug(PPCRecompilerState.recompilerSpinlock.is_locked());
+	if (PPCRecompilerState.freeTierUpCounters.empty())
+		return PPC_REC_TIER_UP_INVALID_COUNTER;
+	uint32 counterIndex = PPCRecompilerState.freeTierUpCounters.back();
+	PPCRecompilerState.freeTierUpCounters.pop_back();
+	ppcRecompilerInstanceData->tierUpCounter[counterIndex] = PPC_REC_TIER_UP_THRESHOLD;
+	return counterIndex;
+}
+
+// assumes PPCRecompilerState.recompilerSpinlock is already held
+void PPCRecompiler_releaseTierUpCounter(uint32& counterIndex)
+{
+	cemu_assert_debug(PPCRecompilerState.recompilerSpinlock.is_locked());
+	if (counterIndex == PPC_REC_TIER_UP_INVALID_COUNTER)
+		return;
+	PPCRecompilerState.tierUpCounterOwner[counterIndex] = {};
+	PPCRecompilerState.freeTierUpCounters.emplace_back(counterIndex);
+	counterIndex = PPC_REC_TIER_UP_INVALID_COUNTER;
+}
+
+// queue all tier 0 functions whose counter ran out for recompilation at tier 1
+void PPCRecompiler_checkTierUpCounters()
+{
+	uint32 queuedCount = 0;
+	PPCRecompilerState.recompilerSpinlock.lock();
+	for (uint32 i = 0; i < (uint32)PPCRecompilerState.tierUpCounterOwner.size(); i++)
+	{
+		auto& owner = PPCRecompilerState.tierUpCounterOwner[i];
+		if (!owner.function || ppcRecompilerInstanceData->tierUpCounter[i] > 0)
+			continue;
+		// make sure the function isn't queued again while the tier 1 version is compiled
+		ppcRecompilerInstanceData->tierUpCounter[i] = std::numeric_limits<sint32>::max();
+		PPCRecompilerState.tierUpQueue.emplace_back(owner);
+		queuedCount++;
+	}
+	PPCRecompilerState.recompilerSpinlock.unlock();
+	for (uint32 i = 0; i < queuedCount; i++)
+		s_recompilerQueueSemaphore.notify();
+}
+
+// assumes PPCRecompilerState.recompilerSpinlock is already held
+bool PPCRecompiler_popTierUpFunction(PPCRecompilerTierUpEntry& entryOut)
+{
+	while (!PPCRecompilerState.tierUpQueue.empty())
+	{
+		PPCRecompilerTierUpEntry entry = PPCRecompilerState.tierUpQueue.front();
+		PPCRecompilerState.tierUpQueue.pop_front();
+		// skip functions that were invalidated in the meantime. Their counter was released and the function object may already be deleted
+		auto& owner = PPCRecompilerState.tierUpCounterOwner[entry.counterIndex];
+		if (owner.function != entry.function || owner.entryAddress != entry.entryAddress)
+			continue;
+		entryOut = entry;
+		return true;
+	}
+	return false;
+}
+
+// remove a tier 0 function after its tier 1 replacement was made active
+// unlike PPCRecompiler_deleteFunction this keeps all jump table entries that were taken over by the replacement
+// assumes PPCRecompilerState.recompilerSpinlock is already held
+void PPCRecompiler_retireFunction(PPCRecFunction_t* func)
+{
+	cemu_assert_debug(PPCRecompilerState.recompilerSpinlock.is_locked());
+	uint8* codeStart = (uint8*)func->x86Code;
+	uint8* codeEnd = codeStart + func->x86Size;
+	for (auto& r : func->list_ranges)
+	{
+		for (uint32 addr = r.ppcAddress; addr < r.ppcAddress + r.ppcSize; addr += 4)
+		{
+			uint8* funcPtr = (uint8*)ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[addr / 4];
+			if (funcPtr < codeStart || funcPtr >= codeEnd)
+				continue;
+			// entry point which the replacement does not provide
+			ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[addr / 4] = PPCRecompiler_leaveRecompilerCode_unvisited;
+			PPCRecompiler_unlinkBranchSitesInRange(addr, addr + 4);
+		}
+		if (r.storedRange)
+			rangeStore_ppcRanges.deleteRange(r.storedRange);
+		r.storedRange = nullptr;
+	}
+	PPCRecompiler_unregisterBranchSites(func);
+	PPCRecompiler_releaseTierUpCounter(func->tierUpCounterIndex);
+	// the x86 code is freed by the caller once all branch sites were relinked to the replacement
+}
+
+bool PPCRecompiler_makeRecompiledFunctionActive(uint32 initialEntryPoint, PPCFunctionBoundaryTracker::PPCRange_t& range, PPCRecFunction_t* ppcRecFunc, std::vector<std::pair<MPTR, uint32>>& entryPoints, uint64 invalidationSequence, PPCRecFunction_t* replacedFunction)
 {
 	// update jump table
 	PPCRecompilerState.recompilerSpinlock.lock();
 
-	// check if the initial entrypoint is still flagged for recompilation
+	// check if the initial entrypoint is still flagged for recompilation (or, for tier-up, if the tier 0 function is still active)
 	// its possible that the range has been invalidated during the time it took to translate the function
-	if (ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[initialEntryPoint / 4] != PPCRecompiler_leaveRecompilerCode_visited)
+	bool isStillRequested;
+	if (replacedFunction)
+		isStillRequested = replacedFunction->tierUpCounterIndex != PPC_REC_TIER_UP_INVALID_COUNTER && PPCRecompilerState.tierUpCounterOwner[replacedFunction->tierUpCounterIndex].function == replacedFunction;
+	else
+		isStillRequested = ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[initialEntryPoint / 4] == PPCRecompiler_leaveRecompilerCode_visited;
+	if (!isStillRequested)
 	{
+		PPCRecompiler_finishCompilation(invalidationSequence);
+		PPCRecompiler_releaseTierUpCounter(ppcRecFunc->tierUpCounterIndex);
 		PPCRecompilerState.recompilerSpinlock.unlock();
+		PPCRecompilerCodeHeap_freeUnpublished(ppcRecFunc->x86Code);
+		delete ppcRecFunc;
 		return false;
 	}
 
@@ -206,6 +603,8 @@ bool PPCRecompiler_makeRecompiledFunctionActive(uint32 initialEntryPoint, PPCFun
 	bool isInvalidated = false;
 	for (auto& invRange : PPCRecompilerState.invalidationRanges)
 	{
+		if (invRange.sequence <= invalidationSequence)
+			continue; // happened before the compilation started
 		MPTR rStartAddr = invRange.startAddress;
 		MPTR rEndAddr = rStartAddr + invRange.size;
 		for (auto& recFuncRange : ppcRecFunc->list_ranges)
@@ -217,13 +616,18 @@ bool PPCRecompiler_makeRecompiledFunctionActive(uint32 initialEntryPoint, PPCFun
 			}
 		}
 	}
-	PPCRecompilerState.invalidationRanges.clear();
+	PPCRecompiler_finishCompilation(invalidationSequence);
 	if (isInvalidated)
 	{
+		PPCRecompiler_releaseTierUpCounter(ppcRecFunc->tierUpCounterIndex);
 		PPCRecompilerState.recompilerSpinlock.unlock();
+		PPCRecompilerCodeHeap_freeUnpublished(ppcRecFunc->x86Code);
+		delete ppcRecFunc;
 		return false;
 	}
 
+	// other threads read the jump table without holding the lock, make sure the code is visible before it gets published
+	std::atomic_thread_fence(std::memory_order_release);
 
 	// update jump table
 	for (auto& itr : entryPoints)
@@ -243,20 +647,190 @@ bool PPCRecompiler_makeRecompiledFunctionActive(uint32 initialEntryPoint, PPCFun
 			ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[v / 4] = PPCRecompiler_leaveRecompilerCode_unvisited;
 	}
 
+	// remove the tier 0 version
+	if (replacedFunction)
+	{
+		PPCRecompiler_retireFunction(replacedFunction);
+		PPCRecompilerState.tierUpCount++;
+	}
+	// start counting executions
+	if (ppcRecFunc->tierUpCounterIndex != PPC_REC_TIER_UP_INVALID_COUNTER)
+		PPCRecompilerState.tierUpCounterOwner[ppcRecFunc->tierUpCounterIndex] = { ppcRecFunc, initialEntryPoint, ppcRecFunc->tierUpCounterIndex };
+
 	// register ranges
 	for (auto& r : ppcRecFunc->list_ranges)
 	{
 		r.storedRange = rangeStore_ppcRanges.storeRange(ppcRecFunc, r.ppcAddress, r.ppcAddress + r.ppcSize);
 	}
+
+	// chain with other active functions
+	PPCRecompiler_registerBranchSites(ppcRecFunc, entryPoints);
+	// nothing links to the tier 0 code anymore. Other threads might still be executing it, the memory is reused once they left it
+	if (replacedFunction)
+	{
+		PPCRecompilerCodeHeap_free(replacedFunction->x86Code);
+		replacedFunction->x86Code = nullptr;
+		replacedFunction->x86CodeWritable = nullptr;
+		replacedFunction->x86Size = 0;
+		PPCRecompiler_releaseFunctionObject(replacedFunction);
+	}
 	PPCRecompilerState.recompilerSpinlock.unlock();
 
 
 	return true;
 }
 
-void PPCRecompiler_recompileAtAddress(uint32 address)
+uint64 PPCRecompiler_hashCodeRanges(const std::vector<std::pair<MPTR, uint32>>& ranges)
 {
-	cemu_assert_debug(ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[address / 4] == PPCRecompiler_leaveRecompilerCode_visited);
+	uint64 h = 0x5182d367734c2ce8ull;
+	for (auto& it : ranges)
+	{
+		if (!memory_isAddressRangeAccessible(it.first, it.second))
+			return 0;
+		h = h * 7841u + it.first;
+		h = h * 7841u + it.second;
+		const uint32* code = (const uint32*)memory_getPointerFromVirtualOffset(it.first);
+		for (uint32 i = 0; i < it.second / 4; i++)
+		{
+			h = (h << 7) | (h >> (64 - 7));
+			h += code[i];
+		}
+	}
+	return h;
+}
+
+// assumes s_translationCache.mutex is held
+void PPCRecompiler_openTranslationCache()
+{
+	s_translationCache.isInitialized = true;
+	const uint64 titleId = CafeSystem::GetForegroundTitleId();
+	const auto pathCache = ActiveSettings::GetCachePath("recompilerCache/{:016x}_{:08x}.bin", titleId, CafeSystem::GetRPXHashUpdated());
+	std::error_code ec;
+	fs::create_directories(ActiveSettings::GetCachePath("recompilerCache"), ec);
+	s_translationCache.fileCache = FileCache::Open(pathCache, true, PPC_RECOMPILER_CACHE_VERSION);
+	if (!s_translationCache.fileCache)
+	{
+		cemuLog_log(LogType::Force, "Unable to open or create recompiler cache file \"{}\"", _pathToUtf8(pathCache));
+		return;
+	}
+	s_translationCache.fileCache->UseCompression(false);
+	std::vector<uint8> fileData;
+	sint32 maxIndex = s_translationCache.fileCache->GetMaximumFileIndex();
+	for (sint32 i = 0; i < maxIndex; i++)
+	{
+		uint64 name1, name2;
+		if (!s_translationCache.fileCache->GetFileByIndex(i, &name1, &name2, fileData))
+			continue;
+		MemStreamReader streamReader(fileData.data(), (sint32)fileData.size());
+		PPCRecompilerCacheEntry entry;
+		entry.entryAddress = (MPTR)name1;
+		entry.codeHash = name2;
+		uint32 rangeCount = streamReader.readBE<uint32>();
+		for (uint32 r = 0; r < rangeCount && !streamReader.hasError(); r++)
+		{
+			MPTR rangeAddress = streamReader.readBE<uint32>();
+			uint32 rangeSize = streamReader.readBE<uint32>();
+			entry.ranges.emplace_back(rangeAddress, rangeSize);
+		}
+		if (streamReader.hasError() || entry.ranges.empty() || entry.entryAddress >= PPC_REC_CODE_AREA_END)
+			continue;
+		s_translationCache.knownEntryAddresses.emplace(entry.entryAddress);
+		s_translationCache.pendingEntries.emplace_back(std::move(entry));
+	}
+	cemuLog_log(LogType::Force, "Recompiler cache: {} functions", s_translationCache.pendingEntries.size());
+}
+
+// queues all cached functions inside the code section whose code still matches
+// assumes s_translationCache.mutex is held
+void _PPCRecompiler_validateTranslationCache(MPTR textStart, uint32 textSize)
+{
+	const MPTR textEnd = textStart + textSize;
+	std::erase_if(s_translationCache.pendingEntries, [&](PPCRecompilerCacheEntry& entry)
+	{
+		if (entry.entryAddress < textStart || entry.entryAddress >= textEnd)
+			return false;
+		if (PPCRecompiler_hashCodeRanges(entry.ranges) != entry.codeHash)
+		{
+			// code differs from when the entry was created (e.g. different graphic pack patches), drop it
+			s_translationCache.knownEntryAddresses.erase(entry.entryAddress);
+			s_translationCache.fileCache->DeleteFile({ entry.entryAddress, entry.codeHash });
+			return true;
+		}
+		PPCRecompilerState.recompilerSpinlock.lock();
+		bool isQueued = ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[entry.entryAddress / 4] == PPCRecompiler_leaveRecompilerCode_unvisited;
+		if (isQueued)
+			PPCRecompiler_queueAddress(entry.entryAddress);
+		PPCRecompilerState.recompilerSpinlock.unlock();
+		if (isQueued)
+			s_recompilerQueueSemaphore.notify();
+		return true;
+	});
+}
+
+// called after a module was loaded and linked. Modules which are loaded at runtime already had their graphic pack patches applied at this point
+void PPCRecompiler_notifyModuleLoaded(MPTR textStart, uint32 textSize)
+{
+	if (ppcRecompilerEnabled == false)
+		return;
+	std::unique_lock _l(s_translationCache.mutex);
+	if (!s_translationCache.isInitialized)
+		PPCRecompiler_openTranslationCache();
+	if (!s_translationCache.patchesApplied)
+	{
+		s_translationCache.unvalidatedModules.emplace_back(textStart, textSize);
+		return;
+	}
+	_PPCRecompiler_validateTranslationCache(textStart, textSize);
+}
+
+// called once GamePatch_scan and the graphic pack patches have modified the modules loaded during boot, before any PPC code runs
+void PPCRecompiler_notifyPatchesApplied()
+{
+	if (ppcRecompilerEnabled == false)
+		return;
+	std::unique_lock _l(s_translationCache.mutex);
+	s_translationCache.patchesApplied = true;
+	for (auto& it : s_translationCache.unvalidatedModules)
+		_PPCRecompiler_validateTranslationCache(it.first, it.second);
+	s_translationCache.unvalidatedModules.clear();
+}
+
+void PPCRecompiler_storeTranslationCacheEntry(MPTR entryAddress, const std::vector<std::pair<MPTR, uint32>>& ranges)
+{
+	std::unique_lock _l(s_translationCache.mutex);
+	if (!s_translationCache.fileCache)
+		return;
+	if (s_translationCache.knownEntryAddresses.find(entryAddress) != s_translationCache.knownEntryAddresses.end())
+		return;
+	uint64 codeHash = PPCRecompiler_hashCodeRanges(ranges);
+	MemStreamWriter streamWriter(4 + ranges.size() * 8);
+	streamWriter.writeBE<uint32>((uint32)ranges.size());
+	for (auto& it : ranges)
+	{
+		streamWriter.writeBE<uint32>(it.first);
+		streamWriter.writeBE<uint32>(it.second);
+	}
+	auto fileData = streamWriter.getResult();
+	s_translationCache.fileCache->AddFile({ entryAddress, codeHash }, fileData.data(), (sint32)fileData.size());
+	s_translationCache.knownEntryAddresses.emplace(entryAddress);
+}
+
+void PPCRecompiler_closeTranslationCache()
+{
+	std::unique_lock _l(s_translationCache.mutex);
+	delete s_translationCache.fileCache;
+	s_translationCache.fileCache = nullptr;
+	s_translationCache.pendingEntries.clear();
+	s_translationCache.knownEntryAddresses.clear();
+	s_translationCache.isInitialized = false;
+	s_translationCache.patchesApplied = false;
+	s_translationCache.unvalidatedModules.clear();
+}
+
+// compile the function at address. If tier0Function is set this recompiles a hot tier 0 function at tier 1 and replaces it
+void PPCRecompiler_recompileAtAddress(uint32 address, uint64 invalidationSequence, PPCRecFunction_t* tier0Function)
+{
+	cemu_assert_debug(tier0Function || ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[address / 4] == PPCRecompiler_leaveRecompilerCode_visited);
 
 	// get size
 	PPCFunctionBoundaryTracker funcBoundaries;
@@ -277,60 +851,124 @@ void PPCRecompiler_recompileAtAddress(uint32 address)
 
 	entryAddresses.emplace(address);
 
+	// new functions start at tier 0, unless all tier-up counters are in use
+	uint8 tier = PPC_REC_TIER_1;
+	uint32 tierUpCounterIndex = PPC_REC_TIER_UP_INVALID_COUNTER;
+	if (!tier0Function)
+	{
+		tierUpCounterIndex = PPCRecompiler_allocateTierUpCounter();
+		if (tierUpCounterIndex != PPC_REC_TIER_UP_INVALID_COUNTER)
+			tier = PPC_REC_TIER_0;
+	}
+
 	PPCRecompilerState.recompilerSpinlock.unlock();
 
 	std::vector<std::pair<MPTR, uint32>> functionEntryPoints;
-	auto func = PPCRecompiler_recompileFunction(range, entryAddresses, functionEntryPoints);
+	auto func = PPCRecompiler_recompileFunction(range, entryAddresses, functionEntryPoints, tier, tierUpCounterIndex);
 
 	if (!func)
 	{
-		return; // recompilation failed
+		// recompilation failed
+		PPCRecompilerState.recompilerSpinlock.lock();
+		PPCRecompiler_finishCompilation(invalidationSequence);
+		PPCRecompiler_releaseTierUpCounter(tierUpCounterIndex);
+		PPCRecompilerState.recompilerSpinlock.unlock();
+		return;
+	}
+	// once active the function can be invalidated and deleted by other threads at any time, gather the ranges for the translation cache before that
+	std::vector<std::pair<MPTR, uint32>> funcRanges;
+	if (!tier0Function)
+	{
+		for (auto& r : func->list_ranges)
+			funcRanges.emplace_back(r.ppcAddress, r.ppcSize);
+	}
+	bool r = PPCRecompiler_makeRecompiledFunctionActive(address, range, func, functionEntryPoints, invalidationSequence, tier0Function);
+	if (r && !tier0Function)
+		PPCRecompiler_storeTranslationCacheEntry(address, funcRanges);
+}
+
+void PPCRecompiler_deleteFunction(PPCRecFunction_t* func);
+
+// delete all recompiled functions to get rid of code heap fragmentation. Functions are recompiled on demand when the interpreter hits them again
+void PPCRecompiler_flushCodeCache()
+{
+	PPCRecompilerState.recompilerSpinlock.lock();
+	uint32 rStart;
+	uint32 rEnd;
+	PPCRecFunction_t* rFunc;
+	uint32 functionCount = 0;
+	while (rangeStore_ppcRanges.findFirstRange(PPC_REC_CODE_AREA_START, PPC_REC_CODE_AREA_END, rStart, rEnd, rFunc))
+	{
+		PPCRecompiler_deleteFunction(rFunc);
+		functionCount++;
 	}
-	bool r = PPCRecompiler_makeRecompiledFunctionActive(address, range, func, functionEntryPoints);
+	PPCRecompilerState.recompilerSpinlock.unlock();
+	PPCRecompilerCodeHeapStats codeHeapStats = PPCRecompilerCodeHeap_getStats();
+	cemuLog_log(LogType::Force, "Recompiler code cache flushed, {} functions removed ({}KB heap)", functionCount, codeHeapStats.heapBytes / 1024);
 }
 
-std::thread s_threadRecompiler;
+std::vector<std::thread> s_threadsRecompiler;
 std::atomic_bool s_recompilerThreadStopSignal{false};
 
-void PPCRecompiler_thread()
+void PPCRecompiler_thread(sint32 workerIndex)
 {
-	SetThreadName("PPCRecompiler");
+	SetThreadName(fmt::format("PPCRecompiler{}", workerIndex).c_str());
+	// asynchronous recompilation:
+	// 1) wait until an address is queued
+	// 2) take the address with the highest priority that is still marked as visited. If there is none, take a hot tier 0 function
+	// 3) calculate size, gather all entry points, recompile and update jump table
+	// the first worker additionally checks the tier-up counters in regular intervals
+	auto lastTierUpCheck = std::chrono::steady_clock::now();
 	while (true)
 	{
-        if(s_recompilerThreadStopSignal)
-            return;
-		std::this_thread::sleep_for(std::chrono::milliseconds(10));
-		// asynchronous recompilation:
-		// 1) take address from queue
-		// 2) check if address is still marked as visited
-		// 3) if yes -> calculate size, gather all entry points, recompile and update jump table
-		while (true)
+		bool hasWork = true;
+		if (workerIndex == 0)
+			hasWork = s_recompilerQueueSemaphore.wait_for(std::chrono::milliseconds(10));
+		else
+			s_recompilerQueueSemaphore.wait();
+		if (s_recompilerThreadStopSignal)
+			return;
+		if (workerIndex == 0)
 		{
-			PPCRecompilerState.recompilerSpinlock.lock();
-			if (PPCRecompilerState.targetQueue.empty())
+			auto now = std::chrono::steady_clock::now();
+			if (now - lastTierUpCheck >= std::chrono::milliseconds(10))
 			{
-				PPCRecompilerState.recompilerSpinlock.unlock();
-				break;
+				lastTierUpCheck = now;
+				PPCRecompiler_checkTierUpCounters();
+				if (PPCRecompilerCodeHeap_consumeFlushRequest())
+					PPCRecompiler_flushCodeCache();
+				PPCRecompilerCodeHeap_reclaim();
 			}
-			auto enterAddress = PPCRecompilerState.targetQueue.front();
-			PPCRecompilerState.targetQueue.pop();
-
-			auto funcPtr = ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[enterAddress / 4];
-			if (funcPtr != PPCRecompiler_leaveRecompilerCode_visited)
+		}
+		if (!hasWork)
+			continue;
+		PPCRecompilerState.recompilerSpinlock.lock();
+		uint32 enterAddress;
+		PPCRecompilerTierUpEntry tierUpEntry{};
+		if (!PPCRecompiler_popQueuedAddress(enterAddress))
+		{
+			if (!PPCRecompiler_popTierUpFunction(tierUpEntry))
 			{
-				// only recompile functions if marked as visited
 				PPCRecompilerState.recompilerSpinlock.unlock();
 				continue;
 			}
-			PPCRecompilerState.recompilerSpinlock.unlock();
-
-			PPCRecompiler_recompileAtAddress(enterAddress);
-			if(s_recompilerThreadStopSignal)
-				return;
+			enterAddress = tierUpEntry.entryAddress;
 		}
+		uint64 invalidationSequence = PPCRecompilerState.invalidationSequence;
+		PPCRecompilerState.activeCompileSequences.emplace(invalidationSequence);
+		PPCRecompilerState.recompilerSpinlock.unlock();
+
+		PPCRecompiler_recompileAtAddress(enterAddress, invalidationSequence, tierUpEntry.function);
 	}
 }
 
+sint32 PPCRecompiler_getWorkerThreadCount()
+{
+	// leave room for the emulated cores and the GPU thread
+	sint32 hostThreadCount = (sint32)std::thread::hardware_concurrency();
+	return std::clamp<sint32>(hostThreadCount - 4, 1, 4);
+}
+
 #define PPC_REC_ALLOC_BLOCK_SIZE	(4*1024*1024) // 4MB
 
 constexpr uint32 PPCRecompiler_GetNumAddressSpaceBlocks()
@@ -421,6 +1059,7 @@ void PPCRecompiler_invalidateTableRange(uint32 offset, uint32 size)
 {
 	if (ppcRecompilerInstanceData == nullptr)
 		return;
+	PPCRecompiler_unlinkBranchSitesInRange(offset, offset + size);
 	for (uint32 i = 0; i < size / 4; i++)
 	{
 		ppcRecompilerInstanceData->ppcRecompilerFuncTable[offset / 4 + i] = nullptr;
@@ -439,11 +1078,19 @@ void PPCRecompiler_deleteFunction(PPCRecFunction_t* func)
 			rangeStore_ppcRanges.deleteRange(r.storedRange);
 		r.storedRange = nullptr;
 	}
-	// todo - free x86 code
+	PPCRecompiler_unregisterBranchSites(func);
+	PPCRecompiler_releaseTierUpCounter(func->tierUpCounterIndex);
+	PPCRecompilerCodeHeap_free(func->x86Code);
+	func->x86Code = nullptr;
+	func->x86CodeWritable = nullptr;
+	func->x86Size = 0;
+	PPCRecompiler_releaseFunctionObject(func);
 }
 
 void PPCRecompiler_invalidateRange(uint32 startAddr, uint32 endAddr)
 {
+	// the interpreter decode cache is active even when the recompiler is disabled
+	PPCInterpreter_invalidateDecodeCache(startAddr, endAddr);
 	if (ppcRecompilerEnabled == false)
 		return;
 	if (startAddr >= PPC_REC_CODE_AREA_SIZE)
@@ -459,9 +1106,13 @@ void PPCRecompiler_invalidateRange(uint32 startAddr, uint32 endAddr)
 	// mark range as unvisited
 	for (uint64 currentAddr = (uint64)startAddr&~3; currentAddr < (uint64)(endAddr&~3); currentAddr += 4)
 		ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable[currentAddr / 4] = PPCRecompiler_leaveRecompilerCode_unvisited;
+	// functions branching into the range have to go through the jump table again
+	PPCRecompiler_unlinkBranchSitesInRange(startAddr&~3, endAddr&~3);
 
 	// add entry to invalidation queue
-	PPCRecompilerState.invalidationRanges.emplace_back(startAddr, endAddr-startAddr);
+	PPCRecompilerState.invalidationSequence++;
+	if (!PPCRecompilerState.activeCompileSequences.empty())
+		PPCRecompilerState.invalidationRanges.emplace_back(startAddr, endAddr-startAddr, PPCRecompilerState.invalidationSequence);
 
 
 	while (rangeStore_ppcRanges.findFirstRange(startAddr, endAddr, rStart, rEnd, rFunc) )
@@ -506,7 +1157,12 @@ void PPCRecompiler_init()
 	debug_printf("Allocating %dMB for recompiler instance data...\n", (sint32)(sizeof(PPCRecompilerInstanceData_t) / 1024 / 1024));
 	ppcRecompilerInstanceData = (PPCRecompilerInstanceData_t*)MemMapper::ReserveMemory(nullptr, sizeof(PPCRecompilerInstanceData_t), MemMapper::PAGE_PERMISSION::P_RW);
 	MemMapper::AllocateMemory(&(ppcRecompilerInstanceData->_x64XMM_xorNegateMaskBottom), sizeof(PPCRecompilerInstanceData_t) - offsetof(PPCRecompilerInstanceData_t, _x64XMM_xorNegateMaskBottom), MemMapper::PAGE_PERMISSION::P_RW, true);
+	PPCRecompilerCodeHeap_init(ActiveSettings::GetRecompilerCodeCacheSize(), ActiveSettings::GetRecompilerCodeCacheCompaction(), ActiveSettings::GetRecompilerDualMapping());
+#if defined(ARCH_AARCH64)
+	PPCRecompilerAArch64Gen_generateRecompilerInterfaceFunctions();
+#else
 	PPCRecompilerX64Gen_generateRecompilerInterfaceFunctions();
+#endif
 
     PPCRecompiler_allocateRange(0, 0x1000); // the first entry is used for fallback to interpreter
     PPCRecompiler_allocateRange(mmuRange_TRAMPOLINE_AREA.getBase(), mmuRange_TRAMPOLINE_AREA.getSize());
@@ -593,21 +1249,70 @@ void PPCRecompiler_init()
 
 	ppcRecompilerEnabled = true;
 
-	// launch recompilation thread
+	// all tier-up counters are available
+	PPCRecompilerState.freeTierUpCounters.clear();
+	for (uint32 i = 0; i < PPC_REC_TIER_UP_COUNTER_COUNT; i++)
+		PPCRecompilerState.freeTierUpCounters.emplace_back(PPC_REC_TIER_UP_COUNTER_COUNT - 1 - i);
+	PPCRecompilerState.tierUpCounterOwner.assign(PPC_REC_TIER_UP_COUNTER_COUNT, {});
+
+	// launch recompilation threads
     s_recompilerThreadStopSignal = false;
-    s_threadRecompiler = std::thread(PPCRecompiler_thread);
+    s_recompilerQueueSemaphore.reset();
+    sint32 workerCount = PPCRecompiler_getWorkerThreadCount();
+    for (sint32 i = 0; i < workerCount; i++)
+        s_threadsRecompiler.emplace_back(PPCRecompiler_thread, i);
 }
 
 void PPCRecompiler_Shutdown()
 {
-    // shut down recompiler thread
+    // shut down recompiler threads
     s_recompilerThreadStopSignal = true;
-    if(s_threadRecompiler.joinable())
-        s_threadRecompiler.join();
+    for (size_t i = 0; i < s_threadsRecompiler.size(); i++)
+        s_recompilerQueueSemaphore.notify();
+    for (auto& thread : s_threadsRecompiler)
+    {
+        if (thread.joinable())
+            thread.join();
+    }
+    s_threadsRecompiler.clear();
     // clean up queues
-    while(!PPCRecompilerState.targetQueue.empty())
-        PPCRecompilerState.targetQueue.pop();
+    PPCRecompilerState.targetQueue = {};
+    PPCRecompilerState.targetHitCount.clear();
     PPCRecompilerState.invalidationRanges.clear();
+    PPCRecompilerState.activeCompileSequences.clear();
+    PPCRecompilerBranchLinkStats branchLinkStats = PPCRecompiler_getBranchLinkStats();
+    cemuLog_log(LogType::Statistics, "Recompiler branch links: {} sites, {} linked, {} patches", branchLinkStats.registeredSites, branchLinkStats.linkedSites, branchLinkStats.patchCount);
+    PPCRecompilerState.branchSites.clear();
+    cemuLog_log(LogType::Statistics, "Recompiler tiers: {} functions promoted to tier 1", PPCRecompilerState.tierUpCount);
+    PPCRecompilerCodeHeapStats codeHeapStats = PPCRecompilerCodeHeap_getStats();
+    cemuLog_log(LogType::Statistics, "Recompiler code heap: {}KB used of {}KB, {} flushes", (codeHeapStats.allocatedBytes - codeHeapStats.pendingFreeBytes) / 1024, codeHeapStats.heapBytes / 1024, codeHeapStats.flushCount);
+    PPCRecompilerState.freeTierUpCounters.clear();
+    PPCRecompilerState.tierUpCounterOwner.clear();
+    PPCRecompilerState.tierUpQueue.clear();
+    PPCRecompilerState.tierUpCount = 0;
+    if (!PPCRecompilerStats_dumpJSON(ActiveSettings::GetUserDataPath("log/recompiler_stats.json")))
+        cemuLog_log(LogType::Force, "Failed to write recompiler statistics");
+    PPCRecompilerStats_reset();
+    s_branchLinkStats.registeredSites = 0;
+    s_branchLinkStats.linkedSites = 0;
+    s_branchLinkStats.patchCount = 0;
+    PPCRecompiler_closeTranslationCache();
+    // delete all function objects, their code is released together with the code heap
+    for (auto& it : PPCRecompilerState.retiredFunctions)
+        delete it.first;
+    PPCRecompilerState.retiredFunctions.clear();
+    uint32 rStart;
+    uint32 rEnd;
+    PPCRecFunction_t* rFunc;
+    while (rangeStore_ppcRanges.findFirstRange(PPC_REC_CODE_AREA_START, PPC_REC_CODE_AREA_END, rStart, rEnd, rFunc))
+    {
+        for (auto& r : rFunc->list_ranges)
+        {
+            if (r.storedRange)
+                rangeStore_ppcRanges.deleteRange(r.storedRange);
+        }
+        delete rFunc;
+    }
     // clean range store
     rangeStore_ppcRanges.clear();
     // clean up memory
@@ -623,4 +1328,6 @@ void PPCRecompiler_Shutdown()
         // mark as unmapped
         ppcRecompiler_reservedBlockMask[i] = false;
     }
+    // the CPU threads are stopped at this point, release all recompiled code
+    PPCRecompilerCodeHeap_shutdown();
 }
\ No newline at end of file
@@ -8,6 +8,16 @@
 
 #define PPC_REC_MAX_VIRTUAL_GPR		(40) // enough to store 32 GPRs + a few SPRs + temp registers (usually only 1-2)
 
+// compile tiers
+// tier 0 skips the expensive optimization passes and counts function entries and loop iterations
+// once the counter runs out the function is recompiled at tier 1 with all optimizations enabled
+#define PPC_REC_TIER_0					(0)
+#define PPC_REC_TIER_1					(1)
+
+#define PPC_REC_TIER_UP_COUNTER_COUNT	(0x10000) // maximum number of tier 0 functions that can be active at the same time
+#define PPC_REC_TIER_UP_THRESHOLD		(2000) // number of entries + loop iterations before a tier 0 function gets recompiled
+#define PPC_REC_TIER_UP_INVALID_COUNTER	(0xFFFFFFFF)
+
 typedef struct  
 {
 	uint32 ppcAddress;
@@ -17,13 +27,25 @@ typedef struct
 	void* storedRange;
 }ppcRecRange_t;
 
+typedef struct
+{
+	uint32 x64Offset; // offset of the 8 byte aligned jump instruction within the function's x86 code
+	uint32 ppcTarget;
+	uint64 unlinkedInstruction; // original jump table based instruction, restored when the link is removed
+	bool isLinked;
+}ppcRecBranchSite_t;
+
 typedef struct  
 {
 	uint32 ppcAddress;
 	uint32 ppcSize; // ppc code size of function
 	void*  x86Code; // pointer to x86 code
+	void*  x86CodeWritable; // alias of x86Code used for patching. Differs from x86Code if code memory is dual mapped
 	size_t x86Size;
 	std::vector<ppcRecRange_t> list_ranges;
+	std::vector<ppcRecBranchSite_t> list_branchSites; // patchable branches to other functions
+	uint8  tier;
+	uint32 tierUpCounterIndex; // index into PPCRecompilerInstanceData_t::tierUpCounter for tier 0 functions
 }PPCRecFunction_t;
 
 #define PPCREC_IML_OP_FLAG_SIGNEXTEND			(1<<0)
@@ -326,6 +348,7 @@ struct ppcImlGenContext_t
 	sint32 segmentListCount;
 	// code generation control
 	bool hasFPUInstruction; // if true, PPCEnter macro will create FP_UNAVAIL checks -> Not needed in user mode
+	sint32 inlineBudget; // maximum instruction count of leaf functions that are inlined at BL call sites
 	// register allocator info
 	struct  
 	{
@@ -367,6 +390,8 @@ typedef struct
 	// MXCSR
 	uint32 _x64XMM_mxCsr_ftzOn;
 	uint32 _x64XMM_mxCsr_ftzOff;
+	// execution counters of tier 0 functions (decremented by the generated code)
+	sint32 tierUpCounter[PPC_REC_TIER_UP_COUNTER_COUNT];
 }PPCRecompilerInstanceData_t;
 
 extern PPCRecompilerInstanceData_t* ppcRecompilerInstanceData;
@@ -379,6 +404,18 @@ void PPCRecompiler_allocateRange(uint32 startAddress, uint32 size);
 
 void PPCRecompiler_invalidateRange(uint32 startAddr, uint32 endAddr);
 
+void PPCRecompiler_notifyModuleLoaded(MPTR textStart, uint32 textSize);
+void PPCRecompiler_notifyPatchesApplied();
+
+struct PPCRecompilerBranchLinkStats
+{
+	uint32 registeredSites; // number of patchable branch sites in active functions
+	uint32 linkedSites; // number of sites that currently jump directly to their target
+	uint64 patchCount; // total number of link and unlink patches
+};
+
+PPCRecompilerBranchLinkStats PPCRecompiler_getBranchLinkStats();
+
 extern void ATTR_MS_ABI (*PPCRecompiler_enterRecompilerCode)(uint64 codeMem, uint64 ppcInterpreterInstance);
 extern void ATTR_MS_ABI (*PPCRecompiler_leaveRecompilerCode_visited)();
 extern void ATTR_MS_ABI (*PPCRecompiler_leaveRecompilerCode_unvisited)();
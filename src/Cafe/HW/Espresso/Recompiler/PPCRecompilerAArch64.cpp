@@ -0,0 +1,1235 @@
+#include "Cafe/HW/Espresso/PPCState.h"
+#include "Cafe/HW/Espresso/Interpreter/PPCInterpreterInternal.h"
+#include "Cafe/HW/Espresso/Interpreter/PPCInterpreterHelper.h"
+#include "PPCRecompiler.h"
+#include "PPCRecompilerIml.h"
+#include "PPCRecompilerX64.h"
+#include "PPCRecompilerAArch64.h"
+#include "util/MemMapper/MemMapper.h"
+
+// AArch64 host backend
+// Lowers the same IML as the x64 backend. Register usage:
+// X3 - X14		virtual GPRs (see aarch64Gen_registerMap)
+// X19			hCPU (PPCInterpreter_t*)
+// X20			memory_base
+// X21			ppcRecompilerInstanceData
+// X22			ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable
+// X17			PPC instruction pointer when jumping through the direct jump table
+// X0-X2, X15, X16	scratch
+// CR bits are always written back to hCPU->cr, only the BDNZ counter update keeps its result in the host flags
+// FPR/paired-single instructions are not supported yet, functions using them fail to compile and stay in the interpreter
+
+sint32 aarch64Gen_registerMap[12] = // virtual GPR to AArch64 register mapping
+{
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14
+};
+
+void* ATTR_MS_ABI PPCRecompiler_virtualHLE(PPCInterpreter_t* hCPU, uint32 hleFuncId);
+void ATTR_MS_ABI PPCRecompiler_getTBL(PPCInterpreter_t* hCPU, uint32 gprIndex);
+void ATTR_MS_ABI PPCRecompiler_getTBU(PPCInterpreter_t* hCPU, uint32 gprIndex);
+
+#define AARCH64_CR_BIT_OFFSET(__crBit) ((sint32)(offsetof(PPCInterpreter_t, cr) + sizeof(uint8) * (__crBit)))
+
+/*
+* Remember current instruction output offset for reloc
+* The instruction generated after this method has been called will be adjusted
+*/
+void PPCRecompilerAArch64Gen_rememberRelocatableOffset(aarch64GenContext_t* aarch64GenContext, uint8 type, void* extraInfo = nullptr)
+{
+	if( aarch64GenContext->relocateOffsetTableCount >= aarch64GenContext->relocateOffsetTableSize )
+	{
+		aarch64GenContext->relocateOffsetTableSize = std::max(4, aarch64GenContext->relocateOffsetTableSize*2);
+		aarch64GenContext->relocateOffsetTable = (aarch64RelocEntry_t*)realloc(aarch64GenContext->relocateOffsetTable, sizeof(aarch64RelocEntry_t)*aarch64GenContext->relocateOffsetTableSize);
+	}
+	aarch64GenContext->relocateOffsetTable[aarch64GenContext->relocateOffsetTableCount].offset = aarch64GenContext->codeBufferIndex;
+	aarch64GenContext->relocateOffsetTable[aarch64GenContext->relocateOffsetTableCount].type = type;
+	aarch64GenContext->relocateOffsetTable[aarch64GenContext->relocateOffsetTableCount].extraInfo = extraInfo;
+	aarch64GenContext->relocateOffsetTableCount++;
+}
+
+void PPCRecompilerAArch64Gen_flushInstructionCache(void* code, sint32 size)
+{
+#if BOOST_OS_WINDOWS
+	FlushInstructionCache(GetCurrentProcess(), code, size);
+#else
+	__builtin___clear_cache((char*)code, (char*)code + size);
+#endif
+}
+
+/*
+* Store the LT/GT/EQ bits of the instruction's cr register based on the current host flags
+*/
+void PPCRecompilerAArch64Gen_storeCRFromFlags(aarch64GenContext_t* aarch64GenContext, PPCRecImlInstruction_t* imlInstruction, sint32 conditionLT, sint32 conditionGT)
+{
+	sint32 crRegister = imlInstruction->crRegister;
+	if( (imlInstruction->crIgnoreMask&(1<<(crRegister*4+PPCREC_CR_BIT_LT))) == 0 )
+	{
+		aarch64Gen_cset_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, conditionLT);
+		aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(crRegister*4+PPCREC_CR_BIT_LT), AARCH64_REG_RESV_TEMP);
+	}
+	if( (imlInstruction->crIgnoreMask&(1<<(crRegister*4+PPCREC_CR_BIT_GT))) == 0 )
+	{
+		aarch64Gen_cset_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, conditionGT);
+		aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(crRegister*4+PPCREC_CR_BIT_GT), AARCH64_REG_RESV_TEMP);
+	}
+	if( (imlInstruction->crIgnoreMask&(1<<(crRegister*4+PPCREC_CR_BIT_EQ))) == 0 )
+	{
+		aarch64Gen_cset_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_COND_EQ);
+		aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(crRegister*4+PPCREC_CR_BIT_EQ), AARCH64_REG_RESV_TEMP);
+	}
+	if( (imlInstruction->crIgnoreMask&(1<<(crRegister*4+PPCREC_CR_BIT_SO))) == 0 )
+	{
+		// copy XER SO (bit 31) to CR SO
+		aarch64Gen_ldr_reg32_mem32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, spr.XER));
+		aarch64Gen_lsr_reg32_reg32_imm(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP, 31);
+		aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(crRegister*4+PPCREC_CR_BIT_SO), AARCH64_REG_RESV_TEMP);
+	}
+}
+
+void PPCRecompilerAArch64Gen_updateCRLogical(aarch64GenContext_t* aarch64GenContext, PPCRecImlInstruction_t* imlInstruction, sint32 resultRegister)
+{
+	aarch64Gen_cmp_reg32_imm32(aarch64GenContext, resultRegister, 0);
+	PPCRecompilerAArch64Gen_storeCRFromFlags(aarch64GenContext, imlInstruction, AARCH64_COND_LT, AARCH64_COND_GT);
+}
+
+/*
+* Copy xer_ca into the host carry flag
+*/
+void PPCRecompilerAArch64Gen_loadCarry(aarch64GenContext_t* aarch64GenContext)
+{
+	aarch64Gen_ldrb_reg32_mem8(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, xer_ca));
+	aarch64Gen_cmp_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP, 1);
+}
+
+/*
+* Copy the host carry flag into xer_ca (does not modify flags)
+*/
+void PPCRecompilerAArch64Gen_storeCarry(aarch64GenContext_t* aarch64GenContext)
+{
+	aarch64Gen_cset_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_COND_CS);
+	aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, xer_ca), AARCH64_REG_RESV_TEMP);
+}
+
+/*
+* Jump to the function registered in the direct jump table for the PPC address in X17
+*/
+void PPCRecompilerAArch64Gen_jumpToIP(aarch64GenContext_t* aarch64GenContext)
+{
+	aarch64Gen_lsr_reg32_reg32_imm(aarch64GenContext, AARCH64_REG_RESV_TEMP2, AARCH64_REG_RESV_IP, 2);
+	aarch64Gen_ldr_reg64_mem64Index(aarch64GenContext, AARCH64_REG_RESV_TEMP2, AARCH64_REG_RESV_JUMPTABLE, AARCH64_REG_RESV_TEMP2);
+	aarch64Gen_br_reg64(aarch64GenContext, AARCH64_REG_RESV_TEMP2);
+}
+
+/*
+* Leave recompiler via ppcRecompilerDirectJumpTable[0], X17 must hold the PPC instruction pointer
+*/
+void PPCRecompilerAArch64Gen_jumpToExit(aarch64GenContext_t* aarch64GenContext)
+{
+	aarch64Gen_ldr_reg64_mem64(aarch64GenContext, AARCH64_REG_RESV_TEMP2, AARCH64_REG_RESV_JUMPTABLE, 0);
+	aarch64Gen_br_reg64(aarch64GenContext, AARCH64_REG_RESV_TEMP2);
+}
+
+bool PPCRecompilerAArch64Gen_imlInstruction_macro(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext, aarch64GenContext_t* aarch64GenContext, PPCRecImlInstruction_t* imlInstruction)
+{
+	if( imlInstruction->operation == PPCREC_IML_MACRO_BLR || imlInstruction->operation == PPCREC_IML_MACRO_BLRL ||
+		imlInstruction->operation == PPCREC_IML_MACRO_BCTR || imlInstruction->operation == PPCREC_IML_MACRO_BCTRL )
+	{
+		uint32 currentInstructionAddress = imlInstruction->op_macro.param;
+		bool isBCTR = imlInstruction->operation == PPCREC_IML_MACRO_BCTR || imlInstruction->operation == PPCREC_IML_MACRO_BCTRL;
+		aarch64Gen_ldr_reg32_mem32(aarch64GenContext, AARCH64_REG_RESV_IP, AARCH64_REG_RESV_HCPU, isBCTR ? offsetof(PPCInterpreter_t, spr.CTR) : offsetof(PPCInterpreter_t, spr.LR));
+		// if BLRL/BCTRL, then update SPR LR
+		if( imlInstruction->operation == PPCREC_IML_MACRO_BLRL || imlInstruction->operation == PPCREC_IML_MACRO_BCTRL )
+		{
+			aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP, currentInstructionAddress + 4);
+			aarch64Gen_str_mem32_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, spr.LR), AARCH64_REG_RESV_TEMP);
+		}
+		PPCRecompilerAArch64Gen_jumpToIP(aarch64GenContext);
+		return true;
+	}
+	else if( imlInstruction->operation == PPCREC_IML_MACRO_BL || imlInstruction->operation == PPCREC_IML_MACRO_B_FAR )
+	{
+		if( imlInstruction->operation == PPCREC_IML_MACRO_BL )
+		{
+			uint32 newLR = imlInstruction->op_macro.param + 4;
+			aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP, newLR);
+			aarch64Gen_str_mem32_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, spr.LR), AARCH64_REG_RESV_TEMP);
+		}
+		// always dispatched through the direct jump table, this backend does not emit linkable branch sites like PPCRecompilerX64Gen_branchSite
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_IP, imlInstruction->op_macro.param2);
+		PPCRecompilerAArch64Gen_jumpToIP(aarch64GenContext);
+		return true;
+	}
+	else if( imlInstruction->operation == PPCREC_IML_MACRO_LEAVE )
+	{
+		uint32 currentInstructionAddress = imlInstruction->op_macro.param;
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_IP, currentInstructionAddress);
+		PPCRecompilerAArch64Gen_jumpToExit(aarch64GenContext);
+		return true;
+	}
+	else if( imlInstruction->operation == PPCREC_IML_MACRO_DEBUGBREAK )
+	{
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP, imlInstruction->op_macro.param2);
+		aarch64Gen_brk(aarch64GenContext);
+		return true;
+	}
+	else if( imlInstruction->operation == PPCREC_IML_MACRO_COUNT_CYCLES )
+	{
+		uint32 cycleCount = imlInstruction->op_macro.param;
+		aarch64Gen_ldr_reg32_mem32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, remainingCycles));
+		aarch64Gen_add_reg32_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP, -(sint32)cycleCount);
+		aarch64Gen_str_mem32_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, remainingCycles), AARCH64_REG_RESV_TEMP);
+		return true;
+	}
+	else if( imlInstruction->operation == PPCREC_IML_MACRO_COUNT_TIER_UP )
+	{
+		uint32 counterIndex = imlInstruction->op_macro.param;
+		sint32 counterOffset = (sint32)(offsetof(PPCRecompilerInstanceData_t, tierUpCounter) + counterIndex * sizeof(sint32));
+		aarch64Gen_ldr_reg32_mem32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_RECDATA, counterOffset);
+		aarch64Gen_add_reg32_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP, -1);
+		aarch64Gen_str_mem32_reg32(aarch64GenContext, AARCH64_REG_RESV_RECDATA, counterOffset, AARCH64_REG_RESV_TEMP);
+		return true;
+	}
+	else if( imlInstruction->operation == PPCREC_IML_MACRO_HLE )
+	{
+		uint32 ppcAddress = imlInstruction->op_macro.param;
+		uint32 funcId = imlInstruction->op_macro.param2;
+		// update instruction pointer
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP, ppcAddress);
+		aarch64Gen_str_mem32_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, instructionPointer), AARCH64_REG_RESV_TEMP);
+		// call HLE function. SP is the native stack at all times, X19-X22 are callee-saved
+		aarch64Gen_mov_reg64_reg64(aarch64GenContext, AARCH64_REG_RESV_ARG0, AARCH64_REG_RESV_HCPU);
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_ARG1, funcId);
+		aarch64Gen_mov_reg64_imm64(aarch64GenContext, AARCH64_REG_RESV_TEMP2, (uint64)PPCRecompiler_virtualHLE);
+		aarch64Gen_blr_reg64(aarch64GenContext, AARCH64_REG_RESV_TEMP2);
+		// result is the (possibly different) hCPU
+		aarch64Gen_mov_reg64_reg64(aarch64GenContext, AARCH64_REG_RESV_HCPU, AARCH64_REG_RESV_ARG0);
+		// check if cycles where decreased beyond zero, if yes -> leave recompiler
+		aarch64Gen_ldr_reg32_mem32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, remainingCycles));
+		aarch64Gen_cmp_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP, 0);
+		sint32 jumpInstructionOffset1 = aarch64GenContext->codeBufferIndex;
+		aarch64Gen_bcond(aarch64GenContext, AARCH64_COND_GE);
+		aarch64Gen_ldr_reg32_mem32(aarch64GenContext, AARCH64_REG_RESV_IP, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, instructionPointer));
+		PPCRecompilerAArch64Gen_jumpToExit(aarch64GenContext);
+		aarch64Gen_patchBranch(aarch64GenContext, jumpInstructionOffset1, aarch64GenContext->codeBufferIndex);
+		// continue at the (possibly changed) instruction pointer
+		aarch64Gen_ldr_reg32_mem32(aarch64GenContext, AARCH64_REG_RESV_IP, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, instructionPointer));
+		PPCRecompilerAArch64Gen_jumpToIP(aarch64GenContext);
+		return true;
+	}
+	else if( imlInstruction->operation == PPCREC_IML_MACRO_MFTB )
+	{
+		uint32 ppcAddress = imlInstruction->op_macro.param;
+		uint32 sprId = imlInstruction->op_macro.param2&0xFFFF;
+		uint32 gprIndex = (imlInstruction->op_macro.param2>>16)&0x1F;
+		// update instruction pointer
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP, ppcAddress);
+		aarch64Gen_str_mem32_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, instructionPointer), AARCH64_REG_RESV_TEMP);
+		// set parameters
+		aarch64Gen_mov_reg64_reg64(aarch64GenContext, AARCH64_REG_RESV_ARG0, AARCH64_REG_RESV_HCPU);
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_ARG1, gprIndex);
+		if( sprId == SPR_TBL )
+			aarch64Gen_mov_reg64_imm64(aarch64GenContext, AARCH64_REG_RESV_TEMP2, (uint64)PPCRecompiler_getTBL);
+		else if( sprId == SPR_TBU )
+			aarch64Gen_mov_reg64_imm64(aarch64GenContext, AARCH64_REG_RESV_TEMP2, (uint64)PPCRecompiler_getTBU);
+		else
+			return false;
+		aarch64Gen_blr_reg64(aarch64GenContext, AARCH64_REG_RESV_TEMP2);
+		return true;
+	}
+	debug_printf("Unknown recompiler macro operation %d\n", imlInstruction->operation);
+	return false;
+}
+
+/*
+* Calculate the 32bit effective address memReg (+ memReg2) + immS32
+* Returns the register holding the EA, which is either memReg itself or REG_RESV_TEMP
+*/
+sint32 PPCRecompilerAArch64Gen_calculateEA(aarch64GenContext_t* aarch64GenContext, sint32 realRegisterMem, sint32 realRegisterMem2, sint32 immS32)
+{
+	if( realRegisterMem2 == PPC_REC_INVALID_REGISTER )
+	{
+		if( immS32 == 0 )
+			return realRegisterMem;
+		aarch64Gen_add_reg32_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP, realRegisterMem, immS32);
+		return AARCH64_REG_RESV_TEMP;
+	}
+	aarch64Gen_add_reg32_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, realRegisterMem, realRegisterMem2);
+	aarch64Gen_add_reg32_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP, immS32);
+	return AARCH64_REG_RESV_TEMP;
+}
+
+/*
+* Load from memory
+*/
+bool PPCRecompilerAArch64Gen_imlInstruction_load(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext, aarch64GenContext_t* aarch64GenContext, PPCRecImlInstruction_t* imlInstruction, bool indexed)
+{
+	sint32 realRegisterData = aarch64TempToRealRegister(imlInstruction->op_storeLoad.registerData);
+	sint32 realRegisterMem = aarch64TempToRealRegister(imlInstruction->op_storeLoad.registerMem);
+	sint32 realRegisterMem2 = PPC_REC_INVALID_REGISTER;
+	if( indexed )
+		realRegisterMem2 = aarch64TempToRealRegister(imlInstruction->op_storeLoad.registerMem2);
+	bool signExtend = imlInstruction->op_storeLoad.flags2.signExtend;
+	bool switchEndian = imlInstruction->op_storeLoad.flags2.swapEndian;
+	if( imlInstruction->op_storeLoad.copyWidth == 32 )
+	{
+		sint32 eaRegister = PPCRecompilerAArch64Gen_calculateEA(aarch64GenContext, realRegisterMem, realRegisterMem2, imlInstruction->op_storeLoad.immS32);
+		aarch64Gen_ldr_reg32_mem32uxtw(aarch64GenContext, realRegisterData, AARCH64_REG_RESV_MEMBASE, eaRegister);
+		if( switchEndian )
+			aarch64Gen_rev_reg32_reg32(aarch64GenContext, realRegisterData, realRegisterData);
+	}
+	else if( imlInstruction->op_storeLoad.copyWidth == 16 )
+	{
+		sint32 eaRegister = PPCRecompilerAArch64Gen_calculateEA(aarch64GenContext, realRegisterMem, realRegisterMem2, imlInstruction->op_storeLoad.immS32);
+		aarch64Gen_ldrh_reg32_mem16uxtw(aarch64GenContext, realRegisterData, AARCH64_REG_RESV_MEMBASE, eaRegister);
+		if( switchEndian )
+			aarch64Gen_rev16_reg32_reg32(aarch64GenContext, realRegisterData, realRegisterData);
+		if( signExtend )
+			aarch64Gen_sxth_reg32_reg32(aarch64GenContext, realRegisterData, realRegisterData);
+	}
+	else if( imlInstruction->op_storeLoad.copyWidth == 8 )
+	{
+		sint32 eaRegister = PPCRecompilerAArch64Gen_calculateEA(aarch64GenContext, realRegisterMem, realRegisterMem2, imlInstruction->op_storeLoad.immS32);
+		if( signExtend )
+			aarch64Gen_ldrsb_reg32_mem8uxtw(aarch64GenContext, realRegisterData, AARCH64_REG_RESV_MEMBASE, eaRegister);
+		else
+			aarch64Gen_ldrb_reg32_mem8uxtw(aarch64GenContext, realRegisterData, AARCH64_REG_RESV_MEMBASE, eaRegister);
+	}
+	else if( imlInstruction->op_storeLoad.copyWidth == PPC_REC_LOAD_LWARX_MARKER )
+	{
+		if( imlInstruction->op_storeLoad.immS32 != 0 )
+			return false;
+		sint32 eaRegister = PPCRecompilerAArch64Gen_calculateEA(aarch64GenContext, realRegisterMem, realRegisterMem2, 0);
+		aarch64Gen_str_mem32_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, reservedMemAddr), eaRegister); // remember EA for reservation
+		aarch64Gen_ldr_reg32_mem32uxtw(aarch64GenContext, realRegisterData, AARCH64_REG_RESV_MEMBASE, eaRegister);
+		if( switchEndian )
+			aarch64Gen_rev_reg32_reg32(aarch64GenContext, realRegisterData, realRegisterData);
+		aarch64Gen_str_mem32_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, reservedMemValue), realRegisterData); // remember value for reservation
+		// LWARX instruction costs extra cycles (this speeds up busy loops)
+		aarch64Gen_ldr_reg32_mem32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, remainingCycles));
+		aarch64Gen_add_reg32_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP, -20);
+		aarch64Gen_str_mem32_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, remainingCycles), AARCH64_REG_RESV_TEMP);
+	}
+	else if( imlInstruction->op_storeLoad.copyWidth == PPC_REC_STORE_LSWI_3 )
+	{
+		if( switchEndian == false )
+			return false;
+		sint32 eaRegister = PPCRecompilerAArch64Gen_calculateEA(aarch64GenContext, realRegisterMem, realRegisterMem2, imlInstruction->op_storeLoad.immS32);
+		aarch64Gen_ldr_reg32_mem32uxtw(aarch64GenContext, realRegisterData, AARCH64_REG_RESV_MEMBASE, eaRegister);
+		aarch64Gen_rev_reg32_reg32(aarch64GenContext, realRegisterData, realRegisterData);
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_ARG1, 0xFFFFFF00);
+		aarch64Gen_and_reg32_reg32_reg32(aarch64GenContext, realRegisterData, realRegisterData, AARCH64_REG_RESV_ARG1);
+	}
+	else
+		return false;
+	return true;
+}
+
+/*
+* Write to memory
+*/
+bool PPCRecompilerAArch64Gen_imlInstruction_store(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext, aarch64GenContext_t* aarch64GenContext, PPCRecImlInstruction_t* imlInstruction, bool indexed)
+{
+	sint32 realRegisterData = aarch64TempToRealRegister(imlInstruction->op_storeLoad.registerData);
+	sint32 realRegisterMem = aarch64TempToRealRegister(imlInstruction->op_storeLoad.registerMem);
+	sint32 realRegisterMem2 = PPC_REC_INVALID_REGISTER;
+	if( indexed )
+		realRegisterMem2 = aarch64TempToRealRegister(imlInstruction->op_storeLoad.registerMem2);
+	bool swapEndian = imlInstruction->op_storeLoad.flags2.swapEndian;
+	if( imlInstruction->op_storeLoad.copyWidth == 32 )
+	{
+		sint32 valueRegister = realRegisterData;
+		if( swapEndian )
+		{
+			aarch64Gen_rev_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP2, realRegisterData);
+			valueRegister = AARCH64_REG_RESV_TEMP2;
+		}
+		sint32 eaRegister = PPCRecompilerAArch64Gen_calculateEA(aarch64GenContext, realRegisterMem, realRegisterMem2, imlInstruction->op_storeLoad.immS32);
+		aarch64Gen_str_mem32uxtw_reg32(aarch64GenContext, AARCH64_REG_RESV_MEMBASE, eaRegister, valueRegister);
+	}
+	else if( imlInstruction->op_storeLoad.copyWidth == 16 )
+	{
+		sint32 valueRegister = realRegisterData;
+		if( swapEndian )
+		{
+			aarch64Gen_rev16_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP2, realRegisterData);
+			valueRegister = AARCH64_REG_RESV_TEMP2;
+		}
+		sint32 eaRegister = PPCRecompilerAArch64Gen_calculateEA(aarch64GenContext, realRegisterMem, realRegisterMem2, imlInstruction->op_storeLoad.immS32);
+		aarch64Gen_strh_mem16uxtw_reg32(aarch64GenContext, AARCH64_REG_RESV_MEMBASE, eaRegister, valueRegister);
+	}
+	else if( imlInstruction->op_storeLoad.copyWidth == 8 )
+	{
+		sint32 eaRegister = PPCRecompilerAArch64Gen_calculateEA(aarch64GenContext, realRegisterMem, realRegisterMem2, imlInstruction->op_storeLoad.immS32);
+		aarch64Gen_strb_mem8uxtw_reg32(aarch64GenContext, AARCH64_REG_RESV_MEMBASE, eaRegister, realRegisterData);
+	}
+	else if( imlInstruction->op_storeLoad.copyWidth == PPC_REC_STORE_STWCX_MARKER )
+	{
+		if( imlInstruction->op_storeLoad.immS32 != 0 )
+			return false;
+		// reset cr0 LT, GT and EQ
+		sint32 crRegister = 0;
+		aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(crRegister*4+PPCREC_CR_BIT_LT), AARCH64_REG_ZR);
+		aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(crRegister*4+PPCREC_CR_BIT_GT), AARCH64_REG_ZR);
+		aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(crRegister*4+PPCREC_CR_BIT_EQ), AARCH64_REG_ZR);
+		// calculate effective address
+		sint32 eaRegister = PPCRecompilerAArch64Gen_calculateEA(aarch64GenContext, realRegisterMem, realRegisterMem2, 0);
+		if( eaRegister != AARCH64_REG_RESV_TEMP )
+			aarch64Gen_mov_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, eaRegister);
+		// compare with reservation
+		aarch64Gen_ldr_reg32_mem32(aarch64GenContext, AARCH64_REG_RESV_TEMP2, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, reservedMemAddr));
+		aarch64Gen_cmp_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP2);
+		sint32 jumpInstructionOffsetJumpToEnd = aarch64GenContext->codeBufferIndex;
+		aarch64Gen_bcond(aarch64GenContext, AARCH64_COND_NE);
+		// EA matches reservation
+		// W0 = new value, W1 = reserved value (both in memory byte order)
+		if( swapEndian )
+			aarch64Gen_rev_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_ARG0, realRegisterData);
+		else
+			aarch64Gen_mov_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_ARG0, realRegisterData);
+		aarch64Gen_ldr_reg32_mem32(aarch64GenContext, AARCH64_REG_RESV_ARG1, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, reservedMemValue));
+		aarch64Gen_rev_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_ARG1, AARCH64_REG_RESV_ARG1);
+		aarch64Gen_add_reg64_reg64_reg32uxtw(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_MEMBASE, AARCH64_REG_RESV_TEMP);
+		// compare-and-swap loop
+		sint32 retryOffset = aarch64GenContext->codeBufferIndex;
+		aarch64Gen_ldaxr_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP2, AARCH64_REG_RESV_TEMP);
+		aarch64Gen_cmp_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP2, AARCH64_REG_RESV_ARG1);
+		sint32 jumpInstructionOffsetFail = aarch64GenContext->codeBufferIndex;
+		aarch64Gen_bcond(aarch64GenContext, AARCH64_COND_NE);
+		aarch64Gen_stlxr_reg32(aarch64GenContext, AARCH64_REG_RESV_IP, AARCH64_REG_RESV_ARG0, AARCH64_REG_RESV_TEMP);
+		sint32 jumpInstructionOffsetRetry = aarch64GenContext->codeBufferIndex;
+		aarch64Gen_cbnz_reg32(aarch64GenContext, AARCH64_REG_RESV_IP);
+		aarch64Gen_patchBranch(aarch64GenContext, jumpInstructionOffsetRetry, retryOffset);
+		sint32 jumpInstructionOffsetDone = aarch64GenContext->codeBufferIndex;
+		aarch64Gen_b(aarch64GenContext);
+		aarch64Gen_patchBranch(aarch64GenContext, jumpInstructionOffsetFail, aarch64GenContext->codeBufferIndex);
+		aarch64Gen_clrex(aarch64GenContext);
+		aarch64Gen_patchBranch(aarch64GenContext, jumpInstructionOffsetDone, aarch64GenContext->codeBufferIndex);
+		// flags are still set by the compare inside the loop
+		aarch64Gen_cset_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP2, AARCH64_COND_EQ);
+		aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(crRegister*4+PPCREC_CR_BIT_EQ), AARCH64_REG_RESV_TEMP2);
+		// reset reservation
+		aarch64Gen_str_mem32_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, reservedMemAddr), AARCH64_REG_ZR);
+		aarch64Gen_str_mem32_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, reservedMemValue), AARCH64_REG_ZR);
+		// copy XER SO to CR0 SO
+		aarch64Gen_ldr_reg32_mem32(aarch64GenContext, AARCH64_REG_RESV_TEMP2, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, spr.XER));
+		aarch64Gen_lsr_reg32_reg32_imm(aarch64GenContext, AARCH64_REG_RESV_TEMP2, AARCH64_REG_RESV_TEMP2, 31);
+		aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(crRegister*4+PPCREC_CR_BIT_SO), AARCH64_REG_RESV_TEMP2);
+		// end
+		aarch64Gen_patchBranch(aarch64GenContext, jumpInstructionOffsetJumpToEnd, aarch64GenContext->codeBufferIndex);
+	}
+	else if( imlInstruction->op_storeLoad.copyWidth == PPC_REC_STORE_STSWI_2 )
+	{
+		// store upper 2 bytes as big-endian
+		aarch64Gen_lsr_reg32_reg32_imm(aarch64GenContext, AARCH64_REG_RESV_TEMP2, realRegisterData, 16);
+		aarch64Gen_rev16_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP2, AARCH64_REG_RESV_TEMP2);
+		sint32 eaRegister = PPCRecompilerAArch64Gen_calculateEA(aarch64GenContext, realRegisterMem, realRegisterMem2, imlInstruction->op_storeLoad.immS32);
+		aarch64Gen_strh_mem16uxtw_reg32(aarch64GenContext, AARCH64_REG_RESV_MEMBASE, eaRegister, AARCH64_REG_RESV_TEMP2);
+	}
+	else if( imlInstruction->op_storeLoad.copyWidth == PPC_REC_STORE_STSWI_3 )
+	{
+		sint32 eaRegister = PPCRecompilerAArch64Gen_calculateEA(aarch64GenContext, realRegisterMem, realRegisterMem2, 0);
+		for(sint32 f=0; f<3; f++)
+		{
+			// byte f holds bits 31-24, 23-16 and 15-8 of the source register
+			aarch64Gen_lsr_reg32_reg32_imm(aarch64GenContext, AARCH64_REG_RESV_TEMP2, realRegisterData, 24 - f * 8);
+			aarch64Gen_add_reg32_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_ARG0, eaRegister, imlInstruction->op_storeLoad.immS32 + f);
+			aarch64Gen_strb_mem8uxtw_reg32(aarch64GenContext, AARCH64_REG_RESV_MEMBASE, AARCH64_REG_RESV_ARG0, AARCH64_REG_RESV_TEMP2);
+		}
+	}
+	else
+		return false;
+	return true;
+}
+
+/*
+* Copy byte/word/dword from memory to memory
+*/
+bool PPCRecompilerAArch64Gen_imlInstruction_mem2mem(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext, aarch64GenContext_t* aarch64GenContext, PPCRecImlInstruction_t* imlInstruction)
+{
+	if( imlInstruction->op_mem2mem.copyWidth != 32 )
+		return false;
+	sint32 realSrcMemReg = aarch64TempToRealRegister(imlInstruction->op_mem2mem.src.registerMem);
+	sint32 realDstMemReg = aarch64TempToRealRegister(imlInstruction->op_mem2mem.dst.registerMem);
+	sint32 eaRegister = PPCRecompilerAArch64Gen_calculateEA(aarch64GenContext, realSrcMemReg, PPC_REC_INVALID_REGISTER, imlInstruction->op_mem2mem.src.immS32);
+	aarch64Gen_ldr_reg32_mem32uxtw(aarch64GenContext, AARCH64_REG_RESV_TEMP2, AARCH64_REG_RESV_MEMBASE, eaRegister);
+	eaRegister = PPCRecompilerAArch64Gen_calculateEA(aarch64GenContext, realDstMemReg, PPC_REC_INVALID_REGISTER, imlInstruction->op_mem2mem.dst.immS32);
+	aarch64Gen_str_mem32uxtw_reg32(aarch64GenContext, AARCH64_REG_RESV_MEMBASE, eaRegister, AARCH64_REG_RESV_TEMP2);
+	return true;
+}
+
+bool PPCRecompilerAArch64Gen_imlInstruction_r_r(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext, aarch64GenContext_t* aarch64GenContext, PPCRecImlInstruction_t* imlInstruction)
+{
+	sint32 rRegResult = aarch64TempToRealRegister(imlInstruction->op_r_r.registerResult);
+	sint32 rRegA = aarch64TempToRealRegister(imlInstruction->op_r_r.registerA);
+	if( imlInstruction->operation == PPCREC_IML_OP_ASSIGN )
+	{
+		// registerResult = registerA
+		aarch64Gen_mov_reg32_reg32(aarch64GenContext, rRegResult, rRegA);
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+		{
+			if( imlInstruction->crMode != PPCREC_CR_MODE_LOGICAL )
+				return false;
+			PPCRecompilerAArch64Gen_updateCRLogical(aarch64GenContext, imlInstruction, rRegResult);
+		}
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_ENDIAN_SWAP )
+	{
+		// registerResult = endianSwap32(registerA)
+		aarch64Gen_rev_reg32_reg32(aarch64GenContext, rRegResult, rRegA);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_ADD )
+	{
+		// registerResult += registerA
+		cemu_assert_debug(imlInstruction->crRegister == PPC_REC_INVALID_REGISTER);
+		aarch64Gen_add_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegResult, rRegA);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_ASSIGN_S8_TO_S32 || imlInstruction->operation == PPCREC_IML_OP_ASSIGN_S16_TO_S32 )
+	{
+		if( imlInstruction->operation == PPCREC_IML_OP_ASSIGN_S8_TO_S32 )
+			aarch64Gen_sxtb_reg32_reg32(aarch64GenContext, rRegResult, rRegA);
+		else
+			aarch64Gen_sxth_reg32_reg32(aarch64GenContext, rRegResult, rRegA);
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+			PPCRecompilerAArch64Gen_updateCRLogical(aarch64GenContext, imlInstruction, rRegResult);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_OR || imlInstruction->operation == PPCREC_IML_OP_AND || imlInstruction->operation == PPCREC_IML_OP_XOR )
+	{
+		if( imlInstruction->operation == PPCREC_IML_OP_OR )
+			aarch64Gen_orr_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegResult, rRegA);
+		else if( imlInstruction->operation == PPCREC_IML_OP_AND )
+			aarch64Gen_and_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegResult, rRegA);
+		else
+			aarch64Gen_eor_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegResult, rRegA);
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+			PPCRecompilerAArch64Gen_updateCRLogical(aarch64GenContext, imlInstruction, rRegResult);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_NOT )
+	{
+		aarch64Gen_mvn_reg32_reg32(aarch64GenContext, rRegResult, rRegA);
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+			PPCRecompilerAArch64Gen_updateCRLogical(aarch64GenContext, imlInstruction, rRegResult);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_CNTLZW )
+	{
+		cemu_assert_debug(imlInstruction->crRegister == PPC_REC_INVALID_REGISTER);
+		aarch64Gen_clz_reg32_reg32(aarch64GenContext, rRegResult, rRegA);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_COMPARE_SIGNED || imlInstruction->operation == PPCREC_IML_OP_COMPARE_UNSIGNED )
+	{
+		// registerA CMP registerB (arithmetic compare)
+		if( imlInstruction->crRegister == PPC_REC_INVALID_REGISTER )
+			return true; // a NO-OP instruction
+		if( imlInstruction->crRegister >= 8 )
+			return false;
+		aarch64Gen_cmp_reg32_reg32(aarch64GenContext, rRegResult, rRegA);
+		if( imlInstruction->operation == PPCREC_IML_OP_COMPARE_SIGNED )
+			PPCRecompilerAArch64Gen_storeCRFromFlags(aarch64GenContext, imlInstruction, AARCH64_COND_LT, AARCH64_COND_GT);
+		else
+			PPCRecompilerAArch64Gen_storeCRFromFlags(aarch64GenContext, imlInstruction, AARCH64_COND_CC, AARCH64_COND_HI);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_NEG )
+	{
+		aarch64Gen_neg_reg32(aarch64GenContext, rRegResult, rRegA);
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+			PPCRecompilerAArch64Gen_updateCRLogical(aarch64GenContext, imlInstruction, rRegResult);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_ADD_CARRY || imlInstruction->operation == PPCREC_IML_OP_ADD_CARRY_ME )
+	{
+		// registerResult = registerA + carry (+ -1)
+		sint32 operandRegister = AARCH64_REG_ZR;
+		if( imlInstruction->operation == PPCREC_IML_OP_ADD_CARRY_ME )
+		{
+			aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_ARG1, 0xFFFFFFFF);
+			operandRegister = AARCH64_REG_RESV_ARG1;
+		}
+		PPCRecompilerAArch64Gen_loadCarry(aarch64GenContext);
+		aarch64Gen_adcs_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegA, operandRegister);
+		PPCRecompilerAArch64Gen_storeCarry(aarch64GenContext);
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+			PPCRecompilerAArch64Gen_updateCRLogical(aarch64GenContext, imlInstruction, rRegResult);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_SUB_CARRY_UPDATE_CARRY )
+	{
+		// registerResult = ~registerA + carry
+		aarch64Gen_mvn_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP2, rRegA);
+		PPCRecompilerAArch64Gen_loadCarry(aarch64GenContext);
+		aarch64Gen_adcs_reg32_reg32_reg32(aarch64GenContext, rRegResult, AARCH64_REG_RESV_TEMP2, AARCH64_REG_ZR);
+		PPCRecompilerAArch64Gen_storeCarry(aarch64GenContext);
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+		{
+			if( imlInstruction->crMode != PPCREC_CR_MODE_LOGICAL )
+				return false;
+			PPCRecompilerAArch64Gen_updateCRLogical(aarch64GenContext, imlInstruction, rRegResult);
+		}
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_DCBZ )
+	{
+		// clear 32 bytes at (registerResult + registerA) & ~0x1F
+		if( imlInstruction->op_r_r.registerResult != imlInstruction->op_r_r.registerA )
+			aarch64Gen_add_reg32_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, rRegA, rRegResult);
+		else
+			aarch64Gen_mov_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, rRegA);
+		aarch64Gen_lsr_reg32_reg32_imm(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP, 5);
+		aarch64Gen_lsl_reg32_reg32_imm(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP, 5);
+		aarch64Gen_add_reg64_reg64_reg32uxtw(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_MEMBASE, AARCH64_REG_RESV_TEMP);
+		aarch64Gen_stp_zero_mem128(aarch64GenContext, AARCH64_REG_RESV_TEMP, 0);
+		aarch64Gen_stp_zero_mem128(aarch64GenContext, AARCH64_REG_RESV_TEMP, 16);
+	}
+	else
+	{
+		debug_printf("PPCRecompilerAArch64Gen_imlInstruction_r_r(): Unsupported operation 0x%x\n", imlInstruction->operation);
+		return false;
+	}
+	return true;
+}
+
+bool PPCRecompilerAArch64Gen_imlInstruction_r_s32(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext, aarch64GenContext_t* aarch64GenContext, PPCRecImlInstruction_t* imlInstruction)
+{
+	sint32 rRegResult = aarch64TempToRealRegister(imlInstruction->op_r_immS32.registerIndex);
+	sint32 immS32 = imlInstruction->op_r_immS32.immS32;
+	if( imlInstruction->operation == PPCREC_IML_OP_ASSIGN )
+	{
+		cemu_assert_debug(imlInstruction->crRegister == PPC_REC_INVALID_REGISTER);
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, rRegResult, (uint32)immS32);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_ADD )
+	{
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+			return false;
+		aarch64Gen_add_reg32_reg32_imm32(aarch64GenContext, rRegResult, rRegResult, immS32);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_SUB )
+	{
+		if( imlInstruction->crRegister == PPCREC_CR_REG_TEMP )
+		{
+			// SUB is for BDNZ instruction, the following CJUMP evaluates the host flags
+			aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_ARG1, (uint32)immS32);
+			aarch64Gen_subs_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegResult, AARCH64_REG_RESV_ARG1);
+			aarch64GenContext->tempCRFlagsValid = true;
+		}
+		else if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+			return false;
+		else
+			aarch64Gen_add_reg32_reg32_imm32(aarch64GenContext, rRegResult, rRegResult, (sint32)(0u - (uint32)immS32));
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_AND || imlInstruction->operation == PPCREC_IML_OP_OR || imlInstruction->operation == PPCREC_IML_OP_XOR )
+	{
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER && (imlInstruction->operation != PPCREC_IML_OP_AND || imlInstruction->crMode != PPCREC_CR_MODE_LOGICAL) )
+			return false;
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_ARG1, (uint32)immS32);
+		if( imlInstruction->operation == PPCREC_IML_OP_AND )
+			aarch64Gen_and_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegResult, AARCH64_REG_RESV_ARG1);
+		else if( imlInstruction->operation == PPCREC_IML_OP_OR )
+			aarch64Gen_orr_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegResult, AARCH64_REG_RESV_ARG1);
+		else
+			aarch64Gen_eor_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegResult, AARCH64_REG_RESV_ARG1);
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+			PPCRecompilerAArch64Gen_updateCRLogical(aarch64GenContext, imlInstruction, rRegResult);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_LEFT_ROTATE )
+	{
+		// registerResult <<<= immS32
+		cemu_assert_debug(imlInstruction->crRegister == PPC_REC_INVALID_REGISTER);
+		aarch64Gen_ror_reg32_reg32_imm(aarch64GenContext, rRegResult, rRegResult, (32 - (uint32)immS32) & 31);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_COMPARE_SIGNED || imlInstruction->operation == PPCREC_IML_OP_COMPARE_UNSIGNED )
+	{
+		// registerResult CMP immS32 (arithmetic compare)
+		if( imlInstruction->crRegister == PPC_REC_INVALID_REGISTER )
+			return true; // a NO-OP instruction
+		if( imlInstruction->crRegister >= 8 )
+			return false;
+		aarch64Gen_cmp_reg32_imm32(aarch64GenContext, rRegResult, immS32);
+		if( imlInstruction->operation == PPCREC_IML_OP_COMPARE_SIGNED )
+			PPCRecompilerAArch64Gen_storeCRFromFlags(aarch64GenContext, imlInstruction, AARCH64_COND_LT, AARCH64_COND_GT);
+		else
+			PPCRecompilerAArch64Gen_storeCRFromFlags(aarch64GenContext, imlInstruction, AARCH64_COND_CC, AARCH64_COND_HI);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_MFCR )
+	{
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, rRegResult, 0);
+		for(sint32 f=0; f<32; f++)
+		{
+			aarch64Gen_ldrb_reg32_mem8(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(f));
+			aarch64Gen_orr_reg32_reg32_reg32lsl(aarch64GenContext, rRegResult, AARCH64_REG_RESV_TEMP, rRegResult, 1);
+		}
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_MTCRF )
+	{
+		uint32 crBitMask = ppc_MTCRFMaskToCRBitMask((uint32)immS32);
+		for(sint32 f=0; f<32; f++)
+		{
+			if( ((crBitMask >> f) & 1) == 0 )
+				continue;
+			aarch64Gen_ubfx_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, rRegResult, 31 - f, 1);
+			aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(f), AARCH64_REG_RESV_TEMP);
+		}
+	}
+	else
+	{
+		debug_printf("PPCRecompilerAArch64Gen_imlInstruction_r_s32(): Unsupported operation 0x%x\n", imlInstruction->operation);
+		return false;
+	}
+	return true;
+}
+
+bool PPCRecompilerAArch64Gen_imlInstruction_conditional_r_s32(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext, aarch64GenContext_t* aarch64GenContext, PPCRecImlInstruction_t* imlInstruction)
+{
+	if( imlInstruction->operation != PPCREC_IML_OP_ASSIGN || imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+		return false;
+	// registerResult = immS32 (conditional)
+	sint32 rRegResult = aarch64TempToRealRegister(imlInstruction->op_conditional_r_s32.registerIndex);
+	uint8 crBitIndex = imlInstruction->op_conditional_r_s32.crRegisterIndex * 4 + imlInstruction->op_conditional_r_s32.crBitIndex;
+	aarch64Gen_ldrb_reg32_mem8(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(crBitIndex));
+	aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP2, (uint32)imlInstruction->op_conditional_r_s32.immS32);
+	aarch64Gen_cmp_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP, 0);
+	aarch64Gen_csel_reg32_reg32_reg32(aarch64GenContext, rRegResult, AARCH64_REG_RESV_TEMP2, rRegResult, imlInstruction->op_conditional_r_s32.bitMustBeSet ? AARCH64_COND_NE : AARCH64_COND_EQ);
+	return true;
+}
+
+bool PPCRecompilerAArch64Gen_imlInstruction_r_r_r(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext, aarch64GenContext_t* aarch64GenContext, PPCRecImlInstruction_t* imlInstruction)
+{
+	sint32 rRegResult = aarch64TempToRealRegister(imlInstruction->op_r_r_r.registerResult);
+	sint32 rRegOperand1 = aarch64TempToRealRegister(imlInstruction->op_r_r_r.registerA);
+	sint32 rRegOperand2 = aarch64TempToRealRegister(imlInstruction->op_r_r_r.registerB);
+	// all operations which allow a cr update use the logical (compare with zero) mode
+	if( imlInstruction->operation == PPCREC_IML_OP_ADD )
+	{
+		aarch64Gen_add_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegOperand1, rRegOperand2);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_ADD_UPDATE_CARRY )
+	{
+		aarch64Gen_adds_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegOperand1, rRegOperand2);
+		PPCRecompilerAArch64Gen_storeCarry(aarch64GenContext);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_ADD_CARRY_UPDATE_CARRY )
+	{
+		PPCRecompilerAArch64Gen_loadCarry(aarch64GenContext);
+		aarch64Gen_adcs_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegOperand1, rRegOperand2);
+		PPCRecompilerAArch64Gen_storeCarry(aarch64GenContext);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_SUB )
+	{
+		aarch64Gen_sub_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegOperand1, rRegOperand2);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_SUB_CARRY_UPDATE_CARRY )
+	{
+		// registerResult = registerOperand1 + ~registerOperand2 + carry
+		// SBC computes op1 - op2 - !C which is the same, and sets C to the PPC carry
+		PPCRecompilerAArch64Gen_loadCarry(aarch64GenContext);
+		aarch64Gen_sbcs_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegOperand1, rRegOperand2);
+		PPCRecompilerAArch64Gen_storeCarry(aarch64GenContext);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_MULTIPLY_SIGNED )
+	{
+		aarch64Gen_mul_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegOperand1, rRegOperand2);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_SUBFC )
+	{
+		// registerResult = registerOperand2(rB) - registerOperand1(rA), ca is set if there is no borrow
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+			return false;
+		aarch64Gen_subs_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegOperand2, rRegOperand1);
+		PPCRecompilerAArch64Gen_storeCarry(aarch64GenContext);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_SLW || imlInstruction->operation == PPCREC_IML_OP_SRW )
+	{
+		// registerResult = registerOperand1(rA) << / >> registerOperand2(rB) (up to 63 bits)
+		// do the shift in 64bit so that shift amounts of 32-63 clear the result
+		aarch64Gen_ubfx_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_ARG1, rRegOperand2, 0, 6);
+		aarch64Gen_mov_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, rRegOperand1);
+		if( imlInstruction->operation == PPCREC_IML_OP_SLW )
+			aarch64Gen_lslv_reg64_reg64_reg64(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_ARG1);
+		else
+			aarch64Gen_lsrv_reg64_reg64_reg64(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_ARG1);
+		aarch64Gen_mov_reg32_reg32(aarch64GenContext, rRegResult, AARCH64_REG_RESV_TEMP);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_LEFT_ROTATE )
+	{
+		// rotate left by n is rotate right by -n
+		aarch64Gen_neg_reg32(aarch64GenContext, AARCH64_REG_RESV_ARG1, rRegOperand2);
+		aarch64Gen_rorv_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegOperand1, AARCH64_REG_RESV_ARG1);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_SRAW )
+	{
+		// registerResult = (sint32)registerOperand1(rA) >> (sint32)registerOperand2(rB) (up to 63 bits)
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+			return false;
+		aarch64Gen_sxtw_reg64_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, rRegOperand1);
+		aarch64Gen_ubfx_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_ARG1, rRegOperand2, 0, 6);
+		aarch64Gen_asrv_reg64_reg64_reg64(aarch64GenContext, AARCH64_REG_RESV_TEMP2, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_ARG1);
+		// ca is set if the source is negative and any non-zero bit was shifted out
+		aarch64Gen_lslv_reg64_reg64_reg64(aarch64GenContext, AARCH64_REG_RESV_ARG0, AARCH64_REG_RESV_TEMP2, AARCH64_REG_RESV_ARG1);
+		aarch64Gen_cmp_reg64_reg64(aarch64GenContext, AARCH64_REG_RESV_ARG0, AARCH64_REG_RESV_TEMP);
+		aarch64Gen_cset_reg32(aarch64GenContext, AARCH64_REG_RESV_ARG0, AARCH64_COND_NE);
+		aarch64Gen_and_reg32_reg32_reg32lsr(aarch64GenContext, AARCH64_REG_RESV_ARG0, AARCH64_REG_RESV_ARG0, AARCH64_REG_RESV_TEMP, 31);
+		aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, xer_ca), AARCH64_REG_RESV_ARG0);
+		aarch64Gen_mov_reg32_reg32(aarch64GenContext, rRegResult, AARCH64_REG_RESV_TEMP2);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_DIVIDE_SIGNED || imlInstruction->operation == PPCREC_IML_OP_DIVIDE_UNSIGNED )
+	{
+		// division by zero yields zero on AArch64 (undefined on PPC)
+		if( imlInstruction->operation == PPCREC_IML_OP_DIVIDE_SIGNED )
+			aarch64Gen_sdiv_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegOperand1, rRegOperand2);
+		else
+			aarch64Gen_udiv_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegOperand1, rRegOperand2);
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+			PPCRecompilerAArch64Gen_updateCRLogical(aarch64GenContext, imlInstruction, rRegResult);
+		return true;
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_MULTIPLY_HIGH_SIGNED || imlInstruction->operation == PPCREC_IML_OP_MULTIPLY_HIGH_UNSIGNED )
+	{
+		if( imlInstruction->operation == PPCREC_IML_OP_MULTIPLY_HIGH_SIGNED )
+			aarch64Gen_smull_reg64_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, rRegOperand1, rRegOperand2);
+		else
+			aarch64Gen_umull_reg64_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, rRegOperand1, rRegOperand2);
+		aarch64Gen_lsr_reg64_reg64_imm(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP, 32);
+		aarch64Gen_mov_reg32_reg32(aarch64GenContext, rRegResult, AARCH64_REG_RESV_TEMP);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_ORC )
+	{
+		// registerResult = registerOperand1 | ~registerOperand2
+		aarch64Gen_orn_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegOperand1, rRegOperand2);
+	}
+	else
+	{
+		debug_printf("PPCRecompilerAArch64Gen_imlInstruction_r_r_r(): Unsupported operation 0x%x\n", imlInstruction->operation);
+		return false;
+	}
+	// set cr bits if enabled
+	if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+	{
+		if( imlInstruction->crMode != PPCREC_CR_MODE_LOGICAL )
+			return false;
+		PPCRecompilerAArch64Gen_updateCRLogical(aarch64GenContext, imlInstruction, rRegResult);
+	}
+	return true;
+}
+
+bool PPCRecompilerAArch64Gen_imlInstruction_r_r_s32(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext, aarch64GenContext_t* aarch64GenContext, PPCRecImlInstruction_t* imlInstruction)
+{
+	sint32 rRegResult = aarch64TempToRealRegister(imlInstruction->op_r_r_s32.registerResult);
+	sint32 rRegOperand = aarch64TempToRealRegister(imlInstruction->op_r_r_s32.registerA);
+	sint32 immS32 = imlInstruction->op_r_r_s32.immS32;
+	if( imlInstruction->operation == PPCREC_IML_OP_ADD )
+	{
+		// registerResult = registerOperand + immS32
+		cemu_assert_debug(imlInstruction->crRegister == PPC_REC_INVALID_REGISTER);
+		aarch64Gen_add_reg32_reg32_imm32(aarch64GenContext, rRegResult, rRegOperand, immS32);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_ADD_UPDATE_CARRY )
+	{
+		// registerResult = registerOperand + immS32, always use ADDS with a register so that the carry matches PPC semantics
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_ARG1, (uint32)immS32);
+		aarch64Gen_adds_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegOperand, AARCH64_REG_RESV_ARG1);
+		PPCRecompilerAArch64Gen_storeCarry(aarch64GenContext);
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+		{
+			if( imlInstruction->crMode != PPCREC_CR_MODE_LOGICAL )
+				return false;
+			PPCRecompilerAArch64Gen_updateCRLogical(aarch64GenContext, imlInstruction, rRegResult);
+		}
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_SUBFC )
+	{
+		// registerResult = immS32 - registerOperand
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+			return false;
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_ARG1, (uint32)immS32);
+		aarch64Gen_subs_reg32_reg32_reg32(aarch64GenContext, rRegResult, AARCH64_REG_RESV_ARG1, rRegOperand);
+		PPCRecompilerAArch64Gen_storeCarry(aarch64GenContext);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_RLWIMI )
+	{
+		// registerResult = ((registerOperand<<<SH)&mask) | (registerResult&~mask)
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+			return false;
+		uint32 vImm = (uint32)immS32;
+		uint32 mb = (vImm>>0)&0xFF;
+		uint32 me = (vImm>>8)&0xFF;
+		uint32 sh = (vImm>>16)&0xFF;
+		uint32 mask = ppc_mask(mb, me);
+		aarch64Gen_ror_reg32_reg32_imm(aarch64GenContext, AARCH64_REG_RESV_TEMP, rRegOperand, (32 - sh) & 31);
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_ARG1, mask);
+		aarch64Gen_and_reg32_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_ARG1);
+		aarch64Gen_bic_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegResult, AARCH64_REG_RESV_ARG1);
+		aarch64Gen_orr_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegResult, AARCH64_REG_RESV_TEMP);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_MULTIPLY_SIGNED )
+	{
+		// registerResult = registerOperand * immS32
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_ARG1, (uint32)immS32);
+		aarch64Gen_mul_reg32_reg32_reg32(aarch64GenContext, rRegResult, rRegOperand, AARCH64_REG_RESV_ARG1);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_SRAW )
+	{
+		// registerResult = registerOperand>>SH and set xer ca flag
+		uint32 sh = (uint32)immS32 & 31;
+		uint32 caTestMask = (1 << sh) - 1;
+		// ca is set if the source is negative and any non-zero bit is shifted out
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_ARG1, caTestMask);
+		aarch64Gen_ands_reg32_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, rRegOperand, AARCH64_REG_RESV_ARG1);
+		aarch64Gen_cset_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_COND_NE);
+		aarch64Gen_and_reg32_reg32_reg32lsr(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP, rRegOperand, 31);
+		aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, xer_ca), AARCH64_REG_RESV_TEMP);
+		aarch64Gen_asr_reg32_reg32_imm(aarch64GenContext, rRegResult, rRegOperand, sh);
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+			PPCRecompilerAArch64Gen_updateCRLogical(aarch64GenContext, imlInstruction, rRegResult);
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_LEFT_SHIFT || imlInstruction->operation == PPCREC_IML_OP_RIGHT_SHIFT )
+	{
+		if( imlInstruction->operation == PPCREC_IML_OP_LEFT_SHIFT )
+			aarch64Gen_lsl_reg32_reg32_imm(aarch64GenContext, rRegResult, rRegOperand, (uint32)immS32 & 31);
+		else
+			aarch64Gen_lsr_reg32_reg32_imm(aarch64GenContext, rRegResult, rRegOperand, (uint32)immS32 & 31);
+		if( imlInstruction->crRegister != PPC_REC_INVALID_REGISTER )
+			PPCRecompilerAArch64Gen_updateCRLogical(aarch64GenContext, imlInstruction, rRegResult);
+	}
+	else
+	{
+		debug_printf("PPCRecompilerAArch64Gen_imlInstruction_r_r_s32(): Unsupported operation 0x%x\n", imlInstruction->operation);
+		return false;
+	}
+	return true;
+}
+
+bool PPCRecompilerAArch64Gen_imlInstruction_conditionalJump(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext, aarch64GenContext_t* aarch64GenContext, PPCRecImlSegment_t* imlSegment, PPCRecImlInstruction_t* imlInstruction)
+{
+	if( imlInstruction->op_conditionalJump.condition == PPCREC_JUMP_CONDITION_NONE )
+	{
+		// jump always
+		if( imlInstruction->op_conditionalJump.jumpAccordingToSegment )
+		{
+			// jump to segment
+			if( imlSegment->nextSegmentBranchTaken == nullptr )
+				return false;
+			PPCRecompilerAArch64Gen_rememberRelocatableOffset(aarch64GenContext, AARCH64_RELOC_LINK_TO_SEGMENT, imlSegment->nextSegmentBranchTaken);
+		}
+		else
+		{
+			// deprecated (jump to jumpmark)
+			PPCRecompilerAArch64Gen_rememberRelocatableOffset(aarch64GenContext, AARCH64_RELOC_LINK_TO_PPC, (void*)(size_t)imlInstruction->op_conditionalJump.jumpmarkAddress);
+		}
+		aarch64Gen_b(aarch64GenContext);
+		return true;
+	}
+	if( imlInstruction->op_conditionalJump.jumpAccordingToSegment )
+		return false;
+	if( imlInstruction->op_conditionalJump.crRegisterIndex >= PPCREC_CR_REG_TEMP )
+	{
+		// temporary cr is used, which means we use the host flags set by the preceding SUB
+		if( aarch64GenContext->tempCRFlagsValid == false )
+			return false;
+		sint32 condition = imlInstruction->op_conditionalJump.condition;
+		if( condition != PPCREC_JUMP_CONDITION_E && condition != PPCREC_JUMP_CONDITION_NE )
+			return false;
+		PPCRecompilerAArch64Gen_rememberRelocatableOffset(aarch64GenContext, AARCH64_RELOC_LINK_TO_PPC, (void*)(size_t)imlInstruction->op_conditionalJump.jumpmarkAddress);
+		aarch64Gen_bcond(aarch64GenContext, condition == PPCREC_JUMP_CONDITION_E ? AARCH64_COND_EQ : AARCH64_COND_NE);
+		return true;
+	}
+	uint8 crBitIndex = imlInstruction->op_conditionalJump.crRegisterIndex*4 + imlInstruction->op_conditionalJump.crBitIndex;
+	aarch64Gen_ldrb_reg32_mem8(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(crBitIndex));
+	PPCRecompilerAArch64Gen_rememberRelocatableOffset(aarch64GenContext, AARCH64_RELOC_LINK_TO_PPC, (void*)(size_t)imlInstruction->op_conditionalJump.jumpmarkAddress);
+	if( imlInstruction->op_conditionalJump.bitMustBeSet )
+		aarch64Gen_cbnz_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP);
+	else
+		aarch64Gen_cbz_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP);
+	return true;
+}
+
+bool PPCRecompilerAArch64Gen_imlInstruction_conditionalJumpCycleCheck(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext, aarch64GenContext_t* aarch64GenContext, PPCRecImlInstruction_t* imlInstruction)
+{
+	// jump if remaining cycles >= 0
+	aarch64Gen_ldr_reg32_mem32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, remainingCycles));
+	aarch64Gen_cmp_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP, 0);
+	PPCRecompilerAArch64Gen_rememberRelocatableOffset(aarch64GenContext, AARCH64_RELOC_LINK_TO_PPC, (void*)(size_t)imlInstruction->op_conditionalJump.jumpmarkAddress);
+	aarch64Gen_bcond(aarch64GenContext, AARCH64_COND_GE);
+	return true;
+}
+
+/*
+* PPC condition register operation
+*/
+bool PPCRecompilerAArch64Gen_imlInstruction_cr(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext, aarch64GenContext_t* aarch64GenContext, PPCRecImlInstruction_t* imlInstruction)
+{
+	if( imlInstruction->operation == PPCREC_IML_OP_CR_CLEAR )
+	{
+		aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(imlInstruction->op_cr.crD), AARCH64_REG_ZR);
+		return true;
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_CR_SET )
+	{
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_TEMP, 1);
+		aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(imlInstruction->op_cr.crD), AARCH64_REG_RESV_TEMP);
+		return true;
+	}
+	else if( imlInstruction->operation == PPCREC_IML_OP_CR_OR || imlInstruction->operation == PPCREC_IML_OP_CR_ORC ||
+		imlInstruction->operation == PPCREC_IML_OP_CR_AND || imlInstruction->operation == PPCREC_IML_OP_CR_ANDC )
+	{
+		aarch64Gen_ldrb_reg32_mem8(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(imlInstruction->op_cr.crB));
+		if( imlInstruction->operation == PPCREC_IML_OP_CR_ORC || imlInstruction->operation == PPCREC_IML_OP_CR_ANDC )
+			aarch64Gen_eor_reg32_reg32_one(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP); // complement
+		aarch64Gen_ldrb_reg32_mem8(aarch64GenContext, AARCH64_REG_RESV_TEMP2, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(imlInstruction->op_cr.crA));
+		if( imlInstruction->operation == PPCREC_IML_OP_CR_OR || imlInstruction->operation == PPCREC_IML_OP_CR_ORC )
+			aarch64Gen_orr_reg32_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP2, AARCH64_REG_RESV_TEMP);
+		else
+			aarch64Gen_and_reg32_reg32_reg32(aarch64GenContext, AARCH64_REG_RESV_TEMP, AARCH64_REG_RESV_TEMP2, AARCH64_REG_RESV_TEMP);
+		aarch64Gen_strb_mem8_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, AARCH64_CR_BIT_OFFSET(imlInstruction->op_cr.crD), AARCH64_REG_RESV_TEMP);
+		return true;
+	}
+	return false;
+}
+
+bool PPCRecompilerAArch64Gen_imlInstruction_r_name(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext, aarch64GenContext_t* aarch64GenContext, PPCRecImlInstruction_t* imlInstruction, bool isStore)
+{
+	uint32 name = imlInstruction->op_r_name.name;
+	sint32 memOffset;
+	if( name >= PPCREC_NAME_R0 && name < PPCREC_NAME_R0+32 )
+	{
+		memOffset = offsetof(PPCInterpreter_t, gpr)+sizeof(uint32)*(name-PPCREC_NAME_R0);
+	}
+	else if( name >= PPCREC_NAME_SPR0 && name < PPCREC_NAME_SPR0+999 )
+	{
+		uint32 sprIndex = (name - PPCREC_NAME_SPR0);
+		if( sprIndex == SPR_LR )
+			memOffset = offsetof(PPCInterpreter_t, spr.LR);
+		else if( sprIndex == SPR_CTR )
+			memOffset = offsetof(PPCInterpreter_t, spr.CTR);
+		else if( sprIndex == SPR_XER )
+			memOffset = offsetof(PPCInterpreter_t, spr.XER);
+		else if( sprIndex >= SPR_UGQR0 && sprIndex <= SPR_UGQR7 )
+			memOffset = offsetof(PPCInterpreter_t, spr.UGQR) + sizeof(PPCInterpreter_t::spr.UGQR[0]) * (sprIndex - SPR_UGQR0);
+		else
+			return false;
+	}
+	else
+		return false;
+	if( isStore )
+		aarch64Gen_str_mem32_reg32(aarch64GenContext, AARCH64_REG_RESV_HCPU, memOffset, aarch64TempToRealRegister(imlInstruction->op_r_name.registerIndex));
+	else
+		aarch64Gen_ldr_reg32_mem32(aarch64GenContext, aarch64TempToRealRegister(imlInstruction->op_r_name.registerIndex), AARCH64_REG_RESV_HCPU, memOffset);
+	return true;
+}
+
+bool PPCRecompiler_generateAArch64Code(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext)
+{
+	aarch64GenContext_t aarch64GenContext = {0};
+	aarch64GenContext.codeBufferSize = 1024;
+	aarch64GenContext.codeBuffer = (uint8*)malloc(aarch64GenContext.codeBufferSize);
+	aarch64GenContext.codeBufferIndex = 0;
+
+	// generate iml instruction code
+	bool codeGenerationFailed = false;
+	for(sint32 s=0; s<ppcImlGenContext->segmentListCount && codeGenerationFailed == false; s++)
+	{
+		PPCRecImlSegment_t* imlSegment = ppcImlGenContext->segmentList[s];
+		ppcImlGenContext->segmentList[s]->x64Offset = aarch64GenContext.codeBufferIndex;
+		aarch64GenContext.tempCRFlagsValid = false;
+		for(sint32 i=0; i<imlSegment->imlListCount; i++)
+		{
+			PPCRecImlInstruction_t* imlInstruction = imlSegment->imlList+i;
+			// only register loads/stores and markers leave the host flags intact
+			if( imlInstruction->type != PPCREC_IML_TYPE_R_NAME && imlInstruction->type != PPCREC_IML_TYPE_NAME_R &&
+				imlInstruction->type != PPCREC_IML_TYPE_JUMPMARK && imlInstruction->type != PPCREC_IML_TYPE_NO_OP &&
+				imlInstruction->type != PPCREC_IML_TYPE_PPC_ENTER && imlInstruction->type != PPCREC_IML_TYPE_CJUMP )
+				aarch64GenContext.tempCRFlagsValid = false;
+
+			bool success = true;
+			if( imlInstruction->type == PPCREC_IML_TYPE_R_NAME )
+				success = PPCRecompilerAArch64Gen_imlInstruction_r_name(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlInstruction, false);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_NAME_R )
+				success = PPCRecompilerAArch64Gen_imlInstruction_r_name(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlInstruction, true);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_R_R )
+				success = PPCRecompilerAArch64Gen_imlInstruction_r_r(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlInstruction);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_R_S32 )
+				success = PPCRecompilerAArch64Gen_imlInstruction_r_s32(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlInstruction);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_CONDITIONAL_R_S32 )
+				success = PPCRecompilerAArch64Gen_imlInstruction_conditional_r_s32(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlInstruction);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_R_R_S32 )
+				success = PPCRecompilerAArch64Gen_imlInstruction_r_r_s32(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlInstruction);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_R_R_R )
+				success = PPCRecompilerAArch64Gen_imlInstruction_r_r_r(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlInstruction);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_CJUMP )
+				success = PPCRecompilerAArch64Gen_imlInstruction_conditionalJump(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlSegment, imlInstruction);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_CJUMP_CYCLE_CHECK )
+				success = PPCRecompilerAArch64Gen_imlInstruction_conditionalJumpCycleCheck(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlInstruction);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_MACRO )
+				success = PPCRecompilerAArch64Gen_imlInstruction_macro(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlInstruction);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_LOAD )
+				success = PPCRecompilerAArch64Gen_imlInstruction_load(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlInstruction, false);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_LOAD_INDEXED )
+				success = PPCRecompilerAArch64Gen_imlInstruction_load(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlInstruction, true);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_STORE )
+				success = PPCRecompilerAArch64Gen_imlInstruction_store(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlInstruction, false);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_STORE_INDEXED )
+				success = PPCRecompilerAArch64Gen_imlInstruction_store(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlInstruction, true);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_MEM2MEM )
+				success = PPCRecompilerAArch64Gen_imlInstruction_mem2mem(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlInstruction);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_CR )
+				success = PPCRecompilerAArch64Gen_imlInstruction_cr(PPCRecFunction, ppcImlGenContext, &aarch64GenContext, imlInstruction);
+			else if( imlInstruction->type == PPCREC_IML_TYPE_JUMPMARK || imlInstruction->type == PPCREC_IML_TYPE_NO_OP )
+			{
+				// no op
+			}
+			else if( imlInstruction->type == PPCREC_IML_TYPE_PPC_ENTER )
+				imlInstruction->op_ppcEnter.x64Offset = aarch64GenContext.codeBufferIndex;
+			else
+			{
+				// FPR instructions are not implemented for AArch64 yet
+				success = false;
+			}
+			if( success == false )
+			{
+				codeGenerationFailed = true;
+				break;
+			}
+		}
+	}
+	// fix relocs
+	for(sint32 i=0; i<aarch64GenContext.relocateOffsetTableCount && codeGenerationFailed == false; i++)
+	{
+		aarch64RelocEntry_t* relocEntry = aarch64GenContext.relocateOffsetTable+i;
+		uint32 hostOffset = 0xFFFFFFFF;
+		if( relocEntry->type == AARCH64_RELOC_LINK_TO_PPC )
+		{
+			// search for segment that starts with this offset
+			uint32 ppcOffset = (uint32)(size_t)relocEntry->extraInfo;
+			for(sint32 s=0; s<ppcImlGenContext->segmentListCount; s++)
+			{
+				if( ppcImlGenContext->segmentList[s]->isJumpDestination && ppcImlGenContext->segmentList[s]->jumpDestinationPPCAddress == ppcOffset )
+				{
+					hostOffset = ppcImlGenContext->segmentList[s]->x64Offset;
+					break;
+				}
+			}
+			if( hostOffset == 0xFFFFFFFF )
+			{
+				debug_printf("Recompiler could not resolve jump (function at 0x%08x)\n", PPCRecFunction->ppcAddress);
+				codeGenerationFailed = true;
+				break;
+			}
+		}
+		else
+		{
+			PPCRecImlSegment_t* destSegment = (PPCRecImlSegment_t*)relocEntry->extraInfo;
+			hostOffset = destSegment->x64Offset;
+		}
+		if( aarch64Gen_patchBranch(&aarch64GenContext, relocEntry->offset, hostOffset) == false )
+			codeGenerationFailed = true;
+	}
+	if( aarch64GenContext.relocateOffsetTable )
+		free(aarch64GenContext.relocateOffsetTable);
+	// handle failed code generation
+	if( codeGenerationFailed )
+	{
+		free(aarch64GenContext.codeBuffer);
+		return false;
+	}
+	// copy code to executable memory
+	uint8* writableMemory;
+	uint8* executableMemory = PPCRecompilerX86_allocateExecutableMemory(aarch64GenContext.codeBufferIndex, writableMemory);
+	if( !executableMemory )
+	{
+		// code cache is full
+		free(aarch64GenContext.codeBuffer);
+		return false;
+	}
+	memcpy(writableMemory, aarch64GenContext.codeBuffer, aarch64GenContext.codeBufferIndex);
+	PPCRecompilerAArch64Gen_flushInstructionCache(executableMemory, aarch64GenContext.codeBufferIndex);
+	free(aarch64GenContext.codeBuffer);
+	// set code
+	PPCRecFunction->x86Code = executableMemory;
+	PPCRecFunction->x86CodeWritable = writableMemory;
+	PPCRecFunction->x86Size = aarch64GenContext.codeBufferIndex;
+	return true;
+}
+
+void* PPCRecompilerAArch64Gen_finalizeInterfaceFunction(aarch64GenContext_t* aarch64GenContext)
+{
+	uint8* writableMemory;
+	uint8* executableMemory = PPCRecompilerX86_allocateExecutableMemory(aarch64GenContext->codeBufferIndex, writableMemory);
+	cemu_assert(executableMemory);
+	memcpy(writableMemory, aarch64GenContext->codeBuffer, aarch64GenContext->codeBufferIndex);
+	PPCRecompilerAArch64Gen_flushInstructionCache(executableMemory, aarch64GenContext->codeBufferIndex);
+	free(aarch64GenContext->codeBuffer);
+	return executableMemory;
+}
+
+/*
+* enterRecompilerCode(X0 = code, X1 = hCPU)
+* Saves all callee-saved registers, pushes the return address of the exit path and remembers SP in hCPU->rspTemp
+*/
+void PPCRecompilerAArch64Gen_generateEnterRecompilerCode()
+{
+	aarch64GenContext_t aarch64GenContext = {0};
+	aarch64GenContext.codeBufferSize = 1024;
+	aarch64GenContext.codeBuffer = (uint8*)malloc(aarch64GenContext.codeBufferSize);
+	aarch64GenContext.codeBufferIndex = 0;
+
+	aarch64Gen_stp_reg64_preIndex(&aarch64GenContext, 29, 30);
+	aarch64Gen_stp_reg64_preIndex(&aarch64GenContext, 27, 28);
+	aarch64Gen_stp_reg64_preIndex(&aarch64GenContext, 25, 26);
+	aarch64Gen_stp_reg64_preIndex(&aarch64GenContext, 23, 24);
+	aarch64Gen_stp_reg64_preIndex(&aarch64GenContext, 21, 22);
+	aarch64Gen_stp_reg64_preIndex(&aarch64GenContext, 19, 20);
+	aarch64Gen_stp_fpr64_preIndex(&aarch64GenContext, 8, 9);
+	aarch64Gen_stp_fpr64_preIndex(&aarch64GenContext, 10, 11);
+	aarch64Gen_stp_fpr64_preIndex(&aarch64GenContext, 12, 13);
+	aarch64Gen_stp_fpr64_preIndex(&aarch64GenContext, 14, 15);
+	// push address of exit path (popped by leaveRecompilerCode)
+	sint32 adrPatchOffset = aarch64GenContext.codeBufferIndex;
+	aarch64Gen_adr_reg64(&aarch64GenContext, AARCH64_REG_LR);
+	aarch64Gen_stp_reg64_preIndex(&aarch64GenContext, AARCH64_REG_LR, AARCH64_REG_ZR);
+	// hCPU
+	aarch64Gen_mov_reg64_reg64(&aarch64GenContext, AARCH64_REG_RESV_HCPU, AARCH64_REG_RESV_ARG1);
+	aarch64Gen_mov_reg64_sp(&aarch64GenContext, AARCH64_REG_RESV_OFFSET);
+	aarch64Gen_str_mem64_reg64(&aarch64GenContext, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, rspTemp), AARCH64_REG_RESV_OFFSET);
+	// fixed registers
+	aarch64Gen_mov_reg64_imm64(&aarch64GenContext, AARCH64_REG_RESV_MEMBASE, (uint64)memory_base);
+	aarch64Gen_mov_reg64_imm64(&aarch64GenContext, AARCH64_REG_RESV_RECDATA, (uint64)ppcRecompilerInstanceData);
+	aarch64Gen_mov_reg64_imm64(&aarch64GenContext, AARCH64_REG_RESV_JUMPTABLE, (uint64)ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable);
+	// jump to recompiled code
+	aarch64Gen_br_reg64(&aarch64GenContext, AARCH64_REG_RESV_ARG0);
+
+	// exit path
+	aarch64Gen_patchBranch(&aarch64GenContext, adrPatchOffset, aarch64GenContext.codeBufferIndex);
+	aarch64Gen_ldp_fpr64_postIndex(&aarch64GenContext, 14, 15);
+	aarch64Gen_ldp_fpr64_postIndex(&aarch64GenContext, 12, 13);
+	aarch64Gen_ldp_fpr64_postIndex(&aarch64GenContext, 10, 11);
+	aarch64Gen_ldp_fpr64_postIndex(&aarch64GenContext, 8, 9);
+	aarch64Gen_ldp_reg64_postIndex(&aarch64GenContext, 19, 20);
+	aarch64Gen_ldp_reg64_postIndex(&aarch64GenContext, 21, 22);
+	aarch64Gen_ldp_reg64_postIndex(&aarch64GenContext, 23, 24);
+	aarch64Gen_ldp_reg64_postIndex(&aarch64GenContext, 25, 26);
+	aarch64Gen_ldp_reg64_postIndex(&aarch64GenContext, 27, 28);
+	aarch64Gen_ldp_reg64_postIndex(&aarch64GenContext, 29, 30);
+	aarch64Gen_ret(&aarch64GenContext);
+
+	PPCRecompiler_enterRecompilerCode = (void ATTR_MS_ABI (*)(uint64,uint64))PPCRecompilerAArch64Gen_finalizeInterfaceFunction(&aarch64GenContext);
+}
+
+void* PPCRecompilerAArch64Gen_generateLeaveRecompilerCode()
+{
+	aarch64GenContext_t aarch64GenContext = {0};
+	aarch64GenContext.codeBufferSize = 128;
+	aarch64GenContext.codeBuffer = (uint8*)malloc(aarch64GenContext.codeBufferSize);
+	aarch64GenContext.codeBufferIndex = 0;
+
+	// update instruction pointer
+	aarch64Gen_str_mem32_reg32(&aarch64GenContext, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, instructionPointer), AARCH64_REG_RESV_IP);
+	// restore SP and return to the exit path of enterRecompilerCode
+	aarch64Gen_ldr_reg64_mem64(&aarch64GenContext, AARCH64_REG_RESV_OFFSET, AARCH64_REG_RESV_HCPU, offsetof(PPCInterpreter_t, rspTemp));
+	aarch64Gen_mov_sp_reg64(&aarch64GenContext, AARCH64_REG_RESV_OFFSET);
+	aarch64Gen_ldp_reg64_postIndex(&aarch64GenContext, AARCH64_REG_LR, AARCH64_REG_ZR);
+	aarch64Gen_ret(&aarch64GenContext);
+
+	return PPCRecompilerAArch64Gen_finalizeInterfaceFunction(&aarch64GenContext);
+}
+
+void PPCRecompilerAArch64Gen_generateRecompilerInterfaceFunctions()
+{
+	PPCRecompilerAArch64Gen_generateEnterRecompilerCode();
+	PPCRecompiler_leaveRecompilerCode_unvisited = (void ATTR_MS_ABI (*)())PPCRecompilerAArch64Gen_generateLeaveRecompilerCode();
+	PPCRecompiler_leaveRecompilerCode_visited = (void ATTR_MS_ABI (*)())PPCRecompilerAArch64Gen_generateLeaveRecompilerCode();
+	cemu_assert_debug(PPCRecompiler_leaveRecompilerCode_unvisited != PPCRecompiler_leaveRecompilerCode_visited);
+}
@@ -0,0 +1,167 @@
+typedef struct
+{
+	uint32 offset;
+	uint8  type;
+	void*  extraInfo;
+}aarch64RelocEntry_t;
+
+typedef struct
+{
+	uint8* codeBuffer;
+	sint32 codeBufferIndex;
+	sint32 codeBufferSize;
+	// host condition flags hold the result of the last PPCREC_CR_REG_TEMP update (BDNZ)
+	bool tempCRFlagsValid;
+	// relocate offsets
+	aarch64RelocEntry_t* relocateOffsetTable;
+	sint32 relocateOffsetTableSize;
+	sint32 relocateOffsetTableCount;
+}aarch64GenContext_t;
+
+#define AARCH64_RELOC_LINK_TO_PPC			(1)		// translate from ppc address to host offset
+#define AARCH64_RELOC_LINK_TO_SEGMENT		(2)		// link to beginning of segment
+
+// general purpose registers
+#define AARCH64_REG_ZR				(31)	// zero register (or SP depending on instruction)
+#define AARCH64_REG_SP				(31)
+#define AARCH64_REG_LR				(30)
+
+// reserved registers
+// X0 - X2 are scratch registers used for call arguments and large offsets
+// X3 - X14 hold the 12 virtual GPRs
+#define AARCH64_REG_RESV_ARG0		(0)
+#define AARCH64_REG_RESV_ARG1		(1)		// also used to materialize immediates
+#define AARCH64_REG_RESV_OFFSET		(2)		// used to materialize hCPU offsets that don't fit into an immediate
+#define AARCH64_REG_RESV_TEMP		(15)
+#define AARCH64_REG_RESV_TEMP2		(16)
+#define AARCH64_REG_RESV_IP			(17)	// PPC instruction pointer when leaving a function through the jump table (same role as RDX on x64)
+#define AARCH64_REG_RESV_HCPU		(19)
+#define AARCH64_REG_RESV_MEMBASE	(20)
+#define AARCH64_REG_RESV_RECDATA	(21)
+#define AARCH64_REG_RESV_JUMPTABLE	(22)	// points to ppcRecompilerInstanceData->ppcRecompilerDirectJumpTable
+
+extern sint32 aarch64Gen_registerMap[12];
+
+#define aarch64TempToRealRegister(__x) (aarch64Gen_registerMap[__x])
+
+// condition codes
+enum
+{
+	AARCH64_COND_EQ = 0,
+	AARCH64_COND_NE = 1,
+	AARCH64_COND_CS = 2, // unsigned higher or same
+	AARCH64_COND_CC = 3, // unsigned lower
+	AARCH64_COND_MI = 4,
+	AARCH64_COND_PL = 5,
+	AARCH64_COND_VS = 6,
+	AARCH64_COND_VC = 7,
+	AARCH64_COND_HI = 8,
+	AARCH64_COND_LS = 9,
+	AARCH64_COND_GE = 10,
+	AARCH64_COND_LT = 11,
+	AARCH64_COND_GT = 12,
+	AARCH64_COND_LE = 13,
+	AARCH64_COND_AL = 14,
+};
+
+bool PPCRecompiler_generateAArch64Code(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext);
+
+void PPCRecompilerAArch64Gen_generateRecompilerInterfaceFunctions();
+
+// ASM gen
+void aarch64Gen_writeU32(aarch64GenContext_t* aarch64GenContext, uint32 v);
+bool aarch64Gen_patchBranch(aarch64GenContext_t* aarch64GenContext, sint32 branchOffset, sint32 destinationOffset);
+
+void aarch64Gen_mov_reg32_imm32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, uint32 imm);
+void aarch64Gen_mov_reg64_imm64(aarch64GenContext_t* aarch64GenContext, sint32 destReg, uint64 imm);
+void aarch64Gen_mov_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg);
+void aarch64Gen_mov_reg64_reg64(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg);
+void aarch64Gen_mov_reg64_sp(aarch64GenContext_t* aarch64GenContext, sint32 destReg);
+void aarch64Gen_mov_sp_reg64(aarch64GenContext_t* aarch64GenContext, sint32 srcReg);
+
+void aarch64Gen_add_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_adds_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_adcs_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_sub_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_subs_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_sbcs_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_add_reg32_reg32_imm32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, sint32 imm);
+void aarch64Gen_add_reg64_reg64_imm12(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, uint32 imm);
+void aarch64Gen_add_reg64_reg64_reg32uxtw(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg64, sint32 srcReg32);
+void aarch64Gen_cmp_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 regA, sint32 regB);
+void aarch64Gen_cmp_reg32_imm32(aarch64GenContext_t* aarch64GenContext, sint32 reg, sint32 imm);
+void aarch64Gen_cmp_reg64_reg64(aarch64GenContext_t* aarch64GenContext, sint32 regA, sint32 regB);
+void aarch64Gen_neg_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg);
+
+void aarch64Gen_and_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_ands_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_and_reg32_reg32_reg32lsr(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB, uint32 shift);
+void aarch64Gen_orr_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_orr_reg32_reg32_reg32lsl(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB, uint32 shift);
+void aarch64Gen_orn_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_eor_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_eor_reg32_reg32_one(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg);
+void aarch64Gen_bic_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_mvn_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg);
+
+void aarch64Gen_mul_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_smull_reg64_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_umull_reg64_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_sdiv_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+void aarch64Gen_udiv_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB);
+
+void aarch64Gen_lsl_reg32_reg32_imm(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, uint32 shift);
+void aarch64Gen_lsr_reg32_reg32_imm(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, uint32 shift);
+void aarch64Gen_asr_reg32_reg32_imm(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, uint32 shift);
+void aarch64Gen_ror_reg32_reg32_imm(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, uint32 shift);
+void aarch64Gen_lsr_reg64_reg64_imm(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, uint32 shift);
+void aarch64Gen_lslv_reg64_reg64_reg64(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, sint32 shiftReg);
+void aarch64Gen_lsrv_reg64_reg64_reg64(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, sint32 shiftReg);
+void aarch64Gen_asrv_reg64_reg64_reg64(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, sint32 shiftReg);
+void aarch64Gen_rorv_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, sint32 shiftReg);
+void aarch64Gen_ubfx_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, uint32 lsb, uint32 width);
+void aarch64Gen_sxtb_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg);
+void aarch64Gen_sxth_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg);
+void aarch64Gen_sxtw_reg64_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg);
+void aarch64Gen_rev_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg);
+void aarch64Gen_rev16_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg);
+void aarch64Gen_clz_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg);
+void aarch64Gen_cset_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 cond);
+void aarch64Gen_csel_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegTrue, sint32 srcRegFalse, sint32 cond);
+
+// memory access relative to a 64bit base register
+void aarch64Gen_ldrb_reg32_mem8(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64, sint32 memOffset);
+void aarch64Gen_strb_mem8_reg32(aarch64GenContext_t* aarch64GenContext, sint32 memBaseReg64, sint32 memOffset, sint32 srcReg);
+void aarch64Gen_ldr_reg32_mem32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64, sint32 memOffset);
+void aarch64Gen_str_mem32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 memBaseReg64, sint32 memOffset, sint32 srcReg);
+void aarch64Gen_ldr_reg64_mem64(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64, sint32 memOffset);
+void aarch64Gen_str_mem64_reg64(aarch64GenContext_t* aarch64GenContext, sint32 memBaseReg64, sint32 memOffset, sint32 srcReg);
+// memory access to membase + zero extended 32bit offset register
+void aarch64Gen_ldr_reg32_mem32uxtw(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64, sint32 memOffsetReg32);
+void aarch64Gen_ldrh_reg32_mem16uxtw(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64, sint32 memOffsetReg32);
+void aarch64Gen_ldrb_reg32_mem8uxtw(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64, sint32 memOffsetReg32);
+void aarch64Gen_ldrsb_reg32_mem8uxtw(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64, sint32 memOffsetReg32);
+void aarch64Gen_str_mem32uxtw_reg32(aarch64GenContext_t* aarch64GenContext, sint32 memBaseReg64, sint32 memOffsetReg32, sint32 srcReg);
+void aarch64Gen_strh_mem16uxtw_reg32(aarch64GenContext_t* aarch64GenContext, sint32 memBaseReg64, sint32 memOffsetReg32, sint32 srcReg);
+void aarch64Gen_strb_mem8uxtw_reg32(aarch64GenContext_t* aarch64GenContext, sint32 memBaseReg64, sint32 memOffsetReg32, sint32 srcReg);
+// jump table lookup: ldr destReg, [tableReg, indexReg, lsl #3]
+void aarch64Gen_ldr_reg64_mem64Index(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 tableReg64, sint32 indexReg64);
+void aarch64Gen_stp_zero_mem128(aarch64GenContext_t* aarch64GenContext, sint32 memBaseReg64, sint32 memOffset);
+void aarch64Gen_stp_reg64_preIndex(aarch64GenContext_t* aarch64GenContext, sint32 regA, sint32 regB);
+void aarch64Gen_ldp_reg64_postIndex(aarch64GenContext_t* aarch64GenContext, sint32 regA, sint32 regB);
+void aarch64Gen_stp_fpr64_preIndex(aarch64GenContext_t* aarch64GenContext, sint32 regA, sint32 regB);
+void aarch64Gen_ldp_fpr64_postIndex(aarch64GenContext_t* aarch64GenContext, sint32 regA, sint32 regB);
+void aarch64Gen_ldaxr_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64);
+void aarch64Gen_stlxr_reg32(aarch64GenContext_t* aarch64GenContext, sint32 statusReg, sint32 srcReg, sint32 memBaseReg64);
+void aarch64Gen_clrex(aarch64GenContext_t* aarch64GenContext);
+
+// branches (immediates are patched later via aarch64Gen_patchBranch or relocs)
+void aarch64Gen_b(aarch64GenContext_t* aarch64GenContext);
+void aarch64Gen_bcond(aarch64GenContext_t* aarch64GenContext, sint32 cond);
+void aarch64Gen_cbz_reg32(aarch64GenContext_t* aarch64GenContext, sint32 reg);
+void aarch64Gen_cbnz_reg32(aarch64GenContext_t* aarch64GenContext, sint32 reg);
+void aarch64Gen_adr_reg64(aarch64GenContext_t* aarch64GenContext, sint32 destReg);
+void aarch64Gen_br_reg64(aarch64GenContext_t* aarch64GenContext, sint32 reg);
+void aarch64Gen_blr_reg64(aarch64GenContext_t* aarch64GenContext, sint32 reg);
+void aarch64Gen_ret(aarch64GenContext_t* aarch64GenContext);
+void aarch64Gen_brk(aarch64GenContext_t* aarch64GenContext);
@@ -0,0 +1,570 @@
+#include "PPCRecompiler.h"
+#include "PPCRecompilerIml.h"
+#include "PPCRecompilerAArch64.h"
+
+// AArch64 instruction encoders
+// all instructions are 4 bytes, branch immediates are written as zero and patched later via aarch64Gen_patchBranch
+
+void aarch64Gen_writeU32(aarch64GenContext_t* aarch64GenContext, uint32 v)
+{
+	if( aarch64GenContext->codeBufferIndex+4 > aarch64GenContext->codeBufferSize )
+	{
+		aarch64GenContext->codeBufferSize *= 2;
+		aarch64GenContext->codeBuffer = (uint8*)realloc(aarch64GenContext->codeBuffer, aarch64GenContext->codeBufferSize);
+	}
+	*(uint32*)(aarch64GenContext->codeBuffer+aarch64GenContext->codeBufferIndex) = v;
+	aarch64GenContext->codeBufferIndex += 4;
+}
+
+bool aarch64Gen_patchBranch(aarch64GenContext_t* aarch64GenContext, sint32 branchOffset, sint32 destinationOffset)
+{
+	uint32* instr = (uint32*)(aarch64GenContext->codeBuffer + branchOffset);
+	sint32 distance = destinationOffset - branchOffset;
+	cemu_assert_debug((distance & 3) == 0);
+	if( (*instr & 0xFC000000) == 0x14000000 )
+	{
+		// B imm26
+		if( distance < -(1<<27) || distance >= (1<<27) )
+			return false;
+		*instr = (*instr & 0xFC000000) | ((uint32)(distance >> 2) & 0x3FFFFFF);
+	}
+	else if( (*instr & 0xFF000010) == 0x54000000 || (*instr & 0x7E000000) == 0x34000000 )
+	{
+		// B.cond / CBZ / CBNZ imm19
+		if( distance < -(1<<20) || distance >= (1<<20) )
+			return false;
+		*instr = (*instr & 0xFF00001F) | (((uint32)(distance >> 2) & 0x7FFFF) << 5);
+	}
+	else if( (*instr & 0x9F000000) == 0x10000000 )
+	{
+		// ADR imm21
+		if( distance < -(1<<20) || distance >= (1<<20) )
+			return false;
+		*instr = (*instr & 0x9F00001F) | (((uint32)distance & 3) << 29) | ((((uint32)distance >> 2) & 0x7FFFF) << 5);
+	}
+	else
+	{
+		cemu_assert_debug(false);
+		return false;
+	}
+	return true;
+}
+
+void aarch64Gen_mov_reg32_imm32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, uint32 imm)
+{
+	if( (imm & 0xFFFF0000) == 0 )
+	{
+		// movz
+		aarch64Gen_writeU32(aarch64GenContext, 0x52800000 | (imm << 5) | destReg);
+	}
+	else if( (imm & 0xFFFF0000) == 0xFFFF0000 )
+	{
+		// movn
+		aarch64Gen_writeU32(aarch64GenContext, 0x12800000 | (((~imm) & 0xFFFF) << 5) | destReg);
+	}
+	else
+	{
+		// movz + movk
+		aarch64Gen_writeU32(aarch64GenContext, 0x52800000 | ((imm & 0xFFFF) << 5) | destReg);
+		aarch64Gen_writeU32(aarch64GenContext, 0x72800000 | (1 << 21) | ((imm >> 16) << 5) | destReg);
+	}
+}
+
+void aarch64Gen_mov_reg64_imm64(aarch64GenContext_t* aarch64GenContext, sint32 destReg, uint64 imm)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0xD2800000 | ((uint32)(imm & 0xFFFF) << 5) | destReg);
+	for(uint32 hw=1; hw<4; hw++)
+	{
+		uint32 part = (uint32)((imm >> (hw*16)) & 0xFFFF);
+		if( part != 0 )
+			aarch64Gen_writeU32(aarch64GenContext, 0xF2800000 | (hw << 21) | (part << 5) | destReg);
+	}
+}
+
+void aarch64Gen_mov_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg)
+{
+	// orr wD, wzr, wS
+	aarch64Gen_writeU32(aarch64GenContext, 0x2A0003E0 | (srcReg << 16) | destReg);
+}
+
+void aarch64Gen_mov_reg64_reg64(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg)
+{
+	// orr xD, xzr, xS
+	aarch64Gen_writeU32(aarch64GenContext, 0xAA0003E0 | (srcReg << 16) | destReg);
+}
+
+void aarch64Gen_mov_reg64_sp(aarch64GenContext_t* aarch64GenContext, sint32 destReg)
+{
+	// add xD, sp, #0
+	aarch64Gen_writeU32(aarch64GenContext, 0x91000000 | (AARCH64_REG_SP << 5) | destReg);
+}
+
+void aarch64Gen_mov_sp_reg64(aarch64GenContext_t* aarch64GenContext, sint32 srcReg)
+{
+	// add sp, xS, #0
+	aarch64Gen_writeU32(aarch64GenContext, 0x91000000 | (srcReg << 5) | AARCH64_REG_SP);
+}
+
+void _aarch64Gen_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, uint32 opcode, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	aarch64Gen_writeU32(aarch64GenContext, opcode | (srcRegB << 16) | (srcRegA << 5) | destReg);
+}
+
+void aarch64Gen_add_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x0B000000, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_adds_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x2B000000, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_adcs_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x3A000000, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_sub_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x4B000000, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_subs_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x6B000000, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_sbcs_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x7A000000, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_add_reg32_reg32_imm32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, sint32 imm)
+{
+	if( imm == 0 )
+	{
+		if( destReg != srcReg )
+			aarch64Gen_mov_reg32_reg32(aarch64GenContext, destReg, srcReg);
+	}
+	else if( imm > 0 && imm < 0x1000 )
+		aarch64Gen_writeU32(aarch64GenContext, 0x11000000 | ((uint32)imm << 10) | (srcReg << 5) | destReg);
+	else if( imm < 0 && imm > -0x1000 )
+		aarch64Gen_writeU32(aarch64GenContext, 0x51000000 | ((uint32)(-imm) << 10) | (srcReg << 5) | destReg);
+	else if( (imm & 0xFFF) == 0 && imm > 0 && imm < 0x1000000 )
+		aarch64Gen_writeU32(aarch64GenContext, 0x11400000 | ((uint32)(imm >> 12) << 10) | (srcReg << 5) | destReg);
+	else
+	{
+		cemu_assert_debug(srcReg != AARCH64_REG_RESV_ARG1);
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_ARG1, (uint32)imm);
+		aarch64Gen_add_reg32_reg32_reg32(aarch64GenContext, destReg, srcReg, AARCH64_REG_RESV_ARG1);
+	}
+}
+
+void aarch64Gen_add_reg64_reg64_imm12(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, uint32 imm)
+{
+	cemu_assert_debug(imm < 0x1000);
+	aarch64Gen_writeU32(aarch64GenContext, 0x91000000 | (imm << 10) | (srcReg << 5) | destReg);
+}
+
+void aarch64Gen_add_reg64_reg64_reg32uxtw(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg64, sint32 srcReg32)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0x8B204000 | (srcReg32 << 16) | (srcReg64 << 5) | destReg);
+}
+
+void aarch64Gen_cmp_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 regA, sint32 regB)
+{
+	aarch64Gen_subs_reg32_reg32_reg32(aarch64GenContext, AARCH64_REG_ZR, regA, regB);
+}
+
+void aarch64Gen_cmp_reg32_imm32(aarch64GenContext_t* aarch64GenContext, sint32 reg, sint32 imm)
+{
+	if( imm >= 0 && imm < 0x1000 )
+		aarch64Gen_writeU32(aarch64GenContext, 0x71000000 | ((uint32)imm << 10) | (reg << 5) | AARCH64_REG_ZR);
+	else
+	{
+		cemu_assert_debug(reg != AARCH64_REG_RESV_ARG1);
+		aarch64Gen_mov_reg32_imm32(aarch64GenContext, AARCH64_REG_RESV_ARG1, (uint32)imm);
+		aarch64Gen_cmp_reg32_reg32(aarch64GenContext, reg, AARCH64_REG_RESV_ARG1);
+	}
+}
+
+void aarch64Gen_cmp_reg64_reg64(aarch64GenContext_t* aarch64GenContext, sint32 regA, sint32 regB)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0xEB000000 | (regB << 16) | (regA << 5) | AARCH64_REG_ZR);
+}
+
+void aarch64Gen_neg_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg)
+{
+	aarch64Gen_sub_reg32_reg32_reg32(aarch64GenContext, destReg, AARCH64_REG_ZR, srcReg);
+}
+
+void aarch64Gen_and_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x0A000000, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_ands_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x6A000000, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_and_reg32_reg32_reg32lsr(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB, uint32 shift)
+{
+	cemu_assert_debug(shift < 32);
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x0A400000 | (shift << 10), destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_orr_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x2A000000, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_orr_reg32_reg32_reg32lsl(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB, uint32 shift)
+{
+	cemu_assert_debug(shift < 32);
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x2A000000 | (shift << 10), destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_orn_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x2A200000, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_eor_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x4A000000, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_eor_reg32_reg32_one(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg)
+{
+	// eor wD, wS, #1 (logical immediate with N=0, immr=0, imms=0)
+	aarch64Gen_writeU32(aarch64GenContext, 0x52000000 | (srcReg << 5) | destReg);
+}
+
+void aarch64Gen_bic_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x0A200000, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_mvn_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg)
+{
+	aarch64Gen_orn_reg32_reg32_reg32(aarch64GenContext, destReg, AARCH64_REG_ZR, srcReg);
+}
+
+void aarch64Gen_mul_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	// madd wD, wA, wB, wzr
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x1B007C00, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_smull_reg64_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x9B207C00, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_umull_reg64_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x9BA07C00, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_sdiv_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x1AC00C00, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_udiv_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegA, sint32 srcRegB)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x1AC00800, destReg, srcRegA, srcRegB);
+}
+
+void aarch64Gen_lsl_reg32_reg32_imm(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, uint32 shift)
+{
+	shift &= 31;
+	if( shift == 0 )
+	{
+		if( destReg != srcReg )
+			aarch64Gen_mov_reg32_reg32(aarch64GenContext, destReg, srcReg);
+		return;
+	}
+	// ubfm wD, wS, #(32-shift), #(31-shift)
+	aarch64Gen_writeU32(aarch64GenContext, 0x53000000 | ((32 - shift) << 16) | ((31 - shift) << 10) | (srcReg << 5) | destReg);
+}
+
+void aarch64Gen_lsr_reg32_reg32_imm(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, uint32 shift)
+{
+	cemu_assert_debug(shift < 32);
+	// ubfm wD, wS, #shift, #31
+	aarch64Gen_writeU32(aarch64GenContext, 0x53007C00 | (shift << 16) | (srcReg << 5) | destReg);
+}
+
+void aarch64Gen_asr_reg32_reg32_imm(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, uint32 shift)
+{
+	cemu_assert_debug(shift < 32);
+	// sbfm wD, wS, #shift, #31
+	aarch64Gen_writeU32(aarch64GenContext, 0x13007C00 | (shift << 16) | (srcReg << 5) | destReg);
+}
+
+void aarch64Gen_ror_reg32_reg32_imm(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, uint32 shift)
+{
+	cemu_assert_debug(shift < 32);
+	// extr wD, wS, wS, #shift
+	aarch64Gen_writeU32(aarch64GenContext, 0x13800000 | (srcReg << 16) | (shift << 10) | (srcReg << 5) | destReg);
+}
+
+void aarch64Gen_lsr_reg64_reg64_imm(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, uint32 shift)
+{
+	cemu_assert_debug(shift < 64);
+	// ubfm xD, xS, #shift, #63
+	aarch64Gen_writeU32(aarch64GenContext, 0xD340FC00 | (shift << 16) | (srcReg << 5) | destReg);
+}
+
+void aarch64Gen_lslv_reg64_reg64_reg64(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, sint32 shiftReg)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x9AC02000, destReg, srcReg, shiftReg);
+}
+
+void aarch64Gen_lsrv_reg64_reg64_reg64(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, sint32 shiftReg)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x9AC02400, destReg, srcReg, shiftReg);
+}
+
+void aarch64Gen_asrv_reg64_reg64_reg64(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, sint32 shiftReg)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x9AC02800, destReg, srcReg, shiftReg);
+}
+
+void aarch64Gen_rorv_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, sint32 shiftReg)
+{
+	_aarch64Gen_reg32_reg32_reg32(aarch64GenContext, 0x1AC02C00, destReg, srcReg, shiftReg);
+}
+
+void aarch64Gen_ubfx_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg, uint32 lsb, uint32 width)
+{
+	cemu_assert_debug(width >= 1 && (lsb + width) <= 32);
+	// ubfm wD, wS, #lsb, #(lsb+width-1)
+	aarch64Gen_writeU32(aarch64GenContext, 0x53000000 | (lsb << 16) | ((lsb + width - 1) << 10) | (srcReg << 5) | destReg);
+}
+
+void aarch64Gen_sxtb_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0x13001C00 | (srcReg << 5) | destReg);
+}
+
+void aarch64Gen_sxth_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0x13003C00 | (srcReg << 5) | destReg);
+}
+
+void aarch64Gen_sxtw_reg64_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0x93407C00 | (srcReg << 5) | destReg);
+}
+
+void aarch64Gen_rev_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0x5AC00800 | (srcReg << 5) | destReg);
+}
+
+void aarch64Gen_rev16_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0x5AC00400 | (srcReg << 5) | destReg);
+}
+
+void aarch64Gen_clz_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcReg)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0x5AC01000 | (srcReg << 5) | destReg);
+}
+
+void aarch64Gen_cset_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 cond)
+{
+	// csinc wD, wzr, wzr, !cond
+	aarch64Gen_writeU32(aarch64GenContext, 0x1A9F07E0 | ((uint32)(cond ^ 1) << 12) | destReg);
+}
+
+void aarch64Gen_csel_reg32_reg32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 srcRegTrue, sint32 srcRegFalse, sint32 cond)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0x1A800000 | (srcRegFalse << 16) | ((uint32)cond << 12) | (srcRegTrue << 5) | destReg);
+}
+
+// load/store with unsigned scaled immediate offset, falls back to register offset in X2 if the offset does not fit
+void _aarch64Gen_loadStore_mem(aarch64GenContext_t* aarch64GenContext, uint32 opcodeImm, uint32 opcodeReg, sint32 scaleShift, sint32 dataReg, sint32 memBaseReg64, sint32 memOffset)
+{
+	if( memOffset >= 0 && (memOffset & ((1 << scaleShift) - 1)) == 0 && (memOffset >> scaleShift) < 0x1000 )
+	{
+		aarch64Gen_writeU32(aarch64GenContext, opcodeImm | ((uint32)(memOffset >> scaleShift) << 10) | (memBaseReg64 << 5) | dataReg);
+		return;
+	}
+	cemu_assert_debug(memBaseReg64 != AARCH64_REG_RESV_OFFSET && dataReg != AARCH64_REG_RESV_OFFSET);
+	aarch64Gen_mov_reg64_imm64(aarch64GenContext, AARCH64_REG_RESV_OFFSET, (uint64)(sint64)memOffset);
+	// register offset with option LSL (no scaling)
+	aarch64Gen_writeU32(aarch64GenContext, opcodeReg | 0x6000 | (AARCH64_REG_RESV_OFFSET << 16) | (memBaseReg64 << 5) | dataReg);
+}
+
+void aarch64Gen_ldrb_reg32_mem8(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64, sint32 memOffset)
+{
+	_aarch64Gen_loadStore_mem(aarch64GenContext, 0x39400000, 0x38600800, 0, destReg, memBaseReg64, memOffset);
+}
+
+void aarch64Gen_strb_mem8_reg32(aarch64GenContext_t* aarch64GenContext, sint32 memBaseReg64, sint32 memOffset, sint32 srcReg)
+{
+	_aarch64Gen_loadStore_mem(aarch64GenContext, 0x39000000, 0x38200800, 0, srcReg, memBaseReg64, memOffset);
+}
+
+void aarch64Gen_ldr_reg32_mem32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64, sint32 memOffset)
+{
+	_aarch64Gen_loadStore_mem(aarch64GenContext, 0xB9400000, 0xB8600800, 2, destReg, memBaseReg64, memOffset);
+}
+
+void aarch64Gen_str_mem32_reg32(aarch64GenContext_t* aarch64GenContext, sint32 memBaseReg64, sint32 memOffset, sint32 srcReg)
+{
+	_aarch64Gen_loadStore_mem(aarch64GenContext, 0xB9000000, 0xB8200800, 2, srcReg, memBaseReg64, memOffset);
+}
+
+void aarch64Gen_ldr_reg64_mem64(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64, sint32 memOffset)
+{
+	_aarch64Gen_loadStore_mem(aarch64GenContext, 0xF9400000, 0xF8600800, 3, destReg, memBaseReg64, memOffset);
+}
+
+void aarch64Gen_str_mem64_reg64(aarch64GenContext_t* aarch64GenContext, sint32 memBaseReg64, sint32 memOffset, sint32 srcReg)
+{
+	_aarch64Gen_loadStore_mem(aarch64GenContext, 0xF9000000, 0xF8200800, 3, srcReg, memBaseReg64, memOffset);
+}
+
+// register offset with option UXTW (no scaling)
+void _aarch64Gen_loadStore_memUxtw(aarch64GenContext_t* aarch64GenContext, uint32 opcode, sint32 dataReg, sint32 memBaseReg64, sint32 memOffsetReg32)
+{
+	aarch64Gen_writeU32(aarch64GenContext, opcode | 0x4000 | (memOffsetReg32 << 16) | (memBaseReg64 << 5) | dataReg);
+}
+
+void aarch64Gen_ldr_reg32_mem32uxtw(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64, sint32 memOffsetReg32)
+{
+	_aarch64Gen_loadStore_memUxtw(aarch64GenContext, 0xB8600800, destReg, memBaseReg64, memOffsetReg32);
+}
+
+void aarch64Gen_ldrh_reg32_mem16uxtw(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64, sint32 memOffsetReg32)
+{
+	_aarch64Gen_loadStore_memUxtw(aarch64GenContext, 0x78600800, destReg, memBaseReg64, memOffsetReg32);
+}
+
+void aarch64Gen_ldrb_reg32_mem8uxtw(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64, sint32 memOffsetReg32)
+{
+	_aarch64Gen_loadStore_memUxtw(aarch64GenContext, 0x38600800, destReg, memBaseReg64, memOffsetReg32);
+}
+
+void aarch64Gen_ldrsb_reg32_mem8uxtw(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64, sint32 memOffsetReg32)
+{
+	_aarch64Gen_loadStore_memUxtw(aarch64GenContext, 0x38E00800, destReg, memBaseReg64, memOffsetReg32);
+}
+
+void aarch64Gen_str_mem32uxtw_reg32(aarch64GenContext_t* aarch64GenContext, sint32 memBaseReg64, sint32 memOffsetReg32, sint32 srcReg)
+{
+	_aarch64Gen_loadStore_memUxtw(aarch64GenContext, 0xB8200800, srcReg, memBaseReg64, memOffsetReg32);
+}
+
+void aarch64Gen_strh_mem16uxtw_reg32(aarch64GenContext_t* aarch64GenContext, sint32 memBaseReg64, sint32 memOffsetReg32, sint32 srcReg)
+{
+	_aarch64Gen_loadStore_memUxtw(aarch64GenContext, 0x78200800, srcReg, memBaseReg64, memOffsetReg32);
+}
+
+void aarch64Gen_strb_mem8uxtw_reg32(aarch64GenContext_t* aarch64GenContext, sint32 memBaseReg64, sint32 memOffsetReg32, sint32 srcReg)
+{
+	_aarch64Gen_loadStore_memUxtw(aarch64GenContext, 0x38200800, srcReg, memBaseReg64, memOffsetReg32);
+}
+
+void aarch64Gen_ldr_reg64_mem64Index(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 tableReg64, sint32 indexReg64)
+{
+	// ldr xD, [xT, xI, lsl #3]
+	aarch64Gen_writeU32(aarch64GenContext, 0xF8607800 | (indexReg64 << 16) | (tableReg64 << 5) | destReg);
+}
+
+void aarch64Gen_stp_zero_mem128(aarch64GenContext_t* aarch64GenContext, sint32 memBaseReg64, sint32 memOffset)
+{
+	cemu_assert_debug((memOffset & 7) == 0 && memOffset >= -512 && memOffset < 512);
+	// stp xzr, xzr, [xB, #offset]
+	aarch64Gen_writeU32(aarch64GenContext, 0xA9000000 | (((uint32)(memOffset / 8) & 0x7F) << 15) | (AARCH64_REG_ZR << 10) | (memBaseReg64 << 5) | AARCH64_REG_ZR);
+}
+
+void aarch64Gen_stp_reg64_preIndex(aarch64GenContext_t* aarch64GenContext, sint32 regA, sint32 regB)
+{
+	// stp xA, xB, [sp, #-16]!
+	aarch64Gen_writeU32(aarch64GenContext, 0xA9800000 | (((uint32)-2 & 0x7F) << 15) | (regB << 10) | (AARCH64_REG_SP << 5) | regA);
+}
+
+void aarch64Gen_ldp_reg64_postIndex(aarch64GenContext_t* aarch64GenContext, sint32 regA, sint32 regB)
+{
+	// ldp xA, xB, [sp], #16
+	aarch64Gen_writeU32(aarch64GenContext, 0xA8C00000 | (2 << 15) | (regB << 10) | (AARCH64_REG_SP << 5) | regA);
+}
+
+void aarch64Gen_stp_fpr64_preIndex(aarch64GenContext_t* aarch64GenContext, sint32 regA, sint32 regB)
+{
+	// stp dA, dB, [sp, #-16]!
+	aarch64Gen_writeU32(aarch64GenContext, 0x6D800000 | (((uint32)-2 & 0x7F) << 15) | (regB << 10) | (AARCH64_REG_SP << 5) | regA);
+}
+
+void aarch64Gen_ldp_fpr64_postIndex(aarch64GenContext_t* aarch64GenContext, sint32 regA, sint32 regB)
+{
+	// ldp dA, dB, [sp], #16
+	aarch64Gen_writeU32(aarch64GenContext, 0x6CC00000 | (2 << 15) | (regB << 10) | (AARCH64_REG_SP << 5) | regA);
+}
+
+void aarch64Gen_ldaxr_reg32(aarch64GenContext_t* aarch64GenContext, sint32 destReg, sint32 memBaseReg64)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0x885FFC00 | (memBaseReg64 << 5) | destReg);
+}
+
+void aarch64Gen_stlxr_reg32(aarch64GenContext_t* aarch64GenContext, sint32 statusReg, sint32 srcReg, sint32 memBaseReg64)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0x8800FC00 | (statusReg << 16) | (memBaseReg64 << 5) | srcReg);
+}
+
+void aarch64Gen_clrex(aarch64GenContext_t* aarch64GenContext)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0xD5033F5F);
+}
+
+void aarch64Gen_b(aarch64GenContext_t* aarch64GenContext)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0x14000000);
+}
+
+void aarch64Gen_bcond(aarch64GenContext_t* aarch64GenContext, sint32 cond)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0x54000000 | (uint32)cond);
+}
+
+void aarch64Gen_cbz_reg32(aarch64GenContext_t* aarch64GenContext, sint32 reg)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0x34000000 | reg);
+}
+
+void aarch64Gen_cbnz_reg32(aarch64GenContext_t* aarch64GenContext, sint32 reg)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0x35000000 | reg);
+}
+
+void aarch64Gen_adr_reg64(aarch64GenContext_t* aarch64GenContext, sint32 destReg)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0x10000000 | destReg);
+}
+
+void aarch64Gen_br_reg64(aarch64GenContext_t* aarch64GenContext, sint32 reg)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0xD61F0000 | (reg << 5));
+}
+
+void aarch64Gen_blr_reg64(aarch64GenContext_t* aarch64GenContext, sint32 reg)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0xD63F0000 | (reg << 5));
+}
+
+void aarch64Gen_ret(aarch64GenContext_t* aarch64GenContext)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0xD65F03C0);
+}
+
+void aarch64Gen_brk(aarch64GenContext_t* aarch64GenContext)
+{
+	aarch64Gen_writeU32(aarch64GenContext, 0xD4200000);
+}
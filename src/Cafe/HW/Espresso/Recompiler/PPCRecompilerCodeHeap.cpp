@@ -0,0 +1,347 @@
+#include "PPCRecompilerCodeHeap.h"
+#include "PPCRecompilerStats.h"
+#include "util/ChunkedHeap/ChunkedHeap.h"
+#include "util/MemMapper/MemMapper.h"
+
+std::atomic<uint64> g_ppcRecompilerCodeHeapEpoch;
+std::atomic<uint32> g_ppcRecompilerCodeHeapActive[2];
+
+class PPCRecompilerCodeHeap : private ChunkedHeap<8> // branch sites need 8 byte alignment
+{
+	struct Allocation
+	{
+		CHAddr addr;
+		uint32 size;
+	};
+
+	struct ChunkMemory
+	{
+		uint8* viewRX;
+		uint8* viewRW; // same as viewRX unless dual mapping is used
+		uint32 size;
+	};
+
+public:
+	PPCRecompilerCodeHeap(uint32 sizeLimitMB, bool useDualMapping) : m_sizeLimit((uint64)sizeLimitMB * 1024 * 1024), m_useDualMapping(useDualMapping) { };
+	~PPCRecompilerCodeHeap();
+
+	uint8* allocCode(uint32 size, uint8*& writableOut)
+	{
+		CHAddr addr = this->alloc(size, 8);
+		if (!addr.isValid())
+			return nullptr;
+		ChunkMemory& chunk = m_chunkMemory[addr.chunkIndex];
+		uint8* code = chunk.viewRX + addr.offset;
+		writableOut = chunk.viewRW + addr.offset;
+		m_allocations.emplace(code, Allocation{ addr, size });
+		return code;
+	}
+
+	void freeCode(uint8* code)
+	{
+		auto it = m_allocations.find(code);
+		if (it == m_allocations.end())
+		{
+			cemuLog_log(LogType::Force, "PPCRecompilerCodeHeap: Attempting to free unknown code {}", fmt::ptr(code));
+			return;
+		}
+		this->free(it->second.addr);
+		PPCRecompilerStats_recordCodeFree(it->second.size);
+		m_allocations.erase(it);
+	}
+
+	uint32 getAllocationSize(uint8* code) const
+	{
+		auto it = m_allocations.find(code);
+		if (it == m_allocations.end())
+			return 0;
+		return it->second.size;
+	}
+
+	void getStatistics(uint64& totalHeapSize, uint64& allocatedBytes) const
+	{
+		totalHeapSize = m_numHeapBytes;
+		allocatedBytes = m_numAllocatedBytes;
+	}
+
+private:
+	uint32 allocateNewChunk(uint32 chunkIndex, uint32 minimumAllocationSize) override;
+
+	uint64 m_sizeLimit; // zero means unlimited
+	bool m_useDualMapping;
+	std::vector<ChunkMemory> m_chunkMemory;
+	std::unordered_map<uint8*, Allocation> m_allocations;
+};
+
+PPCRecompilerCodeHeap::~PPCRecompilerCodeHeap()
+{
+	for (auto& it : m_chunkMemory)
+	{
+		if (it.viewRX != it.viewRW)
+			MemMapper::FreeDualMappedMemory(it.viewRX, it.viewRW, it.size);
+		else
+			MemMapper::FreeMemory(it.viewRX, it.size);
+	}
+}
+
+uint32 PPCRecompilerCodeHeap::allocateNewChunk(uint32 chunkIndex, uint32 minimumAllocationSize)
+{
+	cemu_assert_debug(m_chunkMemory.size() == chunkIndex);
+	uint32 chunkSize = (std::max<uint32>(minimumAllocationSize, PPC_REC_CODE_HEAP_CHUNK_SIZE) + PPC_REC_CODE_HEAP_CHUNK_SIZE - 1) & ~(PPC_REC_CODE_HEAP_CHUNK_SIZE - 1);
+	if (m_sizeLimit != 0 && (uint64)m_numHeapBytes + chunkSize > m_sizeLimit)
+		return 0;
+	if (!m_useDualMapping)
+	{
+		uint8* mem = (uint8*)MemMapper::AllocateMemory(nullptr, chunkSize, MemMapper::PAGE_PERMISSION::P_RWX);
+		if (mem)
+		{
+			m_chunkMemory.push_back({ mem, mem, chunkSize });
+			return chunkSize;
+		}
+		// writable+executable memory is not allowed by some systems (e.g. hardened kernels or SELinux policies)
+		cemuLog_log(LogType::Force, "Recompiler: Failed to allocate RWX memory, switching to dual mapped code memory");
+		m_useDualMapping = true;
+	}
+	void* viewRX;
+	void* viewRW;
+	if (!MemMapper::AllocateDualMappedMemory(chunkSize, viewRX, viewRW))
+	{
+		cemuLog_log(LogType::Force, "Recompiler: Failed to allocate dual mapped code memory");
+		return 0;
+	}
+	m_chunkMemory.push_back({ (uint8*)viewRX, (uint8*)viewRW, chunkSize });
+	return chunkSize;
+}
+
+struct PPCRecompilerPendingFree
+{
+	uint8* code;
+	uint32 size;
+	uint64 epoch; // epoch at the time of the free
+};
+
+struct PPCRecompilerParkedCallSite
+{
+	PPCInterpreter_t* hCPU;
+	uint8* returnAddress;
+};
+
+struct
+{
+	std::mutex mutex;
+	PPCRecompilerCodeHeap* heap{};
+	bool allowCompaction{};
+	std::vector<PPCRecompilerPendingFree> pendingFrees;
+	uint64 pendingFreeBytes{};
+	std::vector<PPCRecompilerParkedCallSite> parkedCallSites;
+	bool flushRequested{};
+	bool hasLoggedLimit{};
+	uint32 flushCount{};
+}s_codeHeap;
+
+void PPCRecompilerCodeHeap_init(uint32 sizeLimitMB, bool allowCompaction, bool useDualMapping)
+{
+	std::unique_lock _l(s_codeHeap.mutex);
+	cemu_assert_debug(s_codeHeap.heap == nullptr);
+	if (sizeLimitMB != 0)
+		sizeLimitMB = std::max<uint32>(sizeLimitMB, PPC_REC_CODE_HEAP_MIN_LIMIT_MB);
+	s_codeHeap.heap = new PPCRecompilerCodeHeap(sizeLimitMB, useDualMapping);
+	s_codeHeap.allowCompaction = allowCompaction;
+	s_codeHeap.pendingFrees.clear();
+	s_codeHeap.pendingFreeBytes = 0;
+	s_codeHeap.parkedCallSites.clear();
+	s_codeHeap.flushRequested = false;
+	s_codeHeap.hasLoggedLimit = false;
+	s_codeHeap.flushCount = 0;
+	g_ppcRecompilerCodeHeapEpoch.store(0);
+	g_ppcRecompilerCodeHeapActive[0].store(0);
+	g_ppcRecompilerCodeHeapActive[1].store(0);
+}
+
+// all CPU threads must be stopped
+void PPCRecompilerCodeHeap_shutdown()
+{
+	std::unique_lock _l(s_codeHeap.mutex);
+	delete s_codeHeap.heap;
+	s_codeHeap.heap = nullptr;
+	s_codeHeap.pendingFrees.clear();
+	s_codeHeap.pendingFreeBytes = 0;
+	s_codeHeap.parkedCallSites.clear();
+}
+
+// assumes s_codeHeap.mutex is held
+// the epoch can advance once no thread is registered in the slot it is going to reuse. Those threads entered two epochs ago or earlier
+void _PPCRecompilerCodeHeap_advanceEpoch()
+{
+	for (sint32 i = 0; i < 2; i++)
+	{
+		uint64 epoch = g_ppcRecompilerCodeHeapEpoch.load(std::memory_order_seq_cst);
+		if (g_ppcRecompilerCodeHeapActive[(epoch + 1) & 1].load(std::memory_order_seq_cst) != 0)
+			return;
+		g_ppcRecompilerCodeHeapEpoch.store(epoch + 1, std::memory_order_seq_cst);
+	}
+}
+
+// assumes s_codeHeap.mutex is held
+// a return address points behind the call instruction, so it can be equal to the end of the code but never to the start
+bool _PPCRecompilerCodeHeap_isPinned(const PPCRecompilerPendingFree& pendingFree, PPCInterpreter_t* hCPU = nullptr)
+{
+	for (auto& it : s_codeHeap.parkedCallSites)
+	{
+		if (hCPU && it.hCPU != hCPU)
+			continue;
+		if (it.returnAddress > pendingFree.code && it.returnAddress <= pendingFree.code + pendingFree.size)
+			return true;
+	}
+	return false;
+}
+
+// assumes s_codeHeap.mutex is held
+void _PPCRecompilerCodeHeap_reclaim()
+{
+	if (s_codeHeap.pendingFrees.empty())
+		return;
+	_PPCRecompilerCodeHeap_advanceEpoch();
+	// threads which were inside recompiled code at the time of the free were registered in the epoch of the free or the one before, after two advances both slots have drained
+	uint64 currentEpoch = g_ppcRecompilerCodeHeapEpoch.load(std::memory_order_seq_cst);
+	std::erase_if(s_codeHeap.pendingFrees, [currentEpoch](const PPCRecompilerPendingFree& pendingFree)
+	{
+		if (pendingFree.epoch + 2 > currentEpoch)
+			return false;
+		if (_PPCRecompilerCodeHeap_isPinned(pendingFree))
+			return false;
+		s_codeHeap.heap->freeCode(pendingFree.code);
+		s_codeHeap.pendingFreeBytes -= pendingFree.size;
+		return true;
+	});
+}
+
+void PPCRecompilerCodeHeap_reclaim()
+{
+	std::unique_lock _l(s_codeHeap.mutex);
+	if (s_codeHeap.heap)
+		_PPCRecompilerCodeHeap_reclaim();
+}
+
+uint8* PPCRecompilerCodeHeap_alloc(uint32 size, uint8*& writableOut)
+{
+	std::unique_lock _l(s_codeHeap.mutex);
+	cemu_assert(s_codeHeap.heap);
+	uint8* code = s_codeHeap.heap->allocCode(size, writableOut);
+	if (!code && !s_codeHeap.pendingFrees.empty())
+	{
+		_PPCRecompilerCodeHeap_reclaim();
+		code = s_codeHeap.heap->allocCode(size, writableOut);
+	}
+	if (!code)
+	{
+		uint64 heapBytes, allocatedBytes;
+		s_codeHeap.heap->getStatistics(heapBytes, allocatedBytes);
+		uint64 unusedBytes = heapBytes - allocatedBytes;
+		if (s_codeHeap.allowCompaction && unusedBytes * 100 >= heapBytes * PPC_REC_CODE_HEAP_COMPACTION_THRESHOLD)
+		{
+			// enough space is free but too fragmented. Throw away all functions and let them be recompiled on demand
+			s_codeHeap.flushRequested = true;
+		}
+		else if (!s_codeHeap.hasLoggedLimit)
+		{
+			cemuLog_log(LogType::Force, "Recompiler code cache is full ({}MB), new functions will be interpreted", heapBytes / 1024 / 1024);
+			s_codeHeap.hasLoggedLimit = true;
+		}
+		return nullptr;
+	}
+	PPCRecompilerStats_recordCodeAllocation(size);
+	return code;
+}
+
+void PPCRecompilerCodeHeap_free(void* code)
+{
+	if (!code)
+		return;
+	// pairs with the fence in PPCRecompilerCodeHeap_enter. The code was already unlinked, any thread which enters after this point can no longer reach it
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	PPCRecompilerPendingFree pendingFree;
+	pendingFree.code = (uint8*)code;
+	pendingFree.epoch = g_ppcRecompilerCodeHeapEpoch.load(std::memory_order_seq_cst);
+	std::unique_lock _l(s_codeHeap.mutex);
+	if (!s_codeHeap.heap)
+		return;
+	pendingFree.size = s_codeHeap.heap->getAllocationSize(pendingFree.code);
+	s_codeHeap.pendingFreeBytes += pendingFree.size;
+	s_codeHeap.pendingFrees.emplace_back(pendingFree);
+}
+
+void _PPCRecompilerCodeHeap_park(PPCInterpreter_t* hCPU)
+{
+	cemu_assert_debug(!hCPU->codeHeapParked);
+	// pin the code first, the epoch slot still protects it until the thread has left
+	std::unique_lock _l(s_codeHeap.mutex);
+	for (PPCRecompilerCodeHeapCallSite* callSite = hCPU->codeHeapCallSite; callSite; callSite = callSite->prev)
+		s_codeHeap.parkedCallSites.emplace_back(PPCRecompilerParkedCallSite{ hCPU, (uint8*)callSite->returnAddress });
+	_l.unlock();
+	g_ppcRecompilerCodeHeapActive[hCPU->codeHeapEpochSlot].fetch_sub(1, std::memory_order_release);
+	hCPU->codeHeapParked = true;
+}
+
+void _PPCRecompilerCodeHeap_unpark(PPCInterpreter_t* hCPU)
+{
+	cemu_assert_debug(hCPU->codeHeapDepth != 0);
+	_PPCRecompilerCodeHeap_enterEpoch(hCPU);
+	hCPU->codeHeapParked = false;
+	// code which was freed while the thread was parked is still going to be executed after the HLE call returns
+	// re-tag it with the current epoch, from now on the epoch slot of the thread keeps it alive
+	std::unique_lock _l(s_codeHeap.mutex);
+	uint64 currentEpoch = g_ppcRecompilerCodeHeapEpoch.load(std::memory_order_seq_cst);
+	for (auto& pendingFree : s_codeHeap.pendingFrees)
+	{
+		if (pendingFree.epoch < currentEpoch && _PPCRecompilerCodeHeap_isPinned(pendingFree, hCPU))
+			pendingFree.epoch = currentEpoch;
+	}
+	std::erase_if(s_codeHeap.parkedCallSites, [hCPU](const PPCRecompilerParkedCallSite& parkedCallSite) { return parkedCallSite.hCPU == hCPU; });
+}
+
+void PPCRecompilerCodeHeap_releaseThread(PPCInterpreter_t* hCPU)
+{
+	if (hCPU->codeHeapDepth == 0)
+		return;
+	if (hCPU->codeHeapParked)
+	{
+		std::unique_lock _l(s_codeHeap.mutex);
+		std::erase_if(s_codeHeap.parkedCallSites, [hCPU](const PPCRecompilerParkedCallSite& parkedCallSite) { return parkedCallSite.hCPU == hCPU; });
+		hCPU->codeHeapParked = false;
+		hCPU->codeHeapDepth = 0;
+		return;
+	}
+	hCPU->codeHeapDepth = 1;
+	PPCRecompilerCodeHeap_leave(hCPU);
+}
+
+void PPCRecompilerCodeHeap_freeUnpublished(void* code)
+{
+	if (!code)
+		return;
+	std::unique_lock _l(s_codeHeap.mutex);
+	if (s_codeHeap.heap)
+		s_codeHeap.heap->freeCode((uint8*)code);
+}
+
+bool PPCRecompilerCodeHeap_consumeFlushRequest()
+{
+	std::unique_lock _l(s_codeHeap.mutex);
+	if (!s_codeHeap.flushRequested)
+		return false;
+	s_codeHeap.flushRequested = false;
+	s_codeHeap.flushCount++;
+	return true;
+}
+
+PPCRecompilerCodeHeapStats PPCRecompilerCodeHeap_getStats()
+{
+	PPCRecompilerCodeHeapStats stats{};
+	std::unique_lock _l(s_codeHeap.mutex);
+	if (s_codeHeap.heap)
+		s_codeHeap.heap->getStatistics(stats.heapBytes, stats.allocatedBytes);
+	stats.pendingFreeBytes = s_codeHeap.pendingFreeBytes;
+	stats.flushCount = s_codeHeap.flushCount;
+	return stats;
+}
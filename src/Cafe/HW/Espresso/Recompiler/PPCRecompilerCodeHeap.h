@@ -0,0 +1,97 @@
+#pragma once
+#include "Cafe/HW/Espresso/Const.h"
+#include "Cafe/HW/Espresso/PPCState.h"
+
+// executable memory for recompiled functions
+// with dual mapping the code is written through a separate read+write view of the same memory, the executable view is never writable
+// memory of deleted functions is reused, but since other cores might still be executing the old code it only becomes available once every PPC thread that was inside recompiled code at the time of the free has left it
+
+#define PPC_REC_CODE_HEAP_CHUNK_SIZE			(4*1024*1024) // 4MB
+#define PPC_REC_CODE_HEAP_MIN_LIMIT_MB			(16) // smaller limits are raised to this
+#define PPC_REC_CODE_HEAP_COMPACTION_THRESHOLD	(25) // percentage of the heap that has to be unused (fragmented) before a full flush is requested
+
+struct PPCRecompilerCodeHeapStats
+{
+	uint64 heapBytes; // size of all chunks
+	uint64 allocatedBytes; // includes code which is waiting to be reclaimed
+	uint64 pendingFreeBytes;
+	uint32 flushCount;
+};
+
+void PPCRecompilerCodeHeap_init(uint32 sizeLimitMB, bool allowCompaction, bool useDualMapping);
+void PPCRecompilerCodeHeap_shutdown();
+
+uint8* PPCRecompilerCodeHeap_alloc(uint32 size, uint8*& writableOut); // returns the executable address or nullptr if the size limit was reached. writableOut receives the address for writing the code
+void PPCRecompilerCodeHeap_free(void* code); // code must no longer be reachable from the jump table or branch sites
+void PPCRecompilerCodeHeap_freeUnpublished(void* code); // for code which was never made visible to the CPU threads
+void PPCRecompilerCodeHeap_reclaim();
+bool PPCRecompilerCodeHeap_consumeFlushRequest();
+
+PPCRecompilerCodeHeapStats PPCRecompilerCodeHeap_getStats();
+
+// recompiled code can be left in the middle of a function (HLE calls may switch fibers) and the PPC thread can resume on a different core
+// so instead of tracking host threads or cores, every PPC thread registers itself in one of two epoch slots while it is inside recompiled code
+// freed code is tagged with the current epoch and reclaimed once the epoch advanced twice, which requires every thread that could still reference it to have left
+// a thread which is switched out while inside recompiled code (blocking HLE calls) is parked instead. It leaves its epoch slot and only pins the code which its HLE call sites will return to
+extern std::atomic<uint64> g_ppcRecompilerCodeHeapEpoch;
+extern std::atomic<uint32> g_ppcRecompilerCodeHeapActive[2];
+
+inline void _PPCRecompilerCodeHeap_enterEpoch(PPCInterpreter_t* hCPU)
+{
+	while (true)
+	{
+		uint64 epoch = g_ppcRecompilerCodeHeapEpoch.load(std::memory_order_seq_cst);
+		uint32 slot = (uint32)(epoch & 1);
+		g_ppcRecompilerCodeHeapActive[slot].fetch_add(1, std::memory_order_seq_cst);
+		// the epoch can only advance while the slot of the next epoch is empty. Re-check so the thread never ends up in a slot which is considered drained
+		if (g_ppcRecompilerCodeHeapEpoch.load(std::memory_order_seq_cst) == epoch)
+		{
+			hCPU->codeHeapEpochSlot = slot;
+			break;
+		}
+		g_ppcRecompilerCodeHeapActive[slot].fetch_sub(1, std::memory_order_seq_cst);
+	}
+	// pairs with the fence in PPCRecompilerCodeHeap_free. Either the freeing thread sees an epoch this thread is registered in or this thread sees the updated jump table
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+inline void PPCRecompilerCodeHeap_enter(PPCInterpreter_t* hCPU)
+{
+	if (hCPU->codeHeapDepth++ != 0)
+		return;
+	_PPCRecompilerCodeHeap_enterEpoch(hCPU);
+}
+
+inline void PPCRecompilerCodeHeap_leave(PPCInterpreter_t* hCPU)
+{
+	cemu_assert_debug(hCPU->codeHeapDepth != 0);
+	if (--hCPU->codeHeapDepth != 0)
+		return;
+	g_ppcRecompilerCodeHeapActive[hCPU->codeHeapEpochSlot].fetch_sub(1, std::memory_order_release);
+}
+
+// return address of an HLE call made from recompiled code. Lives on the host stack of the calling thread
+struct PPCRecompilerCodeHeapCallSite
+{
+	void* returnAddress;
+	PPCRecompilerCodeHeapCallSite* prev;
+};
+
+void _PPCRecompilerCodeHeap_park(PPCInterpreter_t* hCPU);
+void _PPCRecompilerCodeHeap_unpark(PPCInterpreter_t* hCPU);
+
+// called before the PPC thread is switched out
+inline void PPCRecompilerCodeHeap_park(PPCInterpreter_t* hCPU)
+{
+	if (hCPU->codeHeapDepth != 0)
+		_PPCRecompilerCodeHeap_park(hCPU);
+}
+
+// called once the PPC thread resumes
+inline void PPCRecompilerCodeHeap_unpark(PPCInterpreter_t* hCPU)
+{
+	if (hCPU->codeHeapParked)
+		_PPCRecompilerCodeHeap_unpark(hCPU);
+}
+
+void PPCRecompilerCodeHeap_releaseThread(PPCInterpreter_t* hCPU); // for PPC threads which are deleted while inside recompiled code
@@ -102,6 +102,7 @@ enum
 	PPCREC_IML_MACRO_HLE,			// HLE function call
 	PPCREC_IML_MACRO_MFTB,			// get TB register value (low or high)
 	PPCREC_IML_MACRO_LEAVE,			// leaves recompiler and switches to interpeter
+	PPCREC_IML_MACRO_COUNT_TIER_UP,	// decrease the tier-up counter of a tier 0 function
 	// debugging
 	PPCREC_IML_MACRO_DEBUGBREAK,	// throws a debugbreak
 };
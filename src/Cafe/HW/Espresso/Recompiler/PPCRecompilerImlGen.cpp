@@ -5,6 +5,7 @@
 #include "PPCRecompilerX64.h"
 #include "PPCRecompilerImlRanges.h"
 #include "util/helpers/StringBuf.h"
+#include "config/ActiveSettings.h"
 
 bool PPCRecompiler_decodePPCInstruction(ppcImlGenContext_t* ppcImlGenContext);
 uint32 PPCRecompiler_iterateCurrentInstruction(ppcImlGenContext_t* ppcImlGenContext);
@@ -553,15 +554,33 @@ void PPCRecompilerImlGen_CMPLI(ppcImlGenContext_t* ppcImlGenContext, uint32 opco
 	PPCRecompilerImlGen_generateNewInstruction_r_s32(ppcImlGenContext, PPCREC_IML_OP_COMPARE_UNSIGNED, gprRegister, (sint32)b, 0, false, false, cr, PPCREC_CR_MODE_COMPARE_UNSIGNED);
 }
 
-bool PPCRecompiler_canInlineFunction(MPTR functionPtr, sint32* functionInstructionCount)
+// returns true if the function at functionPtr is a straight-line leaf function (no branches, SPR access or macros) of at most maxInstructionCount instructions followed by BLR
+bool PPCRecompiler_canInlineFunction(MPTR functionPtr, sint32 maxInstructionCount, sint32* functionInstructionCount)
 {
-	for (sint32 i = 0; i < 6; i++)
+	if (maxInstructionCount <= 0)
+		return false; // inlining disabled or budget used up
+	for (sint32 i = 0; i <= maxInstructionCount; i++)
 	{
 		uint32 opcode = memory_readU32(functionPtr+i*4);
 		switch ((opcode >> 26))
 		{
+		case 7: // MULLI
+		case 8: // SUBFIC
+		case 10: // CMPLI
+		case 11: // CMPI
+		case 12: // ADDIC
+		case 13: // ADDIC.
 		case 14: // ADDI
 		case 15: // ADDIS
+		case 20: // RLWIMI
+		case 21: // RLWINM
+		case 23: // RLWNM
+		case 24: // ORI
+		case 25: // ORIS
+		case 26: // XORI
+		case 27: // XORIS
+		case 28: // ANDI.
+		case 29: // ANDIS.
 			continue;
 		case 19: // opcode category 19
 			switch (PPC_getBits(opcode, 30, 10))
@@ -575,6 +594,58 @@ bool PPCRecompiler_canInlineFunction(MPTR functionPtr, sint32* functionInstructi
 				return false;
 			}
 			return false;
+		case 31: // opcode category 31
+		{
+			sint32 rD, rA, rB;
+			PPC_OPC_TEMPL_X(opcode, rD, rA, rB);
+			switch (PPC_getBits(opcode, 30, 10))
+			{
+			case 0: // CMP
+			case 8: // SUBFC
+			case 10: // ADDC
+			case 11: // MULHWU
+			case 24: // SLW
+			case 28: // AND
+			case 32: // CMPL
+			case 40: // SUBF
+			case 60: // ANDC
+			case 75: // MULHW
+			case 104: // NEG
+			case 124: // NOR
+			case 136: // SUBFE
+			case 138: // ADDE
+			case 151: // STWX
+			case 200: // SUBFZE
+			case 202: // ADDZE
+			case 215: // STBX
+			case 266: // ADD
+			case 279: // LHZX
+			case 284: // EQV
+			case 316: // XOR
+			case 343: // LHAX
+			case 407: // STHX
+			case 412: // ORC
+			case 444: // OR
+			case 536: // SRW
+			case 792: // SRAW
+			case 824: // SRAWI
+			case 922: // EXTSH
+			case 954: // EXTSB
+				continue;
+			case 23: // LWZX
+			case 87: // LBZX
+				if (rA == 0)
+					return false;
+				continue;
+			case 26: // CNTLZW
+				if (opcode & PPC_OPC_RC)
+					return false;
+				continue;
+			case 235: // MULLW (MULLWO has a different extended opcode)
+				continue;
+			}
+			return false;
+		}
 		case 32: // LWZ
 		case 33: // LWZU
 		case 34: // LBZ
@@ -607,7 +678,7 @@ bool PPCRecompiler_canInlineFunction(MPTR functionPtr, sint32* functionInstructi
 	return false;
 }
 
-void PPCRecompiler_generateInlinedCode(ppcImlGenContext_t* ppcImlGenContext, uint32 startAddress, sint32 instructionCount)
+bool PPCRecompiler_generateInlinedCode(ppcImlGenContext_t* ppcImlGenContext, uint32 startAddress, sint32 instructionCount)
 {
 	for (sint32 i = 0; i < instructionCount; i++)
 	{
@@ -615,14 +686,16 @@ void PPCRecompiler_generateInlinedCode(ppcImlGenContext_t* ppcImlGenContext, uin
 		ppcImlGenContext->cyclesSinceLastBranch++;
 		if (PPCRecompiler_decodePPCInstruction(ppcImlGenContext))
 		{
-			assert_dbg();
+			cemuLog_log(LogType::Force, "PPCRecompiler: Failed to inline function 0x{:08x} (unsupported instruction at 0x{:08x}), calling it instead", startAddress, startAddress + i*4);
+			return false;
 		}
 	}
-	// add range
+	// add range so that modifications to the inlined function also invalidate the caller
 	ppcRecRange_t recRange;
 	recRange.ppcAddress = startAddress;
 	recRange.ppcSize = instructionCount*4 + 4; // + 4 because we have to include the BLR
 	ppcImlGenContext->functionRef->list_ranges.push_back(recRange);
+	return true;
 }
 
 bool PPCRecompilerImlGen_B(ppcImlGenContext_t* ppcImlGenContext, uint32 opcode)
@@ -639,16 +712,28 @@ bool PPCRecompilerImlGen_B(ppcImlGenContext_t* ppcImlGenContext, uint32 opcode)
 		// function call
 		// check if function can be inlined
 		sint32 inlineFuncInstructionCount = 0;
-		if (PPCRecompiler_canInlineFunction(jumpAddressDest, &inlineFuncInstructionCount))
+		if (PPCRecompiler_canInlineFunction(jumpAddressDest, ppcImlGenContext->inlineBudget, &inlineFuncInstructionCount))
 		{
+			// remember the state so that the inlined code can be discarded again if the callee cannot be translated
+			sint32 prevImlListCount = ppcImlGenContext->imlListCount;
+			uint32 prevCyclesSinceLastBranch = ppcImlGenContext->cyclesSinceLastBranch;
 			// generate NOP iml instead of BL macro (this assures that segment PPC range remains intact)
 			PPCRecompilerImlGen_generateNewInstruction_noOp(ppcImlGenContext, NULL);
 			//cemuLog_log(LogType::Force, "Inline func 0x{:08x} at {:08x}", jumpAddressDest, ppcImlGenContext->ppcAddressOfCurrentInstruction);
+			// LR is observable after the call returns
+			uint32 registerLR = PPCRecompilerImlGen_loadOverwriteRegister(ppcImlGenContext, PPCREC_NAME_SPR0+SPR_LR);
+			PPCRecompilerImlGen_generateNewInstruction_r_s32(ppcImlGenContext, PPCREC_IML_OP_ASSIGN, registerLR, (ppcImlGenContext->ppcAddressOfCurrentInstruction+4)&0x7FFFFFFF, 0, false, false, PPC_REC_INVALID_REGISTER, 0);
+			uint32 callSiteAddress = ppcImlGenContext->ppcAddressOfCurrentInstruction;
 			uint32* prevInstructionPtr = ppcImlGenContext->currentInstruction;
 			ppcImlGenContext->currentInstruction = (uint32*)memory_getPointerFromVirtualOffset(jumpAddressDest);
-			PPCRecompiler_generateInlinedCode(ppcImlGenContext, jumpAddressDest, inlineFuncInstructionCount);
+			bool inlineSucceeded = PPCRecompiler_generateInlinedCode(ppcImlGenContext, jumpAddressDest, inlineFuncInstructionCount);
 			ppcImlGenContext->currentInstruction = prevInstructionPtr;
-			return true;
+			ppcImlGenContext->ppcAddressOfCurrentInstruction = callSiteAddress;
+			if (inlineSucceeded)
+				return true;
+			// fall back to a regular call for this BL only, the rest of the caller is still recompiled
+			ppcImlGenContext->imlListCount = prevImlListCount;
+			ppcImlGenContext->cyclesSinceLastBranch = prevCyclesSinceLastBranch;
 		}
 		// generate funtion call instructions
 		PPCRecompilerImlGen_generateNewInstruction_macro(ppcImlGenContext, PPCREC_IML_MACRO_BL, ppcImlGenContext->ppcAddressOfCurrentInstruction, jumpAddressDest, ppcImlGenContext->cyclesSinceLastBranch);
@@ -3303,6 +3388,10 @@ void PPCRecompiler_dumpIMLSegment(PPCRecImlSegment_t* imlSegment, sint32 segment
 			{
 				strOutput.addFmt("MACRO COUNT_CYCLES cycles: {}", imlSegment->imlList[i].op_macro.param);
 			}
+			else if( imlSegment->imlList[i].operation == PPCREC_IML_MACRO_COUNT_TIER_UP )
+			{
+				strOutput.addFmt("MACRO COUNT_TIER_UP counter: {}", imlSegment->imlList[i].op_macro.param);
+			}
 			else
 			{
 				strOutput.addFmt("MACRO ukn operation {}", imlSegment->imlList[i].operation);
@@ -4475,6 +4564,9 @@ bool PPCRecompiler_generateIntermediateCode(ppcImlGenContext_t& ppcImlGenContext
 {
 	//ppcImlGenContext_t ppcImlGenContext = { 0 };
 	ppcImlGenContext.functionRef = ppcRecFunc;
+	// tier 0 functions skip all optional optimization passes to reduce compile latency
+	const bool runOptimizationPasses = ppcRecFunc->tier != PPC_REC_TIER_0;
+	ppcImlGenContext.inlineBudget = (sint32)ActiveSettings::GetRecompilerInlineBudget();
 	// add entire range
 	ppcRecRange_t recRange;
 	recRange.ppcAddress = ppcRecFunc->ppcAddress;
@@ -4517,7 +4609,7 @@ bool PPCRecompiler_generateIntermediateCode(ppcImlGenContext_t& ppcImlGenContext
 					uint32 li;
 					PPC_OPC_TEMPL_I(opcodePrevious, li);
 					sint32 inlineSize = 0;
-					if (PPCRecompiler_canInlineFunction(li + addressOfCurrentInstruction - 4, &inlineSize))
+					if (PPCRecompiler_canInlineFunction(li + addressOfCurrentInstruction - 4, ppcImlGenContext.inlineBudget, &inlineSize))
 						canInlineFunction = true;
 				}
 				if( canInlineFunction == false && (opcodePrevious & PPC_OPC_LK) == false)
@@ -4743,7 +4835,7 @@ bool PPCRecompiler_generateIntermediateCode(ppcImlGenContext_t& ppcImlGenContext
 	PPCRecompilerIML_linkSegments(&ppcImlGenContext);
 
 	// optimization pass - replace segments with conditional MOVs if possible
-	for (sint32 s = 0; s < ppcImlGenContext.segmentListCount; s++)
+	for (sint32 s = 0; runOptimizationPasses && s < ppcImlGenContext.segmentListCount; s++)
 	{
 		PPCRecImlSegment_t* imlSegment = ppcImlGenContext.segmentList[s];
 		if (imlSegment->nextSegmentBranchNotTaken == NULL || imlSegment->nextSegmentBranchTaken == NULL)
@@ -4960,8 +5052,28 @@ bool PPCRecompiler_generateIntermediateCode(ppcImlGenContext_t& ppcImlGenContext
 	// this simplifies logic during register allocation
 	PPCRecompilerIML_isolateEnterableSegments(&ppcImlGenContext);
 
+	// tier 0: count every function entry and every iteration of a potentially infinite loop (cycle check segments)
+	if (ppcRecFunc->tier == PPC_REC_TIER_0)
+	{
+		cemu_assert_debug(ppcRecFunc->tierUpCounterIndex != PPC_REC_TIER_UP_INVALID_COUNTER);
+		for (sint32 s = 0; s < ppcImlGenContext.segmentListCount; s++)
+		{
+			PPCRecImlSegment_t* imlSegment = ppcImlGenContext.segmentList[s];
+			bool isLoopCheck = imlSegment->imlListCount > 0 && imlSegment->imlList[imlSegment->imlListCount - 1].type == PPCREC_IML_TYPE_CJUMP_CYCLE_CHECK;
+			if (!imlSegment->isEnterable && !isLoopCheck)
+				continue;
+			PPCRecompiler_pushBackIMLInstructions(imlSegment, 0, 1);
+			imlSegment->imlList[0].type = PPCREC_IML_TYPE_MACRO;
+			imlSegment->imlList[0].crRegister = PPC_REC_INVALID_REGISTER;
+			imlSegment->imlList[0].operation = PPCREC_IML_MACRO_COUNT_TIER_UP;
+			imlSegment->imlList[0].op_macro.param = ppcRecFunc->tierUpCounterIndex;
+			imlSegment->imlList[0].associatedPPCAddress = 0;
+		}
+	}
+
 	// if GQRs can be predicted, optimize PSQ load/stores
-	PPCRecompiler_optimizePSQLoadAndStore(&ppcImlGenContext);
+	if (runOptimizationPasses)
+		PPCRecompiler_optimizePSQLoadAndStore(&ppcImlGenContext);
 
 	// count number of used registers
 	uint32 numLoadedFPRRegisters = 0;
@@ -5003,10 +5115,13 @@ bool PPCRecompiler_generateIntermediateCode(ppcImlGenContext_t& ppcImlGenContext
 		}
 	}
 
-	// merge certain float load+store patterns (must happen before FPR register remapping)
-	PPCRecompiler_optimizeDirectFloatCopies(&ppcImlGenContext);
-	// delay byte swapping for certain load+store patterns
-	PPCRecompiler_optimizeDirectIntegerCopies(&ppcImlGenContext);
+	if (runOptimizationPasses)
+	{
+		// merge certain float load+store patterns (must happen before FPR register remapping)
+		PPCRecompiler_optimizeDirectFloatCopies(&ppcImlGenContext);
+		// delay byte swapping for certain load+store patterns
+		PPCRecompiler_optimizeDirectIntegerCopies(&ppcImlGenContext);
+	}
 
 	if (numLoadedFPRRegisters > 0)
 	{
@@ -5020,7 +5135,10 @@ bool PPCRecompiler_generateIntermediateCode(ppcImlGenContext_t& ppcImlGenContext
 	PPCRecompilerImm_allocateRegisters(&ppcImlGenContext);
 
 	// remove redundant name load and store instructions
-	PPCRecompiler_reorderConditionModifyInstructions(&ppcImlGenContext);
-	PPCRecompiler_removeRedundantCRUpdates(&ppcImlGenContext);
+	if (runOptimizationPasses)
+	{
+		PPCRecompiler_reorderConditionModifyInstructions(&ppcImlGenContext);
+		PPCRecompiler_removeRedundantCRUpdates(&ppcImlGenContext);
+	}
 	return true;
 }
@@ -7,12 +7,11 @@ void PPCRecompiler_replaceGPRRegisterUsageMultiple(ppcImlGenContext_t* ppcImlGen
 
 bool PPCRecompiler_isSuffixInstruction(PPCRecImlInstruction_t* iml);
 
-uint32 recRACurrentIterationIndex = 0;
+std::atomic_uint32_t recRACurrentIterationIndex = 0; // shared by all recompiler threads
 
 uint32 PPCRecRA_getNextIterationIndex()
 {
-	recRACurrentIterationIndex++;
-	return recRACurrentIterationIndex;
+	return ++recRACurrentIterationIndex;
 }
 
 bool _detectLoop(PPCRecImlSegment_t* currentSegment, sint32 depth, uint32 iterationIndex, PPCRecImlSegment_t* imlSegmentLoopBase)
@@ -986,6 +985,9 @@ void PPCRecompilerImm_prepareForRegisterAllocation(ppcImlGenContext_t* ppcImlGen
 		PPCRecImlSegment_t* imlSegment = ppcImlGenContext->segmentList[s];
 		imlSegment->momentaryIndex = s;
 	}
+	// tier 0 functions skip loop detection, all segments are treated as having the same weight
+	if (ppcImlGenContext->functionRef->tier == PPC_REC_TIER_0)
+		return;
 	for (sint32 s = 0; s < ppcImlGenContext->segmentListCount; s++)
 	{
 		PPCRecImlSegment_t* imlSegment = ppcImlGenContext->segmentList[s];
@@ -0,0 +1,203 @@
+#include "PPCRecompilerStats.h"
+#include "util/helpers/fspinlock.h"
+#include "Common/FileStream.h"
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/prettywriter.h>
+
+std::atomic<uint64> g_ppcRecompilerStatsExitCounter{0};
+
+struct
+{
+	std::atomic<uint64> functionsCompiled{0};
+	std::atomic<uint64> functionsFailed{0};
+	std::atomic<uint64> totalCompileTimeUs{0};
+	std::atomic<uint64> codeBytesAllocated{0};
+	std::atomic<uint32> compileTimeHistogram[PPC_REC_STATS_HISTOGRAM_BUCKETS]{};
+	// compile info per function, only touched by the recompiler threads
+	FSpinlock functionLock;
+	std::unordered_map<MPTR, PPCRecompilerStatsFunction> functions;
+	// sampled exit addresses
+	FSpinlock exitLock;
+	std::unordered_map<MPTR, uint64> exitSamples;
+	uint64 exitSampleCount{0};
+}PPCRecompilerStats;
+
+uint32 _PPCRecompilerStats_getHistogramBucket(uint64 compileTimeUs)
+{
+	uint32 bucket = (uint32)std::bit_width(compileTimeUs);
+	return std::min<uint32>(bucket, PPC_REC_STATS_HISTOGRAM_BUCKETS - 1);
+}
+
+void PPCRecompilerStats_recordCompile(MPTR ppcAddress, uint64 compileTimeUs, uint32 codeSize, bool success)
+{
+	if (!success)
+	{
+		PPCRecompilerStats.functionsFailed.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	PPCRecompilerStats.functionsCompiled.fetch_add(1, std::memory_order_relaxed);
+	PPCRecompilerStats.totalCompileTimeUs.fetch_add(compileTimeUs, std::memory_order_relaxed);
+	PPCRecompilerStats.compileTimeHistogram[_PPCRecompilerStats_getHistogramBucket(compileTimeUs)].fetch_add(1, std::memory_order_relaxed);
+	PPCRecompilerStats.functionLock.lock();
+	auto& entry = PPCRecompilerStats.functions[ppcAddress];
+	entry.ppcAddress = ppcAddress;
+	entry.compileCount++;
+	entry.totalCompileTimeUs += compileTimeUs;
+	entry.maxCompileTimeUs = std::max(entry.maxCompileTimeUs, compileTimeUs);
+	entry.codeSize = codeSize;
+	PPCRecompilerStats.functionLock.unlock();
+}
+
+void PPCRecompilerStats_recordCodeAllocation(uint32 size)
+{
+	PPCRecompilerStats.codeBytesAllocated.fetch_add(size, std::memory_order_relaxed);
+}
+
+void PPCRecompilerStats_recordCodeFree(uint32 size)
+{
+	PPCRecompilerStats.codeBytesAllocated.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void PPCRecompilerStats_recordExitSlow(MPTR address)
+{
+	// never block the CPU thread, drop the sample if another thread is updating the table
+	if (!PPCRecompilerStats.exitLock.try_lock())
+		return;
+	PPCRecompilerStats.exitSampleCount++;
+	auto it = PPCRecompilerStats.exitSamples.find(address);
+	if (it != PPCRecompilerStats.exitSamples.end())
+		it->second++;
+	else if (PPCRecompilerStats.exitSamples.size() < PPC_REC_STATS_MAX_EXIT_ADDRESSES)
+		PPCRecompilerStats.exitSamples.emplace(address, 1);
+	PPCRecompilerStats.exitLock.unlock();
+}
+
+PPCRecompilerStatsSnapshot PPCRecompilerStats_getSnapshot(size_t maxEntries)
+{
+	PPCRecompilerStatsSnapshot snapshot{};
+	snapshot.functionsCompiled = PPCRecompilerStats.functionsCompiled.load(std::memory_order_relaxed);
+	snapshot.functionsFailed = PPCRecompilerStats.functionsFailed.load(std::memory_order_relaxed);
+	snapshot.totalCompileTimeUs = PPCRecompilerStats.totalCompileTimeUs.load(std::memory_order_relaxed);
+	snapshot.codeBytesAllocated = PPCRecompilerStats.codeBytesAllocated.load(std::memory_order_relaxed);
+	snapshot.exitCount = g_ppcRecompilerStatsExitCounter.load(std::memory_order_relaxed);
+	for (sint32 i = 0; i < PPC_REC_STATS_HISTOGRAM_BUCKETS; i++)
+		snapshot.compileTimeHistogram[i] = PPCRecompilerStats.compileTimeHistogram[i].load(std::memory_order_relaxed);
+	// exits
+	PPCRecompilerStats.exitLock.lock();
+	snapshot.exitSampleCount = PPCRecompilerStats.exitSampleCount;
+	snapshot.topExits.reserve(PPCRecompilerStats.exitSamples.size());
+	for (auto& it : PPCRecompilerStats.exitSamples)
+		snapshot.topExits.push_back({ it.first, it.second });
+	PPCRecompilerStats.exitLock.unlock();
+	std::sort(snapshot.topExits.begin(), snapshot.topExits.end(), [](const PPCRecompilerStatsExit& a, const PPCRecompilerStatsExit& b) { return a.sampleCount > b.sampleCount; });
+	if (snapshot.topExits.size() > maxEntries)
+		snapshot.topExits.resize(maxEntries);
+	// functions
+	PPCRecompilerStats.functionLock.lock();
+	snapshot.slowestFunctions.reserve(PPCRecompilerStats.functions.size());
+	for (auto& it : PPCRecompilerStats.functions)
+		snapshot.slowestFunctions.push_back(it.second);
+	PPCRecompilerStats.functionLock.unlock();
+	std::sort(snapshot.slowestFunctions.begin(), snapshot.slowestFunctions.end(), [](const PPCRecompilerStatsFunction& a, const PPCRecompilerStatsFunction& b) { return a.totalCompileTimeUs > b.totalCompileTimeUs; });
+	if (snapshot.slowestFunctions.size() > maxEntries)
+		snapshot.slowestFunctions.resize(maxEntries);
+	return snapshot;
+}
+
+void PPCRecompilerStats_reset()
+{
+	PPCRecompilerStats.functionsCompiled = 0;
+	PPCRecompilerStats.functionsFailed = 0;
+	PPCRecompilerStats.totalCompileTimeUs = 0;
+	PPCRecompilerStats.codeBytesAllocated = 0;
+	for (auto& bucket : PPCRecompilerStats.compileTimeHistogram)
+		bucket = 0;
+	g_ppcRecompilerStatsExitCounter = 0;
+	PPCRecompilerStats.functionLock.lock();
+	PPCRecompilerStats.functions.clear();
+	PPCRecompilerStats.functionLock.unlock();
+	PPCRecompilerStats.exitLock.lock();
+	PPCRecompilerStats.exitSamples.clear();
+	PPCRecompilerStats.exitSampleCount = 0;
+	PPCRecompilerStats.exitLock.unlock();
+}
+
+bool PPCRecompilerStats_dumpJSON(const fs::path& path)
+{
+	PPCRecompilerStatsSnapshot snapshot = PPCRecompilerStats_getSnapshot(256);
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+	writer.StartObject();
+	writer.Key("functionsCompiled");
+	writer.Uint64(snapshot.functionsCompiled);
+	writer.Key("functionsFailed");
+	writer.Uint64(snapshot.functionsFailed);
+	writer.Key("totalCompileTimeUs");
+	writer.Uint64(snapshot.totalCompileTimeUs);
+	writer.Key("codeBytesAllocated");
+	writer.Uint64(snapshot.codeBytesAllocated);
+	writer.Key("exitCount");
+	writer.Uint64(snapshot.exitCount);
+	writer.Key("exitSampleRate");
+	writer.Uint(PPC_REC_STATS_EXIT_SAMPLE_RATE);
+	writer.Key("exitSampleCount");
+	writer.Uint64(snapshot.exitSampleCount);
+	// histogram, upper bound of each bucket in microseconds
+	writer.Key("compileTimeHistogram");
+	writer.StartArray();
+	for (sint32 i = 0; i < PPC_REC_STATS_HISTOGRAM_BUCKETS; i++)
+	{
+		writer.StartObject();
+		writer.Key("maxUs");
+		if (i == PPC_REC_STATS_HISTOGRAM_BUCKETS - 1)
+			writer.Null();
+		else
+			writer.Uint64((1ull << i) - 1);
+		writer.Key("count");
+		writer.Uint(snapshot.compileTimeHistogram[i]);
+		writer.EndObject();
+	}
+	writer.EndArray();
+	writer.Key("topExits");
+	writer.StartArray();
+	for (auto& exit : snapshot.topExits)
+	{
+		writer.StartObject();
+		writer.Key("address");
+		writer.String(fmt::format("{:08x}", exit.address).c_str());
+		writer.Key("samples");
+		writer.Uint64(exit.sampleCount);
+		writer.EndObject();
+	}
+	writer.EndArray();
+	writer.Key("slowestFunctions");
+	writer.StartArray();
+	for (auto& func : snapshot.slowestFunctions)
+	{
+		writer.StartObject();
+		writer.Key("address");
+		writer.String(fmt::format("{:08x}", func.ppcAddress).c_str());
+		writer.Key("compileCount");
+		writer.Uint(func.compileCount);
+		writer.Key("totalCompileTimeUs");
+		writer.Uint64(func.totalCompileTimeUs);
+		writer.Key("maxCompileTimeUs");
+		writer.Uint64(func.maxCompileTimeUs);
+		writer.Key("codeSize");
+		writer.Uint(func.codeSize);
+		writer.EndObject();
+	}
+	writer.EndArray();
+	writer.EndObject();
+
+	std::error_code ec;
+	fs::create_directories(path.parent_path(), ec);
+	FileStream* file = FileStream::createFile2(path);
+	if (!file)
+		return false;
+	file->writeData(buffer.GetString(), (sint32)buffer.GetSize());
+	delete file;
+	return true;
+}
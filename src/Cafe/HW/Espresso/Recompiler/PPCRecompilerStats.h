@@ -0,0 +1,54 @@
+#pragma once
+
+// recompiler statistics
+// counters are always collected. Premature exits from recompiled code are only sampled (1 in PPC_REC_STATS_EXIT_SAMPLE_RATE) to keep the overhead on the exit path low
+
+#define PPC_REC_STATS_EXIT_SAMPLE_RATE		(16) // must be a power of two
+#define PPC_REC_STATS_MAX_EXIT_ADDRESSES	(4096) // sampled exit addresses beyond this are only counted in the totals
+#define PPC_REC_STATS_HISTOGRAM_BUCKETS		(16) // bucket n holds compile times of [2^(n-1), 2^n) microseconds, the last bucket holds everything above
+
+struct PPCRecompilerStatsFunction
+{
+	MPTR ppcAddress;
+	uint32 compileCount;
+	uint64 totalCompileTimeUs;
+	uint64 maxCompileTimeUs;
+	uint32 codeSize; // host code size of the most recent compilation
+};
+
+struct PPCRecompilerStatsExit
+{
+	MPTR address;
+	uint64 sampleCount;
+};
+
+struct PPCRecompilerStatsSnapshot
+{
+	uint64 functionsCompiled;
+	uint64 functionsFailed; // functions which could not be recompiled and stay in the interpreter
+	uint64 totalCompileTimeUs;
+	uint64 codeBytesAllocated; // host code currently allocated, including code that is waiting to be reclaimed
+	uint64 exitCount; // number of times recompiled code returned to the interpreter with cycles left
+	uint64 exitSampleCount;
+	uint32 compileTimeHistogram[PPC_REC_STATS_HISTOGRAM_BUCKETS];
+	std::vector<PPCRecompilerStatsExit> topExits; // sorted by sample count, descending
+	std::vector<PPCRecompilerStatsFunction> slowestFunctions; // sorted by total compile time, descending
+};
+
+void PPCRecompilerStats_recordCompile(MPTR ppcAddress, uint64 compileTimeUs, uint32 codeSize, bool success);
+void PPCRecompilerStats_recordCodeAllocation(uint32 size);
+void PPCRecompilerStats_recordCodeFree(uint32 size);
+void PPCRecompilerStats_recordExitSlow(MPTR address);
+
+extern std::atomic<uint64> g_ppcRecompilerStatsExitCounter;
+
+// called whenever recompiled code returns to the interpreter prematurely
+inline void PPCRecompilerStats_recordExit(MPTR address)
+{
+	if ((g_ppcRecompilerStatsExitCounter.fetch_add(1, std::memory_order_relaxed) & (PPC_REC_STATS_EXIT_SAMPLE_RATE - 1)) == 0)
+		PPCRecompilerStats_recordExitSlow(address);
+}
+
+PPCRecompilerStatsSnapshot PPCRecompilerStats_getSnapshot(size_t maxEntries);
+void PPCRecompilerStats_reset();
+bool PPCRecompilerStats_dumpJSON(const fs::path& path);
@@ -4,9 +4,13 @@
 #include "PPCRecompiler.h"
 #include "PPCRecompilerIml.h"
 #include "PPCRecompilerX64.h"
+#include "PPCRecompilerCodeHeap.h"
 #include "Cafe/OS/libs/coreinit/coreinit_Time.h"
 #include "util/MemMapper/MemMapper.h"
 #include "Common/cpu_features.h"
+#if BOOST_OS_WINDOWS
+#include <intrin.h> // _ReturnAddress
+#endif
 
 sint32 x64Gen_registerMap[12] = // virtual GPR to x64 register mapping
 {
@@ -30,6 +34,40 @@ void PPCRecompilerX64Gen_rememberRelocatableOffset(x64GenContext_t* x64GenContex
 	x64GenContext->relocateOffsetTableCount++;
 }
 
+/*
+* Jump to another function via the direct jump table
+* The jump is padded to 8 bytes and placed at an 8 byte aligned offset so that it can later be atomically patched into a direct JMP to the target function (see PPCRecompiler_linkBranchSite)
+*/
+void PPCRecompilerX64Gen_branchSite(x64GenContext_t* x64GenContext, uint32 newIP)
+{
+	// align so that the jump following MOV EDX, imm32 starts on an 8 byte boundary
+	x64Gen_nop(x64GenContext, (8 - ((x64GenContext->codeBufferIndex + 5) & 7)) & 7);
+	// remember new instruction pointer in RDX
+	x64Gen_mov_reg64Low32_imm32(x64GenContext, REG_RDX, newIP);
+	cemu_assert_debug((x64GenContext->codeBufferIndex & 7) == 0);
+	PPCRecompilerX64Gen_rememberRelocatableOffset(x64GenContext, X64_RELOC_BRANCH_SITE, (void*)(size_t)newIP);
+	// since RDX is constant we can use JMP [R15+const_offset] if jumpTableOffset+RDX*2 does not exceed the 2GB boundary
+	uint64 lookupOffset = (uint64)offsetof(PPCRecompilerInstanceData_t, ppcRecompilerDirectJumpTable) + (uint64)newIP * 2ULL;
+	if (lookupOffset >= 0x80000000ULL)
+	{
+		// JMP [offset+RDX*(8/4)+R15]
+		x64Gen_writeU8(x64GenContext, 0x41);
+		x64Gen_writeU8(x64GenContext, 0xFF);
+		x64Gen_writeU8(x64GenContext, 0xA4);
+		x64Gen_writeU8(x64GenContext, 0x57);
+		x64Gen_writeU32(x64GenContext, (uint32)offsetof(PPCRecompilerInstanceData_t, ppcRecompilerDirectJumpTable));
+	}
+	else
+	{
+		// JMP [R15+offset]
+		x64Gen_writeU8(x64GenContext, 0x41);
+		x64Gen_writeU8(x64GenContext, 0xFF);
+		x64Gen_writeU8(x64GenContext, 0xA7);
+		x64Gen_writeU32(x64GenContext, (uint32)lookupOffset);
+		x64Gen_nop(x64GenContext, 1);
+	}
+}
+
 /*
 * Overwrites the currently cached (in x64 cf) cr* register
 * Should be called before each x64 instruction which overwrites the current status flags (with mappedCRRegister set to PPCREC_CR_TEMPORARY unless explicitly set by PPC instruction)
@@ -106,7 +144,15 @@ void* ATTR_MS_ABI PPCRecompiler_virtualHLE(PPCInterpreter_t* hCPU, uint32 hleFun
 	{
 		auto hleCall = PPCInterpreter_getHLECall(hleFuncId);
 		cemu_assert(hleCall != nullptr);
+		// the HLE function may switch fibers, remember where it returns to so the code stays alive while the thread is parked
+#if BOOST_OS_WINDOWS
+		PPCRecompilerCodeHeapCallSite callSite{ _ReturnAddress(), hCPU->codeHeapCallSite };
+#else
+		PPCRecompilerCodeHeapCallSite callSite{ __builtin_return_address(0), hCPU->codeHeapCallSite };
+#endif
+		hCPU->codeHeapCallSite = &callSite;
 		hleCall(hCPU);
+		hCPU->codeHeapCallSite = callSite.prev;
 	}
 	hCPU->rspTemp = prevRSPTemp;
 	return PPCInterpreter_getCurrentInstance();
@@ -164,52 +210,12 @@ bool PPCRecompilerX64Gen_imlInstruction_macro(PPCRecFunction_t* PPCRecFunction,
 		// MOV DWORD [SPR_LinkRegister], newLR
 		uint32 newLR = imlInstruction->op_macro.param + 4;
 		x64Gen_mov_mem32Reg64_imm32(x64GenContext, REG_RSP, offsetof(PPCInterpreter_t, spr.LR), newLR);
-		// remember new instruction pointer in RDX
-		uint32 newIP = imlInstruction->op_macro.param2;
-		x64Gen_mov_reg64Low32_imm32(x64GenContext, REG_RDX, newIP);
-		// since RDX is constant we can use JMP [R15+const_offset] if jumpTableOffset+RDX*2 does not exceed the 2GB boundary
-		uint64 lookupOffset = (uint64)offsetof(PPCRecompilerInstanceData_t, ppcRecompilerDirectJumpTable) + (uint64)newIP * 2ULL;
-		if (lookupOffset >= 0x80000000ULL)
-		{
-			// JMP [offset+RDX*(8/4)+R15]
-			x64Gen_writeU8(x64GenContext, 0x41);
-			x64Gen_writeU8(x64GenContext, 0xFF);
-			x64Gen_writeU8(x64GenContext, 0xA4);
-			x64Gen_writeU8(x64GenContext, 0x57);
-			x64Gen_writeU32(x64GenContext, (uint32)offsetof(PPCRecompilerInstanceData_t, ppcRecompilerDirectJumpTable));
-		}
-		else
-		{
-			x64Gen_writeU8(x64GenContext, 0x41);
-			x64Gen_writeU8(x64GenContext, 0xFF);
-			x64Gen_writeU8(x64GenContext, 0xA7);
-			x64Gen_writeU32(x64GenContext, (uint32)lookupOffset);
-		}
+		PPCRecompilerX64Gen_branchSite(x64GenContext, imlInstruction->op_macro.param2);
 		return true;
 	}
 	else if( imlInstruction->operation == PPCREC_IML_MACRO_B_FAR )
 	{
-		// remember new instruction pointer in RDX
-		uint32 newIP = imlInstruction->op_macro.param2;
-		x64Gen_mov_reg64Low32_imm32(x64GenContext, REG_RDX, newIP);
-		// Since RDX is constant we can use JMP [R15+const_offset] if jumpTableOffset+RDX*2 does not exceed the 2GB boundary
-		uint64 lookupOffset = (uint64)offsetof(PPCRecompilerInstanceData_t, ppcRecompilerDirectJumpTable) + (uint64)newIP * 2ULL;
-		if (lookupOffset >= 0x80000000ULL)
-		{
-			// JMP [offset+RDX*(8/4)+R15]
-			x64Gen_writeU8(x64GenContext, 0x41);
-			x64Gen_writeU8(x64GenContext, 0xFF);
-			x64Gen_writeU8(x64GenContext, 0xA4);
-			x64Gen_writeU8(x64GenContext, 0x57);
-			x64Gen_writeU32(x64GenContext, (uint32)offsetof(PPCRecompilerInstanceData_t, ppcRecompilerDirectJumpTable));
-		}
-		else
-		{
-			x64Gen_writeU8(x64GenContext, 0x41);
-			x64Gen_writeU8(x64GenContext, 0xFF);
-			x64Gen_writeU8(x64GenContext, 0xA7);
-			x64Gen_writeU32(x64GenContext, (uint32)lookupOffset);
-		}
+		PPCRecompilerX64Gen_branchSite(x64GenContext, imlInstruction->op_macro.param2);
 		return true;
 	}
 	else if( imlInstruction->operation == PPCREC_IML_MACRO_LEAVE )
@@ -239,6 +245,13 @@ bool PPCRecompilerX64Gen_imlInstruction_macro(PPCRecFunction_t* PPCRecFunction,
 		x64Gen_sub_mem32reg64_imm32(x64GenContext, REG_RSP, offsetof(PPCInterpreter_t, remainingCycles), cycleCount);
 		return true;
 	}
+	else if( imlInstruction->operation == PPCREC_IML_MACRO_COUNT_TIER_UP )
+	{
+		// DEC DWORD [R15+offset]
+		uint32 counterIndex = imlInstruction->op_macro.param;
+		x64Gen_dec_mem32(x64GenContext, REG_RESV_RECDATA, (uint32)(offsetof(PPCRecompilerInstanceData_t, tierUpCounter) + counterIndex * sizeof(sint32)));
+		return true;
+	}
 	else if( imlInstruction->operation == PPCREC_IML_MACRO_HLE )
 	{
 		uint32 ppcAddress = imlInstruction->op_macro.param;
@@ -2260,31 +2273,10 @@ void PPCRecompilerX64Gen_imlInstruction_name_r(PPCRecFunction_t* PPCRecFunction,
 		assert_dbg();
 }
 
-uint8* codeMemoryBlock = nullptr;
-sint32 codeMemoryBlockIndex = 0;
-sint32 codeMemoryBlockSize = 0;
-
-std::mutex mtx_allocExecutableMemory;
-
-uint8* PPCRecompilerX86_allocateExecutableMemory(sint32 size)
+// returns the address the code is executed from. The code has to be written to writableMemory, which is a different view of the same memory if W^X dual mapping is used
+uint8* PPCRecompilerX86_allocateExecutableMemory(sint32 size, uint8*& writableMemory)
 {
-	std::lock_guard<std::mutex> lck(mtx_allocExecutableMemory);
-	if( codeMemoryBlockIndex+size > codeMemoryBlockSize )
-	{
-		// allocate new block
-		codeMemoryBlockSize = std::max(1024*1024*4, size+1024); // 4MB (or more if the function is larger than 4MB)
-		codeMemoryBlockIndex = 0;
-		codeMemoryBlock = (uint8*)MemMapper::AllocateMemory(nullptr, codeMemoryBlockSize, MemMapper::PAGE_PERMISSION::P_RWX);
-	}
-	uint8* codeMem = codeMemoryBlock + codeMemoryBlockIndex;
-	codeMemoryBlockIndex += size;
-	// pad to 4 byte alignment
-	while (codeMemoryBlockIndex & 3)
-	{
-		codeMemoryBlock[codeMemoryBlockIndex] = 0x90;
-		codeMemoryBlockIndex++;
-	}
-	return codeMem;
+	return PPCRecompilerCodeHeap_alloc((uint32)size, writableMemory);
 }
 
 void PPCRecompiler_dumpIML(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext);
@@ -2487,7 +2479,16 @@ bool PPCRecompiler_generateX64Code(PPCRecFunction_t* PPCRecFunction, ppcImlGenCo
 		return false;
 	}
 	// allocate executable memory
-	uint8* executableMemory = PPCRecompilerX86_allocateExecutableMemory(x64GenContext.codeBufferIndex);
+	uint8* writableMemory;
+	uint8* executableMemory = PPCRecompilerX86_allocateExecutableMemory(x64GenContext.codeBufferIndex, writableMemory);
+	if (!executableMemory)
+	{
+		// code cache is full
+		free(x64GenContext.codeBuffer);
+		if (x64GenContext.relocateOffsetTable)
+			free(x64GenContext.relocateOffsetTable);
+		return false;
+	}
 	size_t baseAddress = (size_t)executableMemory;
 	// fix relocs
 	for(sint32 i=0; i<x64GenContext.relocateOffsetTableCount; i++)
@@ -2514,7 +2515,11 @@ bool PPCRecompiler_generateX64Code(PPCRecFunction_t* PPCRecFunction, ppcImlGenCo
 				if (x64Offset == 0xFFFFFFFF)
 				{
 					debug_printf("Recompiler could not resolve jump (function at 0x%08x)\n", PPCRecFunction->ppcAddress);
-					// todo: Cleanup
+					PPCRecompilerCodeHeap_freeUnpublished(executableMemory);
+					free(x64GenContext.codeBuffer);
+					if (x64GenContext.relocateOffsetTable)
+						free(x64GenContext.relocateOffsetTable);
+					PPCRecFunction->list_branchSites.clear();
 					return false;
 				}
 			}
@@ -2555,6 +2560,16 @@ bool PPCRecompiler_generateX64Code(PPCRecFunction_t* PPCRecFunction, ppcImlGenCo
 			else
 				assert_dbg();
 		}
+		else if (x64GenContext.relocateOffsetTable[i].type == X64_RELOC_BRANCH_SITE)
+		{
+			// the jump is left untouched. It gets linked to the target function once both are active
+			ppcRecBranchSite_t branchSite{};
+			branchSite.x64Offset = x64GenContext.relocateOffsetTable[i].offset;
+			branchSite.ppcTarget = (uint32)(size_t)x64GenContext.relocateOffsetTable[i].extraInfo;
+			memcpy(&branchSite.unlinkedInstruction, x64GenContext.codeBuffer + branchSite.x64Offset, sizeof(uint64));
+			branchSite.isLinked = false;
+			PPCRecFunction->list_branchSites.emplace_back(branchSite);
+		}
 		else
 		{
 			assert_dbg();
@@ -2562,13 +2577,14 @@ bool PPCRecompiler_generateX64Code(PPCRecFunction_t* PPCRecFunction, ppcImlGenCo
 	}
 
 	// copy code to executable memory
-	memcpy(executableMemory, x64GenContext.codeBuffer, x64GenContext.codeBufferIndex);
+	memcpy(writableMemory, x64GenContext.codeBuffer, x64GenContext.codeBufferIndex);
 	free(x64GenContext.codeBuffer);
 	x64GenContext.codeBuffer = nullptr;
 	if (x64GenContext.relocateOffsetTable)
 		free(x64GenContext.relocateOffsetTable);
 	// set code
 	PPCRecFunction->x86Code = executableMemory;
+	PPCRecFunction->x86CodeWritable = writableMemory;
 	PPCRecFunction->x86Size = x64GenContext.codeBufferIndex;
 	return true;
 }
@@ -2645,9 +2661,11 @@ void PPCRecompilerX64Gen_generateEnterRecompilerCode()
 	// RET
 	x64Gen_ret(&x64GenContext);
 
-	uint8* executableMemory = PPCRecompilerX86_allocateExecutableMemory(x64GenContext.codeBufferIndex);
+	uint8* writableMemory;
+	uint8* executableMemory = PPCRecompilerX86_allocateExecutableMemory(x64GenContext.codeBufferIndex, writableMemory);
+	cemu_assert(executableMemory);
 	// copy code to executable memory
-	memcpy(executableMemory, x64GenContext.codeBuffer, x64GenContext.codeBufferIndex);
+	memcpy(writableMemory, x64GenContext.codeBuffer, x64GenContext.codeBufferIndex);
 	free(x64GenContext.codeBuffer);
 	PPCRecompiler_enterRecompilerCode = (void ATTR_MS_ABI (*)(uint64,uint64))executableMemory;
 }
@@ -2671,9 +2689,11 @@ void* PPCRecompilerX64Gen_generateLeaveRecompilerCode()
 	// RET
 	x64Gen_ret(&x64GenContext);
 
-	uint8* executableMemory = PPCRecompilerX86_allocateExecutableMemory(x64GenContext.codeBufferIndex);
+	uint8* writableMemory;
+	uint8* executableMemory = PPCRecompilerX86_allocateExecutableMemory(x64GenContext.codeBufferIndex, writableMemory);
+	cemu_assert(executableMemory);
 	// copy code to executable memory
-	memcpy(executableMemory, x64GenContext.codeBuffer, x64GenContext.codeBufferIndex);
+	memcpy(writableMemory, x64GenContext.codeBuffer, x64GenContext.codeBufferIndex);
 	free(x64GenContext.codeBuffer);
 	return executableMemory;
 }
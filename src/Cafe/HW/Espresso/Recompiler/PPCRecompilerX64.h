@@ -127,12 +127,14 @@ enum
 #define X86_RELOC_MAKE_RELATIVE				(0)		// make code imm relative to instruction
 #define X64_RELOC_LINK_TO_PPC				(1)		// translate from ppc address to x86 offset 
 #define X64_RELOC_LINK_TO_SEGMENT			(2)		// link to beginning of segment
+#define X64_RELOC_BRANCH_SITE				(3)		// patchable jump to another function (extraInfo is the ppc target address)
 
 #define PPC_X64_GPR_USABLE_REGISTERS		(16-4)
 #define PPC_X64_FPR_USABLE_REGISTERS		(16-1) // Use XMM0 - XMM14, XMM15 is the temp register
 
 
 bool PPCRecompiler_generateX64Code(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext);
+uint8* PPCRecompilerX86_allocateExecutableMemory(sint32 size, uint8*& writableMemory);
 
 void PPCRecompilerX64Gen_crConditionFlags_forget(PPCRecFunction_t* PPCRecFunction, ppcImlGenContext_t* ppcImlGenContext, x64GenContext_t* x64GenContext);
 
@@ -154,6 +156,7 @@ void PPCRecompilerX64Gen_imlInstruction_fpr_r(PPCRecFunction_t* PPCRecFunction,
 void x64Gen_writeU8(x64GenContext_t* x64GenContext, uint8 v);
 void x64Gen_writeU16(x64GenContext_t* x64GenContext, uint32 v);
 void x64Gen_writeU32(x64GenContext_t* x64GenContext, uint32 v);
+void x64Gen_nop(x64GenContext_t* x64GenContext, sint32 size);
 
 void x64Emit_mov_reg32_mem32(x64GenContext_t* x64GenContext, sint32 destReg, sint32 memBaseReg64, sint32 memOffset);
 void x64Emit_mov_mem32_reg32(x64GenContext_t* x64GenContext, sint32 memBaseReg64, sint32 memOffset, sint32 srcReg);
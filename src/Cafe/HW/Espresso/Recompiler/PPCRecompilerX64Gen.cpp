@@ -901,8 +901,16 @@ void x64Gen_dec_mem32(x64GenContext_t* x64GenContext, sint32 memoryRegister, uin
 	// DEC dword [<reg64>+imm]
 	sint32 memoryImmS32 = (sint32)memoryImmU32;
 	if (memoryRegister != REG_RSP)
-		assert_dbg(); // not supported yet
-	if (memoryImmS32 >= -128 && memoryImmS32 <= 127)
+	{
+		if ((memoryRegister & 7) == 4)
+			assert_dbg(); // R12 requires SIB byte, not supported yet
+		if (memoryRegister >= 8)
+			x64Gen_writeU8(x64GenContext, 0x41);
+		x64Gen_writeU8(x64GenContext, 0xFF);
+		x64Gen_writeU8(x64GenContext, 0x88 | (memoryRegister & 7));
+		x64Gen_writeU32(x64GenContext, memoryImmU32);
+	}
+	else if (memoryImmS32 >= -128 && memoryImmS32 <= 127)
 	{
 		x64Gen_writeU8(x64GenContext, 0xFF);
 		x64Gen_writeU8(x64GenContext, 0x4C);
@@ -1883,3 +1891,25 @@ void x64Gen_int3(x64GenContext_t* x64GenContext)
 {
 	x64Gen_writeU8(x64GenContext, 0xCC);
 }
+
+void x64Gen_nop(x64GenContext_t* x64GenContext, sint32 size)
+{
+	// recommended multi-byte NOP sequences
+	static const uint8 nopTable[8][8] = {
+		{ 0x90 },
+		{ 0x66, 0x90 },
+		{ 0x0F, 0x1F, 0x00 },
+		{ 0x0F, 0x1F, 0x40, 0x00 },
+		{ 0x0F, 0x1F, 0x44, 0x00, 0x00 },
+		{ 0x66, 0x0F, 0x1F, 0x44, 0x00, 0x00 },
+		{ 0x0F, 0x1F, 0x80, 0x00, 0x00, 0x00, 0x00 },
+		{ 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+	};
+	while (size > 0)
+	{
+		sint32 chunkSize = std::min(size, 8);
+		for (sint32 i = 0; i < chunkSize; i++)
+			x64Gen_writeU8(x64GenContext, nopTable[chunkSize - 1][i]);
+		size -= chunkSize;
+	}
+}
@@ -1,7 +1,10 @@
+#include "Cafe/HW/Latte/Core/LatteBufferCache.h"
+#include "Cafe/HW/Latte/Core/LatteHash.h"
 #include "Cafe/HW/Latte/Renderer/Renderer.h"
 #include "util/ChunkedHeap/ChunkedHeap.h"
 #include "util/helpers/fspinlock.h"
 #include "config/ActiveSettings.h"
+#include "Cafe/GameProfile/GameProfile.h"
 
 #define CACHE_PAGE_SIZE		0x400
 #define CACHE_PAGE_SIZE_M1	(CACHE_PAGE_SIZE-1)
@@ -269,6 +272,9 @@ std::unique_ptr<VHeap> g_gpuBufferHeap = nullptr;
 std::vector<uint8> s_pageUploadBuffer;
 std::vector<class BufferCacheNode*> s_allCacheNodes;
 
+LatteBufferCacheSyncStats s_syncStats{};
+LatteBufferCacheSyncStats s_syncStatsLastFrame{};
+
 void LatteBufferCache_removeSingleNodeFromTree(BufferCacheNode* node);
 
 class BufferCacheNode
@@ -356,10 +362,49 @@ public:
 		uint8* pagePtr = memory_getPointerFromPhysicalOffset(rangeBegin);
 		sint32 uploadPageBegin = -1;
 		CachePageInfo* pageInfo = m_pageInfo.data() + basePageIndex;
+		// with write tracking, host pages which were not written since they were last armed don't need to be hashed
+		// arming is skipped while the OS writes into guest memory (e.g. file reads), in that case we only hash
+		bool useWriteTracking = memory_writeTrackingIsEnabled() && memory_writeTrackingTryLockArm();
+		uint32 hostPageSize = useWriteTracking ? memory_writeTrackingGetPageSize() : 0;
+		sint32 cachePagesPerHostPage = hostPageSize / CACHE_PAGE_SIZE;
 		for (sint32 i = 0; i < numPages; i++)
 		{
+			if (useWriteTracking && (((rangeBegin + i * CACHE_PAGE_SIZE) & (hostPageSize - 1)) == 0) && (i + cachePagesPerHostPage) <= numPages)
+			{
+				uint32 cleanGeneration = memory_writeTrackingGetCleanGeneration(pagePtr);
+				bool canTrack = true;
+				bool isUnmodified = cleanGeneration != 0;
+				for (sint32 f = 0; f < cachePagesPerHostPage; f++)
+				{
+					canTrack = canTrack && !pageInfo[f].hasStreamoutData;
+					isUnmodified = isUnmodified && pageInfo[f].writeTrackingGeneration == cleanGeneration;
+				}
+				if (canTrack && isUnmodified)
+				{
+					if (uploadPageBegin != -1)
+					{
+						if (uploadData)
+							uploadPages(uploadPageBegin, basePageIndex + i);
+						uploadPageBegin = -1;
+					}
+					s_syncStats.bytesSkipped += hostPageSize;
+					i += cachePagesPerHostPage - 1;
+					pagePtr += hostPageSize;
+					pageInfo += cachePagesPerHostPage;
+					continue;
+				}
+				if (canTrack)
+				{
+					// arm before hashing. Any write which happens after the hash was calculated will flag the page as dirty
+					uint32 generation = memory_writeTrackingArm(pagePtr);
+					for (sint32 f = 0; f < cachePagesPerHostPage; f++)
+						pageInfo[f].writeTrackingGeneration = generation;
+				}
+			}
+			s_syncStats.bytesHashed += CACHE_PAGE_SIZE;
 			if (pageInfo->hasStreamoutData)
 			{
+				pageInfo->writeTrackingGeneration = 0;
 				// first upload any pending sequence of pages
 				if (uploadPageBegin != -1)
 				{
@@ -408,6 +453,8 @@ public:
 			if (uploadData)
 				uploadPages(uploadPageBegin, basePageIndex + numPages);
 		}
+		if (useWriteTracking)
+			memory_writeTrackingUnlockArm();
 	}
 
 	void checkAndSyncModifications(bool uploadData)
@@ -517,6 +564,7 @@ private:
 	{
 		uint64 hash{ 0 };
 		bool hasStreamoutData{ false };
+		uint32 writeTrackingGeneration{ 0 }; // generation of the host page when the hash was last updated, zero if not tracked
 	};
 
 	MPTR m_rangeBegin;
@@ -600,6 +648,7 @@ private:
 		checkAndSyncModifications(rangeBegin, rangeEnd, false);
 
 		g_renderer->bufferCache_upload(memory_getPointerFromPhysicalOffset(rangeBegin), rangeEnd - rangeBegin, getBufferOffset(rangeBegin));
+		s_syncStats.bytesUploaded += rangeEnd - rangeBegin;
 	}
 
 	void syncFromNode(BufferCacheNode* srcNode)
@@ -638,6 +687,7 @@ private:
 			m_pageInfo[firstPage + i].hash = hashPage(s_pageUploadBuffer.data() + i * CACHE_PAGE_SIZE);
 		}
 		g_renderer->bufferCache_upload(s_pageUploadBuffer.data(), uploadRangeEnd - uploadRangeBegin, getBufferOffset(uploadRangeBegin));
+		s_syncStats.bytesUploaded += uploadRangeEnd - uploadRangeBegin;
 	}
 
 	// upload only non-streamout data of a single page
@@ -697,34 +747,7 @@ private:
 
 	static uint64 hashPage(uint8* mem)
 	{
-		static const uint64 k0 = 0x55F23EAD;
-		static const uint64 k1 = 0x185FDC6D;
-		static const uint64 k2 = 0xF7431F49;
-		static const uint64 k3 = 0xA4C7AE9D;
-
-		cemu_assert_debug((CACHE_PAGE_SIZE % 32) == 0);
-		const uint64* ptr = (const uint64*)mem;
-		const uint64* end = ptr + (CACHE_PAGE_SIZE / sizeof(uint64));
-
-		uint64 h0 = 0;
-		uint64 h1 = 0;
-		uint64 h2 = 0;
-		uint64 h3 = 0;
-		while (ptr < end)
-		{
-			h0 = std::rotr(h0, 7);
-			h1 = std::rotr(h1, 7);
-			h2 = std::rotr(h2, 7);
-			h3 = std::rotr(h3, 7);
-
-			h0 += ptr[0] * k0;
-			h1 += ptr[1] * k1;
-			h2 += ptr[2] * k2;
-			h3 += ptr[3] * k3;
-			ptr += 4;
-		}
-
-		return h0 + h1 + h2 + h3;
+		return LatteHash_Compute(mem, CACHE_PAGE_SIZE);
 	}
 
 	// flag page as having streamout data, also write streamout signatures to page memory
@@ -743,6 +766,7 @@ private:
 		
 		auto pageInfo = m_pageInfo.data() + pageIndex;
 		pageInfo->hasStreamoutData = true;
+		pageInfo->writeTrackingGeneration = 0;
 
 		// if the whole page is replaced we can use a cached hash
 		if (pageRangeBegin == rangeBegin && pageRangeEnd == rangeEnd)
@@ -989,11 +1013,16 @@ void LatteBufferCache_init(size_t bufferSize)
     cemu_assert_debug(g_gpuBufferCache.empty());
 	g_gpuBufferHeap.reset(new VHeap(nullptr, (uint32)bufferSize));
 	g_renderer->bufferCache_init((uint32)bufferSize);
+	s_syncStats = {};
+	s_syncStatsLastFrame = {};
+	if (g_current_game_profile->GetBufferCacheWriteTracking())
+		memory_writeTrackingEnable();
 }
 
 void LatteBufferCache_UnloadAll()
 {
     BufferCacheNode::UnloadAll();
+	memory_writeTrackingDisable();
 }
 
 void LatteBufferCache_getStats(uint32& heapSize, uint32& allocationSize, uint32& allocNum)
@@ -1001,6 +1030,11 @@ void LatteBufferCache_getStats(uint32& heapSize, uint32& allocationSize, uint32&
 	g_gpuBufferHeap->getStats(heapSize, allocationSize, allocNum);
 }
 
+void LatteBufferCache_getSyncStats(LatteBufferCacheSyncStats& stats)
+{
+	stats = s_syncStatsLastFrame;
+}
+
 FSpinlock g_spinlockDCFlushQueue;
 
 class SparseBitset
@@ -1094,6 +1128,8 @@ void LatteBufferCache_notifyDrawDone()
 
 void LatteBufferCache_notifySwapTVScanBuffer()
 {
+	s_syncStatsLastFrame = s_syncStats;
+	s_syncStats = {};
 	if( ActiveSettings::FlushGPUCacheOnSwap() )
 		g_currentCacheChronon++;
 }
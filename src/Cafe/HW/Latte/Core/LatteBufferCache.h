@@ -15,4 +15,13 @@ void LatteBufferCache_incrementalCleanup();
 
 void LatteBufferCache_getStats(uint32& heapSize, uint32& allocationSize, uint32& allocNum);
 
+struct LatteBufferCacheSyncStats
+{
+	uint64 bytesHashed;
+	uint64 bytesSkipped; // unmodified according to write tracking
+	uint64 bytesUploaded;
+};
+
+void LatteBufferCache_getSyncStats(LatteBufferCacheSyncStats& stats); // totals of the previous frame
+
 void LatteBufferCache_notifySwapTVScanBuffer();
\ No newline at end of file
@@ -0,0 +1,257 @@
+#include "Cafe/HW/Latte/Core/LatteHash.h"
+#include "Common/cpu_features.h"
+
+#define LATTE_HASH_STRIPES_PER_BLOCK	(16)
+
+#define LATTE_HASH_PRIME32_1	(0x9E3779B1u)
+#define LATTE_HASH_PRIME32_2	(0x85EBCA77u)
+#define LATTE_HASH_PRIME32_3	(0xC2B2AE3Du)
+#define LATTE_HASH_PRIME64_1	(0x9E3779B185EBCA87ull)
+#define LATTE_HASH_PRIME64_2	(0xC2B2AE3D27D4EB4Full)
+#define LATTE_HASH_PRIME64_3	(0x165667B19E3779F9ull)
+#define LATTE_HASH_PRIME64_4	(0x85EBCA77C2B2AE63ull)
+#define LATTE_HASH_PRIME64_5	(0x27D4EB2F165667C5ull)
+
+// the keys of stripe n within a block start at s_latteHashSecret[n], so that reordered stripes result in a different hash
+static constexpr uint32 LATTE_HASH_SECRET_COUNT = LATTE_HASH_STRIPES_PER_BLOCK - 1 + 8;
+
+template<size_t TCount>
+static constexpr std::array<uint64, TCount> _LatteHash_generateKeys(uint64 seed)
+{
+	std::array<uint64, TCount> keys{};
+	for (auto& it : keys)
+	{
+		// splitmix64
+		seed += 0x9E3779B97F4A7C15ull;
+		uint64 z = seed;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		it = z ^ (z >> 31);
+	}
+	return keys;
+}
+
+alignas(64) static constexpr std::array<uint64, LATTE_HASH_SECRET_COUNT> s_latteHashSecret = _LatteHash_generateKeys<LATTE_HASH_SECRET_COUNT>(0x4C61747465486173ull);
+alignas(64) static constexpr std::array<uint64, 8> s_latteHashScrambleKey = _LatteHash_generateKeys<8>(0x536372616D626C65ull);
+
+struct LatteHashState
+{
+	alignas(64) uint64 acc[8]{ LATTE_HASH_PRIME32_3, LATTE_HASH_PRIME64_1, LATTE_HASH_PRIME64_2, LATTE_HASH_PRIME64_3, LATTE_HASH_PRIME64_4, LATTE_HASH_PRIME32_2, LATTE_HASH_PRIME64_5, LATTE_HASH_PRIME32_1 };
+	uint32 blockPos{ 0 };
+};
+
+// process stripeCount stripes, each stripe starts stride bytes after the previous one
+using LatteHashAccumulateFunc = void(*)(LatteHashState& state, const uint8* data, uint32 stripeCount, uint32 stride);
+
+[[maybe_unused]] static void _LatteHash_accumulateGeneric(LatteHashState& state, const uint8* data, uint32 stripeCount, uint32 stride)
+{
+	uint64* acc = state.acc;
+	while (stripeCount--)
+	{
+		const uint64* key = s_latteHashSecret.data() + state.blockPos;
+		for (uint32 i = 0; i < 8; i++)
+		{
+			uint64 d;
+			memcpy(&d, data + i * 8, sizeof(uint64));
+			uint64 dk = d ^ key[i];
+			acc[i ^ 1] += d;
+			acc[i] += (uint64)(uint32)dk * (dk >> 32);
+		}
+		data += stride;
+		if (++state.blockPos == LATTE_HASH_STRIPES_PER_BLOCK)
+		{
+			for (uint32 i = 0; i < 8; i++)
+			{
+				acc[i] ^= acc[i] >> 47;
+				acc[i] ^= s_latteHashScrambleKey[i];
+				acc[i] *= LATTE_HASH_PRIME32_1;
+			}
+			state.blockPos = 0;
+		}
+	}
+}
+
+#if defined(ARCH_X86_64)
+// SSE2 is part of the x86-64 baseline and is always available
+static void _LatteHash_accumulateSSE2(LatteHashState& state, const uint8* data, uint32 stripeCount, uint32 stride)
+{
+	__m128i acc[4];
+	for (uint32 i = 0; i < 4; i++)
+		acc[i] = _mm_load_si128((const __m128i*)state.acc + i);
+	const __m128i prime32 = _mm_set1_epi32((sint32)LATTE_HASH_PRIME32_1);
+	while (stripeCount--)
+	{
+		const __m128i* key = (const __m128i*)(s_latteHashSecret.data() + state.blockPos);
+		for (uint32 i = 0; i < 4; i++)
+		{
+			__m128i d = _mm_loadu_si128((const __m128i*)data + i);
+			__m128i dk = _mm_xor_si128(d, _mm_loadu_si128(key + i));
+			__m128i dkHi = _mm_shuffle_epi32(dk, _MM_SHUFFLE(0, 3, 0, 1));
+			acc[i] = _mm_add_epi64(acc[i], _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2)));
+			acc[i] = _mm_add_epi64(acc[i], _mm_mul_epu32(dk, dkHi));
+		}
+		data += stride;
+		if (++state.blockPos == LATTE_HASH_STRIPES_PER_BLOCK)
+		{
+			for (uint32 i = 0; i < 4; i++)
+			{
+				__m128i a = _mm_xor_si128(acc[i], _mm_srli_epi64(acc[i], 47));
+				a = _mm_xor_si128(a, _mm_load_si128((const __m128i*)s_latteHashScrambleKey.data() + i));
+				__m128i lo = _mm_mul_epu32(a, prime32);
+				__m128i hi = _mm_mul_epu32(_mm_srli_epi64(a, 32), prime32);
+				acc[i] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+			}
+			state.blockPos = 0;
+		}
+	}
+	for (uint32 i = 0; i < 4; i++)
+		_mm_store_si128((__m128i*)state.acc + i, acc[i]);
+}
+
+ATTRIBUTE_AVX2
+static void _LatteHash_accumulateAVX2(LatteHashState& state, const uint8* data, uint32 stripeCount, uint32 stride)
+{
+	__m256i acc[2];
+	for (uint32 i = 0; i < 2; i++)
+		acc[i] = _mm256_load_si256((const __m256i*)state.acc + i);
+	const __m256i prime32 = _mm256_set1_epi32((sint32)LATTE_HASH_PRIME32_1);
+	while (stripeCount--)
+	{
+		const __m256i* key = (const __m256i*)(s_latteHashSecret.data() + state.blockPos);
+		for (uint32 i = 0; i < 2; i++)
+		{
+			__m256i d = _mm256_loadu_si256((const __m256i*)data + i);
+			__m256i dk = _mm256_xor_si256(d, _mm256_loadu_si256(key + i));
+			__m256i dkHi = _mm256_shuffle_epi32(dk, _MM_SHUFFLE(0, 3, 0, 1));
+			acc[i] = _mm256_add_epi64(acc[i], _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2)));
+			acc[i] = _mm256_add_epi64(acc[i], _mm256_mul_epu32(dk, dkHi));
+		}
+		data += stride;
+		if (++state.blockPos == LATTE_HASH_STRIPES_PER_BLOCK)
+		{
+			for (uint32 i = 0; i < 2; i++)
+			{
+				__m256i a = _mm256_xor_si256(acc[i], _mm256_srli_epi64(acc[i], 47));
+				a = _mm256_xor_si256(a, _mm256_load_si256((const __m256i*)s_latteHashScrambleKey.data() + i));
+				__m256i lo = _mm256_mul_epu32(a, prime32);
+				__m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), prime32);
+				acc[i] = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+			}
+			state.blockPos = 0;
+		}
+	}
+	for (uint32 i = 0; i < 2; i++)
+		_mm256_store_si256((__m256i*)state.acc + i, acc[i]);
+}
+
+ATTRIBUTE_AVX512
+static void _LatteHash_accumulateAVX512(LatteHashState& state, const uint8* data, uint32 stripeCount, uint32 stride)
+{
+	__m512i acc = _mm512_load_si512(state.acc);
+	const __m512i prime32 = _mm512_set1_epi32((sint32)LATTE_HASH_PRIME32_1);
+	while (stripeCount--)
+	{
+		__m512i d = _mm512_loadu_si512(data);
+		__m512i dk = _mm512_xor_si512(d, _mm512_loadu_si512(s_latteHashSecret.data() + state.blockPos));
+		__m512i dkHi = _mm512_shuffle_epi32(dk, (_MM_PERM_ENUM)_MM_SHUFFLE(0, 3, 0, 1));
+		acc = _mm512_add_epi64(acc, _mm512_shuffle_epi32(d, (_MM_PERM_ENUM)_MM_SHUFFLE(1, 0, 3, 2)));
+		acc = _mm512_add_epi64(acc, _mm512_mul_epu32(dk, dkHi));
+		data += stride;
+		if (++state.blockPos == LATTE_HASH_STRIPES_PER_BLOCK)
+		{
+			__m512i a = _mm512_xor_si512(acc, _mm512_srli_epi64(acc, 47));
+			a = _mm512_xor_si512(a, _mm512_load_si512(s_latteHashScrambleKey.data()));
+			__m512i lo = _mm512_mul_epu32(a, prime32);
+			__m512i hi = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), prime32);
+			acc = _mm512_add_epi64(lo, _mm512_slli_epi64(hi, 32));
+			state.blockPos = 0;
+		}
+	}
+	_mm512_store_si512(state.acc, acc);
+}
+#endif
+
+static LatteHashAccumulateFunc _LatteHash_getAccumulateFunc()
+{
+#if defined(ARCH_X86_64)
+	if (g_CPUFeatures.x86.avx512f)
+		return _LatteHash_accumulateAVX512;
+	if (g_CPUFeatures.x86.avx2)
+		return _LatteHash_accumulateAVX2;
+	return _LatteHash_accumulateSSE2;
+#else
+	return _LatteHash_accumulateGeneric;
+#endif
+}
+
+const char* LatteHash_GetImplementationName()
+{
+	LatteHashAccumulateFunc func = _LatteHash_getAccumulateFunc();
+#if defined(ARCH_X86_64)
+	if (func == _LatteHash_accumulateAVX512)
+		return "AVX-512";
+	if (func == _LatteHash_accumulateAVX2)
+		return "AVX2";
+	if (func == _LatteHash_accumulateSSE2)
+		return "SSE2";
+#endif
+	return "Generic";
+}
+
+static uint64 _LatteHash_finalize(const LatteHashState& state, uint32 size)
+{
+	uint64 h = (uint64)size * LATTE_HASH_PRIME64_1;
+	for (uint32 i = 0; i < 8; i++)
+		h = std::rotl(h ^ (state.acc[i] * LATTE_HASH_PRIME64_2), 27) * LATTE_HASH_PRIME64_1 + LATTE_HASH_PRIME64_4;
+	h ^= h >> 33;
+	h *= LATTE_HASH_PRIME64_2;
+	h ^= h >> 29;
+	h *= LATTE_HASH_PRIME64_3;
+	h ^= h >> 32;
+	return h;
+}
+
+uint64 LatteHash_Compute(const void* data, uint32 size)
+{
+	LatteHashAccumulateFunc accumulate = _LatteHash_getAccumulateFunc();
+	LatteHashState state;
+	uint32 stripeCount = size / LATTE_HASH_STRIPE_SIZE;
+	accumulate(state, (const uint8*)data, stripeCount, LATTE_HASH_STRIPE_SIZE);
+	uint32 remainingSize = size % LATTE_HASH_STRIPE_SIZE;
+	if (remainingSize != 0)
+	{
+		// trailing bytes are padded with zeros
+		uint8 lastStripe[LATTE_HASH_STRIPE_SIZE]{};
+		memcpy(lastStripe, (const uint8*)data + stripeCount * LATTE_HASH_STRIPE_SIZE, remainingSize);
+		accumulate(state, lastStripe, 1, LATTE_HASH_STRIPE_SIZE);
+	}
+	return _LatteHash_finalize(state, size);
+}
+
+uint64 LatteHash_ComputeSampled(const void* data, uint32 size, uint32 stride)
+{
+	cemu_assert_debug(stride != 0 && (stride % LATTE_HASH_STRIPE_SIZE) == 0);
+	LatteHashState state;
+	if (size >= LATTE_HASH_STRIPE_SIZE)
+	{
+		uint32 stripeCount = (size - LATTE_HASH_STRIPE_SIZE) / stride + 1;
+		_LatteHash_getAccumulateFunc()(state, (const uint8*)data, stripeCount, stride);
+	}
+	return _LatteHash_finalize(state, size);
+}
+
+void LatteHash_ComputeShaderHash(const uint32* programCode, uint32 programSize, uint64& outputHash1, uint64& outputHash2)
+{
+	// this algorithm could be more efficient since we could leverage the fact that the size is always aligned to 8 byte
+	// but it is serial by design and changing it would invalidate existing shader caches and graphic packs
+	outputHash1 = 0;
+	outputHash2 = 0;
+	for (uint32 i = 0; i < programSize / 4; i++)
+	{
+		uint32 temp = programCode[i];
+		outputHash1 += (uint64)temp;
+		outputHash2 ^= (uint64)temp;
+		outputHash1 = (outputHash1 << 3) | (outputHash1 >> 61);
+		outputHash2 = (outputHash2 >> 7) | (outputHash2 << 57);
+	}
+}
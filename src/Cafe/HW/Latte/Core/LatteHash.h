@@ -0,0 +1,17 @@
+#pragma once
+
+// content hashing used for change detection of guest memory (buffer cache pages, textures)
+// data is processed in 64 byte stripes which are accumulated into 8 independent 64bit lanes. Every 16 stripes the lanes get scrambled
+// all implementations (generic, SSE2, AVX2, AVX-512) produce identical hashes, the fastest one supported by the CPU is used
+
+#define LATTE_HASH_STRIPE_SIZE	(64)
+
+uint64 LatteHash_Compute(const void* data, uint32 size);
+// hashes only one stripe every stride bytes. Stride must be a multiple of LATTE_HASH_STRIPE_SIZE. A trailing partial stripe is ignored
+uint64 LatteHash_ComputeSampled(const void* data, uint32 size, uint32 stride);
+
+// hash of shader programs. Part of the names of cached shaders and graphic pack shaders, the algorithm must never change
+void LatteHash_ComputeShaderHash(const uint32* programCode, uint32 programSize, uint64& outputHash1, uint64& outputHash2);
+
+// for testing, returns the name of the implementation which is used
+const char* LatteHash_GetImplementationName();
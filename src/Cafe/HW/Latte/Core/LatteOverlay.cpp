@@ -13,6 +13,8 @@
 
 #include "input/InputManager.h"
 #include "util/SystemInfo/SystemInfo.h"
+#include "Cafe/IOSU/fsa/iosu_fsa.h"
+#include "Cafe/HW/Latte/Core/LatteBufferCache.h"
 
 #include <cinttypes>
 
@@ -111,6 +113,12 @@ void LatteOverlay_renderOverlay(ImVec2& position, ImVec2& pivot, sint32 directio
 				// general debug info
 				ImGui::Text("--- Debug info ---");
 				ImGui::Text("IndexUploadPerFrame: %dKB", (performanceMonitor.stats.indexDataUploadPerFrame+1023)/1024);
+				iosu::fsa::FSAStatistics fsaStats = iosu::fsa::GetStatistics();
+				ImGui::Text("FSA queue: %u (max %u)", fsaStats.queueDepth, fsaStats.maxQueueDepth);
+				ImGui::Text("FSA read-ahead: %" PRIu64 " hits %" PRIu64 " misses %" PRIu64 " MB read ahead", fsaStats.readAheadHits, fsaStats.readAheadMisses, fsaStats.readAheadBytes / 1024 / 1024);
+				LatteBufferCacheSyncStats bufferCacheSyncStats;
+				LatteBufferCache_getSyncStats(bufferCacheSyncStats);
+				ImGui::Text("Buffer sync/f: hashed %uKB skipped %uKB uploaded %uKB", (uint32)(bufferCacheSyncStats.bytesHashed / 1024), (uint32)(bufferCacheSyncStats.bytesSkipped / 1024), (uint32)(bufferCacheSyncStats.bytesUploaded / 1024));
 				// backend specific info
 				g_renderer->AppendOverlayDebugInfo();
 			}
@@ -5,6 +5,7 @@
 #include "Cafe/HW/Latte/Core/LatteShader.h"
 #include "Cafe/HW/Latte/LegacyShaderDecompiler/LatteDecompiler.h"
 #include "Cafe/HW/Latte/Core/FetchShader.h"
+#include "Cafe/HW/Latte/Core/LatteHash.h"
 #include "Cafe/HW/Latte/Core/LattePerformanceMonitor.h"
 #include "Cafe/HW/Latte/Renderer/Vulkan/VulkanRenderer.h"
 #include "Cafe/OS/libs/gx2/GX2.h" // todo - remove dependency
@@ -82,23 +83,6 @@ inline ska::flat_hash_map<uint64, LatteDecompilerShader*>& LatteSHRC_GetCacheByT
 	return sPixelShaders;
 }
 
-// calculate hash from shader binary
-// this algorithm could be more efficient since we could leverage the fact that the size is always aligned to 8 byte
-// but since this is baked into the shader names used for gfx packs and shader caches we can't really change this
-void _calcShaderHashGeneric(uint32* programCode, uint32 programSize, uint64& outputHash1, uint64& outputHash2)
-{
-	outputHash1 = 0;
-	outputHash2 = 0;
-	for (uint32 i = 0; i < programSize / 4; i++)
-	{
-		uint32 temp = programCode[i];
-		outputHash1 += (uint64)temp;
-		outputHash2 ^= (uint64)temp;
-		outputHash1 = (outputHash1 << 3) | (outputHash1 >> 61);
-		outputHash2 = (outputHash2 >> 7) | (outputHash2 << 57);
-	}
-}
-
 void _calculateShaderProgramHash(uint32* programCode, uint32 programSize, _ShaderHashCache* hashCache, uint64* outputHash1, uint64* outputHash2)
 {
 	uint64 progHash1 = 0;
@@ -112,7 +96,7 @@ void _calculateShaderProgramHash(uint32* programCode, uint32 programSize, _Shade
 	}
 	else if (hashCache->prevProgramCode != programCode || hashCache->prevProgramSize != programSize)
 	{
-		_calcShaderHashGeneric(programCode, programSize, progHash1, progHash2);
+		LatteHash_ComputeShaderHash(programCode, programSize, progHash1, progHash2);
 		hashCache->prevProgramCode = programCode;
 		hashCache->prevProgramSize = programSize;
 		hashCache->prevHash1 = progHash1;
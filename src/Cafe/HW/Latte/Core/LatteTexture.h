@@ -333,6 +333,8 @@ float* LatteTexture_getEffectiveTextureScale(LatteConst::ShaderType shaderType,
 LatteTextureView* LatteTexture_CreateTexture(Latte::E_DIM dim, MPTR physAddress, MPTR physMipAddress, Latte::E_GX2SURFFMT format, uint32 width, uint32 height, uint32 depth, uint32 pitch, uint32 mipLevels, uint32 swizzle, Latte::E_HWTILEMODE tileMode, bool isDepth);
 void LatteTexture_Delete(LatteTexture* texture);
 
+void LatteTextureLoader_init();
+void LatteTextureLoader_shutdown();
 void LatteTextureLoader_writeReadbackTextureToMemory(LatteTextureDefinition* textureData, uint32 sliceIndex, uint32 mipIndex, uint8* linearPixelData);
 
 sint32 LatteTexture_getEffectiveWidth(LatteTexture* texture);
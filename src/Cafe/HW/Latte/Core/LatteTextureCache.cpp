@@ -2,7 +2,7 @@
 #include "Cafe/HW/Latte/Core/LatteDraw.h"
 #include "Cafe/HW/Latte/Core/LatteTexture.h"
 #include "Cafe/HW/Latte/Renderer/Renderer.h"
-#include "Common/cpu_features.h"
+#include "Cafe/HW/Latte/Core/LatteHash.h"
 
 std::unordered_set<LatteTexture*> g_allTextures;
 
@@ -21,24 +21,6 @@ void LatteTC_UnregisterTexture(LatteTexture* tex)
 	g_allTextures.erase(tex);
 }
 
-// sample few uint64s uniformly over memory range
-uint32 _quickStochasticHash(void* texData, uint32 memRange)
-{
-	uint64* texDataU64 = (uint64*)texData;
-
-	uint64 hashVal = 0;
-	memRange /= sizeof(uint64);
-
-	uint32 memStep = memRange / 37; // use prime here to avoid memStep aligning nicely with pitch of texture, leading to sampling only along the border of a texture
-	for (sint32 i = 0; i < 37; i++)
-	{
-		hashVal += *texDataU64;
-		hashVal = (hashVal << 3) | (hashVal >> 61);
-		texDataU64 += memStep;
-	}
-	return (uint32)hashVal ^ (uint32)(hashVal >> 32);
-}
-
 uint32 LatteTexture_CalculateTextureDataHash(LatteTexture* hostTexture)
 {
 	if( hostTexture->texDataPtrHigh == hostTexture->texDataPtrLow )
@@ -64,136 +46,35 @@ uint32 LatteTexture_CalculateTextureDataHash(LatteTexture* hostTexture)
 	}
 
 	uint32 memRange = hostTexture->texDataPtrHigh - hostTexture->texDataPtrLow;
-	uint32* texDataU32 = (uint32*)memory_getPointerFromPhysicalOffset(hostTexture->texDataPtrLow);
-	uint32 hashVal = 0;
+	uint8* texData = memory_getPointerFromPhysicalOffset(hostTexture->texDataPtrLow);
 	uint32 pixelCount = hostTexture->width*hostTexture->height;
 
+	// larger textures are only partially hashed. Each sample is a full cache line, sampling with a smaller stride would not reduce the amount of memory that is read
+	uint32 sampleStride = 0; // zero means every byte is hashed
 	bool isCompressedFormat = hostTexture->IsCompressedFormat();
 	if (isCompressedFormat || hostTexture->useLightHash)
 	{
-		// check only 32 samples of the texture
-		if (memRange < 256)
-		{
-			memRange /= sizeof(uint32);
-			while (memRange--)
-			{
-				hashVal += *texDataU32;
-				hashVal = (hashVal << 3) | (hashVal >> 29);
-				texDataU32++;
-			}
-		}
-		else
-		{
-			hashVal = _quickStochasticHash(texDataU32, memRange);
-		}
-		return hashVal;
-	}
-
-
-	if( pixelCount <= (700*700) )
-	{
-		// small texture size
-		bool isCompressedFormat = hostTexture->IsCompressedFormat();
-		if( isCompressedFormat == false || memRange < 0x200 )
-		{
-			memRange /= (4*sizeof(uint32));
-			while( memRange-- )
-			{
-				hashVal += *texDataU32;
-				hashVal = (hashVal<<3)|(hashVal>>29);
-				texDataU32 += 4;
-			}
-		}
-		else
-		{
-			memRange /= (32*sizeof(uint32));
-			while( memRange-- )
-			{
-				hashVal += *texDataU32;
-				hashVal = (hashVal<<3)|(hashVal>>29);
-				texDataU32 += 32;
-			}
-		}
+		// check only a few samples spread uniformly over the texture
+		// divide by a prime to avoid the stride aligning nicely with pitch of texture, leading to sampling only along the border of a texture
+		if (memRange >= 256)
+			sampleStride = std::max<uint32>(memRange / 37, LATTE_HASH_STRIPE_SIZE) & ~(LATTE_HASH_STRIPE_SIZE - 1);
 	}
 	else if( pixelCount <= (1200*1200) )
 	{
-		// medium texture size
-		bool isCompressedFormat = hostTexture->IsCompressedFormat();
-		if( isCompressedFormat == false )
-		{
-			memRange /= (12*sizeof(uint32));
-			while( memRange-- )
-			{
-				hashVal += *texDataU32;
-				hashVal = (hashVal<<3)|(hashVal>>29);
-				texDataU32 += 12;
-			}
-		}
-		else
-		{
-			memRange /= (96*sizeof(uint32));
-			while( memRange-- )
-			{
-				hashVal += *texDataU32;
-				hashVal = (hashVal<<3)|(hashVal>>29);
-				texDataU32 += 96;
-			}
-		}
+		// small and medium texture size
+		sampleStride = 0;
 	}
 	else
 	{
 		// huge texture size
-		bool isCompressedFormat = hostTexture->IsCompressedFormat();
-		if( isCompressedFormat == false )
-		{
-#if BOOST_OS_WINDOWS
-			if (g_CPUFeatures.x86.avx2)
-			{
-				__m256i h256 = { 0 };
-				__m256i* readPtr = (__m256i*)texDataU32;
-				memRange /= (288);
-				while (memRange--)
-				{
-					__m256i temp = _mm256_load_si256(readPtr);
-					readPtr += (288 / 32);
-					h256 = _mm256_xor_si256(h256, temp);
-				}
-#ifdef __clang__
-				hashVal = h256[0] + h256[1] + h256[2] + h256[3] + h256[4] + h256[5] + h256[6] + h256[7];
-#else
-				hashVal = h256.m256i_u32[0] + h256.m256i_u32[1] + h256.m256i_u32[2] + h256.m256i_u32[3] + h256.m256i_u32[4] + h256.m256i_u32[5] + h256.m256i_u32[6] + h256.m256i_u32[7];
-#endif
-			}
-#else
-			if( false ) {}
-#endif
-			else
-			{
-				memRange /= (32 * sizeof(uint64));
-				uint64 h64 = 0;
-				uint64* texDataU64 = (uint64*)texDataU32;
-				while (memRange--)
-				{
-					h64 += *texDataU64;
-					h64 = (h64 << 3) | (h64 >> 61);
-					texDataU64 += 32;
-				}
-				hashVal = (h64 & 0xFFFFFFFF) + (h64 >> 32);
-			}
-		}
-		else
-		{
-			memRange /= (512*sizeof(uint32));
-			while( memRange-- )
-			{
-				hashVal += *texDataU32;
-				hashVal = (hashVal<<3)|(hashVal>>29);
-				texDataU32 += 512;
-			}
-		}
+		sampleStride = 256;
 	}
-
-	return hashVal;
+	uint64 h64;
+	if (sampleStride == 0)
+		h64 = LatteHash_Compute(texData, memRange);
+	else
+		h64 = LatteHash_ComputeSampled(texData, memRange, sampleStride);
+	return (uint32)h64 ^ (uint32)(h64 >> 32);
 }
 
 uint64 _botwLargeTexHax = 0;
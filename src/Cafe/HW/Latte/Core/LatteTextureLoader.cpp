@@ -2,10 +2,13 @@
 #include "Cafe/HW/Latte/LatteAddrLib/LatteAddrLib.h"
 #include "config/ActiveSettings.h"
 #include "Cafe/CafeSystem.h"
+#include "util/helpers/helpers.h"
 
 //#define BENCHMARK_TEXTURE_DECODING		// if defined, time it takes to decode textures will be measured and logged to log.txt
 
 #ifdef BENCHMARK_TEXTURE_DECODING
+#include "util/highresolutiontimer/HighResolutionTimer.h"
+
 uint64 textureDecodeBenchmark_perFormatSum[0x40] = { 0 }; // duration sum per texture format (hw format) - in microseconds
 uint64 textureDecodeBenchmark_totalSum = 0;
 #endif
@@ -63,10 +66,8 @@ void LatteTextureLoader_begin(LatteTextureLoaderCtx* textureLoader, uint32 slice
 	// correct handling for LINEAR_ALIGNED pitch alignment is still not fully understood:
 	//seems like sometimes there is a conditional pitch alignment to 0x40 OR there is no pitch alignment at all and we have a bug somewhere else
 
-	uint64 titleId = CafeSystem::GetForegroundTitleId();
-	titleId &= ~0x300ULL;
-
-	if (tileMode == Latte::E_HWTILEMODE::TM_LINEAR_ALIGNED && titleId == (0x000500301001200aULL))
+	// the title id is only needed for linear surfaces and is not set when decoding outside of a running title (e.g. the benchmark tool)
+	if (tileMode == Latte::E_HWTILEMODE::TM_LINEAR_ALIGNED && CafeSystem::IsTitleRunning() && (CafeSystem::GetForegroundTitleId() & ~0x300ULL) == 0x000500301001200aULL)
 	{
 		// examples of titles that use linear textures:
 		// Minecraft - Uses sprite atlases with mips and linear tilemode. Expects padding of pitch for smaller mips to be 0x40
@@ -80,6 +81,8 @@ void LatteTextureLoader_begin(LatteTextureLoaderCtx* textureLoader, uint32 slice
 	textureLoader->width = std::max(textureLoader->width, 1);
 	textureLoader->height = height >> (mipIndex);
 	textureLoader->height = std::max(textureLoader->height, 1);
+	textureLoader->decodeBeginY = 0;
+	textureLoader->decodeEndY = textureLoader->height;
 
 	textureLoader->pitch = surfaceInfo.pitch;
 	// calculate start address
@@ -599,6 +602,122 @@ void LatteTextureLoader_loadTextureDataIntoSlice(LatteTexture* hostTexture, sint
 	}
 }
 
+// large textures are split into horizontal bands which are decoded in parallel by a pool of worker threads
+// the GPU thread decodes bands too and only continues once all bands are done
+#define TEXTURE_DECODE_MAX_WORKERS		(4)
+#define TEXTURE_DECODE_BANDS_PER_THREAD	(2) // more bands than threads to even out differences in decode speed
+
+struct
+{
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable workCond;
+	std::condition_variable doneCond;
+	bool exit{false};
+	uint32 parallelThreshold{}; // in bytes of decoded data, 0 means disabled
+	// current job. Only the GPU thread submits jobs
+	TextureDecoder* decoder{};
+	LatteTextureLoaderCtx* ctx{};
+	uint8* outputData{};
+	sint32 bandHeight{};
+	sint32 bandCount{};
+	sint32 nextBand{};
+	sint32 activeThreads{};
+}s_textureDecodePool;
+
+void LatteTextureLoader_decodeBand(sint32 bandIndex)
+{
+	// every band gets its own copy of the context since the decoders are allowed to modify it
+	LatteTextureLoaderCtx bandCtx = *s_textureDecodePool.ctx;
+	bandCtx.decodeBeginY = bandIndex * s_textureDecodePool.bandHeight;
+	bandCtx.decodeEndY = std::min(bandCtx.decodeBeginY + s_textureDecodePool.bandHeight, bandCtx.height);
+	s_textureDecodePool.decoder->decode(&bandCtx, s_textureDecodePool.outputData);
+}
+
+void LatteTextureLoader_decodeWorkerThread(sint32 workerIndex)
+{
+	SetThreadName(fmt::format("TexDecode-{}", workerIndex).c_str());
+	std::unique_lock _l(s_textureDecodePool.mutex);
+	while (true)
+	{
+		s_textureDecodePool.workCond.wait(_l, [] { return s_textureDecodePool.exit || s_textureDecodePool.nextBand < s_textureDecodePool.bandCount; });
+		if (s_textureDecodePool.exit)
+			break;
+		sint32 bandIndex = s_textureDecodePool.nextBand++;
+		s_textureDecodePool.activeThreads++;
+		_l.unlock();
+		LatteTextureLoader_decodeBand(bandIndex);
+		_l.lock();
+		s_textureDecodePool.activeThreads--;
+		if (s_textureDecodePool.activeThreads == 0 && s_textureDecodePool.nextBand >= s_textureDecodePool.bandCount)
+			s_textureDecodePool.doneCond.notify_one();
+	}
+}
+
+void LatteTextureLoader_init()
+{
+	cemu_assert_debug(s_textureDecodePool.workers.empty());
+	s_textureDecodePool.parallelThreshold = ActiveSettings::GetTextureDecodeParallelThreshold() * 1024;
+	if (s_textureDecodePool.parallelThreshold == 0)
+		return;
+	// leave room for the emulated cores and the GPU thread
+	sint32 workerCount = std::clamp<sint32>((sint32)std::thread::hardware_concurrency() - 4, 1, TEXTURE_DECODE_MAX_WORKERS);
+	s_textureDecodePool.exit = false;
+	for (sint32 i = 0; i < workerCount; i++)
+		s_textureDecodePool.workers.emplace_back(LatteTextureLoader_decodeWorkerThread, i);
+}
+
+void LatteTextureLoader_shutdown()
+{
+	s_textureDecodePool.mutex.lock();
+	s_textureDecodePool.exit = true;
+	s_textureDecodePool.mutex.unlock();
+	s_textureDecodePool.workCond.notify_all();
+	for (auto& it : s_textureDecodePool.workers)
+		it.join();
+	s_textureDecodePool.workers.clear();
+}
+
+void LatteTextureLoader_decode(TextureDecoder* texDecoder, LatteTextureLoaderCtx* textureLoader, uint8* pixelData, uint32 imageSize)
+{
+	if (s_textureDecodePool.workers.empty() || imageSize < s_textureDecodePool.parallelThreshold)
+	{
+		texDecoder->decode(textureLoader, pixelData);
+		return;
+	}
+	// bands start at multiples of 8 texel rows so they never share a micro tile or a compressed block
+	sint32 threadCount = (sint32)s_textureDecodePool.workers.size() + 1;
+	sint32 bandAlignment = 8 * textureLoader->stepY;
+	sint32 bandHeight = (textureLoader->height + threadCount * TEXTURE_DECODE_BANDS_PER_THREAD - 1) / (threadCount * TEXTURE_DECODE_BANDS_PER_THREAD);
+	bandHeight = (bandHeight + bandAlignment - 1) / bandAlignment * bandAlignment;
+	sint32 bandCount = (textureLoader->height + bandHeight - 1) / bandHeight;
+	if (bandCount <= 1)
+	{
+		texDecoder->decode(textureLoader, pixelData);
+		return;
+	}
+	std::unique_lock _l(s_textureDecodePool.mutex);
+	s_textureDecodePool.decoder = texDecoder;
+	s_textureDecodePool.ctx = textureLoader;
+	s_textureDecodePool.outputData = pixelData;
+	s_textureDecodePool.bandHeight = bandHeight;
+	s_textureDecodePool.bandCount = bandCount;
+	s_textureDecodePool.nextBand = 0;
+	s_textureDecodePool.workCond.notify_all();
+	while (s_textureDecodePool.nextBand < s_textureDecodePool.bandCount)
+	{
+		sint32 bandIndex = s_textureDecodePool.nextBand++;
+		s_textureDecodePool.activeThreads++;
+		_l.unlock();
+		LatteTextureLoader_decodeBand(bandIndex);
+		_l.lock();
+		s_textureDecodePool.activeThreads--;
+	}
+	s_textureDecodePool.doneCond.wait(_l, [] { return s_textureDecodePool.activeThreads == 0; });
+	s_textureDecodePool.bandCount = 0;
+	s_textureDecodePool.ctx = nullptr;
+}
+
 void LatteTextureLoader_UpdateTextureSliceData(LatteTexture* tex, uint32 sliceIndex, uint32 mipIndex, MPTR physImagePtr, MPTR physMipPtr, Latte::E_DIM dim, uint32 width, uint32 height, uint32 depth, uint32 mipLevels, uint32 pitch, Latte::E_HWTILEMODE tileMode, uint32 swizzle, bool dumpTex)
 {
 	LatteTextureLoaderCtx textureLoader = { 0 };
@@ -646,22 +765,19 @@ void LatteTextureLoader_UpdateTextureSliceData(LatteTexture* tex, uint32 sliceIn
 	uint8* pixelData = (uint8*)g_renderer->texture_acquireTextureUploadBuffer(imageSize);
 	// decode texture (if data is required)
 #ifdef BENCHMARK_TEXTURE_DECODING
-	LARGE_INTEGER benchmark_begin;
-	LARGE_INTEGER benchmark_end;
-	LARGE_INTEGER benchmark_freq;
-	QueryPerformanceCounter(&benchmark_begin);
+	BenchmarkTimer benchmarkTimer;
+	benchmarkTimer.Start();
 #endif
 	if (tex->overwriteInfo.hasFormatOverwrite == false && tex->overwriteInfo.hasResolutionOverwrite == false)
 	{
-		texDecoder->decode(&textureLoader, pixelData);
+		LatteTextureLoader_decode(texDecoder, &textureLoader, pixelData, imageSize);
 	}
 #ifdef BENCHMARK_TEXTURE_DECODING
-	QueryPerformanceCounter(&benchmark_end);
-	QueryPerformanceFrequency(&benchmark_freq);
-	uint64 benchmarkResultMicroSeconds = (benchmark_end.QuadPart - benchmark_begin.QuadPart) * 1000000ULL / benchmark_freq.QuadPart;
+	benchmarkTimer.Stop();
+	uint64 benchmarkResultMicroSeconds = (uint64)(benchmarkTimer.GetElapsedMilliseconds() * 1000.0);
 	textureDecodeBenchmark_perFormatSum[(int)tex->format & 0x3F] += benchmarkResultMicroSeconds;
 	textureDecodeBenchmark_totalSum += benchmarkResultMicroSeconds;
-	cemuLog_log(LogType::Force, "TexDecode {:04}x{:04}x{:04} Fmt {:04x} Dim {} TileMode {:02x} Took {:03}.{:03}ms Sum(format) {:06}ms Sum(total) {:06}ms", textureLoader.width, textureLoader.height, textureLoader.surfaceInfoDepth, (int)tex->format, (int)tex->dim, textureLoader.tileMode, (uint32)(benchmarkResultMicroSeconds / 1000ULL), (uint32)(benchmarkResultMicroSeconds % 1000ULL), (uint32)(textureDecodeBenchmark_perFormatSum[tex->gx2Format & 0x3F] / 1000ULL), (uint32)(textureDecodeBenchmark_totalSum / 1000ULL));
+	cemuLog_log(LogType::Force, "TexDecode {:04}x{:04}x{:04} Fmt {:04x} Dim {} TileMode {:02x} Took {:03}.{:03}ms Sum(format) {:06}ms Sum(total) {:06}ms", textureLoader.width, textureLoader.height, textureLoader.surfaceInfoDepth, (int)tex->format, (int)tex->dim, textureLoader.tileMode, (uint32)(benchmarkResultMicroSeconds / 1000ULL), (uint32)(benchmarkResultMicroSeconds % 1000ULL), (uint32)(textureDecodeBenchmark_perFormatSum[(int)tex->format & 0x3F] / 1000ULL), (uint32)(textureDecodeBenchmark_totalSum / 1000ULL));
 #endif
 
 	// convert texture to RGBA when dumping is enabled
@@ -19,6 +19,9 @@ struct LatteTextureLoaderCtx
 	Latte::E_HWTILEMODE tileMode;
 	uint32 bpp;
 	uint8* inputData;
+	// range of pixel rows written by decode(), large textures are split into bands which are decoded in parallel
+	sint32 decodeBeginY;
+	sint32 decodeEndY;
 	sint32 minOffsetOutdated;
 	sint32 maxOffsetOutdated;
 	// calculated info
@@ -36,9 +39,35 @@ struct LatteTextureLoaderCtx
 	uint8* dumpRGBA;
 };
 
+void LatteTextureLoader_begin(LatteTextureLoaderCtx* textureLoader, uint32 sliceIndex, uint32 mipIndex, MPTR physImagePtr, MPTR physMipPtr, Latte::E_GX2SURFFMT format, Latte::E_DIM dim, uint32 width, uint32 height, uint32 depth, uint32 mipLevels, uint32 pitch, Latte::E_HWTILEMODE tileMode, uint32 swizzle);
 uint8* LatteTextureLoader_GetInput(LatteTextureLoaderCtx* textureLoader, sint32 x, sint32 y);
 
 #include "Cafe/HW/Latte/LatteAddrLib/AddrLibFastDecode.h"
+#include "Cafe/HW/Latte/Core/LatteTextureLoaderSIMD.h"
+
+// decode packed 8bit or 16bit texels to RGBA8
+// linear surfaces are expanded directly from the input rows. Otherwise the texels are first detiled into the second half of each output row and then expanded in place
+template<typename texelType>
+void LatteTextureLoader_decodeExpandToRGBA8(LatteTextureLoaderCtx* textureLoader, uint8* outputData, const LatteTextureExpandFormat& format)
+{
+	static_assert(sizeof(texelType) == 1 || sizeof(texelType) == 2);
+	sint32 rowSize = textureLoader->width * 4;
+	if (textureLoader->tileMode == Latte::E_HWTILEMODE::TM_LINEAR_GENERAL || textureLoader->tileMode == Latte::E_HWTILEMODE::TM_LINEAR_ALIGNED)
+	{
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y++)
+			LatteTextureLoader_expandToRGBA8(LatteTextureLoader_GetInput(textureLoader, 0, y), sizeof(texelType), outputData + y * rowSize, textureLoader->width, format);
+		return;
+	}
+	sint32 texelOffset = textureLoader->width * (4 - sizeof(texelType));
+	LatteTextureLoaderCtx rowCtx = *textureLoader;
+	rowCtx.decodedTexelCountX = rowSize / sizeof(texelType);
+	optimizedDecodeLoops<texelType, 1, false, false>(&rowCtx, outputData + texelOffset);
+	for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y++)
+	{
+		uint8* rowOutput = outputData + y * rowSize;
+		LatteTextureLoader_expandToRGBA8(rowOutput + texelOffset, sizeof(texelType), rowOutput, textureLoader->width, format);
+	}
+}
 
 void decodeBC1Block(uint8* inputData, float* output4x4RGBA);
 void decodeBC2Block_UNORM(uint8* inputData, float* imageRGBA);
@@ -398,7 +427,7 @@ public:
 		// note - before 1.15.4 this format was implemented as big-endian
 		//optimizedDecodeLoops<uint64, 2, false>(textureLoader, outputData);
 
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			sint32 yc = y;
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
@@ -436,7 +465,7 @@ public:
 		// note - before 1.15.4 this format was implemented as big-endian
 		//optimizedDecodeLoops<uint64, 1, false>(textureLoader, outputData);
 
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			sint32 yc = y;
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
@@ -494,7 +523,7 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			sint32 yc = y;
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
@@ -521,7 +550,7 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			sint32 yc = y;
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
@@ -566,7 +595,7 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			sint32 yc = y;
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
@@ -604,7 +633,7 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			sint32 yc = y;
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
@@ -642,27 +671,9 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
-		{
-			sint32 yc = y;
-			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
-			{
-				uint8* blockData = LatteTextureLoader_GetInput(textureLoader, x, y);
-				sint32 pixelOffset = (x + yc * textureLoader->width) * 4;
-				uint8 v0 = (*(uint8*)(blockData + 0));
-
-				uint8 red4 = (v0 >> 4) & 0xF;
-				uint8 green4 = (v0 & 0xF);
-
-				red4 = (red4 << 4) | red4;
-				green4 = (green4 << 4) | green4;
-
-				*(uint8*)(outputData + pixelOffset + 0) = red4;
-				*(uint8*)(outputData + pixelOffset + 1) = green4;
-				*(uint8*)(outputData + pixelOffset + 2) = 0;
-				*(uint8*)(outputData + pixelOffset + 3) = 255;
-			}
-		}
+		// nibbles are replicated to 8 bit, blue is zero and alpha is 255
+		static constexpr LatteTextureExpandFormat expandFormat{ { { 4, 0xF, 17, 0, 0 }, { 0, 0xF, 17, 0, 0 }, { 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 255 } } };
+		LatteTextureLoader_decodeExpandToRGBA8<uint8>(textureLoader, outputData, expandFormat);
 	}
 
 	void decodePixelToRGBA(uint8* blockData, uint8* outputPixel, uint8 blockOffsetX, uint8 blockOffsetY) override
@@ -689,7 +700,7 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			sint32 yc = y;
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
@@ -734,32 +745,9 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
-		{
-			sint32 yc = y;
-			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
-			{
-				uint8* blockData = LatteTextureLoader_GetInput(textureLoader, x, y);
-				sint32 pixelOffset = (x + yc * textureLoader->width) * 4;
-				uint8 v0 = (*(uint8*)(blockData + 0));
-				uint8 v1 = (*(uint8*)(blockData + 1));
-
-				uint8 red4 = (v0 & 0xF);
-				uint8 green4 = (v0 >> 4) & 0xF;
-				uint8 blue4 = (v1) & 0xF;
-				uint8 alpha4 = (v1 >> 4) & 0xF;
-
-				red4 = (red4 << 4) | red4;
-				green4 = (green4 << 4) | green4;
-				blue4 = (blue4 << 4) | blue4;
-				alpha4 = (alpha4 << 4) | alpha4;
-
-				*(uint8*)(outputData + pixelOffset + 0) = red4;
-				*(uint8*)(outputData + pixelOffset + 1) = green4;
-				*(uint8*)(outputData + pixelOffset + 2) = blue4;
-				*(uint8*)(outputData + pixelOffset + 3) = alpha4;
-			}
-		}
+		// nibbles are replicated to 8 bit
+		static constexpr LatteTextureExpandFormat expandFormat{ { { 0, 0xF, 17, 0, 0 }, { 4, 0xF, 17, 0, 0 }, { 8, 0xF, 17, 0, 0 }, { 12, 0xF, 17, 0, 0 } } };
+		LatteTextureLoader_decodeExpandToRGBA8<uint16>(textureLoader, outputData, expandFormat);
 	}
 
 	void decodePixelToRGBA(uint8* blockData, uint8* outputPixel, uint8 blockOffsetX, uint8 blockOffsetY) override
@@ -840,7 +828,9 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		memset(outputData, 0, sizeof(uint32) * getTexelCountX(textureLoader) * getTexelCountY(textureLoader));
+		sint32 texelBeginY = textureLoader->decodeBeginY / textureLoader->stepY;
+		sint32 texelEndY = (textureLoader->decodeEndY + textureLoader->stepY - 1) / textureLoader->stepY;
+		memset(outputData + sizeof(uint32) * getTexelCountX(textureLoader) * texelBeginY, 0, sizeof(uint32) * getTexelCountX(textureLoader) * (texelEndY - texelBeginY));
 	}
 
 	void decodePixelToRGBA(uint8* blockData, uint8* outputPixel, uint8 blockOffsetX, uint8 blockOffsetY) override
@@ -858,7 +848,9 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		memset(outputData, 0, sizeof(uint64) * getTexelCountX(textureLoader) * getTexelCountY(textureLoader));
+		sint32 texelBeginY = textureLoader->decodeBeginY / textureLoader->stepY;
+		sint32 texelEndY = (textureLoader->decodeEndY + textureLoader->stepY - 1) / textureLoader->stepY;
+		memset(outputData + sizeof(uint64) * getTexelCountX(textureLoader) * texelBeginY, 0, sizeof(uint64) * getTexelCountX(textureLoader) * (texelEndY - texelBeginY));
 	}
 
 	void decodePixelToRGBA(uint8* blockData, uint8* outputPixel, uint8 blockOffsetX, uint8 blockOffsetY) override
@@ -1039,7 +1031,7 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			sint32 yc = y;
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
@@ -1095,29 +1087,9 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
-		{
-			sint32 yc = y;
-			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
-			{
-				uint8* blockData = LatteTextureLoader_GetInput(textureLoader, x, y);
-				sint32 pixelOffset = (x + yc * textureLoader->width) * 4;
-				uint16 v0 = (*(uint16*)(blockData + 0));
-
-				uint8 c0 = (v0 & 0x1F);
-				uint8 c1 = (v0 >> 5) & 0x3F;
-				uint8 c2 = (v0 >> 11) & 0x1F;
-
-				c0 = (c0 << 3) | c0 >> 3;// blue
-				c1 = (c1 << 2) | c1 >> 4;// green
-				c2 = (c2 << 3) | c2 >> 3;// red
-
-				*(uint8*)(outputData + pixelOffset + 0) = c0;// blue
-				*(uint8*)(outputData + pixelOffset + 1) = c1;// green
-				*(uint8*)(outputData + pixelOffset + 2) = c2;// red
-				*(uint8*)(outputData + pixelOffset + 3) = 255;//alpha
-			}
-		}
+		// output order is blue, green, red, alpha
+		static constexpr LatteTextureExpandFormat expandFormat{ { { 0, 0x1F, 65, 3, 0 }, { 5, 0x3F, 65, 4, 0 }, { 11, 0x1F, 65, 3, 0 }, { 0, 0, 0, 0, 255 } } };
+		LatteTextureLoader_decodeExpandToRGBA8<uint16>(textureLoader, outputData, expandFormat);
 	}
 
 	void decodePixelToRGBA(uint8* blockData, uint8* outputPixel, uint8 blockOffsetX, uint8 blockOffsetY) override
@@ -1214,30 +1186,9 @@ public:
 
     void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
     {
-        for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
-        {
-            sint32 yc = y;
-            for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
-            {
-                uint16* blockData = (uint16*)LatteTextureLoader_GetInput(textureLoader, x, y);
-                sint32 pixelOffset = (x + yc * textureLoader->width) * 4;
-                uint32 colorData = (*(uint16*)(blockData + 0));
-                // swap order of components
-                uint8 red = (colorData >> 0) & 0x1F;
-                uint8 green = (colorData >> 5) & 0x1F;
-                uint8 blue = (colorData >> 10) & 0x1F;
-                uint8 alpha = (colorData >> 15) & 0x1;
-
-                red = red << 3 | red >> 2;
-                green = green << 3 | green >> 2;
-                blue = blue << 3 | blue >> 2;
-                alpha = alpha * 0xff;
-
-                // MSB...LSB : ABGR
-                colorData = (alpha << 24) | (blue << 16) | (green << 8) | red;
-                *(uint32*)(outputData + pixelOffset + 0) = colorData;
-            }
-        }
+        // red is stored in the lowest bits
+        static constexpr LatteTextureExpandFormat expandFormat{ { { 0, 0x1F, 33, 2, 0 }, { 5, 0x1F, 33, 2, 0 }, { 10, 0x1F, 33, 2, 0 }, { 15, 0x1, 255, 0, 0 } } };
+        LatteTextureLoader_decodeExpandToRGBA8<uint16>(textureLoader, outputData, expandFormat);
     }
 
     void decodePixelToRGBA(uint8* blockData, uint8* outputPixel, uint8 blockOffsetX, uint8 blockOffsetY) override
@@ -1335,7 +1286,7 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			sint32 yc = y;
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
@@ -1378,30 +1329,9 @@ public:
 
     void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
     {
-        for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
-        {
-            sint32 yc = y;
-            for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
-            {
-                uint16* blockData = (uint16*)LatteTextureLoader_GetInput(textureLoader, x, y);
-                sint32 pixelOffset = (x + yc * textureLoader->width) * 4;
-                uint32 colorData = (*(uint16*)(blockData + 0));
-                // swap order of components
-                uint8 red = (colorData >> 11) & 0x1F;
-                uint8 green = (colorData >> 6) & 0x1F;
-                uint8 blue = (colorData >> 1) & 0x1F;
-                uint8 alpha = (colorData >> 0) & 0x1;
-
-                red = red << 3 | red >> 2;
-                green = green << 3 | green >> 2;
-                blue = blue << 3 | blue >> 2;
-                alpha = alpha * 0xff;
-
-                // MSB...LSB ABGR
-                colorData = red | (green << 8) | (blue << 16) | (alpha << 24);
-                *(uint32*)(outputData + pixelOffset + 0) = colorData;
-            }
-        }
+        // alpha is stored in the lowest bit
+        static constexpr LatteTextureExpandFormat expandFormat{ { { 11, 0x1F, 33, 2, 0 }, { 6, 0x1F, 33, 2, 0 }, { 1, 0x1F, 33, 2, 0 }, { 0, 0x1, 255, 0, 0 } } };
+        LatteTextureLoader_decodeExpandToRGBA8<uint16>(textureLoader, outputData, expandFormat);
     }
 
     void decodePixelToRGBA(uint8* blockData, uint8* outputPixel, uint8 blockOffsetX, uint8 blockOffsetY) override
@@ -1456,7 +1386,7 @@ public:
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
 		// todo - implement
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			sint32 yc = y;
 			sint32 pixelOffset = (yc * textureLoader->width) * (2 * 4);
@@ -1501,7 +1431,7 @@ public:
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
 		// todo - implement
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			sint32 yc = y;
 			sint32 pixelOffset = (yc * textureLoader->width) * (2 * 4);
@@ -1564,32 +1494,14 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
 			{
 				uint8* blockData = LatteTextureLoader_GetInput(textureLoader, x, y);
 				sint32 blockSizeX = (std::min)(4, textureLoader->width - x);
 				sint32 blockSizeY = (std::min)(4, textureLoader->height - y);
-				// decode 4x4 pixels at once
-				float rgbaBlock[4 * 4 * 4];
-				decodeBC1Block(blockData, rgbaBlock);
-				for (sint32 py = 0; py < blockSizeY; py++)
-				{
-					sint32 yc = y + py;
-					for (sint32 px = 0; px < blockSizeX; px++)
-					{
-						sint32 pixelOffset = (x + px + yc * textureLoader->width) * 16; // write to target buffer
-						float red = rgbaBlock[(px + py * 4) * 4 + 0];
-						float green = rgbaBlock[(px + py * 4) * 4 + 1];
-						float blue = rgbaBlock[(px + py * 4) * 4 + 2];
-						float alpha = rgbaBlock[(px + py * 4) * 4 + 3];
-						*(float*)(outputData + pixelOffset + 0) = red;
-						*(float*)(outputData + pixelOffset + 4) = green;
-						*(float*)(outputData + pixelOffset + 8) = blue;
-						*(float*)(outputData + pixelOffset + 12) = alpha;
-					}
-				}
+				LatteTextureLoader_decodeBC1ToRGBA32F(blockData, (float*)(outputData + (x + y * textureLoader->width) * 16), textureLoader->width, blockSizeX, blockSizeY);
 			}
 		}
 	}
@@ -1690,32 +1602,14 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
 			{
 				uint8* blockData = LatteTextureLoader_GetInput(textureLoader, x, y);
 				sint32 blockSizeX = (std::min)(4, textureLoader->width - x);
 				sint32 blockSizeY = (std::min)(4, textureLoader->height - y);
-				// decode 4x4 pixels at once
-				float rgbaBlock[4 * 4 * 4];
-				decodeBC2Block_UNORM(blockData, rgbaBlock);
-				for (sint32 py = 0; py < blockSizeY; py++)
-				{
-					sint32 yc = y + py;
-					for (sint32 px = 0; px < blockSizeX; px++)
-					{
-						sint32 pixelOffset = (x + px + yc * textureLoader->width) * 16; // write to target buffer
-						float red = rgbaBlock[(px + py * 4) * 4 + 0];
-						float green = rgbaBlock[(px + py * 4) * 4 + 1];
-						float blue = rgbaBlock[(px + py * 4) * 4 + 2];
-						float alpha = rgbaBlock[(px + py * 4) * 4 + 3];
-						*(float*)(outputData + pixelOffset + 0) = red;
-						*(float*)(outputData + pixelOffset + 4) = green;
-						*(float*)(outputData + pixelOffset + 8) = blue;
-						*(float*)(outputData + pixelOffset + 12) = alpha;
-					}
-				}
+				LatteTextureLoader_decodeBC2ToRGBA32F(blockData, (float*)(outputData + (x + y * textureLoader->width) * 16), textureLoader->width, blockSizeX, blockSizeY);
 			}
 		}
 	}
@@ -1747,32 +1641,14 @@ public:
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
 		// todo - apply srgb conversion
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
 			{
 				uint8* blockData = LatteTextureLoader_GetInput(textureLoader, x, y);
 				sint32 blockSizeX = (std::min)(4, textureLoader->width - x);
 				sint32 blockSizeY = (std::min)(4, textureLoader->height - y);
-				// decode 4x4 pixels at once
-				float rgbaBlock[4 * 4 * 4];
-				decodeBC2Block_UNORM(blockData, rgbaBlock);
-				for (sint32 py = 0; py < blockSizeY; py++)
-				{
-					sint32 yc = y + py;
-					for (sint32 px = 0; px < blockSizeX; px++)
-					{
-						sint32 pixelOffset = (x + px + yc * textureLoader->width) * 16; // write to target buffer
-						float red = rgbaBlock[(px + py * 4) * 4 + 0];
-						float green = rgbaBlock[(px + py * 4) * 4 + 1];
-						float blue = rgbaBlock[(px + py * 4) * 4 + 2];
-						float alpha = rgbaBlock[(px + py * 4) * 4 + 3];
-						*(float*)(outputData + pixelOffset + 0) = red;
-						*(float*)(outputData + pixelOffset + 4) = green;
-						*(float*)(outputData + pixelOffset + 8) = blue;
-						*(float*)(outputData + pixelOffset + 12) = alpha;
-					}
-				}
+				LatteTextureLoader_decodeBC2ToRGBA32F(blockData, (float*)(outputData + (x + y * textureLoader->width) * 16), textureLoader->width, blockSizeX, blockSizeY);
 			}
 		}
 	}
@@ -1804,32 +1680,14 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
 			{
 				uint8* blockData = LatteTextureLoader_GetInput(textureLoader, x, y);
 				sint32 blockSizeX = (std::min)(4, textureLoader->width - x);
 				sint32 blockSizeY = (std::min)(4, textureLoader->height - y);
-				// decode 4x4 pixels at once
-				float rgbaBlock[4 * 4 * 4];
-				decodeBC3Block_UNORM(blockData, rgbaBlock);
-				for (sint32 py = 0; py < blockSizeY; py++)
-				{
-					sint32 yc = y + py;
-					for (sint32 px = 0; px < blockSizeX; px++)
-					{
-						sint32 pixelOffset = (x + px + yc * textureLoader->width) * 16; // write to target buffer
-						float red = rgbaBlock[(px + py * 4) * 4 + 0];
-						float green = rgbaBlock[(px + py * 4) * 4 + 1];
-						float blue = rgbaBlock[(px + py * 4) * 4 + 2];
-						float alpha = rgbaBlock[(px + py * 4) * 4 + 3];
-						*(float*)(outputData + pixelOffset + 0) = red;
-						*(float*)(outputData + pixelOffset + 4) = green;
-						*(float*)(outputData + pixelOffset + 8) = blue;
-						*(float*)(outputData + pixelOffset + 12) = alpha;
-					}
-				}
+				LatteTextureLoader_decodeBC3ToRGBA32F(blockData, (float*)(outputData + (x + y * textureLoader->width) * 16), textureLoader->width, blockSizeX, blockSizeY);
 			}
 		}
 	}
@@ -1909,28 +1767,14 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
 			{
 				uint8* blockData = LatteTextureLoader_GetInput(textureLoader, x, y);
 				sint32 blockSizeX = (std::min)(4, textureLoader->width - x);
 				sint32 blockSizeY = (std::min)(4, textureLoader->height - y);
-				// decode 4x4 pixels at once
-				float rBlock[4 * 4 * 1];
-				decodeBC4Block_UNORM(blockData, rBlock);
-
-				for (sint32 py = 0; py < blockSizeY; py++)
-				{
-					sint32 yc = y + py;
-					for (sint32 px = 0; px < blockSizeX; px++)
-					{
-						sint32 pixelOffset = (x + px + yc * textureLoader->width) * 8; // write to target buffer
-						float red = rBlock[(px + py * 4) * 1 + 0];
-						*(float*)(outputData + pixelOffset + 0) = red;
-						*(float*)(outputData + pixelOffset + 4) = 0.0f;
-					}
-				}
+				LatteTextureLoader_decodeBC4ToRG32F(blockData, (float*)(outputData + (x + y * textureLoader->width) * 8), textureLoader->width, blockSizeX, blockSizeY);
 			}
 		}
 	}
@@ -1994,29 +1838,14 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
 			{
 				uint8* blockData = LatteTextureLoader_GetInput(textureLoader, x, y);
 				sint32 blockSizeX = (std::min)(4, textureLoader->width - x);
 				sint32 blockSizeY = (std::min)(4, textureLoader->height - y);
-				// decode 4x4 pixels at once
-				float rgBlock[4 * 4 * 2];
-				decodeBC5Block_UNORM(blockData, rgBlock);
-
-				for (sint32 py = 0; py < blockSizeY; py++)
-				{
-					sint32 yc = y + py;
-					for (sint32 px = 0; px < blockSizeX; px++)
-					{
-						sint32 pixelOffset = (x + px + yc * textureLoader->width) * 8; // write to target buffer
-						float red = rgBlock[(px + py * 4) * 2 + 0];
-						float green = rgBlock[(px + py * 4) * 2 + 1];
-						*(float*)(outputData + pixelOffset + 0) = red;
-						*(float*)(outputData + pixelOffset + 4) = green;
-					}
-				}
+				LatteTextureLoader_decodeBC5ToRG32F(blockData, (float*)(outputData + (x + y * textureLoader->width) * 8), textureLoader->width, blockSizeX, blockSizeY);
 			}
 		}
 	}
@@ -2045,29 +1874,14 @@ public:
 
 	void decode(LatteTextureLoaderCtx* textureLoader, uint8* outputData) override
 	{
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			for (sint32 x = 0; x < textureLoader->width; x += textureLoader->stepX)
 			{
 				uint8* blockData = LatteTextureLoader_GetInput(textureLoader, x, y);
 				sint32 blockSizeX = (std::min)(4, textureLoader->width - x);
 				sint32 blockSizeY = (std::min)(4, textureLoader->height - y);
-				// decode 4x4 pixels at once
-				float rgBlock[4 * 4 * 2];
-				decodeBC5Block_SNORM(blockData, rgBlock);
-
-				for (sint32 py = 0; py < blockSizeY; py++)
-				{
-					sint32 yc = y + py;
-					for (sint32 px = 0; px < blockSizeX; px++)
-					{
-						sint32 pixelOffset = (x + px + yc * textureLoader->width) * 8; // write to target buffer
-						float red = rgBlock[(px + py * 4) * 2 + 0];
-						float green = rgBlock[(px + py * 4) * 2 + 1];
-						*(float*)(outputData + pixelOffset + 0) = red;
-						*(float*)(outputData + pixelOffset + 4) = green;
-					}
-				}
+				LatteTextureLoader_decodeBC5SNormToRG32F(blockData, (float*)(outputData + (x + y * textureLoader->width) * 8), textureLoader->width, blockSizeX, blockSizeY);
 			}
 		}
 	}
@@ -0,0 +1,432 @@
+#include "Cafe/HW/Latte/Core/LatteTextureLoader.h"
+#include "Cafe/HW/Latte/Core/LatteTextureLoaderSIMD.h"
+#include "Common/cpu_features.h"
+
+/* Packed texel expansion */
+
+static void _LatteTextureLoader_expandToRGBA8Generic(const uint8* input, sint32 inputTexelSize, uint8* output, sint32 texelCount, const LatteTextureExpandFormat& format)
+{
+	for (sint32 i = 0; i < texelCount; i++)
+	{
+		uint32 v = (inputTexelSize == 2) ? *(const uint16*)(input + i * 2) : input[i];
+		uint8 rgba[4];
+		for (sint32 c = 0; c < 4; c++)
+		{
+			const LatteTextureExpandChannel& ch = format.channel[c];
+			rgba[c] = (uint8)(((((v >> ch.shift) & ch.mask) * ch.mul) >> ch.rshift) | ch.constant);
+		}
+		memcpy(output + i * 4, rgba, 4);
+	}
+}
+
+#if defined(ARCH_X86_64)
+// all channels are calculated in 16bit lanes and then interleaved into RGBA8
+ATTRIBUTE_SSE41
+static sint32 _LatteTextureLoader_expandToRGBA8SSE41(const uint8* input, sint32 inputTexelSize, uint8* output, sint32 texelCount, const LatteTextureExpandFormat& format)
+{
+	__m128i shift[4], mask[4], mul[4], rshift[4], constant[4];
+	for (sint32 c = 0; c < 4; c++)
+	{
+		const LatteTextureExpandChannel& ch = format.channel[c];
+		shift[c] = _mm_cvtsi32_si128(ch.shift);
+		mask[c] = _mm_set1_epi16(ch.mask);
+		mul[c] = _mm_set1_epi16(ch.mul);
+		rshift[c] = _mm_cvtsi32_si128(ch.rshift);
+		constant[c] = _mm_set1_epi16(ch.constant);
+	}
+	sint32 i = 0;
+	for (; i + 8 <= texelCount; i += 8)
+	{
+		__m128i v;
+		if (inputTexelSize == 2)
+			v = _mm_loadu_si128((const __m128i*)(input + i * 2));
+		else
+			v = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(input + i)));
+		__m128i c[4];
+		for (sint32 k = 0; k < 4; k++)
+			c[k] = _mm_or_si128(_mm_srl_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srl_epi16(v, shift[k]), mask[k]), mul[k]), rshift[k]), constant[k]);
+		__m128i lo = _mm_or_si128(c[0], _mm_slli_epi16(c[1], 8));
+		__m128i hi = _mm_or_si128(c[2], _mm_slli_epi16(c[3], 8));
+		_mm_storeu_si128((__m128i*)(output + i * 4), _mm_unpacklo_epi16(lo, hi));
+		_mm_storeu_si128((__m128i*)(output + i * 4 + 16), _mm_unpackhi_epi16(lo, hi));
+	}
+	return i;
+}
+
+ATTRIBUTE_AVX2
+static sint32 _LatteTextureLoader_expandToRGBA8AVX2(const uint8* input, sint32 inputTexelSize, uint8* output, sint32 texelCount, const LatteTextureExpandFormat& format)
+{
+	__m256i mask[4], mul[4], constant[4];
+	__m128i shift[4], rshift[4];
+	for (sint32 c = 0; c < 4; c++)
+	{
+		const LatteTextureExpandChannel& ch = format.channel[c];
+		shift[c] = _mm_cvtsi32_si128(ch.shift);
+		mask[c] = _mm256_set1_epi16(ch.mask);
+		mul[c] = _mm256_set1_epi16(ch.mul);
+		rshift[c] = _mm_cvtsi32_si128(ch.rshift);
+		constant[c] = _mm256_set1_epi16(ch.constant);
+	}
+	sint32 i = 0;
+	for (; i + 16 <= texelCount; i += 16)
+	{
+		__m256i v;
+		if (inputTexelSize == 2)
+			v = _mm256_loadu_si256((const __m256i*)(input + i * 2));
+		else
+			v = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(input + i)));
+		__m256i c[4];
+		for (sint32 k = 0; k < 4; k++)
+			c[k] = _mm256_or_si256(_mm256_srl_epi16(_mm256_mullo_epi16(_mm256_and_si256(_mm256_srl_epi16(v, shift[k]), mask[k]), mul[k]), rshift[k]), constant[k]);
+		__m256i lo = _mm256_or_si256(c[0], _mm256_slli_epi16(c[1], 8));
+		__m256i hi = _mm256_or_si256(c[2], _mm256_slli_epi16(c[3], 8));
+		// unpack works within 128bit lanes, texels 0-3 and 8-11 end up in the first register
+		__m256i rgba0 = _mm256_unpacklo_epi16(lo, hi);
+		__m256i rgba1 = _mm256_unpackhi_epi16(lo, hi);
+		_mm256_storeu_si256((__m256i*)(output + i * 4), _mm256_permute2x128_si256(rgba0, rgba1, 0x20));
+		_mm256_storeu_si256((__m256i*)(output + i * 4 + 32), _mm256_permute2x128_si256(rgba0, rgba1, 0x31));
+	}
+	return i + _LatteTextureLoader_expandToRGBA8SSE41(input + i * inputTexelSize, inputTexelSize, output + i * 4, texelCount - i, format);
+}
+#endif
+
+// input and output may overlap as long as the input does not start before the output
+// all kernels read a group of texels before writing it, so expanding a row in place from its second half is safe
+void LatteTextureLoader_expandToRGBA8(const uint8* input, sint32 inputTexelSize, uint8* output, sint32 texelCount, const LatteTextureExpandFormat& format)
+{
+	cemu_assert_debug(inputTexelSize == 1 || inputTexelSize == 2);
+	sint32 processed = 0;
+#if defined(ARCH_X86_64)
+	if (g_CPUFeatures.x86.avx2)
+		processed = _LatteTextureLoader_expandToRGBA8AVX2(input, inputTexelSize, output, texelCount, format);
+	else if (g_CPUFeatures.x86.sse4_1)
+		processed = _LatteTextureLoader_expandToRGBA8SSE41(input, inputTexelSize, output, texelCount, format);
+#endif
+	_LatteTextureLoader_expandToRGBA8Generic(input + processed * inputTexelSize, inputTexelSize, output + processed * 4, texelCount - processed, format);
+}
+
+/* BCn decompression */
+
+// the generic path and partial blocks at the surface border use the scalar block decoders
+static void _LatteTextureLoader_storeDecodedBlock(const float* block, sint32 channelCount, float* output, sint32 pitch, sint32 sizeX, sint32 sizeY)
+{
+	for (sint32 py = 0; py < sizeY; py++)
+		memcpy(output + py * pitch * channelCount, block + py * 4 * channelCount, sizeX * channelCount * sizeof(float));
+}
+
+#if defined(ARCH_X86_64)
+static const std::array<float, 16> s_bc2AlphaTable = []()
+{
+	std::array<float, 16> table;
+	for (uint32 i = 0; i < 16; i++)
+		table[i] = (float)(uint8)(i | (i << 4)) / 255.0f;
+	return table;
+}();
+
+// RGB565 to (r, g, b, 1.0)
+static inline __m128 _LatteTextureLoader_unpackRGB565(uint32 c)
+{
+	__m128i v = _mm_setr_epi32((c >> 11) & 0x1F, (c >> 5) & 0x3F, c & 0x1F, 1);
+	return _mm_div_ps(_mm_cvtepi32_ps(v), _mm_setr_ps(31.0f, 63.0f, 31.0f, 1.0f));
+}
+
+// color palette of BC2 and BC3, these always use four color mode
+static inline void _LatteTextureLoader_buildBC23ColorPalette(uint8* blockData, __m128* palette)
+{
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 three = _mm_set1_ps(3.0f);
+	palette[0] = _LatteTextureLoader_unpackRGB565(*(uint16*)(blockData + 8));
+	palette[1] = _LatteTextureLoader_unpackRGB565(*(uint16*)(blockData + 10));
+	palette[2] = _mm_div_ps(_mm_add_ps(_mm_mul_ps(palette[0], two), palette[1]), three);
+	palette[3] = _mm_div_ps(_mm_add_ps(palette[0], _mm_mul_ps(palette[1], two)), three);
+}
+
+// 8 entry palette as used by BC3 alpha, BC4 and BC5. Interpolated entries are (w0 * p0 + w1 * p1) / divisor like in the scalar decoders
+static inline void _LatteTextureLoader_buildBC4Palette(float* palette, float p0, float p1, bool sixInterpolatedValues, float minValue)
+{
+	__m128 v0 = _mm_set1_ps(p0);
+	__m128 v1 = _mm_set1_ps(p1);
+	__m128 lo, hi;
+	if (sixInterpolatedValues)
+	{
+		const __m128 divisor = _mm_set1_ps(7.0f);
+		lo = _mm_div_ps(_mm_add_ps(_mm_mul_ps(_mm_setr_ps(0.0f, 0.0f, 6.0f, 5.0f), v0), _mm_mul_ps(_mm_setr_ps(0.0f, 0.0f, 1.0f, 2.0f), v1)), divisor);
+		hi = _mm_div_ps(_mm_add_ps(_mm_mul_ps(_mm_setr_ps(4.0f, 3.0f, 2.0f, 1.0f), v0), _mm_mul_ps(_mm_setr_ps(3.0f, 4.0f, 5.0f, 6.0f), v1)), divisor);
+	}
+	else
+	{
+		const __m128 divisor = _mm_set1_ps(5.0f);
+		lo = _mm_div_ps(_mm_add_ps(_mm_mul_ps(_mm_setr_ps(0.0f, 0.0f, 4.0f, 3.0f), v0), _mm_mul_ps(_mm_setr_ps(0.0f, 0.0f, 1.0f, 2.0f), v1)), divisor);
+		hi = _mm_div_ps(_mm_add_ps(_mm_mul_ps(_mm_setr_ps(2.0f, 1.0f, 0.0f, 0.0f), v0), _mm_mul_ps(_mm_setr_ps(3.0f, 4.0f, 0.0f, 0.0f), v1)), divisor);
+	}
+	_mm_storeu_ps(palette + 0, lo);
+	_mm_storeu_ps(palette + 4, hi);
+	palette[0] = p0;
+	palette[1] = p1;
+	if (!sixInterpolatedValues)
+	{
+		palette[6] = minValue;
+		palette[7] = 1.0f;
+	}
+}
+
+// 3bit indices of the 16 pixels of a BC3 alpha, BC4 or BC5 channel
+static inline uint64 _LatteTextureLoader_readBC4Indices(const uint8* indexData)
+{
+	uint64 indices = 0;
+	for (sint32 i = 0; i < 6; i++)
+		indices |= (uint64)indexData[i] << (i * 8);
+	return indices;
+}
+
+ATTRIBUTE_SSE41
+static void _LatteTextureLoader_decodeBC1SSE41(uint8* blockData, float* output, sint32 pitch)
+{
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 three = _mm_set1_ps(3.0f);
+	uint16 c0 = *(uint16*)(blockData + 0);
+	uint16 c1 = *(uint16*)(blockData + 2);
+	__m128 palette[4];
+	palette[0] = _LatteTextureLoader_unpackRGB565(c0);
+	palette[1] = _LatteTextureLoader_unpackRGB565(c1);
+	if (c0 > c1)
+	{
+		palette[2] = _mm_div_ps(_mm_add_ps(_mm_mul_ps(palette[0], two), palette[1]), three);
+		palette[3] = _mm_div_ps(_mm_add_ps(palette[0], _mm_mul_ps(palette[1], two)), three);
+	}
+	else
+	{
+		palette[2] = _mm_div_ps(_mm_add_ps(palette[0], palette[1]), two);
+		palette[3] = _mm_setzero_ps();
+	}
+	for (sint32 py = 0; py < 4; py++)
+	{
+		uint32 rowIndices = blockData[4 + py];
+		float* rowOutput = output + py * pitch * 4;
+		for (sint32 px = 0; px < 4; px++)
+			_mm_storeu_ps(rowOutput + px * 4, palette[(rowIndices >> (px * 2)) & 3]);
+	}
+}
+
+ATTRIBUTE_SSE41
+static void _LatteTextureLoader_decodeBC2SSE41(uint8* blockData, float* output, sint32 pitch)
+{
+	__m128 palette[4];
+	_LatteTextureLoader_buildBC23ColorPalette(blockData, palette);
+	uint32 colorIndices = *(uint32*)(blockData + 12);
+	uint64 alphaCodes = *(uint64*)(blockData + 0);
+	for (sint32 py = 0; py < 4; py++)
+	{
+		float* rowOutput = output + py * pitch * 4;
+		for (sint32 px = 0; px < 4; px++)
+		{
+			uint32 pixelIndex = px + py * 4;
+			__m128 alpha = _mm_set1_ps(s_bc2AlphaTable[(alphaCodes >> (pixelIndex * 4)) & 0xF]);
+			_mm_storeu_ps(rowOutput + px * 4, _mm_blend_ps(palette[(colorIndices >> (pixelIndex * 2)) & 3], alpha, 0x8));
+		}
+	}
+}
+
+ATTRIBUTE_SSE41
+static void _LatteTextureLoader_decodeBC3SSE41(uint8* blockData, float* output, sint32 pitch)
+{
+	__m128 palette[4];
+	_LatteTextureLoader_buildBC23ColorPalette(blockData, palette);
+	uint32 colorIndices = *(uint32*)(blockData + 12);
+	float alphaPalette[8];
+	_LatteTextureLoader_buildBC4Palette(alphaPalette, (float)blockData[0] / 255.0f, (float)blockData[1] / 255.0f, blockData[0] > blockData[1], 0.0f);
+	uint64 alphaIndices = _LatteTextureLoader_readBC4Indices(blockData + 2);
+	for (sint32 py = 0; py < 4; py++)
+	{
+		float* rowOutput = output + py * pitch * 4;
+		for (sint32 px = 0; px < 4; px++)
+		{
+			uint32 pixelIndex = px + py * 4;
+			__m128 alpha = _mm_set1_ps(alphaPalette[(alphaIndices >> (pixelIndex * 3)) & 7]);
+			_mm_storeu_ps(rowOutput + px * 4, _mm_blend_ps(palette[(colorIndices >> (pixelIndex * 2)) & 3], alpha, 0x8));
+		}
+	}
+}
+
+// BC4 and BC5 output two floats per pixel. The generic variant handles both, for BC4 greenPalette is all zero
+ATTRIBUTE_SSE41
+static void _LatteTextureLoader_storeBC45SSE41(const float* redPalette, uint64 redIndices, const float* greenPalette, uint64 greenIndices, float* output, sint32 pitch)
+{
+	for (sint32 py = 0; py < 4; py++)
+	{
+		float* rowOutput = output + py * pitch * 2;
+		for (sint32 px = 0; px < 4; px += 2)
+		{
+			uint32 shift = (px + py * 4) * 3;
+			__m128 rg = _mm_setr_ps(redPalette[(redIndices >> shift) & 7], greenPalette[(greenIndices >> shift) & 7], redPalette[(redIndices >> (shift + 3)) & 7], greenPalette[(greenIndices >> (shift + 3)) & 7]);
+			_mm_storeu_ps(rowOutput + px * 2, rg);
+		}
+	}
+}
+
+// permutevar8x32 looks up eight palette entries at once. Even lanes take red and odd lanes take green
+ATTRIBUTE_AVX2
+static void _LatteTextureLoader_storeBC45AVX2(const float* redPalette, uint64 redIndices, const float* greenPalette, uint64 greenIndices, bool hasGreen, float* output, sint32 pitch)
+{
+	__m256 red = _mm256_loadu_ps(redPalette);
+	__m256 green = _mm256_loadu_ps(greenPalette);
+	const __m256i laneShift = _mm256_setr_epi32(0, 0, 3, 3, 6, 6, 9, 9);
+	const __m256i indexMask = _mm256_set1_epi32(7);
+	for (sint32 py = 0; py < 4; py++)
+	{
+		__m256i redIndex = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((sint32)(redIndices >> (py * 12))), laneShift), indexMask);
+		__m256 rg = _mm256_permutevar8x32_ps(red, redIndex);
+		if (hasGreen)
+		{
+			__m256i greenIndex = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((sint32)(greenIndices >> (py * 12))), laneShift), indexMask);
+			rg = _mm256_blend_ps(rg, _mm256_permutevar8x32_ps(green, greenIndex), 0xAA);
+		}
+		else
+			rg = _mm256_blend_ps(rg, _mm256_setzero_ps(), 0xAA);
+		_mm256_storeu_ps(output + py * pitch * 2, rg);
+	}
+}
+
+static void _LatteTextureLoader_storeBC45(const float* redPalette, uint64 redIndices, const float* greenPalette, uint64 greenIndices, bool hasGreen, float* output, sint32 pitch)
+{
+	if (g_CPUFeatures.x86.avx2)
+		_LatteTextureLoader_storeBC45AVX2(redPalette, redIndices, greenPalette, greenIndices, hasGreen, output, pitch);
+	else
+		_LatteTextureLoader_storeBC45SSE41(redPalette, redIndices, greenPalette, greenIndices, output, pitch);
+}
+
+static void _LatteTextureLoader_decodeBC4SIMD(uint8* blockData, float* output, sint32 pitch)
+{
+	float redPalette[8];
+	static const float s_zeroPalette[8]{};
+	_LatteTextureLoader_buildBC4Palette(redPalette, (float)blockData[0] / 255.0f, (float)blockData[1] / 255.0f, blockData[0] > blockData[1], 0.0f);
+	_LatteTextureLoader_storeBC45(redPalette, _LatteTextureLoader_readBC4Indices(blockData + 2), s_zeroPalette, 0, false, output, pitch);
+}
+
+template<bool isSigned>
+static void _LatteTextureLoader_decodeBC5SIMD(uint8* blockData, float* output, sint32 pitch)
+{
+	float palette[2][8];
+	for (sint32 c = 0; c < 2; c++)
+	{
+		uint8* channelData = blockData + c * 8;
+		float p0, p1;
+		if constexpr (isSigned)
+		{
+			p0 = ((float)(*(sint8*)(channelData + 0)) + 128.0f) / 255.0f;
+			p1 = ((float)(*(sint8*)(channelData + 1)) + 128.0f) / 255.0f;
+			p0 = (p0 * 2.0f - 1.0f);
+			p1 = (p1 * 2.0f - 1.0f);
+		}
+		else
+		{
+			p0 = ((float)channelData[0]) / 255.0f;
+			p1 = ((float)channelData[1]) / 255.0f;
+		}
+		_LatteTextureLoader_buildBC4Palette(palette[c], p0, p1, p0 > p1, isSigned ? -1.0f : 0.0f);
+	}
+	_LatteTextureLoader_storeBC45(palette[0], _LatteTextureLoader_readBC4Indices(blockData + 2), palette[1], _LatteTextureLoader_readBC4Indices(blockData + 8 + 2), true, output, pitch);
+}
+#endif
+
+void LatteTextureLoader_decodeBC1ToRGBA32F(uint8* blockData, float* output, sint32 pitch, sint32 sizeX, sint32 sizeY)
+{
+#if defined(ARCH_X86_64)
+	if (sizeX == 4 && sizeY == 4 && g_CPUFeatures.x86.sse4_1)
+	{
+		_LatteTextureLoader_decodeBC1SSE41(blockData, output, pitch);
+		return;
+	}
+#endif
+	float rgbaBlock[4 * 4 * 4];
+	decodeBC1Block(blockData, rgbaBlock);
+	_LatteTextureLoader_storeDecodedBlock(rgbaBlock, 4, output, pitch, sizeX, sizeY);
+}
+
+void LatteTextureLoader_decodeBC2ToRGBA32F(uint8* blockData, float* output, sint32 pitch, sint32 sizeX, sint32 sizeY)
+{
+#if defined(ARCH_X86_64)
+	if (sizeX == 4 && sizeY == 4 && g_CPUFeatures.x86.sse4_1)
+	{
+		_LatteTextureLoader_decodeBC2SSE41(blockData, output, pitch);
+		return;
+	}
+#endif
+	float rgbaBlock[4 * 4 * 4];
+	decodeBC2Block_UNORM(blockData, rgbaBlock);
+	_LatteTextureLoader_storeDecodedBlock(rgbaBlock, 4, output, pitch, sizeX, sizeY);
+}
+
+void LatteTextureLoader_decodeBC3ToRGBA32F(uint8* blockData, float* output, sint32 pitch, sint32 sizeX, sint32 sizeY)
+{
+#if defined(ARCH_X86_64)
+	if (sizeX == 4 && sizeY == 4 && g_CPUFeatures.x86.sse4_1)
+	{
+		_LatteTextureLoader_decodeBC3SSE41(blockData, output, pitch);
+		return;
+	}
+#endif
+	float rgbaBlock[4 * 4 * 4];
+	decodeBC3Block_UNORM(blockData, rgbaBlock);
+	_LatteTextureLoader_storeDecodedBlock(rgbaBlock, 4, output, pitch, sizeX, sizeY);
+}
+
+void LatteTextureLoader_decodeBC4ToRG32F(uint8* blockData, float* output, sint32 pitch, sint32 sizeX, sint32 sizeY)
+{
+#if defined(ARCH_X86_64)
+	if (sizeX == 4 && sizeY == 4 && g_CPUFeatures.x86.sse4_1)
+	{
+		_LatteTextureLoader_decodeBC4SIMD(blockData, output, pitch);
+		return;
+	}
+#endif
+	float rBlock[4 * 4 * 1];
+	decodeBC4Block_UNORM(blockData, rBlock);
+	for (sint32 py = 0; py < sizeY; py++)
+	{
+		for (sint32 px = 0; px < sizeX; px++)
+		{
+			output[(px + py * pitch) * 2 + 0] = rBlock[px + py * 4];
+			output[(px + py * pitch) * 2 + 1] = 0.0f;
+		}
+	}
+}
+
+void LatteTextureLoader_decodeBC5ToRG32F(uint8* blockData, float* output, sint32 pitch, sint32 sizeX, sint32 sizeY)
+{
+#if defined(ARCH_X86_64)
+	if (sizeX == 4 && sizeY == 4 && g_CPUFeatures.x86.sse4_1)
+	{
+		_LatteTextureLoader_decodeBC5SIMD<false>(blockData, output, pitch);
+		return;
+	}
+#endif
+	float rgBlock[4 * 4 * 2];
+	decodeBC5Block_UNORM(blockData, rgBlock);
+	_LatteTextureLoader_storeDecodedBlock(rgBlock, 2, output, pitch, sizeX, sizeY);
+}
+
+void LatteTextureLoader_decodeBC5SNormToRG32F(uint8* blockData, float* output, sint32 pitch, sint32 sizeX, sint32 sizeY)
+{
+#if defined(ARCH_X86_64)
+	if (sizeX == 4 && sizeY == 4 && g_CPUFeatures.x86.sse4_1)
+	{
+		_LatteTextureLoader_decodeBC5SIMD<true>(blockData, output, pitch);
+		return;
+	}
+#endif
+	float rgBlock[4 * 4 * 2];
+	decodeBC5Block_SNORM(blockData, rgBlock);
+	_LatteTextureLoader_storeDecodedBlock(rgBlock, 2, output, pitch, sizeX, sizeY);
+}
+
+const char* LatteTextureLoader_getSIMDImplementationName()
+{
+#if defined(ARCH_X86_64)
+	if (g_CPUFeatures.x86.avx2)
+		return "AVX2";
+	if (g_CPUFeatures.x86.sse4_1)
+		return "SSE4.1";
+#endif
+	return "Generic";
+}
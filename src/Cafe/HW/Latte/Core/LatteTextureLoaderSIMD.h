@@ -0,0 +1,33 @@
+#pragma once
+
+// vectorized kernels used by the texture decoders
+// every kernel produces exactly the same output as the scalar code, the fastest implementation supported by the CPU (AVX2, SSE4.1 or generic) is used
+
+// expansion of packed 8bit or 16bit texels to 32bit RGBA8
+// every output byte is calculated as (((texel >> shift) & mask) * mul >> rshift) | constant. Results must fit into 8 bits
+struct LatteTextureExpandChannel
+{
+	uint8 shift;
+	uint8 mask;
+	uint16 mul;
+	uint8 rshift;
+	uint8 constant;
+};
+
+struct LatteTextureExpandFormat
+{
+	LatteTextureExpandChannel channel[4]; // in the order of the output bytes
+};
+
+void LatteTextureLoader_expandToRGBA8(const uint8* input, sint32 inputTexelSize, uint8* output, sint32 texelCount, const LatteTextureExpandFormat& format);
+
+// decode a single BC block straight into the output surface. pitch is in pixels, sizeX and sizeY clip the block at the right and bottom border of the surface
+void LatteTextureLoader_decodeBC1ToRGBA32F(uint8* blockData, float* output, sint32 pitch, sint32 sizeX, sint32 sizeY);
+void LatteTextureLoader_decodeBC2ToRGBA32F(uint8* blockData, float* output, sint32 pitch, sint32 sizeX, sint32 sizeY);
+void LatteTextureLoader_decodeBC3ToRGBA32F(uint8* blockData, float* output, sint32 pitch, sint32 sizeX, sint32 sizeY);
+void LatteTextureLoader_decodeBC4ToRG32F(uint8* blockData, float* output, sint32 pitch, sint32 sizeX, sint32 sizeY); // green is always zero
+void LatteTextureLoader_decodeBC5ToRG32F(uint8* blockData, float* output, sint32 pitch, sint32 sizeX, sint32 sizeY);
+void LatteTextureLoader_decodeBC5SNormToRG32F(uint8* blockData, float* output, sint32 pitch, sint32 sizeX, sint32 sizeY);
+
+// for testing, returns the name of the implementation which is used
+const char* LatteTextureLoader_getSIMDImplementationName();
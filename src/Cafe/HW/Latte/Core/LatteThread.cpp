@@ -123,6 +123,7 @@ int Latte_ThreadEntry()
 
 	LatteTiming_Init();
 	LatteTexture_init();
+	LatteTextureLoader_init();
 	LatteTC_Init();
 	LatteBufferCache_init(164 * 1024 * 1024);
 	LatteQuery_Init();
@@ -253,6 +254,7 @@ void LatteThread_Exit()
     LatteBufferCache_UnloadAll();
 	// clean up texture cache
 	LatteTC_UnloadAllTextures();
+	LatteTextureLoader_shutdown();
 	// clean up runtime shader cache
     LatteSHRC_UnloadAll();
     // close disk cache
@@ -2,10 +2,10 @@
 #include "Cafe/HW/Latte/LatteAddrLib/LatteAddrLib.h"
 
 template<typename texelBaseType, int texelBaseTypeCount, bool isEncodeDirection, bool isCompressed>
-void optimizedDecodeLoop_tm04_numSamples1_8x8(LatteTextureLoaderCtx* textureLoader, uint8* outputData, sint32 texelCountX, sint32 texelCountY)
+void optimizedDecodeLoop_tm04_numSamples1_8x8(LatteTextureLoaderCtx* textureLoader, uint8* outputData, sint32 texelCountX, sint32 texelBeginY, sint32 texelEndY)
 {
 	uint16* tableBase = textureLoader->computeAddrInfo.microTilePixelIndexTable + ((textureLoader->computeAddrInfo.slice & 7) << 6);
-	for (sint32 yt = 0; yt < texelCountY; yt += 8)
+	for (sint32 yt = texelBeginY; yt < texelEndY; yt += 8)
 	{
 		for (sint32 xt = 0; xt < texelCountX; xt += 8)
 		{
@@ -64,10 +64,10 @@ void optimizedDecodeLoop_tm04_numSamples1_8x8(LatteTextureLoaderCtx* textureLoad
 }
 
 template<typename texelBaseType, int texelBaseTypeCount, bool isEncodeDirection, bool isCompressed>
-void optimizedDecodeLoop_tm04_numSamples1_8x8_optimizedRowCopy(LatteTextureLoaderCtx* textureLoader, uint8* outputData, sint32 texelCountX, sint32 texelCountY)
+void optimizedDecodeLoop_tm04_numSamples1_8x8_optimizedRowCopy(LatteTextureLoaderCtx* textureLoader, uint8* outputData, sint32 texelCountX, sint32 texelBeginY, sint32 texelEndY)
 {
 	uint16* tableBase = textureLoader->computeAddrInfo.microTilePixelIndexTable + ((textureLoader->computeAddrInfo.slice & 7) << 6);
-	for (sint32 yt = 0; yt < texelCountY; yt += 8)
+	for (sint32 yt = texelBeginY; yt < texelEndY; yt += 8)
 	{
 		for (sint32 xt = 0; xt < texelCountX; xt += 8)
 		{
@@ -196,25 +196,30 @@ void optimizedDecodeLoop_tm04_numSamples1_8x8_optimizedRowCopy(LatteTextureLoade
 template<typename texelBaseType, int texelBaseTypeCount, bool isEncodeDirection, bool isCompressed>
 void optimizedDecodeLoops(LatteTextureLoaderCtx* textureLoader, uint8* outputData)
 {
+	// only rows in the range decodeBeginY to decodeEndY are processed
 	sint32 texelCountX;
-	sint32 texelCountY;
+	sint32 texelBeginY;
+	sint32 texelEndY;
 	if (isCompressed)
 	{
 		texelCountX = (textureLoader->width + 3) / 4;
-		texelCountY = (textureLoader->height + 3) / 4;
+		texelBeginY = textureLoader->decodeBeginY / 4;
+		texelEndY = (textureLoader->decodeEndY + 3) / 4;
 	}
 	else
 	{
 		texelCountX = textureLoader->width;
-		texelCountY = textureLoader->height;
+		texelBeginY = textureLoader->decodeBeginY;
+		texelEndY = textureLoader->decodeEndY;
 	}
 
 	if (textureLoader->tileMode == Latte::E_HWTILEMODE::TM_2D_TILED_THIN1 && textureLoader->computeAddrInfo.numSamples == 1)
 	{
 		sint32 texelCountOrigX = texelCountX;
-		sint32 texelCountOrigY = texelCountY;
 		texelCountX &= ~7;
-		texelCountY &= ~7;
+		// begin is always aligned to 8 texel rows, only the last band can end with a partial tile row
+		cemu_assert_debug((texelBeginY & 7) == 0);
+		sint32 texelEndY8 = std::max(texelEndY & ~7, texelBeginY);
 		// full tiles (assuming tileMode=4 and numSamples=1)
 		// only recalculate tile related offset at the beginning of each block
 		// calculate offsets in loop
@@ -222,23 +227,23 @@ void optimizedDecodeLoops(LatteTextureLoaderCtx* textureLoader, uint8* outputDat
 		// unsure if this variant is faster:
 		if (textureLoader->computeAddrInfo.microTileType == 0 && (sizeof(texelBaseType)*texelBaseTypeCount) == 8)
 		{
-			optimizedDecodeLoop_tm04_numSamples1_8x8_optimizedRowCopy<texelBaseType, texelBaseTypeCount, isEncodeDirection, isCompressed>(textureLoader, outputData, texelCountX, texelCountY);
+			optimizedDecodeLoop_tm04_numSamples1_8x8_optimizedRowCopy<texelBaseType, texelBaseTypeCount, isEncodeDirection, isCompressed>(textureLoader, outputData, texelCountX, texelBeginY, texelEndY8);
 		}
 		else if (textureLoader->computeAddrInfo.microTileType == 0 && (sizeof(texelBaseType)*texelBaseTypeCount) == 4)
 		{
-			optimizedDecodeLoop_tm04_numSamples1_8x8_optimizedRowCopy<texelBaseType, texelBaseTypeCount, isEncodeDirection, isCompressed>(textureLoader, outputData, texelCountX, texelCountY);
+			optimizedDecodeLoop_tm04_numSamples1_8x8_optimizedRowCopy<texelBaseType, texelBaseTypeCount, isEncodeDirection, isCompressed>(textureLoader, outputData, texelCountX, texelBeginY, texelEndY8);
 		}
 		else if (textureLoader->computeAddrInfo.microTileType == 0 && (sizeof(texelBaseType)*texelBaseTypeCount) == 1)
 		{
-			optimizedDecodeLoop_tm04_numSamples1_8x8_optimizedRowCopy<texelBaseType, texelBaseTypeCount, isEncodeDirection, isCompressed>(textureLoader, outputData, texelCountX, texelCountY);
+			optimizedDecodeLoop_tm04_numSamples1_8x8_optimizedRowCopy<texelBaseType, texelBaseTypeCount, isEncodeDirection, isCompressed>(textureLoader, outputData, texelCountX, texelBeginY, texelEndY8);
 		}
 		else
 		{
-			optimizedDecodeLoop_tm04_numSamples1_8x8<texelBaseType, texelBaseTypeCount, isEncodeDirection, isCompressed>(textureLoader, outputData, texelCountX, texelCountY);
+			optimizedDecodeLoop_tm04_numSamples1_8x8<texelBaseType, texelBaseTypeCount, isEncodeDirection, isCompressed>(textureLoader, outputData, texelCountX, texelBeginY, texelEndY8);
 		}
 		// the above code only handles full 8x8 pixel blocks, for uneven sizes we need to process the remaining pixels here
 		// right border
-		for (sint32 yt = 0; yt < texelCountY; yt++)
+		for (sint32 yt = texelBeginY; yt < texelEndY8; yt++)
 		{
 			sint32 pixelOffset = (yt*textureLoader->decodedTexelCountX + texelCountX) * (sizeof(texelBaseType)*texelBaseTypeCount);
 			texelBaseType* blockOutput = (texelBaseType*)(outputData + pixelOffset);
@@ -272,7 +277,7 @@ void optimizedDecodeLoops(LatteTextureLoaderCtx* textureLoader, uint8* outputDat
 			}
 		}
 		// bottom border (with bottom right corner)
-		for (sint32 yt = texelCountY; yt < texelCountOrigY; yt++)
+		for (sint32 yt = texelEndY8; yt < texelEndY; yt++)
 		{
 			sint32 pixelOffset = (yt*textureLoader->decodedTexelCountX) * (sizeof(texelBaseType)*texelBaseTypeCount);
 			texelBaseType* blockOutput = (texelBaseType*)(outputData + pixelOffset);
@@ -310,7 +315,7 @@ void optimizedDecodeLoops(LatteTextureLoaderCtx* textureLoader, uint8* outputDat
 	{
 		// optimized handler for linear textures
 		uint32 sliceOffset = textureLoader->sliceIndex * textureLoader->height * textureLoader->pitch;
-		for (sint32 y = 0; y < texelCountY; y++)
+		for (sint32 y = texelBeginY; y < texelEndY; y++)
 		{
 			sint32 pixelOffset = (y*textureLoader->decodedTexelCountX) * (sizeof(texelBaseType)*texelBaseTypeCount);
 			texelBaseType* blockOutput = (texelBaseType*)(outputData + pixelOffset);
@@ -348,7 +353,7 @@ void optimizedDecodeLoops(LatteTextureLoaderCtx* textureLoader, uint8* outputDat
 	else
 	{
 		// generic handler
-		for (sint32 y = 0; y < textureLoader->height; y += textureLoader->stepY)
+		for (sint32 y = textureLoader->decodeBeginY; y < textureLoader->decodeEndY; y += textureLoader->stepY)
 		{
 			sint32 pixelOffset = ((y / textureLoader->stepY)*textureLoader->decodedTexelCountX) * (sizeof(texelBaseType)*texelBaseTypeCount);
 			texelBaseType* blockOutput = (texelBaseType*)(outputData + pixelOffset);
@@ -196,8 +196,11 @@ void memory_mapForCurrentTitle()
 	}
 }
 
+void _memory_writeTrackingReset();
+
 void memory_unmapForCurrentTitle()
 {
+    _memory_writeTrackingReset();
     for (auto& itr : g_mmuRanges)
     {
         if (itr->isMapped() && !itr->isMappedEarly())
@@ -412,6 +415,152 @@ void memory_createDump()
 	}
 }
 
+// write tracking state of a host page. Zero means the page was never armed, otherwise it is the arm generation shifted left by one and bit 0 is set once the page was written
+#define WRITE_TRACKING_DIRTY_BIT	(1u)
+
+struct
+{
+	std::atomic<uint32>* pageState{};
+	uint32 pageShift{};
+	std::atomic_bool isEnabled{};
+	std::shared_mutex hostWriteMutex; // held shared during host writes, arming pages requires exclusive access
+}s_writeTracking;
+
+void memory_writeTrackingEnable()
+{
+	if (s_writeTracking.isEnabled)
+		return;
+	size_t pageSize = MemMapper::GetPageSize();
+	if (!s_writeTracking.pageState)
+	{
+		s_writeTracking.pageShift = std::countr_zero(pageSize);
+		s_writeTracking.pageState = new std::atomic<uint32>[0x100000000ull >> s_writeTracking.pageShift]();
+	}
+	s_writeTracking.isEnabled = true;
+	cemuLog_log(LogType::Force, "Guest memory write tracking enabled ({}KB pages)", pageSize / 1024);
+}
+
+// must not be called while other threads can still arm pages
+void memory_writeTrackingDisable()
+{
+	if (!s_writeTracking.isEnabled)
+		return;
+	s_writeTracking.isEnabled = false;
+	const size_t pageCount = 0x100000000ull >> s_writeTracking.pageShift;
+	const size_t pageSize = (size_t)1 << s_writeTracking.pageShift;
+	for (size_t i = 0; i < pageCount; i++)
+	{
+		uint32 state = s_writeTracking.pageState[i].load(std::memory_order_relaxed);
+		if (state == 0 || (state & WRITE_TRACKING_DIRTY_BIT) != 0)
+			continue;
+		MemMapper::ProtectMemory(memory_base + (i << s_writeTracking.pageShift), pageSize, MemMapper::PAGE_PERMISSION::P_RW);
+		s_writeTracking.pageState[i].fetch_or(WRITE_TRACKING_DIRTY_BIT);
+	}
+	// pages stay flagged as dirty so that faults which are still in flight on other threads are handled. They are reset once guest memory is unmapped
+}
+
+// all threads which access guest memory must be stopped
+void _memory_writeTrackingReset()
+{
+	if (!s_writeTracking.pageState)
+		return;
+	cemu_assert_debug(!s_writeTracking.isEnabled);
+	const size_t pageCount = 0x100000000ull >> s_writeTracking.pageShift;
+	for (size_t i = 0; i < pageCount; i++)
+		s_writeTracking.pageState[i].store(0, std::memory_order_relaxed);
+}
+
+bool memory_writeTrackingIsEnabled()
+{
+	return s_writeTracking.isEnabled.load(std::memory_order_relaxed);
+}
+
+uint32 memory_writeTrackingGetPageSize()
+{
+	return 1u << s_writeTracking.pageShift;
+}
+
+uint32 memory_writeTrackingGetCleanGeneration(uint8* pagePtr)
+{
+	size_t pageIndex = (size_t)(pagePtr - memory_base) >> s_writeTracking.pageShift;
+	uint32 state = s_writeTracking.pageState[pageIndex].load(std::memory_order_acquire);
+	if ((state & WRITE_TRACKING_DIRTY_BIT) != 0)
+		return 0;
+	return state >> 1;
+}
+
+uint32 memory_writeTrackingArm(uint8* pagePtr)
+{
+	size_t pageIndex = (size_t)(pagePtr - memory_base) >> s_writeTracking.pageShift;
+	cemu_assert_debug(((size_t)(pagePtr - memory_base) & (memory_writeTrackingGetPageSize() - 1)) == 0);
+	uint32 state = s_writeTracking.pageState[pageIndex].load(std::memory_order_relaxed);
+	if (state != 0 && (state & WRITE_TRACKING_DIRTY_BIT) == 0)
+		return state >> 1; // already armed
+	uint32 generation = (state >> 1) + 1;
+	if (generation >= 0x80000000)
+		generation = 1;
+	// the state has to be updated before the page is protected. A write fault always observes the new state and can't be lost
+	s_writeTracking.pageState[pageIndex].store(generation << 1, std::memory_order_seq_cst);
+	MemMapper::ProtectMemory(pagePtr, memory_writeTrackingGetPageSize(), MemMapper::PAGE_PERMISSION::P_READ);
+	return generation;
+}
+
+// unprotect the page first and then flag it as dirty, otherwise the page could get armed again in between and the write would be missed
+void _memory_writeTrackingUnprotectPage(size_t pageIndex)
+{
+	MemMapper::ProtectMemory(memory_base + (pageIndex << s_writeTracking.pageShift), (size_t)1 << s_writeTracking.pageShift, MemMapper::PAGE_PERMISSION::P_RW);
+	s_writeTracking.pageState[pageIndex].fetch_or(WRITE_TRACKING_DIRTY_BIT, std::memory_order_seq_cst);
+}
+
+bool memory_writeTrackingTryLockArm()
+{
+	return s_writeTracking.hostWriteMutex.try_lock();
+}
+
+void memory_writeTrackingUnlockArm()
+{
+	s_writeTracking.hostWriteMutex.unlock();
+}
+
+// write tracking is opt-in, when it's off host writes skip the lock entirely. Tracking is enabled before the title starts, so it can't get turned on during a host write
+bool memory_writeTrackingBeginHostWrite(void* ptr, size_t size)
+{
+	if (!memory_writeTrackingIsEnabled() || size == 0)
+		return false;
+	if ((uint8*)ptr < memory_base || (uint8*)ptr >= memory_base + 0x100000000ull)
+		return false;
+	s_writeTracking.hostWriteMutex.lock_shared();
+	size_t firstPage = (size_t)((uint8*)ptr - memory_base) >> s_writeTracking.pageShift;
+	size_t lastPage = (std::min<size_t>((size_t)((uint8*)ptr - memory_base) + (size - 1), 0xFFFFFFFFull)) >> s_writeTracking.pageShift;
+	// dirty pages are included too. A page can briefly be protected while already flagged as dirty if it gets written while it is armed
+	for (size_t i = firstPage; i <= lastPage; i++)
+	{
+		if (s_writeTracking.pageState[i].load(std::memory_order_acquire) != 0)
+			_memory_writeTrackingUnprotectPage(i);
+	}
+	return true;
+}
+
+void memory_writeTrackingEndHostWrite(bool isTracked)
+{
+	if (isTracked)
+		s_writeTracking.hostWriteMutex.unlock_shared();
+}
+
+bool memory_writeTrackingHandleFault(void* faultAddress)
+{
+	if (!s_writeTracking.pageState || !memory_base)
+		return false;
+	if ((uint8*)faultAddress < memory_base || (uint8*)faultAddress >= memory_base + 0x100000000ull)
+		return false;
+	size_t pageIndex = (size_t)((uint8*)faultAddress - memory_base) >> s_writeTracking.pageShift;
+	// pages which were armed at least once are never reset while guest memory is mapped. Faults on dirty pages can happen when multiple threads write to the same page at once
+	if (s_writeTracking.pageState[pageIndex].load(std::memory_order_acquire) == 0)
+		return false;
+	_memory_writeTrackingUnprotectPage(pageIndex);
+	return true;
+}
+
 namespace MMU
 {
 	// MMIO access handler
@@ -139,6 +139,21 @@ MMURange* memory_getMMURangeByAddress(MPTR address);
 
 bool memory_isAddressRangeAccessible(MPTR virtualAddress, uint32 size);
 
+// optional write tracking for guest memory, used by the GPU buffer cache to skip hashing of unmodified pages
+// armed pages are write protected and the first write afterwards flags them as dirty. Granularity is the host page size
+// writes done by the OS kernel (file or socket reads directly into guest memory) don't raise a fault and would fail instead. Wrap them in memory_writeTrackingBeginHostWrite() and memory_writeTrackingEndHostWrite()
+void memory_writeTrackingEnable();
+void memory_writeTrackingDisable();
+bool memory_writeTrackingIsEnabled();
+uint32 memory_writeTrackingGetPageSize();
+uint32 memory_writeTrackingGetCleanGeneration(uint8* pagePtr); // returns the generation of the last arm or 0 if the page was written since then
+bool memory_writeTrackingTryLockArm(); // fails while a host write is in progress
+void memory_writeTrackingUnlockArm();
+uint32 memory_writeTrackingArm(uint8* pagePtr); // returns the new generation. pagePtr must be aligned to the tracking page size. Requires the arm lock
+bool memory_writeTrackingBeginHostWrite(void* ptr, size_t size); // returns false if the write doesn't need tracking, pass the result to memory_writeTrackingEndHostWrite()
+void memory_writeTrackingEndHostWrite(bool isTracked);
+bool memory_writeTrackingHandleFault(void* faultAddress); // called by the exception handler, returns true if the fault was caused by write tracking
+
 #define MEMORY_CODELOW0_ADDR				(0x00010000)
 #define MEMORY_CODELOW0_SIZE				(0x000F0000) // ~1MB
 
@@ -3,6 +3,7 @@
 #include "Cafe/IOSU/kernel/iosu_kernel.h"
 #include "Cafe/Filesystem/fsc.h"
 #include "util/helpers/helpers.h"
+#include "util/highresolutiontimer/HighResolutionTimer.h"
 
 #include "Cafe/OS/libs/coreinit/coreinit_FS.h"	 // get rid of this dependency, requires reworking some of the IPC stuff. See locations where we use coreinit::FSCmdBlockBody_t
 #include "Cafe/HW/Latte/Core/LatteBufferCache.h" // also remove this dependency
@@ -19,6 +20,113 @@ namespace iosu
 		SysAllocator<iosu::kernel::IOSMessage, 352> _m_sFSAIoMsgQueueMsgBuffer;
 		std::thread sFSAIoThread;
 
+		// ioctl commands are processed by a pool of host threads
+		// commands which operate on a file handle always go to the same worker and are processed in submission order, all other commands are ordered per client
+		// coreinit only keeps one command per FSClient in flight, so the priority order of the FSCmdQueue is preserved as well
+		#define FSA_IO_WORKER_COUNT		(4)
+
+		struct FSAPendingCommand
+		{
+			IPCCommandBody* cmd;
+			HRTick submitTick;
+		};
+
+		struct FSAIoWorker
+		{
+			std::thread thread;
+			std::mutex mutex;
+			std::condition_variable notifyCond;
+			std::deque<FSAPendingCommand> queue;
+			bool shutdown{false};
+		};
+
+		std::array<FSAIoWorker, FSA_IO_WORKER_COUNT> sFSAIoWorkers;
+
+		struct
+		{
+			std::atomic<uint32> queueDepth{};
+			std::atomic<uint32> maxQueueDepth{};
+			std::atomic<uint64> commandCount{};
+			std::atomic<uint64> latencyHistogram[FSA_LATENCY_HISTOGRAM_BUCKETS]{};
+			std::atomic<uint64> readAheadHits{};
+			std::atomic<uint64> readAheadMisses{};
+			std::atomic<uint64> readAheadBytes{};
+		}sFSAStats;
+
+		// read-ahead for sequentially read files
+		// after a few reads which continue where the previous read ended, the worker fills a buffer with the data that follows once it has no other commands queued
+		// the read-ahead state of a handle is only accessed by the worker which processes the commands of that handle
+		// only handles without write access use read-ahead. Any write, truncate, remove or rename invalidates all buffers
+		#define FSA_READAHEAD_BUFFER_SIZE		(512 * 1024)
+		#define FSA_READAHEAD_BUFFER_COUNT		(16)
+		#define FSA_READAHEAD_MIN_SEQ_READS		(2) // number of sequential reads before read-ahead starts
+
+		struct FSAReadAheadState
+		{
+			uint32 nextReadPos; // file position right after the previous read
+			uint32 sequentialReads;
+			uint8* buffer; // nullptr if no buffer is assigned
+			uint32 bufferFilePos;
+			uint32 bufferSize; // number of valid bytes
+			uint32 writeGeneration;
+
+			void Reset();
+		};
+
+		struct
+		{
+			std::mutex mutex;
+			std::vector<uint8*> freeBuffers;
+			uint32 numAllocatedBuffers{};
+		}sFSAReadAheadPool;
+
+		std::atomic<uint32> sFSAWriteGeneration{}; // incremented after a modification completed, a buffer filled while the modification was in progress is then discarded as well
+		thread_local uint32 t_fsaPendingReadAheadHandle = FS_INVALID_HANDLE_VALUE;
+
+		uint8* __FSAAcquireReadAheadBuffer()
+		{
+			std::unique_lock _l(sFSAReadAheadPool.mutex);
+			if (!sFSAReadAheadPool.freeBuffers.empty())
+			{
+				uint8* buffer = sFSAReadAheadPool.freeBuffers.back();
+				sFSAReadAheadPool.freeBuffers.pop_back();
+				return buffer;
+			}
+			if (sFSAReadAheadPool.numAllocatedBuffers >= FSA_READAHEAD_BUFFER_COUNT)
+				return nullptr;
+			sFSAReadAheadPool.numAllocatedBuffers++;
+			return new uint8[FSA_READAHEAD_BUFFER_SIZE];
+		}
+
+		void __FSAReleaseReadAheadBuffer(uint8* buffer)
+		{
+			std::unique_lock _l(sFSAReadAheadPool.mutex);
+			sFSAReadAheadPool.freeBuffers.emplace_back(buffer);
+		}
+
+		// all buffers must have been released back to the pool
+		void __FSAFreeReadAheadBuffers()
+		{
+			std::unique_lock _l(sFSAReadAheadPool.mutex);
+			cemu_assert_debug(sFSAReadAheadPool.freeBuffers.size() == sFSAReadAheadPool.numAllocatedBuffers);
+			for (uint8* buffer : sFSAReadAheadPool.freeBuffers)
+				delete[] buffer;
+			sFSAReadAheadPool.freeBuffers.clear();
+			sFSAReadAheadPool.numAllocatedBuffers = 0;
+		}
+
+		void FSAReadAheadState::Reset()
+		{
+			if (buffer)
+				__FSAReleaseReadAheadBuffer(buffer);
+			nextReadPos = 0;
+			sequentialReads = 0;
+			buffer = nullptr;
+			bufferFilePos = 0;
+			bufferSize = 0;
+			writeGeneration = 0;
+		}
+
 		struct FSAClient // IOSU's counterpart to the coreinit FSClient struct
 		{
 			std::string workingDirectory;
@@ -174,11 +282,13 @@ namespace iosu
 				bool isAllocated{false};
 				FSCVirtualFile* fscFile;
 				uint16 handleCheckValue;
+				FSAReadAheadState readAhead{};
 			};
 
 		public:
 			FSA_RESULT AllocateHandle(FSResHandle& handleOut, FSCVirtualFile* fscFile)
 			{
+				std::unique_lock _l(m_mutex);
 				for (size_t i = 0; i < m_handleTable.size(); i++)
 				{
 					auto& it = m_handleTable.at(i);
@@ -189,6 +299,7 @@ namespace iosu
 					it.handleCheckValue = checkValue;
 					it.fscFile = fscFile;
 					it.isAllocated = true;
+					it.readAhead.Reset();
 					uint32 handleVal = ((uint32)i << 16) | (uint32)checkValue;
 					handleOut = (FSResHandle)handleVal;
 					return FSA_RESULT::OK;
@@ -199,6 +310,7 @@ namespace iosu
 
 			FSA_RESULT ReleaseHandle(FSResHandle handle)
 			{
+				std::unique_lock _l(m_mutex);
 				uint16 index = (uint16)((uint32)handle >> 16);
 				uint16 checkValue = (uint16)(handle & 0xFFFF);
 				if (index >= m_handleTable.size())
@@ -210,11 +322,13 @@ namespace iosu
 					return FSA_RESULT::INVALID_FILE_HANDLE;
 				it.fscFile = nullptr;
 				it.isAllocated = false;
+				it.readAhead.Reset();
 				return FSA_RESULT::OK;
 			}
 
 			FSCVirtualFile* GetByHandle(FSResHandle handle)
 			{
+				std::unique_lock _l(m_mutex);
 				uint16 index = (uint16)((uint32)handle >> 16);
 				uint16 checkValue = (uint16)(handle & 0xFFFF);
 				if (index >= m_handleTable.size())
@@ -227,7 +341,30 @@ namespace iosu
 				return it.fscFile;
 			}
 
+			// the returned state must only be accessed by the worker which processes the commands of this handle
+			FSAReadAheadState* GetReadAheadState(FSResHandle handle)
+			{
+				std::unique_lock _l(m_mutex);
+				uint16 index = (uint16)((uint32)handle >> 16);
+				uint16 checkValue = (uint16)(handle & 0xFFFF);
+				if (index >= m_handleTable.size())
+					return nullptr;
+				auto& it = m_handleTable.at(index);
+				if (!it.isAllocated || it.handleCheckValue != checkValue)
+					return nullptr;
+				return &it.readAhead;
+			}
+
+			// gives the read-ahead buffers of handles which are still open back to the pool. IO workers must be stopped
+			void ReleaseReadAheadBuffers()
+			{
+				std::unique_lock _l(m_mutex);
+				for (auto& it : m_handleTable)
+					it.readAhead.Reset();
+			}
+
 		private:
+			std::mutex m_mutex; // handles are allocated and released by multiple IO workers
 			uint32 m_currentCounter = 1;
 			std::array<_FSAHandleResource, 0x3C0> m_handleTable;
 		};
@@ -347,6 +484,7 @@ namespace iosu
 			std::string path = __FSATranslatePath(client, (char*)shimBuffer->request.cmdRemove.path);
 			sint32 fscStatus = FSC_STATUS_FILE_NOT_FOUND;
 			fsc_remove(path.c_str(), &fscStatus);
+			sFSAWriteGeneration++;
 			return FSA_convertFSCtoFSAStatus(fscStatus);
 		}
 
@@ -364,6 +502,7 @@ namespace iosu
 			std::string dstPath = __FSATranslatePath(client, (char*)shimBuffer->request.cmdRename.dstPath);
 			sint32 fscStatus = FSC_STATUS_FILE_NOT_FOUND;
 			fsc_rename(srcPath.c_str(), dstPath.c_str(), &fscStatus);
+			sFSAWriteGeneration++;
 			return FSA_convertFSCtoFSAStatus(fscStatus);
 		}
 
@@ -453,6 +592,94 @@ namespace iosu
 			return FSA_RESULT::OK;
 		}
 
+		uint32 __FSAReadWithReadAhead(FSCVirtualFile* fscFile, FSAReadAheadState* readAhead, uint8* dest, uint32 size)
+		{
+			uint32 readPos = fsc_getFileSeek(fscFile);
+			if (readAhead->writeGeneration != sFSAWriteGeneration.load())
+				readAhead->bufferSize = 0; // file might have been modified
+			// copy as much as possible from the read-ahead buffer
+			uint32 bytesCopied = 0;
+			if (readPos >= readAhead->bufferFilePos && readPos < readAhead->bufferFilePos + readAhead->bufferSize)
+			{
+				uint32 bufferOffset = readPos - readAhead->bufferFilePos;
+				bytesCopied = std::min(size, readAhead->bufferSize - bufferOffset);
+				memcpy(dest, readAhead->buffer + bufferOffset, bytesCopied);
+			}
+			uint32 bytesRead = bytesCopied;
+			if (bytesCopied < size)
+			{
+				if (bytesCopied != 0)
+					fsc_setFileSeek(fscFile, readPos + bytesCopied);
+				bytesRead += fsc_readFile(fscFile, dest + bytesCopied, size - bytesCopied);
+			}
+			else
+				fsc_setFileSeek(fscFile, readPos + bytesCopied);
+			if (readAhead->buffer)
+			{
+				if (bytesCopied == size)
+					sFSAStats.readAheadHits++;
+				else
+					sFSAStats.readAheadMisses++;
+			}
+			// detect sequential access
+			if (readPos == readAhead->nextReadPos)
+				readAhead->sequentialReads++;
+			else
+				readAhead->sequentialReads = 0;
+			readAhead->nextReadPos = readPos + bytesRead;
+			return bytesRead;
+		}
+
+		// called by the worker after replying to a read command
+		void __FSAFillReadAheadBuffer(uint32 fileHandle)
+		{
+			FSCVirtualFile* fscFile = sFileHandleTable.GetByHandle(fileHandle);
+			FSAReadAheadState* readAhead = sFileHandleTable.GetReadAheadState(fileHandle);
+			if (!fscFile || !readAhead)
+				return;
+			uint32 nextReadPos = readAhead->nextReadPos;
+			if (readAhead->sequentialReads < FSA_READAHEAD_MIN_SEQ_READS)
+			{
+				// access is not sequential (anymore), give the buffer back to the pool
+				if (readAhead->buffer)
+				{
+					__FSAReleaseReadAheadBuffer(readAhead->buffer);
+					readAhead->buffer = nullptr;
+					readAhead->bufferSize = 0;
+				}
+				return;
+			}
+			uint32 writeGeneration = sFSAWriteGeneration.load();
+			if (readAhead->writeGeneration != writeGeneration)
+				readAhead->bufferSize = 0;
+			// keep the remaining buffered data
+			uint32 bytesKept = 0;
+			if (nextReadPos >= readAhead->bufferFilePos && nextReadPos < readAhead->bufferFilePos + readAhead->bufferSize)
+				bytesKept = readAhead->bufferFilePos + readAhead->bufferSize - nextReadPos;
+			if (bytesKept >= FSA_READAHEAD_BUFFER_SIZE / 2)
+				return; // enough data is buffered
+			uint32 fileSize = fsc_getFileSize(fscFile);
+			if (nextReadPos + bytesKept >= fileSize)
+				return;
+			if (!readAhead->buffer)
+			{
+				readAhead->buffer = __FSAAcquireReadAheadBuffer();
+				if (!readAhead->buffer)
+					return; // all buffers are in use
+			}
+			if (bytesKept != 0)
+				memmove(readAhead->buffer, readAhead->buffer + (nextReadPos - readAhead->bufferFilePos), bytesKept);
+			uint32 bytesToRead = std::min<uint32>(FSA_READAHEAD_BUFFER_SIZE - bytesKept, fileSize - (nextReadPos + bytesKept));
+			uint32 filePos = fsc_getFileSeek(fscFile);
+			fsc_setFileSeek(fscFile, nextReadPos + bytesKept);
+			uint32 bytesRead = fsc_readFile(fscFile, readAhead->buffer + bytesKept, bytesToRead);
+			fsc_setFileSeek(fscFile, filePos);
+			readAhead->bufferFilePos = nextReadPos;
+			readAhead->bufferSize = bytesKept + bytesRead;
+			readAhead->writeGeneration = writeGeneration;
+			sFSAStats.readAheadBytes += bytesRead;
+		}
+
 		FSA_RESULT FSAProcessCmd_read(FSAClient* client, FSAShimBuffer* shimBuffer, MEMPTR<void> destPtr, uint32be transferSize)
 		{
 			uint32 transferElementSize = shimBuffer->request.cmdReadFile.size;
@@ -469,7 +696,17 @@ namespace iosu
 			if ((flags & FSA_CMD_FLAG_SET_POS) != 0)
 				fsc_setFileSeek(fscFile, filePos);
 			// todo: File permissions
-			uint32 bytesSuccessfullyRead = fsc_readFile(fscFile, destPtr, bytesToRead);
+			uint32 bytesSuccessfullyRead;
+			FSAReadAheadState* readAhead = sFileHandleTable.GetReadAheadState(fileHandle);
+			bool isTrackedWrite = memory_writeTrackingBeginHostWrite(destPtr.GetPtr(), bytesToRead);
+			if (readAhead && !fsc_isWritable(fscFile))
+			{
+				bytesSuccessfullyRead = __FSAReadWithReadAhead(fscFile, readAhead, (uint8*)destPtr.GetPtr(), bytesToRead);
+				t_fsaPendingReadAheadHandle = fileHandle;
+			}
+			else
+				bytesSuccessfullyRead = fsc_readFile(fscFile, destPtr, bytesToRead);
+			memory_writeTrackingEndHostWrite(isTrackedWrite);
 			if (transferElementSize == 0)
 				return FSA_RESULT::OK;
 
@@ -500,6 +737,7 @@ namespace iosu
 			if ((flags & FSA_CMD_FLAG_SET_POS) != 0)
 				fsc_setFileSeek(fscFile, filePos);
 			uint32 bytesSuccessfullyWritten = fsc_writeFile(fscFile, destPtr, bytesToWrite);
+			sFSAWriteGeneration++;
 			debug_printf("FSAProcessCmd_write(): Writing 0x%08x bytes (bytes actually written: 0x%08x)\n", bytesToWrite, bytesSuccessfullyWritten);
 			return (FSA_RESULT)(bytesSuccessfullyWritten / transferElementSize); // return number of elements read
 		}
@@ -628,6 +866,7 @@ namespace iosu
 			if (!fscFile)
 				return FSA_RESULT::INVALID_FILE_HANDLE;
 			fsc_setFileLength(fscFile, fsc_getFileSeek(fscFile));
+			sFSAWriteGeneration++;
 			return FSA_RESULT::OK;
 		}
 
@@ -830,6 +1069,124 @@ namespace iosu
 			IOS_ResourceReply(cmd, (IOS_ERROR)fsaResult);
 		}
 
+		void FSAExecuteCommand(IPCCommandBody* cmd)
+		{
+			uint32 clientHandle = (uint32)cmd->devHandle;
+			cemu_assert(clientHandle < sFSAClientArray.size());
+			cemu_assert(sFSAClientArray[clientHandle].isAllocated);
+			if (cmd->cmdId == IPCCommandId::IOS_IOCTL)
+			{
+				FSAHandleCommandIoctl(sFSAClientArray.data() + clientHandle, cmd, (FSA_CMD_OPERATION_TYPE)cmd->args[0].value(), MEMPTR<void>(cmd->args[1]), MEMPTR<void>(cmd->args[3]));
+			}
+			else
+			{
+				FSA_CMD_OPERATION_TYPE requestId = (FSA_CMD_OPERATION_TYPE)cmd->args[0].value();
+				uint32 numIn = cmd->args[1];
+				uint32 numOut = cmd->args[2];
+				IPCIoctlVector* vec = MEMPTR<IPCIoctlVector>{cmd->args[3]}.GetPtr();
+				FSAHandleCommandIoctlv(sFSAClientArray.data() + clientHandle, cmd, requestId, numIn, numOut, vec);
+			}
+		}
+
+		// returns the file handle used by the command or FS_INVALID_HANDLE_VALUE if the command does not operate on an open file
+		uint32 __FSAGetCommandFileHandle(IPCCommandBody* cmd)
+		{
+			FSA_CMD_OPERATION_TYPE operationId = (FSA_CMD_OPERATION_TYPE)cmd->args[0].value();
+			if (cmd->cmdId == IPCCommandId::IOS_IOCTLV)
+			{
+				if (operationId != FSA_CMD_OPERATION_TYPE::READ && operationId != FSA_CMD_OPERATION_TYPE::WRITE)
+					return FS_INVALID_HANDLE_VALUE;
+				IPCIoctlVector* vec = MEMPTR<IPCIoctlVector>{cmd->args[3]}.GetPtr();
+				FSAShimBuffer* shimBuffer = (FSAShimBuffer*)vec[0].basePhys.GetPtr();
+				if (operationId == FSA_CMD_OPERATION_TYPE::READ)
+					return shimBuffer->request.cmdReadFile.fileHandle;
+				return shimBuffer->request.cmdWriteFile.fileHandle;
+			}
+			FSAShimBuffer* shimBuffer = MEMPTR<FSAShimBuffer>(cmd->args[1]).GetPtr();
+			switch (operationId)
+			{
+			case FSA_CMD_OPERATION_TYPE::GETPOS:
+				return shimBuffer->request.cmdGetPosFile.fileHandle;
+			case FSA_CMD_OPERATION_TYPE::SETPOS:
+				return shimBuffer->request.cmdSetPosFile.fileHandle;
+			case FSA_CMD_OPERATION_TYPE::ISEOF:
+				return shimBuffer->request.cmdIsEof.fileHandle;
+			case FSA_CMD_OPERATION_TYPE::GETSTATFILE:
+				return shimBuffer->request.cmdGetStatFile.fileHandle;
+			case FSA_CMD_OPERATION_TYPE::CLOSEFILE:
+				return shimBuffer->request.cmdCloseFile.fileHandle;
+			case FSA_CMD_OPERATION_TYPE::APPENDFILE:
+				return shimBuffer->request.cmdAppendFile.fileHandle;
+			case FSA_CMD_OPERATION_TYPE::TRUNCATEFILE:
+				return shimBuffer->request.cmdTruncateFile.fileHandle;
+			case FSA_CMD_OPERATION_TYPE::FLUSHFILE:
+				return shimBuffer->request.cmdFlushFile.fileHandle;
+			default:
+				break;
+			}
+			return FS_INVALID_HANDLE_VALUE;
+		}
+
+		void __FSARecordCommandDone(HRTick submitTick)
+		{
+			uint64 latencyUs = HighResolutionTimer::ticksToMicroseconds(HighResolutionTimer::now().getTick() - submitTick);
+			uint32 bucket = 0;
+			while (bucket < FSA_LATENCY_HISTOGRAM_BUCKETS - 1 && latencyUs >= (16ull << bucket))
+				bucket++;
+			sFSAStats.latencyHistogram[bucket]++;
+			sFSAStats.commandCount++;
+			sFSAStats.queueDepth--;
+		}
+
+		void FSAIoWorkerThread(sint32 workerIndex)
+		{
+			SetThreadName(fmt::format("IOSU-FSA-{}", workerIndex).c_str());
+			FSAIoWorker& worker = sFSAIoWorkers[workerIndex];
+			std::unique_lock _l(worker.mutex);
+			while (true)
+			{
+				worker.notifyCond.wait(_l, [&]() { return !worker.queue.empty() || worker.shutdown; });
+				if (worker.queue.empty())
+					return; // shutdown signaled
+				FSAPendingCommand pendingCmd = worker.queue.front();
+				worker.queue.pop_front();
+				_l.unlock();
+				FSAExecuteCommand(pendingCmd.cmd);
+				__FSARecordCommandDone(pendingCmd.submitTick);
+				_l.lock();
+				if (t_fsaPendingReadAheadHandle != FS_INVALID_HANDLE_VALUE)
+				{
+					// only read ahead if there are no other commands waiting
+					uint32 fileHandle = t_fsaPendingReadAheadHandle;
+					t_fsaPendingReadAheadHandle = FS_INVALID_HANDLE_VALUE;
+					if (worker.queue.empty())
+					{
+						_l.unlock();
+						__FSAFillReadAheadBuffer(fileHandle);
+						_l.lock();
+					}
+				}
+			}
+		}
+
+		void FSASubmitToWorker(IPCCommandBody* cmd)
+		{
+			uint32 fileHandle = __FSAGetCommandFileHandle(cmd);
+			uint32 workerIndex;
+			if (fileHandle != FS_INVALID_HANDLE_VALUE)
+				workerIndex = (fileHandle >> 16) % FSA_IO_WORKER_COUNT; // upper 16 bits are the handle table index
+			else
+				workerIndex = (uint32)cmd->devHandle % FSA_IO_WORKER_COUNT;
+			uint32 queueDepth = ++sFSAStats.queueDepth;
+			uint32 maxQueueDepth = sFSAStats.maxQueueDepth.load();
+			while (queueDepth > maxQueueDepth && !sFSAStats.maxQueueDepth.compare_exchange_weak(maxQueueDepth, queueDepth)) {}
+			FSAIoWorker& worker = sFSAIoWorkers[workerIndex];
+			worker.mutex.lock();
+			worker.queue.push_back({ cmd, HighResolutionTimer::now().getTick() });
+			worker.mutex.unlock();
+			worker.notifyCond.notify_one();
+		}
+
 		void FSAIoThread()
 		{
 			SetThreadName("IOSU-FSA");
@@ -861,21 +1218,9 @@ namespace iosu
 					IOS_ResourceReply(cmd, IOS_ERROR_OK);
 					continue;
 				}
-				else if (cmd->cmdId == IPCCommandId::IOS_IOCTL)
-				{
-					cemu_assert(clientHandle < sFSAClientArray.size());
-					cemu_assert(sFSAClientArray[clientHandle].isAllocated);
-					FSAHandleCommandIoctl(sFSAClientArray.data() + clientHandle, cmd, (FSA_CMD_OPERATION_TYPE)cmd->args[0].value(), MEMPTR<void>(cmd->args[1]), MEMPTR<void>(cmd->args[3]));
-				}
-				else if (cmd->cmdId == IPCCommandId::IOS_IOCTLV)
+				else if (cmd->cmdId == IPCCommandId::IOS_IOCTL || cmd->cmdId == IPCCommandId::IOS_IOCTLV)
 				{
-					cemu_assert(clientHandle < sFSAClientArray.size());
-					cemu_assert(sFSAClientArray[clientHandle].isAllocated);
-					FSA_CMD_OPERATION_TYPE requestId = (FSA_CMD_OPERATION_TYPE)cmd->args[0].value();
-					uint32 numIn = cmd->args[1];
-					uint32 numOut = cmd->args[2];
-					IPCIoctlVector* vec = MEMPTR<IPCIoctlVector>{cmd->args[3]}.GetPtr();
-					FSAHandleCommandIoctlv(sFSAClientArray.data() + clientHandle, cmd, requestId, numIn, numOut, vec);
+					FSASubmitToWorker(cmd);
 				}
 				else
 				{
@@ -886,14 +1231,41 @@ namespace iosu
 			}
 		}
 
+		FSAStatistics GetStatistics()
+		{
+			FSAStatistics stats{};
+			stats.queueDepth = sFSAStats.queueDepth.load();
+			stats.maxQueueDepth = sFSAStats.maxQueueDepth.load();
+			stats.commandCount = sFSAStats.commandCount.load();
+			for (sint32 i = 0; i < FSA_LATENCY_HISTOGRAM_BUCKETS; i++)
+				stats.latencyHistogram[i] = sFSAStats.latencyHistogram[i].load();
+			stats.readAheadHits = sFSAStats.readAheadHits.load();
+			stats.readAheadMisses = sFSAStats.readAheadMisses.load();
+			stats.readAheadBytes = sFSAStats.readAheadBytes.load();
+			return stats;
+		}
+
 		void Initialize()
 		{
 			for (auto& it : sFSAClientArray)
 				it.ReleaseAndCleanup();
+			sFSAStats.queueDepth = 0;
+			sFSAStats.maxQueueDepth = 0;
+			sFSAStats.commandCount = 0;
+			for (auto& it : sFSAStats.latencyHistogram)
+				it = 0;
+			sFSAStats.readAheadHits = 0;
+			sFSAStats.readAheadMisses = 0;
+			sFSAStats.readAheadBytes = 0;
 			sFSAIoMsgQueue = (IOSMsgQueueId)IOS_CreateMessageQueue(_m_sFSAIoMsgQueueMsgBuffer.GetPtr(), _m_sFSAIoMsgQueueMsgBuffer.GetCount());
 			IOS_ERROR r = IOS_RegisterResourceManager("/dev/fsa", sFSAIoMsgQueue);
 			IOS_DeviceAssociateId("/dev/fsa", 11);
 			cemu_assert(!IOS_ResultIsError(r));
+			for (sint32 i = 0; i < FSA_IO_WORKER_COUNT; i++)
+			{
+				sFSAIoWorkers[i].shutdown = false;
+				sFSAIoWorkers[i].thread = std::thread(FSAIoWorkerThread, i);
+			}
 			sFSAIoThread = std::thread(FSAIoThread);
 		}
 
@@ -901,6 +1273,31 @@ namespace iosu
 		{
 			IOS_SendMessage(sFSAIoMsgQueue, 0, 0);
 			sFSAIoThread.join();
+			// workers finish their queued commands before exiting
+			for (auto& it : sFSAIoWorkers)
+			{
+				it.mutex.lock();
+				it.shutdown = true;
+				it.mutex.unlock();
+				it.notifyCond.notify_one();
+				it.thread.join();
+			}
+			sFileHandleTable.ReleaseReadAheadBuffers();
+			__FSAFreeReadAheadBuffers();
+			FSAStatistics stats = GetStatistics();
+			if (stats.commandCount != 0 && cemuLog_isLoggingEnabled(LogType::Statistics))
+			{
+				std::string histogram;
+				for (sint32 i = 0; i < FSA_LATENCY_HISTOGRAM_BUCKETS; i++)
+				{
+					if (i == FSA_LATENCY_HISTOGRAM_BUCKETS - 1)
+						histogram.append(fmt::format(" >={}us:{}", 16ull << (i - 1), stats.latencyHistogram[i]));
+					else
+						histogram.append(fmt::format(" <{}us:{}", 16ull << i, stats.latencyHistogram[i]));
+				}
+				cemuLog_log(LogType::Statistics, "FSA: Processed {} commands, max queue depth {}. Latency:{}", stats.commandCount, stats.maxQueueDepth, histogram);
+				cemuLog_log(LogType::Statistics, "FSA: Read-ahead hits {} misses {} ({}MB read ahead)", stats.readAheadHits, stats.readAheadMisses, stats.readAheadBytes / 1024 / 1024);
+			}
 		}
 	} // namespace fsa
 } // namespace iosu
@@ -211,6 +211,22 @@ namespace iosu
 		};
 		static_assert(sizeof(FSAShimBuffer) == 0x938); // exact size of this is not known
 
+		#define FSA_LATENCY_HISTOGRAM_BUCKETS	(12)
+
+		struct FSAStatistics
+		{
+			uint32 queueDepth; // commands which are queued or being processed
+			uint32 maxQueueDepth;
+			uint64 commandCount;
+			uint64 latencyHistogram[FSA_LATENCY_HISTOGRAM_BUCKETS]; // bucket i counts commands which completed in less than 16us << i, the last bucket counts all slower commands
+			// reads on handles with a read-ahead buffer. A hit was served entirely from memory
+			uint64 readAheadHits;
+			uint64 readAheadMisses;
+			uint64 readAheadBytes;
+		};
+
+		FSAStatistics GetStatistics();
+
 		void Initialize();
 		void Shutdown();
 	} // namespace fsa
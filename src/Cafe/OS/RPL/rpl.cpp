@@ -159,6 +159,8 @@ MPTR _generateTrampolineFarJump(RPLModule* rplLoaderContext, MPTR destAddr)
 	memory_writeU32(trampolineAddr + 0x8, 0x7D6903A6);
 	// BCTR
 	memory_writeU32(trampolineAddr + 0xC, 0x4E800420);
+	// the trampoline area is reused by the next title
+	PPCRecompiler_invalidateRange(trampolineAddr, trampolineAddr + 4*4);
 	// if the destination is a known symbol, create a proxy (duplicate) symbol at the jump
 	rplSymbolStorage_createJumpProxySymbol(trampolineAddr, destAddr);
 	rplLoaderContext->trampolineMap.emplace(destAddr, trampolineAddr);
@@ -728,6 +730,7 @@ uint32 RPLLoader_MakePPCCallable(void(*ppcCallableExport)(PPCInterpreter_t* hCPU
 	MPTR codeAddr = memory_getVirtualOffsetFromPointer(RPLLoader_AllocateTrampolineCodeSpace(4));
 	uint32 opcode = (1 << 26) | functionIndex;
 	memory_write<uint32>(codeAddr, opcode);
+	PPCRecompiler_invalidateRange(codeAddr, codeAddr + 4);
 	g_map_callableExports[ppcCallableExport] = codeAddr;
 	return codeAddr;
 }
@@ -766,6 +769,7 @@ uint32 rpl_mapHLEImport(RPLModule* rplLoaderContext, const char* rplName, const
 		MPTR codeAddr = memory_getVirtualOffsetFromPointer(RPLLoader_AllocateTrampolineCodeSpace(4));
 		uint32 opcode = (1 << 26) | functionIndex;
 		memory_write<uint32>(codeAddr, opcode);
+		PPCRecompiler_invalidateRange(codeAddr, codeAddr + 4);
 		// register mapped import
 		mappedFunctionImport_t newImport;
 		newImport.hash1 = mappedImportHash1;
@@ -787,6 +791,7 @@ uint32 rpl_mapHLEImport(RPLModule* rplLoaderContext, const char* rplName, const
 	uint32 opcode = (1 << 26) | (0xFFD0); // opcode for HLE: Unsupported import
 	memory_write<uint32>(codeStart + 0, opcode);
 	memory_write<uint32>(codeStart + 4, 0x4E800020);
+	PPCRecompiler_invalidateRange(codeStart, codeStart + 8);
 	currentAddress += 8;
 	// write name of lib/function
 	sint32 libNameLength = std::min(128, (sint32)strlen(libName));
@@ -1878,6 +1883,7 @@ void RPLLoader_Link()
 		RPLLoader_LoadDebugSymbols(rplModuleList[i]);
 		rplModuleList[i]->isLinked = true; // mark as linked
 		GraphicPack2::NotifyModuleLoaded(rplModuleList[i]);
+		PPCRecompiler_notifyModuleLoaded(rplModuleList[i]->regionMappingBase_text.GetMPTR(), rplModuleList[i]->regionSize_text);
 		debuggerWindow_notifyModuleLoaded(rplModuleList[i]);
 	}
 }
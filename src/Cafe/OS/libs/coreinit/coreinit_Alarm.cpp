@@ -17,26 +17,44 @@ namespace coreinit
 	SysAllocator<char, 32> _g_alarmThreadName;
 
 
+	// host alarms are kept in a hierarchical timing wheel, arming and cancelling an alarm is O(1)
+	// a level 0 slot covers one granule of timer ticks, a slot on the next level covers one whole revolution of the level below
+	// whenever a level wraps around the matching slot of the level above is cascaded (redistributed) downwards
+	#define ALARM_WHEEL_GRANULE_SHIFT	(12) // 4096 ticks (~66us)
+	#define ALARM_WHEEL_SLOT_BITS		(6)
+	#define ALARM_WHEEL_SLOT_COUNT		(1 << ALARM_WHEEL_SLOT_BITS)
+	#define ALARM_WHEEL_LEVEL_COUNT		(4) // covers 2^36 ticks (~18 minutes), alarms further in the future are kept in an overflow list
+
 	class OSHostAlarm 
 	{
+		struct AlarmList
+		{
+			OSHostAlarm* head{};
+		};
+
+		static constexpr sint32 LEVEL_DUE = -1; // alarm is in the list of expired alarms which are about to be triggered
+		static constexpr sint32 LEVEL_OVERFLOW = ALARM_WHEEL_LEVEL_COUNT;
+
 	public:
 		OSHostAlarm(uint64 nextFire, uint64 period, void(*callbackFunc)(uint64 currentTick, void* context), void* context) : m_nextFire(nextFire), m_period(period), m_callbackFunc(callbackFunc), m_context(context)
 		{
 			cemu_assert_debug(__OSHasSchedulerLock()); // must hold lock
-			auto r = g_activeAlarmList.emplace(this);
-			cemu_assert_debug(r.second); // check if insertion was successful
-			m_isActive = true;
-			updateEarliestAlarmAtomic();
+			if (isWheelEmpty())
+				g_wheelTime = OSGetTime() >> ALARM_WHEEL_GRANULE_SHIFT;
+			insertIntoWheel();
+			if (m_nextFire < g_soonestAlarm)
+			{
+				g_soonestAlarm = m_nextFire;
+				__OSWakeupIdleMainCore(); // the main core may be sleeping until the previous deadline
+			}
 		}
 
 		~OSHostAlarm()
 		{
 			cemu_assert_debug(__OSHasSchedulerLock()); // must hold lock
-			if (m_isActive)
-			{
-				g_activeAlarmList.erase(g_activeAlarmList.find(this));
-				updateEarliestAlarmAtomic();
-			}
+			// g_soonestAlarm is allowed to be earlier than the actual soonest alarm, it's corrected on the next update
+			if (m_list)
+				unlink();
 		}
 
 		uint64 getFireTick() const
@@ -49,61 +67,26 @@ namespace coreinit
 			m_callbackFunc(currentTick, m_context);
 		}
 
-		static void updateEarliestAlarmAtomic()
-		{
-			cemu_assert_debug(__OSHasSchedulerLock());
-			if (!g_activeAlarmList.empty())
-			{
-				auto firstAlarm = g_activeAlarmList.begin();
-				g_soonestAlarm = (*firstAlarm)->m_nextFire;
-			}
-			else
-			{
-				g_soonestAlarm = std::numeric_limits<uint64>::max();
-			}
-		}
-
 		static void updateAlarms(uint64 currentTick)
 		{
 			cemu_assert_debug(__OSHasSchedulerLock());
-			if (g_activeAlarmList.empty())
-				return;
-
-			// debug begin
-#ifdef CEMU_DEBUG_ASSERT
-			uint64 prevTick = 0;
-			auto itr = g_activeAlarmList.begin();
-			while (itr != g_activeAlarmList.end())
-			{
-				uint64 t = (*itr)->m_nextFire;
-				if (t < prevTick)
-					cemu_assert_suspicious();
-				prevTick = t;
-				++itr;
-			}
-#endif
-			// debug end
-			while (true)
+			collectDueAlarms(currentTick);
+			while (g_dueList.head)
 			{
-				auto firstAlarm = g_activeAlarmList.begin();
-				if (currentTick >= (*firstAlarm)->m_nextFire)
+				OSHostAlarm* alarm = g_dueList.head;
+				alarm->unlink();
+				alarm->triggerAlarm(currentTick);
+				// if periodic alarm then requeue
+				if (alarm->m_period > 0)
 				{
-					OSHostAlarm* alarm = *firstAlarm;
-					g_activeAlarmList.erase(firstAlarm);
-					alarm->triggerAlarm(currentTick);
-					// if periodic alarm then requeue
-					if (alarm->m_period > 0)
-					{
-						alarm->m_nextFire += alarm->m_period;
-						g_activeAlarmList.emplace(alarm);
-					}
+					alarm->m_nextFire += alarm->m_period;
+					if (alarm->m_nextFire <= currentTick)
+						alarm->insertIntoDueList();
 					else
-						alarm->m_isActive = false;
-					updateEarliestAlarmAtomic();
+						alarm->insertIntoWheel();
 				}
-				else
-					break;
-			}	
+			}
+			updateSoonestFireTick();
 		}
 
 		uint64 getNextFire() const 
@@ -111,6 +94,11 @@ namespace coreinit
 			return m_nextFire;
 		}
 
+		static uint64 getSoonestFireTick()
+		{
+			return g_soonestAlarm;
+		}
+
 		static bool quickCheckForAlarm(uint64 currentTick)
 		{
 			// fast way to check if any alarm was triggered without requiring scheduler lock
@@ -119,7 +107,21 @@ namespace coreinit
 
         static void Reset()
         {
-            g_activeAlarmList.clear();
+			auto clearList = [](AlarmList& list)
+			{
+				for (OSHostAlarm* alarm = list.head; alarm; alarm = alarm->m_next)
+					alarm->m_list = nullptr;
+				list.head = nullptr;
+			};
+			for (sint32 level = 0; level < ALARM_WHEEL_LEVEL_COUNT; level++)
+			{
+				for (auto& slot : g_wheel[level])
+					clearList(slot);
+				g_wheelMask[level] = 0;
+			}
+			clearList(g_wheelOverflow);
+			clearList(g_dueList);
+			g_wheelTime = 0;
             g_soonestAlarm = 0;
         }
 
@@ -136,21 +138,185 @@ namespace coreinit
 			}
 		};
 
-	private:	
+	private:
+		void linkInto(AlarmList& list, sint32 level, uint32 slot, OSHostAlarm* prev)
+		{
+			m_list = &list;
+			m_level = level;
+			m_slot = slot;
+			m_prev = prev;
+			m_next = prev ? prev->m_next : list.head;
+			if (prev)
+				prev->m_next = this;
+			else
+				list.head = this;
+			if (m_next)
+				m_next->m_prev = this;
+		}
+
+		void unlink()
+		{
+			if (m_prev)
+				m_prev->m_next = m_next;
+			else
+				m_list->head = m_next;
+			if (m_next)
+				m_next->m_prev = m_prev;
+			if (m_list->head == nullptr && m_level >= 0 && m_level < ALARM_WHEEL_LEVEL_COUNT)
+				g_wheelMask[m_level] &= ~(1ull << m_slot);
+			m_list = nullptr;
+			m_prev = nullptr;
+			m_next = nullptr;
+		}
+
+		void insertIntoWheel()
+		{
+			uint64 granule = m_nextFire >> ALARM_WHEEL_GRANULE_SHIFT;
+			if (granule < g_wheelTime)
+				granule = g_wheelTime; // already expired, goes into the current slot
+			uint64 delta = granule - g_wheelTime;
+			for (sint32 level = 0; level < ALARM_WHEEL_LEVEL_COUNT; level++)
+			{
+				if (delta >= (1ull << ((level + 1) * ALARM_WHEEL_SLOT_BITS)))
+					continue;
+				uint32 slot = (uint32)(granule >> (level * ALARM_WHEEL_SLOT_BITS)) & (ALARM_WHEEL_SLOT_COUNT - 1);
+				linkInto(g_wheel[level][slot], level, slot, nullptr);
+				g_wheelMask[level] |= (1ull << slot);
+				return;
+			}
+			linkInto(g_wheelOverflow, LEVEL_OVERFLOW, 0, nullptr);
+		}
+
+		// the due list is ordered by fire time
+		void insertIntoDueList()
+		{
+			OSHostAlarm* prev = nullptr;
+			for (OSHostAlarm* itr = g_dueList.head; itr && ComparatorFireTime()(itr, this); itr = itr->m_next)
+				prev = itr;
+			linkInto(g_dueList, LEVEL_DUE, 0, prev);
+		}
+
+		static bool isWheelEmpty()
+		{
+			for (sint32 level = 0; level < ALARM_WHEEL_LEVEL_COUNT; level++)
+			{
+				if (g_wheelMask[level] != 0)
+					return false;
+			}
+			return g_wheelOverflow.head == nullptr;
+		}
+
+		static void reinsertAll(AlarmList& list)
+		{
+			OSHostAlarm* alarm = list.head;
+			while (alarm)
+			{
+				OSHostAlarm* next = alarm->m_next;
+				alarm->unlink();
+				alarm->insertIntoWheel();
+				alarm = next;
+			}
+		}
+
+		// called when entering a granule at which level 0 wraps around
+		static void cascade()
+		{
+			for (sint32 level = 1; level < ALARM_WHEEL_LEVEL_COUNT; level++)
+			{
+				uint32 slot = (uint32)(g_wheelTime >> (level * ALARM_WHEEL_SLOT_BITS)) & (ALARM_WHEEL_SLOT_COUNT - 1);
+				reinsertAll(g_wheel[level][slot]);
+				if (slot != 0)
+					return;
+			}
+			reinsertAll(g_wheelOverflow);
+		}
+
+		// advance the wheel up to the current tick and move all expired alarms to the due list
+		static void collectDueAlarms(uint64 currentTick)
+		{
+			uint64 currentGranule = currentTick >> ALARM_WHEEL_GRANULE_SHIFT;
+			while (true)
+			{
+				if (isWheelEmpty())
+				{
+					g_wheelTime = std::max(g_wheelTime, currentGranule);
+					return;
+				}
+				OSHostAlarm* alarm = g_wheel[0][g_wheelTime & (ALARM_WHEEL_SLOT_COUNT - 1)].head;
+				while (alarm)
+				{
+					OSHostAlarm* next = alarm->m_next;
+					if (alarm->m_nextFire <= currentTick)
+					{
+						alarm->unlink();
+						alarm->insertIntoDueList();
+					}
+					alarm = next;
+				}
+				if (g_wheelTime >= currentGranule)
+					return;
+				// with no alarms on level 0 we can skip ahead to the next cascade
+				if (g_wheelMask[0] == 0)
+					g_wheelTime = std::min<uint64>((g_wheelTime | (ALARM_WHEEL_SLOT_COUNT - 1)) + 1, currentGranule);
+				else
+					g_wheelTime++;
+				if ((g_wheelTime & (ALARM_WHEEL_SLOT_COUNT - 1)) == 0)
+					cascade();
+			}
+		}
+
+		// exact if the soonest alarm is on level 0, otherwise a lower bound
+		static void updateSoonestFireTick()
+		{
+			uint64 soonestAlarm = std::numeric_limits<uint64>::max();
+			if (g_wheelMask[0] != 0)
+			{
+				// level 0 slots are in order starting with the current one
+				uint32 currentSlot = (uint32)g_wheelTime & (ALARM_WHEEL_SLOT_COUNT - 1);
+				uint32 slot = (currentSlot + std::countr_zero(std::rotr(g_wheelMask[0], currentSlot))) & (ALARM_WHEEL_SLOT_COUNT - 1);
+				for (OSHostAlarm* alarm = g_wheel[0][slot].head; alarm; alarm = alarm->m_next)
+					soonestAlarm = std::min(soonestAlarm, alarm->m_nextFire);
+			}
+			for (sint32 level = 1; level <= ALARM_WHEEL_LEVEL_COUNT; level++)
+			{
+				bool hasAlarms = level < ALARM_WHEEL_LEVEL_COUNT ? g_wheelMask[level] != 0 : g_wheelOverflow.head != nullptr;
+				if (!hasAlarms)
+					continue;
+				// alarms on this level are not due before the level below wraps around and the next cascade happens
+				uint64 nextCascade = ((g_wheelTime >> (level * ALARM_WHEEL_SLOT_BITS)) + 1) << (level * ALARM_WHEEL_SLOT_BITS);
+				soonestAlarm = std::min<uint64>(soonestAlarm, nextCascade << ALARM_WHEEL_GRANULE_SHIFT);
+				break;
+			}
+			g_soonestAlarm = soonestAlarm;
+		}
+
 		uint64 m_nextFire;
 		uint64 m_period; // if zero then repeat is disabled 
-		bool m_isActive{ false };
 
 		void (*m_callbackFunc)(uint64 currentTick, void* context);
 		void* m_context;
 
-		static std::set<class OSHostAlarm*, ComparatorFireTime> g_activeAlarmList;
+		// link in wheel slot, overflow list or due list. m_list is null if the alarm is not active
+		AlarmList* m_list{};
+		OSHostAlarm* m_prev{};
+		OSHostAlarm* m_next{};
+		sint32 m_level{};
+		uint32 m_slot{};
+
+		static AlarmList g_wheel[ALARM_WHEEL_LEVEL_COUNT][ALARM_WHEEL_SLOT_COUNT];
+		static uint64 g_wheelMask[ALARM_WHEEL_LEVEL_COUNT]; // non-empty slots
+		static AlarmList g_wheelOverflow;
+		static AlarmList g_dueList;
+		static uint64 g_wheelTime; // current granule, all earlier granules have been processed
 		static std::atomic_uint64_t g_soonestAlarm;
 	};
 
-
-	std::set<class OSHostAlarm*, OSHostAlarm::ComparatorFireTime> OSHostAlarm::g_activeAlarmList;
-	std::atomic_uint64_t OSHostAlarm::g_soonestAlarm{};
+	OSHostAlarm::AlarmList OSHostAlarm::g_wheel[ALARM_WHEEL_LEVEL_COUNT][ALARM_WHEEL_SLOT_COUNT];
+	uint64 OSHostAlarm::g_wheelMask[ALARM_WHEEL_LEVEL_COUNT]{};
+	OSHostAlarm::AlarmList OSHostAlarm::g_wheelOverflow;
+	OSHostAlarm::AlarmList OSHostAlarm::g_dueList;
+	uint64 OSHostAlarm::g_wheelTime{};
+	std::atomic_uint64_t OSHostAlarm::g_soonestAlarm{ std::numeric_limits<uint64>::max() };
 
 	OSHostAlarm* OSHostAlarmCreate(uint64 nextFire, uint64 period, void(*callbackFunc)(uint64 currentTick, void* context), void* context)
 	{
@@ -158,6 +324,11 @@ namespace coreinit
 		return hostAlarm;
 	}
 
+	uint64 OSHostAlarmGetSoonestFireTick()
+	{
+		return OSHostAlarm::getSoonestFireTick();
+	}
+
 	void OSHostAlarmDestroy(OSHostAlarm* hostAlarm)
 	{
 		delete hostAlarm;
@@ -6,6 +6,7 @@ namespace coreinit
 	class OSHostAlarm;
 	OSHostAlarm* OSHostAlarmCreate(uint64 nextFire, uint64 period, void(*callbackFunc)(uint64 currentTick, void* context), void* context);
 	void OSHostAlarmDestroy(OSHostAlarm* hostAlarm);
+	uint64 OSHostAlarmGetSoonestFireTick(); // returns max uint64 if no alarm is pending
 
 	struct OSAlarm_t
 	{
@@ -9,6 +9,8 @@ namespace coreinit
 	#define MBLOCK_TYPE_FREE ('FR')
 	#define MBLOCK_TYPE_USED ('UD')
 
+	#define MEM_HEAP_CHECK_OPTION_PRINT_ERRORS (1 << 0)
+
 	struct MBlock2_t
 	{
 		uint32be fields; // 0x00
@@ -163,48 +165,313 @@ namespace coreinit
 		return newBlock;
 	}
 
-	bool _MEMExpHeap_RecycleRegion(MBlockChain2_t* blockChain, ExpMemBlockRegion* region)
+	// host side index of the free blocks of an expanded heap, used to avoid walking the free chain in guest memory
+	// the guest visible chain stays authoritative. Every change to the free chain is mirrored here
+	// blocks are stored in a treap ordered by address, where each node also tracks the largest block in its subtree (first fit),
+	// and in a set ordered by size (best fit)
+	class MEMExpHeapFreeIndex
 	{
-		ExpMemBlockRegion newRegion;
-		newRegion.start = region->start;
-		newRegion.end = region->end;
+		static constexpr uint32 INVALID_NODE = 0xFFFFFFFF;
+
+		struct Node
+		{
+			MBlock2_t* block;
+			uint32 size;
+			uint32 maxSize; // largest block size within this subtree
+			uint32 priority;
+			uint32 left;
+			uint32 right;
+		};
+
+	public:
+		MEMExpHeapFreeIndex(uintptr_t heapStart, uintptr_t heapEnd) : m_heapStart(heapStart), m_heapEnd(heapEnd) {}
+
+		void Insert(MBlock2_t* block)
+		{
+			const uint32 nodeIndex = AllocNode();
+			Node& node = m_nodes[nodeIndex];
+			node.block = block;
+			node.size = block->dataSize;
+			node.maxSize = node.size;
+			node.priority = NextPriority();
+			node.left = INVALID_NODE;
+			node.right = INVALID_NODE;
+			m_bySize.emplace(node.size, (uintptr_t)block);
+			uint32 left, right;
+			Split(m_root, (uintptr_t)block, left, right);
+			m_root = Merge(Merge(left, nodeIndex), right);
+		}
+
+		void Remove(MBlock2_t* block)
+		{
+			uint32 left, middle, right;
+			Split(m_root, (uintptr_t)block, left, right);
+			Split(right, (uintptr_t)block + 1, middle, right);
+			cemu_assert_debug(middle != INVALID_NODE);
+			if (middle != INVALID_NODE)
+			{
+				m_bySize.erase({ m_nodes[middle].size, (uintptr_t)block });
+				m_freeNodes.emplace_back(middle);
+			}
+			m_root = Merge(left, right);
+		}
+
+		size_t GetCount() const
+		{
+			return m_bySize.size();
+		}
+
+		bool Contains(MBlock2_t* block, uint32 size) const
+		{
+			return m_bySize.find({ size, (uintptr_t)block }) != m_bySize.end();
+		}
+
+		bool Overlaps(uintptr_t start, uintptr_t end) const
+		{
+			return start < m_heapEnd && m_heapStart < end;
+		}
+
+		// get the closest blocks below and at or above the given address
+		void FindNeighbours(uintptr_t addr, MBlock2_t*& prevBlock, MBlock2_t*& nextBlock) const
+		{
+			prevBlock = nullptr;
+			nextBlock = nullptr;
+			uint32 nodeIndex = m_root;
+			while (nodeIndex != INVALID_NODE)
+			{
+				const Node& node = m_nodes[nodeIndex];
+				if ((uintptr_t)node.block < addr)
+				{
+					prevBlock = node.block;
+					nodeIndex = node.right;
+				}
+				else
+				{
+					nextBlock = node.block;
+					nodeIndex = node.left;
+				}
+			}
+		}
+
+		// first block in address order (or reverse order if fromTail is set) for which fits() returns true
+		template<typename TFunc>
+		MBlock2_t* FindFirstFit(uint32 minSize, bool fromTail, TFunc fits) const
+		{
+			return FindFirstFitInSubtree(m_root, minSize, fromTail, fits);
+		}
 
-		MEMPTR<MBlock2_t> prev;
-		MEMPTR<MBlock2_t> find = blockChain->headMBlock;
-		while (find)
+		// smallest block for which fits() returns true. Among blocks of the same size the lowest address wins, or the highest if fromTail is set
+		template<typename TFunc>
+		MBlock2_t* FindBestFit(uint32 minSize, bool fromTail, TFunc fits) const
 		{
-			MBlock2_t* findMBlock = find.GetPtr();
-			const uintptr_t blockAddr = (uintptr_t)findMBlock;
-			if (blockAddr >= region->start)
+			for (auto it = m_bySize.lower_bound({ minSize, 0 }); it != m_bySize.end(); ++it)
 			{
-				if (blockAddr == region->end)
+				if (!fits((MBlock2_t*)it->second))
+					continue;
+				if (!fromTail)
+					return (MBlock2_t*)it->second;
+				// walk the blocks of the same size backwards, starting at the highest address
+				auto itSameSize = m_bySize.upper_bound({ it->first, UINTPTR_MAX });
+				while (true)
 				{
-					newRegion.end = MBLOCK_GET_END(findMBlock);
-					_MEMExpHeap_RemoveMBlock(blockChain, findMBlock);
-
-					MEMExpHeapHead2* heap = EXP_HEAP_GET_FROM_FREE_BLOCKCHAIN(blockChain);
-					uint8 options = heap->flags;
-					if (HAS_FLAG(options, MEM_HEAP_OPTION_FILL))
-					{
-						const uint32 fillVal = MEMGetFillValForHeap(HEAP_FILL_TYPE::ON_FREE);
-						memset(findMBlock, fillVal, sizeof(MBlock2_t));
-					}
+					--itSameSize;
+					if (fits((MBlock2_t*)itSameSize->second))
+						return (MBlock2_t*)itSameSize->second;
 				}
+			}
+			return nullptr;
+		}
 
-				break;
+	private:
+		uint32 AllocNode()
+		{
+			if (!m_freeNodes.empty())
+			{
+				uint32 nodeIndex = m_freeNodes.back();
+				m_freeNodes.pop_back();
+				return nodeIndex;
 			}
+			m_nodes.emplace_back();
+			return (uint32)(m_nodes.size() - 1);
+		}
 
-			prev = find;
-			find = findMBlock->nextBlock;
+		uint32 NextPriority()
+		{
+			m_seed ^= m_seed << 13;
+			m_seed ^= m_seed >> 17;
+			m_seed ^= m_seed << 5;
+			return m_seed;
+		}
+
+		void UpdateNode(uint32 nodeIndex)
+		{
+			Node& node = m_nodes[nodeIndex];
+			node.maxSize = node.size;
+			if (node.left != INVALID_NODE)
+				node.maxSize = std::max(node.maxSize, m_nodes[node.left].maxSize);
+			if (node.right != INVALID_NODE)
+				node.maxSize = std::max(node.maxSize, m_nodes[node.right].maxSize);
+		}
+
+		// split into nodes with an address below key (left) and the rest (right)
+		void Split(uint32 nodeIndex, uintptr_t key, uint32& left, uint32& right)
+		{
+			if (nodeIndex == INVALID_NODE)
+			{
+				left = INVALID_NODE;
+				right = INVALID_NODE;
+				return;
+			}
+			Node& node = m_nodes[nodeIndex];
+			if ((uintptr_t)node.block < key)
+			{
+				Split(node.right, key, node.right, right);
+				left = nodeIndex;
+			}
+			else
+			{
+				Split(node.left, key, left, node.left);
+				right = nodeIndex;
+			}
+			UpdateNode(nodeIndex);
+		}
+
+		// all addresses in left must be below those in right
+		uint32 Merge(uint32 left, uint32 right)
+		{
+			if (left == INVALID_NODE)
+				return right;
+			if (right == INVALID_NODE)
+				return left;
+			if (m_nodes[left].priority > m_nodes[right].priority)
+			{
+				m_nodes[left].right = Merge(m_nodes[left].right, right);
+				UpdateNode(left);
+				return left;
+			}
+			m_nodes[right].left = Merge(left, m_nodes[right].left);
+			UpdateNode(right);
+			return right;
+		}
+
+		template<typename TFunc>
+		MBlock2_t* FindFirstFitInSubtree(uint32 nodeIndex, uint32 minSize, bool fromTail, TFunc& fits) const
+		{
+			if (nodeIndex == INVALID_NODE)
+				return nullptr;
+			const Node& node = m_nodes[nodeIndex];
+			if (node.maxSize < minSize)
+				return nullptr;
+			if (MBlock2_t* block = FindFirstFitInSubtree(fromTail ? node.right : node.left, minSize, fromTail, fits))
+				return block;
+			if (node.size >= minSize && fits(node.block))
+				return node.block;
+			return FindFirstFitInSubtree(fromTail ? node.left : node.right, minSize, fromTail, fits);
+		}
+
+		uintptr_t m_heapStart;
+		uintptr_t m_heapEnd;
+		std::vector<Node> m_nodes;
+		std::vector<uint32> m_freeNodes;
+		uint32 m_root{INVALID_NODE};
+		uint32 m_seed{0x2545F491};
+		std::set<std::pair<uint32, uintptr_t>> m_bySize; // (dataSize, block address)
+	};
+
+	std::mutex s_expHeapFreeIndexMutex;
+	std::unordered_map<MEMExpHeapHead2*, std::unique_ptr<MEMExpHeapFreeIndex>> s_expHeapFreeIndex;
+
+	MEMExpHeapFreeIndex* _MEMExpHeap_GetFreeIndex(MEMExpHeapHead2* heap)
+	{
+		std::unique_lock _l(s_expHeapFreeIndexMutex);
+		auto it = s_expHeapFreeIndex.find(heap);
+		if (it == s_expHeapFreeIndex.end())
+			return nullptr;
+		return it->second.get();
+	}
+
+	// (re)build the index from the guest free chain
+	void _MEMExpHeap_CreateFreeIndex(MEMExpHeapHead2* heap)
+	{
+		const uintptr_t heapStart = (uintptr_t)heap;
+		const uintptr_t heapEnd = (uintptr_t)heap->heapEnd.GetPtr();
+		MEMExpHeapFreeIndex* freeIndex = new MEMExpHeapFreeIndex(heapStart, heapEnd);
+		for (MBlock2_t* block = heap->expHeapHead.chainFreeBlocks.headMBlock.GetPtr(); block != nullptr; block = block->nextBlock.GetPtr())
+			freeIndex->Insert(block);
+		std::unique_lock _l(s_expHeapFreeIndexMutex);
+		// heaps which were never destroyed but whose memory got reused are dropped here
+		std::erase_if(s_expHeapFreeIndex, [&](const auto& it) { return it.second->Overlaps(heapStart, heapEnd); });
+		s_expHeapFreeIndex[heap].reset(freeIndex);
+	}
+
+	void _MEMExpHeap_DestroyFreeIndex(MEMExpHeapHead2* heap)
+	{
+		std::unique_lock _l(s_expHeapFreeIndexMutex);
+		s_expHeapFreeIndex.erase(heap);
+	}
+
+	void* _MEMExpHeap_RemoveFreeMBlock(MBlockChain2_t* freeChain, MEMExpHeapFreeIndex* freeIndex, MBlock2_t* block)
+	{
+		if (freeIndex)
+			freeIndex->Remove(block);
+		return _MEMExpHeap_RemoveMBlock(freeChain, block);
+	}
+
+	MBlock2_t* _MEMExpHeap_InsertFreeMBlock(MBlockChain2_t* freeChain, MEMExpHeapFreeIndex* freeIndex, MBlock2_t* newBlock, MBlock2_t* prevBlock)
+	{
+		if (freeIndex)
+			freeIndex->Insert(newBlock);
+		return _MEMExpHeap_InsertMBlock(freeChain, newBlock, prevBlock);
+	}
+
+	// get the first free block at or after the given address and the free block before it
+	void _MEMExpHeap_FindFreeNeighbours(MBlockChain2_t* freeChain, MEMExpHeapFreeIndex* freeIndex, uintptr_t addr, MBlock2_t*& prevBlock, MBlock2_t*& nextBlock)
+	{
+		if (freeIndex)
+		{
+			freeIndex->FindNeighbours(addr, prevBlock, nextBlock);
+			return;
+		}
+		prevBlock = nullptr;
+		nextBlock = freeChain->headMBlock.GetPtr();
+		while (nextBlock && (uintptr_t)nextBlock < addr)
+		{
+			prevBlock = nextBlock;
+			nextBlock = nextBlock->nextBlock.GetPtr();
+		}
+	}
+
+	bool _MEMExpHeap_RecycleRegion(MBlockChain2_t* blockChain, ExpMemBlockRegion* region)
+	{
+		ExpMemBlockRegion newRegion;
+		newRegion.start = region->start;
+		newRegion.end = region->end;
+
+		MEMExpHeapFreeIndex* freeIndex = _MEMExpHeap_GetFreeIndex(EXP_HEAP_GET_FROM_FREE_BLOCKCHAIN(blockChain));
+
+		MBlock2_t* prev;
+		MBlock2_t* find;
+		_MEMExpHeap_FindFreeNeighbours(blockChain, freeIndex, region->start, prev, find);
+		if (find && (uintptr_t)find == region->end)
+		{
+			newRegion.end = MBLOCK_GET_END(find);
+			_MEMExpHeap_RemoveFreeMBlock(blockChain, freeIndex, find);
+
+			MEMExpHeapHead2* heap = EXP_HEAP_GET_FROM_FREE_BLOCKCHAIN(blockChain);
+			uint8 options = heap->flags;
+			if (HAS_FLAG(options, MEM_HEAP_OPTION_FILL))
+			{
+				const uint32 fillVal = MEMGetFillValForHeap(HEAP_FILL_TYPE::ON_FREE);
+				memset(find, fillVal, sizeof(MBlock2_t));
+			}
 		}
 
 		if (prev)
 		{
-			MBlock2_t* prevMBlock = prev.GetPtr();
-			if (MBLOCK_GET_END(prevMBlock) == region->start)
+			if (MBLOCK_GET_END(prev) == region->start)
 			{
-				newRegion.start = (uintptr_t)prevMBlock;
-				prev = (MBlock2_t*)_MEMExpHeap_RemoveMBlock(blockChain, prevMBlock);
+				newRegion.start = (uintptr_t)prev;
+				prev = (MBlock2_t*)_MEMExpHeap_RemoveFreeMBlock(blockChain, freeIndex, prev);
 			}
 		}
 
@@ -220,11 +487,11 @@ namespace coreinit
 		}
 
 		MBlock2_t* newBlock = _MEMExpHeap_InitMBlock(&newRegion, MBLOCK_TYPE_FREE);
-		_MEMExpHeap_InsertMBlock(blockChain, newBlock, prev.GetPtr());
+		_MEMExpHeap_InsertFreeMBlock(blockChain, freeIndex, newBlock, prev);
 		return true;
 	}
 
-void* _MEMExpHeap_AllocUsedBlockFromFreeBlock(MBlockChain2_t* blockChain, MBlock2_t* freeBlock, uintptr_t blockMemStart, uint32 size, MEMExpHeapAllocDirection direction)
+void* _MEMExpHeap_AllocUsedBlockFromFreeBlock(MBlockChain2_t* blockChain, MEMExpHeapFreeIndex* freeIndex, MBlock2_t* freeBlock, uintptr_t blockMemStart, uint32 size, MEMExpHeapAllocDirection direction)
 {
 	MEMExpHeapHead2* heap = EXP_HEAP_GET_FROM_FREE_BLOCKCHAIN(blockChain);
 
@@ -234,12 +501,12 @@ void* _MEMExpHeap_AllocUsedBlockFromFreeBlock(MBlockChain2_t* blockChain, MBlock
 	ExpMemBlockRegion newRegion = {blockMemStart + size, freeRegion.end};
 	freeRegion.end = blockMemStart - sizeof(MBlock2_t);
 
-	MBlock2_t* prevBlock = (MBlock2_t*)_MEMExpHeap_RemoveMBlock(blockChain, freeBlock);
+	MBlock2_t* prevBlock = (MBlock2_t*)_MEMExpHeap_RemoveFreeMBlock(blockChain, freeIndex, freeBlock);
 
 	if ((freeRegion.end - freeRegion.start) >= 0x18 && (direction != MEMExpHeapAllocDirection::HEAD || HAS_FLAG(heap->expHeapHead.fields, MEM_EXPHEAP_USE_ALIGN_MARGIN)))
 	{
 		MBlock2_t* newBlock = _MEMExpHeap_InitMBlock(&freeRegion, MBLOCK_TYPE_FREE);
-		prevBlock = _MEMExpHeap_InsertMBlock(blockChain, newBlock, prevBlock);
+		prevBlock = _MEMExpHeap_InsertFreeMBlock(blockChain, freeIndex, newBlock, prevBlock);
 	}
 	else
 		freeRegion.end = freeRegion.start;
@@ -247,7 +514,7 @@ void* _MEMExpHeap_AllocUsedBlockFromFreeBlock(MBlockChain2_t* blockChain, MBlock
 	if ((newRegion.end - newRegion.start) >= 0x18 && (direction != MEMExpHeapAllocDirection::TAIL || HAS_FLAG(heap->expHeapHead.fields, MEM_EXPHEAP_USE_ALIGN_MARGIN)))
 	{
 		MBlock2_t* newBlock = _MEMExpHeap_InitMBlock(&newRegion, MBLOCK_TYPE_FREE);
-		prevBlock = _MEMExpHeap_InsertMBlock(blockChain, newBlock, prevBlock);
+		prevBlock = _MEMExpHeap_InsertFreeMBlock(blockChain, freeIndex, newBlock, prevBlock);
 	}
 	else
 		newRegion.start = newRegion.end;
@@ -282,15 +549,13 @@ void* _MEMExpHeap_AllocUsedBlockFromFreeBlock(MBlockChain2_t* blockChain, MBlock
 	return (void*)blockMemStart;
 }
 
-void* _MEMExpHeap_AllocFromTail(MEMHeapHandle heap, uint32 size, int alignment)
+// reference implementation which walks the guest free chain
+MBlock2_t* _MEMExpHeap_FindFreeBlockFromTailLinear(MEMExpHeapHead2* expHeap, uint32 size, int alignment, uintptr_t& blockMemStart)
 {
-	MEMExpHeapHead2* expHeap = (MEMExpHeapHead2*)heap;
-
 	const bool searchForFirstEntry = (expHeap->expHeapHead.fields&1) == MEM_EXPHEAP_ALLOC_MODE_FIRST;
 	const int alignmentMinusOne = alignment - 1;
 
 	MBlock2_t* freeBlock = nullptr;
-	uintptr_t blockMemStart = 0;
 	uint32 foundSize = -1;
 
 	for (MBlock2_t* findBlock = expHeap->expHeapHead.chainFreeBlocks.tailMBlock.GetPtr(); findBlock != nullptr; findBlock = findBlock->prevBlock.GetPtr())
@@ -316,23 +581,16 @@ void* _MEMExpHeap_AllocFromTail(MEMHeapHandle heap, uint32 size, int alignment)
 		if (foundSize == size)
 			break;
 	}
-
-	void* mem = nullptr;
-	if (freeBlock)
-		mem = _MEMExpHeap_AllocUsedBlockFromFreeBlock(&expHeap->expHeapHead.chainFreeBlocks, freeBlock, blockMemStart, size, coreinit::MEMExpHeapAllocDirection::TAIL);
-
-	return mem;
+	return freeBlock;
 }
 
-void* _MEMExpHeap_AllocFromHead(MEMHeapHandle heap, uint32 size, int alignment)
+// reference implementation which walks the guest free chain
+MBlock2_t* _MEMExpHeap_FindFreeBlockFromHeadLinear(MEMExpHeapHead2* expHeap, uint32 size, int alignment, uintptr_t& blockMemStart)
 {
-	MEMExpHeapHead2* expHeap = (MEMExpHeapHead2*)heap;
-
 	const bool searchForFirstEntry = (expHeap->expHeapHead.fields&1) == MEM_EXPHEAP_ALLOC_MODE_FIRST;
 	const int alignmentMinusOne = alignment - 1;
 
 	MBlock2_t* freeBlock = nullptr;
-	uintptr_t blockMemStart = 0;
 	uint32 foundSize = -1;
 
 	for (MBlock2_t* findBlock = expHeap->expHeapHead.chainFreeBlocks.headMBlock.GetPtr(); findBlock != nullptr; findBlock = findBlock->nextBlock.GetPtr())
@@ -357,10 +615,93 @@ void* _MEMExpHeap_AllocFromHead(MEMHeapHandle heap, uint32 size, int alignment)
 		if (foundSize == size)
 			break;
 	}
+	return freeBlock;
+}
+
+// same result as _MEMExpHeap_FindFreeBlockFromTailLinear
+MBlock2_t* _MEMExpHeap_FindFreeBlockFromTail(MEMExpHeapHead2* expHeap, MEMExpHeapFreeIndex* freeIndex, uint32 size, int alignment, uintptr_t& blockMemStart)
+{
+	const bool searchForFirstEntry = (expHeap->expHeapHead.fields&1) == MEM_EXPHEAP_ALLOC_MODE_FIRST;
+	const int alignmentMinusOne = alignment - 1;
+
+	auto getAlignedEnd = [&](MBlock2_t* block) -> uintptr_t
+	{
+		return (MBLOCK_GET_MEMORY(block) + (uint32)block->dataSize - size) & ~alignmentMinusOne;
+	};
+	auto fits = [&](MBlock2_t* block) -> bool
+	{
+		return getAlignedEnd(block) >= MBLOCK_GET_MEMORY(block);
+	};
+
+	MBlock2_t* freeBlock;
+	if (searchForFirstEntry)
+		freeBlock = freeIndex->FindFirstFit(size, true, fits);
+	else
+		freeBlock = freeIndex->FindBestFit(size, true, fits);
+	if (freeBlock)
+		blockMemStart = getAlignedEnd(freeBlock);
+	return freeBlock;
+}
+
+// same result as _MEMExpHeap_FindFreeBlockFromHeadLinear
+MBlock2_t* _MEMExpHeap_FindFreeBlockFromHead(MEMExpHeapHead2* expHeap, MEMExpHeapFreeIndex* freeIndex, uint32 size, int alignment, uintptr_t& blockMemStart)
+{
+	const bool searchForFirstEntry = (expHeap->expHeapHead.fields&1) == MEM_EXPHEAP_ALLOC_MODE_FIRST;
+	const int alignmentMinusOne = alignment - 1;
+
+	auto getAlignedStart = [&](MBlock2_t* block) -> uintptr_t
+	{
+		return (MBLOCK_GET_MEMORY(block) + alignmentMinusOne) & ~alignmentMinusOne;
+	};
+	auto fits = [&](MBlock2_t* block) -> bool
+	{
+		return (uint32)block->dataSize >= getAlignedStart(block) - MBLOCK_GET_MEMORY(block) + size;
+	};
+
+	MBlock2_t* freeBlock;
+	if (searchForFirstEntry)
+		freeBlock = freeIndex->FindFirstFit(size, false, fits);
+	else
+		freeBlock = freeIndex->FindBestFit(size, false, fits);
+	if (freeBlock)
+		blockMemStart = getAlignedStart(freeBlock);
+	return freeBlock;
+}
+
+void* _MEMExpHeap_AllocFromTail(MEMHeapHandle heap, uint32 size, int alignment)
+{
+	MEMExpHeapHead2* expHeap = (MEMExpHeapHead2*)heap;
+	MEMExpHeapFreeIndex* freeIndex = _MEMExpHeap_GetFreeIndex(expHeap);
+
+	uintptr_t blockMemStart = 0;
+	MBlock2_t* freeBlock;
+	if (freeIndex)
+		freeBlock = _MEMExpHeap_FindFreeBlockFromTail(expHeap, freeIndex, size, alignment, blockMemStart);
+	else
+		freeBlock = _MEMExpHeap_FindFreeBlockFromTailLinear(expHeap, size, alignment, blockMemStart);
+
+	void* mem = nullptr;
+	if (freeBlock)
+		mem = _MEMExpHeap_AllocUsedBlockFromFreeBlock(&expHeap->expHeapHead.chainFreeBlocks, freeIndex, freeBlock, blockMemStart, size, coreinit::MEMExpHeapAllocDirection::TAIL);
+
+	return mem;
+}
+
+void* _MEMExpHeap_AllocFromHead(MEMHeapHandle heap, uint32 size, int alignment)
+{
+	MEMExpHeapHead2* expHeap = (MEMExpHeapHead2*)heap;
+	MEMExpHeapFreeIndex* freeIndex = _MEMExpHeap_GetFreeIndex(expHeap);
+
+	uintptr_t blockMemStart = 0;
+	MBlock2_t* freeBlock;
+	if (freeIndex)
+		freeBlock = _MEMExpHeap_FindFreeBlockFromHead(expHeap, freeIndex, size, alignment, blockMemStart);
+	else
+		freeBlock = _MEMExpHeap_FindFreeBlockFromHeadLinear(expHeap, size, alignment, blockMemStart);
 
 	void* mem = nullptr;
 	if (freeBlock)
-		mem = _MEMExpHeap_AllocUsedBlockFromFreeBlock(&expHeap->expHeapHead.chainFreeBlocks, freeBlock, blockMemStart, size, coreinit::MEMExpHeapAllocDirection::HEAD);
+		mem = _MEMExpHeap_AllocUsedBlockFromFreeBlock(&expHeap->expHeapHead.chainFreeBlocks, freeIndex, freeBlock, blockMemStart, size, coreinit::MEMExpHeapAllocDirection::HEAD);
 
 	return mem;
 }
@@ -387,6 +728,8 @@ MEMHeapHandle _MEMExpHeap_InitHeap(void* startAddress, void* endAddress, uint32
 	header->expHeapHead.groupID = 0;
 	header->expHeapHead.fields = 0;
 
+	_MEMExpHeap_CreateFreeIndex(header);
+
 	return (MEMHeapHandle)header;
 }
 
@@ -439,6 +782,7 @@ MEMHeapHandle MEMCreateExpHeapEx(void* startAddress, uint32 size, uint32 createF
 void* MEMDestroyExpHeap(MEMHeapHandle heap)
 {
 	IsValidExpHeapHandle_(heap);
+	_MEMExpHeap_DestroyFreeIndex((MEMExpHeapHead2*)heap);
 	MEMBaseDestroyHeap(heap);
 	MEMHeapTable_Remove(heap);
 	return heap;
@@ -546,7 +890,7 @@ uint32 MEMAdjustExpHeap(MEMHeapHandle heap)
 		uintptr_t heapEnd = (uintptr_t)heap->heapEnd.GetPtr();
 		if (blockMemEnd == heapEnd)
 		{
-			_MEMExpHeap_RemoveMBlock(&expHeap->expHeapHead.chainFreeBlocks, tail);
+			_MEMExpHeap_RemoveFreeMBlock(&expHeap->expHeapHead.chainFreeBlocks, _MEMExpHeap_GetFreeIndex(expHeap), tail);
 
 			uint32 removedBlockSize = sizeof(MBlock2_t) + (uint32)tail->dataSize;
 			uintptr_t newHeapEnd = heapEnd - removedBlockSize;
@@ -592,54 +936,41 @@ uint32 MEMResizeForMBlockExpHeap(MEMHeapHandle heap, void* memBlock, uint32 size
 		}
 		else
 		{
-			MEMPTR<MBlock2_t> free = expHeap->expHeapHead.chainFreeBlocks.headMBlock;
+			MEMExpHeapFreeIndex* freeIndex = _MEMExpHeap_GetFreeIndex(expHeap);
 			const uintptr_t blockEndAddr = MBLOCK_GET_END(mBlock);
-			while (free)
+			MBlock2_t* prevBlock;
+			MBlock2_t* freeBlock;
+			_MEMExpHeap_FindFreeNeighbours(&expHeap->expHeapHead.chainFreeBlocks, freeIndex, blockEndAddr, prevBlock, freeBlock);
+			if (freeBlock && (uintptr_t)freeBlock == blockEndAddr && size <= (dataSize + (uint32)freeBlock->dataSize + sizeof(MBlock2_t)))
 			{
-				MBlock2_t* freeBlock = free.GetPtr();
-				if ((uintptr_t)freeBlock == blockEndAddr)
+				ExpMemBlockRegion region;
+				_MEMExpHeap_GetRegionOfMBlock(&region, freeBlock);
+				prevBlock = (MBlock2_t*)_MEMExpHeap_RemoveFreeMBlock(&expHeap->expHeapHead.chainFreeBlocks, freeIndex, freeBlock);
+
+				uintptr_t oldStart = region.start;
+				region.start = (uintptr_t)memBlock + size;
+
+				if (region.end - region.start < sizeof(MBlock2_t))
+					region.start = region.end;
+
+				mBlock->dataSize = (uint32)(region.start - (uintptr_t)memBlock);
+				if (region.end - region.start >= sizeof(MBlock2_t))
 				{
-					const uint32 freeDataSize = freeBlock->dataSize;
-					if (size > (dataSize + freeDataSize + sizeof(MBlock2_t)))
-					{
-						newSize = 0;
-						break;
-					}
-
-					ExpMemBlockRegion region;
-					_MEMExpHeap_GetRegionOfMBlock(&region, freeBlock);
-					MBlock2_t* prevBlock = (MBlock2_t*)_MEMExpHeap_RemoveMBlock(&expHeap->expHeapHead.chainFreeBlocks, freeBlock);
-
-					uintptr_t oldStart = region.start;
-					region.start = (uintptr_t)memBlock + size;
-
-					if (region.end - region.start < sizeof(MBlock2_t))
-						region.start = region.end;
-
-					mBlock->dataSize = (uint32)(region.start - (uintptr_t)memBlock);
-					if (region.end - region.start >= sizeof(MBlock2_t))
-					{
-						MBlock2_t* newBlock = _MEMExpHeap_InitMBlock(&region, MBLOCK_TYPE_FREE);
-						_MEMExpHeap_InsertMBlock(&expHeap->expHeapHead.chainFreeBlocks, newBlock, prevBlock);
-					}
-
-					if (HAS_FLAG(heap->flags, MEM_HEAP_OPTION_CLEAR))
-						memset((void*)oldStart, 0x00, region.start - oldStart);
-					else if (HAS_FLAG(heap->flags, MEM_HEAP_OPTION_FILL))
-					{
-						const uint32 fillValue = MEMGetFillValForHeap(HEAP_FILL_TYPE::ON_ALLOC);
-						memset((void*)oldStart, fillValue, region.start - oldStart);
-					}
-
-					newSize = (uint32)mBlock->dataSize;
+					MBlock2_t* newBlock = _MEMExpHeap_InitMBlock(&region, MBLOCK_TYPE_FREE);
+					_MEMExpHeap_InsertFreeMBlock(&expHeap->expHeapHead.chainFreeBlocks, freeIndex, newBlock, prevBlock);
+				}
 
-					break;
+				if (HAS_FLAG(heap->flags, MEM_HEAP_OPTION_CLEAR))
+					memset((void*)oldStart, 0x00, region.start - oldStart);
+				else if (HAS_FLAG(heap->flags, MEM_HEAP_OPTION_FILL))
+				{
+					const uint32 fillValue = MEMGetFillValForHeap(HEAP_FILL_TYPE::ON_ALLOC);
+					memset((void*)oldStart, fillValue, region.start - oldStart);
 				}
 
-				free = freeBlock->nextBlock;
+				newSize = (uint32)mBlock->dataSize;
 			}
-
-			if (!free)
+			else
 				newSize = 0;
 		}
 	}
@@ -789,6 +1120,55 @@ uint16 MEMGetAllocDirForMBlockExpHeap(const void* memBlock)
 	return (fields >> 31) & 1;
 }
 
+// validates a block chain. Blocks must be within the heap, in address order and must not overlap
+bool _MEMExpHeap_CheckBlockChain(MEMExpHeapHead2* expHeap, MBlockChain2_t* blockChain, uint16 typeCode, bool printErrors)
+{
+	const uintptr_t heapStart = (uintptr_t)expHeap->heapStart.GetPtr();
+	const uintptr_t heapEnd = (uintptr_t)expHeap->heapEnd.GetPtr();
+	const char* chainName = typeCode == MBLOCK_TYPE_FREE ? "free" : "used";
+	const bool isAddressOrdered = typeCode == MBLOCK_TYPE_FREE; // used blocks are appended in allocation order
+	uintptr_t prevEnd = heapStart;
+	MBlock2_t* prevBlock = nullptr;
+	uint32 blockCount = 0;
+	const uint32 maxBlockCount = (uint32)((heapEnd - heapStart) / sizeof(MBlock2_t));
+	for (MBlock2_t* block = blockChain->headMBlock.GetPtr(); block != nullptr; block = block->nextBlock.GetPtr())
+	{
+		const uintptr_t blockAddr = (uintptr_t)block;
+		bool isValid = blockAddr >= heapStart && blockAddr + sizeof(MBlock2_t) <= heapEnd && MBLOCK_GET_END(block) <= heapEnd;
+		isValid = isValid && (uint16)block->typeCode == typeCode && block->prevBlock.GetPtr() == prevBlock;
+		if (isValid && isAddressOrdered)
+			isValid = blockAddr >= prevEnd;
+		if (!isValid || ++blockCount > maxBlockCount)
+		{
+			if (printErrors)
+				cemuLog_log(LogType::Force, "MEMCheckExpHeap(): Bad {} block 0x{:08x} in heap 0x{:08x}", chainName, memory_getVirtualOffsetFromPointer(block), memory_getVirtualOffsetFromPointer(expHeap));
+			return false;
+		}
+		prevEnd = MBLOCK_GET_END(block);
+		prevBlock = block;
+	}
+	if (blockChain->tailMBlock.GetPtr() != prevBlock)
+	{
+		if (printErrors)
+			cemuLog_log(LogType::Force, "MEMCheckExpHeap(): Bad tail of {} chain in heap 0x{:08x}", chainName, memory_getVirtualOffsetFromPointer(expHeap));
+		return false;
+	}
+	return true;
+}
+
+// compare the host index against the free chain
+bool _MEMExpHeap_CheckFreeIndex(MEMExpHeapHead2* expHeap, MEMExpHeapFreeIndex* freeIndex)
+{
+	size_t blockCount = 0;
+	for (MBlock2_t* block = expHeap->expHeapHead.chainFreeBlocks.headMBlock.GetPtr(); block != nullptr; block = block->nextBlock.GetPtr())
+	{
+		if (!freeIndex->Contains(block, block->dataSize))
+			return false;
+		blockCount++;
+	}
+	return blockCount == freeIndex->GetCount();
+}
+
 bool MEMCheckExpHeap(MEMHeapHandle heap, uint32 options)
 {
 	if (heap == MEM_HEAP_INVALID_HANDLE || heap->magic != coreinit::MEMHeapMagic::EXP_HEAP)
@@ -796,11 +1176,22 @@ bool MEMCheckExpHeap(MEMHeapHandle heap, uint32 options)
 
 	heap->AcquireLock();
 
-	// todo
+	MEMExpHeapHead2* expHeap = (MEMExpHeapHead2*)heap;
+	const bool printErrors = HAS_FLAG(options, MEM_HEAP_CHECK_OPTION_PRINT_ERRORS);
+	bool isValid = _MEMExpHeap_CheckBlockChain(expHeap, &expHeap->expHeapHead.chainFreeBlocks, MBLOCK_TYPE_FREE, printErrors);
+	isValid = _MEMExpHeap_CheckBlockChain(expHeap, &expHeap->expHeapHead.chainUsedBlocks, MBLOCK_TYPE_USED, printErrors) && isValid;
+
+	MEMExpHeapFreeIndex* freeIndex = _MEMExpHeap_GetFreeIndex(expHeap);
+	if (isValid && freeIndex && !_MEMExpHeap_CheckFreeIndex(expHeap, freeIndex))
+	{
+		// the guest modified the heap structures directly. The chain is authoritative, so rebuild the index from it
+		cemuLog_log(LogType::Force, "MEMCheckExpHeap(): Free block index of heap 0x{:08x} is out of sync, rebuilding it", memory_getVirtualOffsetFromPointer(expHeap));
+		_MEMExpHeap_CreateFreeIndex(expHeap);
+	}
 
 	heap->ReleaseLock();
 
-	return true;
+	return isValid;
 }
 
 bool MEMCheckForMBlockExpHeap(const void* memBlock, MEMHeapHandle heap, uint32 options)
@@ -840,8 +1231,6 @@ void MEMInitAllocatorForExpHeap(MEMAllocator* allocator, MEMHeapHandle heap, sin
 
 #pragma region wrapper
 
-void expheap_test();
-
 void export_MEMCreateExpHeapEx(PPCInterpreter_t* hCPU)
 {
 	ppcDefineParamMEMPTR(startAddress, void, 0);
@@ -1014,69 +1403,97 @@ void export_MEMInitAllocatorForExpHeap(PPCInterpreter_t* hCPU)
 	osLib_returnFromFunction(hCPU, 0);
 }
 
-void expheap_test()
+// randomized differential test of the free block index against the linear search
+// allocates and frees blocks with random sizes, alignments, directions and alloc modes and checks that both searches agree on the block
+sint32 expheap_test(void* heapMemory, uint32 heapSize)
 {
 	srand(1000);
 
-	MEMHeapHandle heapHandle = MEMCreateExpHeapEx(memory_getPointerFromVirtualOffset(0x11000000), 0x10000000, 0);
+	MEMHeapHandle heapHandle = MEMCreateExpHeapEx(heapMemory, heapSize, 0);
 	MEMExpHeapHead2* expHeap = (MEMExpHeapHead2*)heapHandle;
-	sint32 idx = 0;
-
-	for (MBlock2_t* findBlock = expHeap->expHeapHead.chainFreeBlocks.headMBlock.GetPtr(); findBlock != nullptr; findBlock = findBlock->nextBlock.GetPtr())
-	{
-		const uintptr_t blockMemory = MBLOCK_GET_MEMORY(findBlock);
-		const uint32 dataSize = (uint32)findBlock->dataSize;
-
-		debug_printf(">> freeBlock %04d addr %08x - %08x\n", idx, memory_getVirtualOffsetFromPointer((void*)blockMemory), memory_getVirtualOffsetFromPointer((void*)blockMemory) + dataSize);
-		idx++;
-	}
 
 	void* allocTable[1024];
 	sint32 allocCount = 0;
+	sint32 mismatchCount = 0;
 
-	printf("Run ExpHeap test...\n");
-	for (sint32 t = 0; t < 2; t++)
+	cemuLog_log(LogType::Force, "Run ExpHeap test...");
+	for (sint32 t = 0; t < 100000; t++)
 	{
-		// allocate a bunch of entries
-		sint32 r = rand() % 100;
-		//for (sint32 i = 0; i < r; i++)
+		MEMExpHeapFreeIndex* freeIndex = _MEMExpHeap_GetFreeIndex(expHeap);
+		cemu_assert(freeIndex);
+		if ((t % 1000) == 0)
 		{
-			if( allocCount >= 1024 )
-				continue;
-
-			uint32 size = (rand() % 1000) * 12;
-			void* mem = MEMAllocFromExpHeapEx(heapHandle, size * 12, -0x2000);
-			if (mem)
+			expHeap->expHeapHead.fields &= ~MEM_EXPHEAP_ALLOC_MODE_NEAR;
+			expHeap->expHeapHead.fields |= (rand() & 1) ? MEM_EXPHEAP_ALLOC_MODE_NEAR : MEM_EXPHEAP_ALLOC_MODE_FIRST;
+		}
+		const sint32 op = rand() % 8;
+		if (allocCount > 0 && (op < 3 || allocCount >= 1024))
+		{
+			sint32 index = rand() % allocCount;
+			if (op == 0)
+			{
+				MEMResizeForMBlockExpHeap(heapHandle, allocTable[index], ((rand() % 0x4000) + 1) * 4);
+			}
+			else
+			{
+				MEMFreeToExpHeap(heapHandle, allocTable[index]);
+				allocTable[index] = allocTable[allocCount - 1];
+				allocCount--;
+			}
+		}
+		else
+		{
+			uint32 size = ((rand() % 0x2000) + 1) * 4;
+			sint32 alignment = 4 << (rand() % 8);
+			const bool fromTail = (rand() % 3) == 0;
+
+			uintptr_t memStartIndexed = 0, memStartLinear = 0;
+			MBlock2_t* blockIndexed;
+			MBlock2_t* blockLinear;
+			if (fromTail)
+			{
+				blockIndexed = _MEMExpHeap_FindFreeBlockFromTail(expHeap, freeIndex, size, alignment, memStartIndexed);
+				blockLinear = _MEMExpHeap_FindFreeBlockFromTailLinear(expHeap, size, alignment, memStartLinear);
+			}
+			else
 			{
-				allocTable[allocCount] = mem;
-				allocCount++;
-				
+				blockIndexed = _MEMExpHeap_FindFreeBlockFromHead(expHeap, freeIndex, size, alignment, memStartIndexed);
+				blockLinear = _MEMExpHeap_FindFreeBlockFromHeadLinear(expHeap, size, alignment, memStartLinear);
 			}
+			if (blockIndexed != blockLinear || memStartIndexed != memStartLinear)
+			{
+				cemuLog_log(LogType::Force, "ExpHeap test: Mismatch in step {} (size 0x{:x} alignment {} tail {}). Index: 0x{:08x} Linear: 0x{:08x}", t, size, alignment, fromTail, memory_getVirtualOffsetFromPointer(blockIndexed), memory_getVirtualOffsetFromPointer(blockLinear));
+				mismatchCount++;
+			}
+			void* mem = MEMAllocFromExpHeapEx(heapHandle, size, fromTail ? -alignment : alignment);
+			if (mem)
+				allocTable[allocCount++] = mem;
+		}
+		if (!_MEMExpHeap_CheckFreeIndex(expHeap, freeIndex) || !MEMCheckExpHeap(heapHandle, MEM_HEAP_CHECK_OPTION_PRINT_ERRORS))
+		{
+			cemuLog_log(LogType::Force, "ExpHeap test: Heap is inconsistent after step {}", t);
+			mismatchCount++;
+			break;
 		}
 	}
-	// free everything that remains
+	// free everything that remains, only a single free block should be left
 	for (sint32 i = 0; i < allocCount; i++)
-	{
 		MEMFreeToExpHeap(heapHandle, allocTable[i]);
-	}
-	allocCount = 0;
-	// debug print free blocks (only one should remain)
-	expHeap = (MEMExpHeapHead2*)heapHandle;
-	idx = 0;
-	for (MBlock2_t* findBlock = expHeap->expHeapHead.chainFreeBlocks.headMBlock.GetPtr(); findBlock != nullptr; findBlock = findBlock->nextBlock.GetPtr())
-	{
-		const uintptr_t blockMemory = MBLOCK_GET_MEMORY(findBlock);
-		const uint32 dataSize = (uint32)findBlock->dataSize;
-
-		debug_printf("freeBlock %04d addr %08x - %08x\n", idx, memory_getVirtualOffsetFromPointer((void*)blockMemory), memory_getVirtualOffsetFromPointer((void*)blockMemory) + dataSize);
-		idx++;
-	}
+	if (_MEMExpHeap_GetFreeIndex(expHeap)->GetCount() != 1 || expHeap->expHeapHead.chainFreeBlocks.headMBlock != expHeap->expHeapHead.chainFreeBlocks.tailMBlock)
+		mismatchCount++;
+	MEMDestroyExpHeap(heapHandle);
 
-	assert_dbg();
+	cemuLog_log(LogType::Force, "ExpHeap test finished with {} errors", mismatchCount);
+	return mismatchCount;
 }
 
 void expheap_load()
 {
+	{
+		std::unique_lock _l(s_expHeapFreeIndexMutex);
+		s_expHeapFreeIndex.clear();
+	}
+
 	osLib_addFunction("coreinit", "MEMCreateExpHeapEx", export_MEMCreateExpHeapEx);
 	osLib_addFunction("coreinit", "MEMDestroyExpHeap", export_MEMDestroyExpHeap);
 	osLib_addFunction("coreinit", "MEMAllocFromExpHeapEx", export_MEMAllocFromExpHeapEx);
@@ -46,7 +46,12 @@ namespace coreinit
 	static_assert(sizeof(MEMExpHeapHead2) == 0x54);
 
 	MEMHeapHandle MEMCreateExpHeapEx(void* startAddress, uint32 size, uint32 createFlags);
+	void* MEMDestroyExpHeap(MEMHeapHandle heap);
 	void* MEMAllocFromExpHeapEx(MEMHeapHandle heap, uint32 size, sint32 alignment);
 	void MEMFreeToExpHeap(MEMHeapHandle heap, void* mem);
 	uint32 MEMGetAllocatableSizeForExpHeapEx(MEMHeapHandle heap, sint32 alignment);
+	uint16 MEMSetAllocModeForExpHeap(MEMHeapHandle heap, uint16 mode);
+
+	// randomized self check of the free block index, the heap is created in the given guest memory. Returns the number of errors
+	sint32 expheap_test(void* heapMemory, uint32 heapSize);
 }
@@ -1,23 +1,85 @@
 #include "Cafe/OS/common/OSCommon.h"
 #include "coreinit_Scheduler.h"
+#include "util/highresolutiontimer/HighResolutionTimer.h"
 
 thread_local sint32 s_schedulerLockCount = 0;
+thread_local sint32 t_schedulerCoreLockIndex = -1; // core whose lock is held on its own, -1 if none
+
+// the scheduler lock is split per core. Holding the global lock means holding the locks of all cores, they are always acquired in core order
+// a core lock alone only protects the run queue of that core and the threads which can't run anywhere else, see __OSThreadSwitchToNext()
+
+// lock statistics, one slot per emulated core and one shared slot for all other host threads
+struct alignas(64) SchedulerLockStatsSlot
+{
+	std::atomic<uint64> acquisitions{0};
+	std::atomic<uint64> contendedAcquisitions{0};
+	std::atomic<uint64> contendedWaitTicks{0};
+	std::atomic<uint64> coreAcquisitions{0};
+	std::atomic<uint64> coreContendedAcquisitions{0};
+	std::atomic<uint64> coreContendedWaitTicks{0};
+};
+
+SchedulerLockStatsSlot s_schedulerLockStats[Espresso::CORE_COUNT + 1];
+thread_local sint32 t_schedulerLockStatsSlot = Espresso::CORE_COUNT;
 
 #if BOOST_OS_WINDOWS
 #include <synchapi.h>
-CRITICAL_SECTION s_csSchedulerLock;
+CRITICAL_SECTION s_csSchedulerLock[Espresso::CORE_COUNT];
 #else
 #include <pthread.h>
-pthread_mutex_t s_ptmSchedulerLock;
+pthread_mutex_t s_ptmSchedulerLock[Espresso::CORE_COUNT];
 #endif
 
-void __OSLockScheduler(void* obj)
+bool _OSTryLockSchedulerCoreMutex(sint32 coreIndex)
+{
+#if BOOST_OS_WINDOWS
+	return TryEnterCriticalSection(s_csSchedulerLock + coreIndex);
+#else
+	return pthread_mutex_trylock(s_ptmSchedulerLock + coreIndex) == 0;
+#endif
+}
+
+void _OSLockSchedulerCoreMutex(sint32 coreIndex)
+{
+#if BOOST_OS_WINDOWS
+	EnterCriticalSection(s_csSchedulerLock + coreIndex);
+#else
+	pthread_mutex_lock(s_ptmSchedulerLock + coreIndex);
+#endif
+}
+
+void _OSUnlockSchedulerCoreMutex(sint32 coreIndex)
 {
 #if BOOST_OS_WINDOWS
-	EnterCriticalSection(&s_csSchedulerLock);
+	LeaveCriticalSection(s_csSchedulerLock + coreIndex);
 #else
-	pthread_mutex_lock(&s_ptmSchedulerLock);
+	pthread_mutex_unlock(s_ptmSchedulerLock + coreIndex);
 #endif
+}
+
+void __OSLockScheduler(void* obj)
+{
+	cemu_assert_debug(t_schedulerCoreLockIndex < 0); // a held core lock has to be released first, otherwise the core order is violated
+	SchedulerLockStatsSlot& stats = s_schedulerLockStats[t_schedulerLockStatsSlot];
+	stats.acquisitions.fetch_add(1, std::memory_order_relaxed);
+	bool isContended = false;
+	HRTick waitStart = 0;
+	for (sint32 i = 0; i < Espresso::CORE_COUNT; i++)
+	{
+		if (_OSTryLockSchedulerCoreMutex(i))
+			continue;
+		if (!isContended)
+		{
+			isContended = true;
+			waitStart = HighResolutionTimer::now().getTick();
+		}
+		_OSLockSchedulerCoreMutex(i);
+	}
+	if (isContended)
+	{
+		stats.contendedAcquisitions.fetch_add(1, std::memory_order_relaxed);
+		stats.contendedWaitTicks.fetch_add(HighResolutionTimer::now().getTick() - waitStart, std::memory_order_relaxed);
+	}
 	s_schedulerLockCount++;
 	cemu_assert_debug(s_schedulerLockCount <= 1); // >= 2 should not happen. Scheduler lock does not allow recursion
 }
@@ -29,29 +91,112 @@ bool __OSHasSchedulerLock()
 
 bool __OSTryLockScheduler(void* obj)
 {
-	bool r;
-#if BOOST_OS_WINDOWS
-	r = TryEnterCriticalSection(&s_csSchedulerLock);
-#else
-	r = pthread_mutex_trylock(&s_ptmSchedulerLock) == 0;
-#endif
-	if (r)
+	cemu_assert_debug(t_schedulerCoreLockIndex < 0);
+	for (sint32 i = 0; i < Espresso::CORE_COUNT; i++)
 	{
-		s_schedulerLockCount++;
-		return true;
+		if (_OSTryLockSchedulerCoreMutex(i))
+			continue;
+		while (--i >= 0)
+			_OSUnlockSchedulerCoreMutex(i);
+		return false;
 	}
-	return false;
+	s_schedulerLockStats[t_schedulerLockStatsSlot].acquisitions.fetch_add(1, std::memory_order_relaxed);
+	s_schedulerLockCount++;
+	return true;
 }
 
 void __OSUnlockScheduler(void* obj)
 {
 	s_schedulerLockCount--;
 	cemu_assert_debug(s_schedulerLockCount >= 0);
-#if BOOST_OS_WINDOWS
-	LeaveCriticalSection(&s_csSchedulerLock);
-#else
-	pthread_mutex_unlock(&s_ptmSchedulerLock);
-#endif
+	for (sint32 i = Espresso::CORE_COUNT - 1; i >= 0; i--)
+		_OSUnlockSchedulerCoreMutex(i);
+}
+
+void __OSLockSchedulerCore(sint32 coreIndex)
+{
+	cemu_assert_debug(coreIndex >= 0 && coreIndex < Espresso::CORE_COUNT);
+	cemu_assert_debug(s_schedulerLockCount == 0 && t_schedulerCoreLockIndex < 0);
+	SchedulerLockStatsSlot& stats = s_schedulerLockStats[t_schedulerLockStatsSlot];
+	stats.coreAcquisitions.fetch_add(1, std::memory_order_relaxed);
+	if (!_OSTryLockSchedulerCoreMutex(coreIndex))
+	{
+		HRTick waitStart = HighResolutionTimer::now().getTick();
+		_OSLockSchedulerCoreMutex(coreIndex);
+		stats.coreContendedAcquisitions.fetch_add(1, std::memory_order_relaxed);
+		stats.coreContendedWaitTicks.fetch_add(HighResolutionTimer::now().getTick() - waitStart, std::memory_order_relaxed);
+	}
+	t_schedulerCoreLockIndex = coreIndex;
+}
+
+void __OSUnlockSchedulerCore(sint32 coreIndex)
+{
+	cemu_assert_debug(t_schedulerCoreLockIndex == coreIndex);
+	t_schedulerCoreLockIndex = -1;
+	_OSUnlockSchedulerCoreMutex(coreIndex);
+}
+
+bool __OSHasSchedulerCoreLock(sint32 coreIndex)
+{
+	return s_schedulerLockCount > 0 || t_schedulerCoreLockIndex == coreIndex;
+}
+
+bool __OSHasAnySchedulerLock()
+{
+	return s_schedulerLockCount > 0 || t_schedulerCoreLockIndex >= 0;
+}
+
+void __OSDowngradeSchedulerLock(sint32 coreIndex)
+{
+	cemu_assert_debug(s_schedulerLockCount == 1 && t_schedulerCoreLockIndex < 0);
+	for (sint32 i = Espresso::CORE_COUNT - 1; i >= 0; i--)
+	{
+		if (i != coreIndex)
+			_OSUnlockSchedulerCoreMutex(i);
+	}
+	s_schedulerLockCount--;
+	t_schedulerCoreLockIndex = coreIndex;
+}
+
+void __OSUnlockSchedulerHeld()
+{
+	if (t_schedulerCoreLockIndex >= 0)
+		__OSUnlockSchedulerCore(t_schedulerCoreLockIndex);
+	else
+		__OSUnlockScheduler();
+}
+
+void __OSSetSchedulerLockStatsCore(sint32 coreIndex)
+{
+	cemu_assert_debug(coreIndex >= 0 && coreIndex < Espresso::CORE_COUNT);
+	t_schedulerLockStatsSlot = coreIndex;
+}
+
+OSSchedulerLockStats __OSGetSchedulerLockStats(sint32 coreIndex)
+{
+	cemu_assert_debug(coreIndex >= 0 && coreIndex <= Espresso::CORE_COUNT);
+	SchedulerLockStatsSlot& slot = s_schedulerLockStats[coreIndex];
+	OSSchedulerLockStats stats;
+	stats.acquisitions = slot.acquisitions.load(std::memory_order_relaxed);
+	stats.contendedAcquisitions = slot.contendedAcquisitions.load(std::memory_order_relaxed);
+	stats.contendedWaitUs = HighResolutionTimer::ticksToMicroseconds(slot.contendedWaitTicks.load(std::memory_order_relaxed));
+	stats.coreAcquisitions = slot.coreAcquisitions.load(std::memory_order_relaxed);
+	stats.coreContendedAcquisitions = slot.coreContendedAcquisitions.load(std::memory_order_relaxed);
+	stats.coreContendedWaitUs = HighResolutionTimer::ticksToMicroseconds(slot.coreContendedWaitTicks.load(std::memory_order_relaxed));
+	return stats;
+}
+
+void __OSResetSchedulerLockStats()
+{
+	for (auto& slot : s_schedulerLockStats)
+	{
+		slot.acquisitions = 0;
+		slot.contendedAcquisitions = 0;
+		slot.contendedWaitTicks = 0;
+		slot.coreAcquisitions = 0;
+		slot.coreContendedAcquisitions = 0;
+		slot.coreContendedWaitTicks = 0;
+	}
 }
 
 namespace coreinit
@@ -108,12 +253,14 @@ namespace coreinit
 	void InitializeSchedulerLock()
 	{
 #if BOOST_OS_WINDOWS
-		InitializeCriticalSection(&s_csSchedulerLock);
+		for (auto& it : s_csSchedulerLock)
+			InitializeCriticalSection(&it);
 #else
 		pthread_mutexattr_t ma;
 		pthread_mutexattr_init(&ma);
 		pthread_mutexattr_settype(&ma, PTHREAD_MUTEX_RECURSIVE);
-		pthread_mutex_init(&s_ptmSchedulerLock, &ma);
+		for (auto& it : s_ptmSchedulerLock)
+			pthread_mutex_init(&it, &ma);
 #endif
 		cafeExportRegister("coreinit", __OSLockScheduler, LogType::Placeholder);
 		cafeExportRegister("coreinit", __OSUnlockScheduler, LogType::Placeholder);
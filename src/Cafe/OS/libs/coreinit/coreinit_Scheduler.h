@@ -5,6 +5,30 @@ bool __OSHasSchedulerLock();
 bool __OSTryLockScheduler(void* obj = nullptr);
 void __OSUnlockScheduler(void* obj = nullptr);
 
+// per core scheduler locks, the global lock above holds all of them
+// thread switches hand the held lock over to the next fiber, which is why __OSUnlockSchedulerHeld() releases whichever lock is held
+void __OSLockSchedulerCore(sint32 coreIndex);
+void __OSUnlockSchedulerCore(sint32 coreIndex);
+bool __OSHasSchedulerCoreLock(sint32 coreIndex); // also true if the global lock is held
+bool __OSHasAnySchedulerLock();
+void __OSDowngradeSchedulerLock(sint32 coreIndex); // global lock -> lock of coreIndex
+void __OSUnlockSchedulerHeld();
+
+struct OSSchedulerLockStats
+{
+	uint64 acquisitions;
+	uint64 contendedAcquisitions; // acquisitions which had to wait for another thread to release the lock
+	uint64 contendedWaitUs;
+	// core lock only, used for thread switches which stay on one core
+	uint64 coreAcquisitions;
+	uint64 coreContendedAcquisitions;
+	uint64 coreContendedWaitUs;
+};
+
+void __OSSetSchedulerLockStatsCore(sint32 coreIndex); // attribute lock statistics of the calling host thread to an emulated core
+OSSchedulerLockStats __OSGetSchedulerLockStats(sint32 coreIndex); // coreIndex == Espresso::CORE_COUNT returns the statistics of all non-core host threads
+void __OSResetSchedulerLockStats();
+
 namespace coreinit
 {
 	uint32 OSIsInterruptEnabled();
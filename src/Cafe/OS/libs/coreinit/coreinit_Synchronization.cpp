@@ -26,30 +26,100 @@ namespace coreinit
 		event->userData = userData;
 	}
 
-	void OSResetEvent(OSEvent* event)
+	// the event state is also accessed without holding the scheduler lock
+	// uncontended signal, wait and reset operations only need to change the state and use atomics instead of the scheduler lock
+	// a thread which starts waiting publishes itself in the wait queue and then checks the state again, while a lock-free signal sets the state and then checks the wait queue
+	// both sides use a full fence in between, so at least one of them will notice the other
+	std::atomic<betype<OSEvent::EVENT_STATE>>* _OSEventState(OSEvent* event)
 	{
-		__OSLockScheduler();
-		if (event->state == OSEvent::EVENT_STATE::STATE_SIGNALED)
-			event->state = OSEvent::EVENT_STATE::STATE_NOT_SIGNALED;
-		__OSUnlockScheduler();
+		return _rawPtrToAtomic(&event->state);
 	}
 
-	void OSWaitEventInternal(OSEvent* event)
+	// in auto mode the signaled state is consumed atomically so only one thread can take it
+	bool _OSEventTryConsume(OSEvent* event)
 	{
-		if (event->state == OSEvent::EVENT_STATE::STATE_SIGNALED)
+		if (event->mode == OSEvent::EVENT_MODE::MODE_MANUAL)
+			return _OSEventState(event)->load() == OSEvent::EVENT_STATE::STATE_SIGNALED;
+		betype<OSEvent::EVENT_STATE> expected = OSEvent::EVENT_STATE::STATE_SIGNALED;
+		return _OSEventState(event)->compare_exchange_strong(expected, OSEvent::EVENT_STATE::STATE_NOT_SIGNALED);
+	}
+
+	// returns false if the event got signaled before the thread was visible in the wait queue, in that case the thread does not need to wait
+	bool _OSEventQueueWait(OSEvent* event, OSThread_t* thread)
+	{
+		cemu_assert_debug(__OSHasSchedulerLock());
+		event->threadQueue.queueOnly(thread);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (_OSEventTryConsume(event))
 		{
-			if (event->mode == OSEvent::EVENT_MODE::MODE_AUTO)
-				event->state = OSEvent::EVENT_STATE::STATE_NOT_SIGNALED;
+			event->threadQueue.undoQueueOnly(thread);
+			return false;
+		}
+		return true;
+	}
+
+	// called by a lock-free signal when it found threads in the wait queue after setting the state
+	void _OSEventWakeupAfterSignal(OSEvent* event, bool wakeupAll)
+	{
+		cemu_assert_debug(__OSHasSchedulerLock());
+		if (event->threadQueue.isEmpty())
+			return;
+		if (event->mode == OSEvent::EVENT_MODE::MODE_AUTO)
+		{
+			if (!_OSEventTryConsume(event))
+				return; // signal was already taken by another thread
+			if (wakeupAll)
+				event->threadQueue.wakeupEntireWaitQueue(true);
+			else
+				event->threadQueue.wakeupSingleThreadWaitQueue(true);
 		}
 		else
 		{
-			// enter wait queue
-			event->threadQueue.queueAndWait(OSGetCurrentThread());
+			event->threadQueue.wakeupEntireWaitQueue(true);
 		}
 	}
 
+	// returns true if the signal was handled without the scheduler lock
+	bool _OSEventSignalFast(OSEvent* event, bool wakeupAll)
+	{
+		auto* state = _OSEventState(event);
+		if (state->load() == OSEvent::EVENT_STATE::STATE_SIGNALED)
+			return true;
+		// racy read of the queue head, a false result only means the slow path is used
+		if (!event->threadQueue.head.IsNull())
+			return false;
+		betype<OSEvent::EVENT_STATE> expected = OSEvent::EVENT_STATE::STATE_NOT_SIGNALED;
+		if (!state->compare_exchange_strong(expected, OSEvent::EVENT_STATE::STATE_SIGNALED))
+			return true; // signaled concurrently
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (event->threadQueue.head.IsNull())
+			return true;
+		// a thread started waiting concurrently and did not see the signaled state
+		__OSLockScheduler();
+		_OSEventWakeupAfterSignal(event, wakeupAll);
+		__OSUnlockScheduler();
+		return true;
+	}
+
+	void OSResetEvent(OSEvent* event)
+	{
+		betype<OSEvent::EVENT_STATE> expected = OSEvent::EVENT_STATE::STATE_SIGNALED;
+		_OSEventState(event)->compare_exchange_strong(expected, OSEvent::EVENT_STATE::STATE_NOT_SIGNALED);
+	}
+
+	void OSWaitEventInternal(OSEvent* event)
+	{
+		if (_OSEventTryConsume(event))
+			return;
+		// enter wait queue
+		if (_OSEventQueueWait(event, OSGetCurrentThread()))
+			PPCCore_switchToSchedulerWithLock();
+	}
+
 	void OSWaitEvent(OSEvent* event)
 	{
+		if (_OSEventTryConsume(event))
+			return;
 		__OSLockScheduler();
 		OSWaitEventInternal(event);
 		__OSUnlockScheduler();
@@ -75,13 +145,10 @@ namespace coreinit
 
 	bool OSWaitEventWithTimeout(OSEvent* event, uint64 timeout)
 	{
+		if (_OSEventTryConsume(event))
+			return true;
 		__OSLockScheduler();
-		if (event->state == OSEvent::EVENT_STATE::STATE_SIGNALED)
-		{
-			if (event->mode == OSEvent::EVENT_MODE::MODE_AUTO)
-				event->state = OSEvent::EVENT_STATE::STATE_NOT_SIGNALED;
-		}
-		else
+		if (!_OSEventTryConsume(event))
 		{
 			if (timeout == 0)
 			{
@@ -100,8 +167,13 @@ namespace coreinit
 			data.thread = OSGetCurrentThread();
 			data.threadQueue = &event->threadQueue;
 			data.hasTimeout = false;
+			if (!_OSEventQueueWait(event, data.thread))
+			{
+				__OSUnlockScheduler();
+				return true;
+			}
 			auto hostAlarm = coreinit::OSHostAlarmCreate(OSGetTime() + coreinit::EspressoTime::ConvertNsToTimerTicks(timeout), 0, _OSWaitEventWithTimeoutHandler, &data);
-			event->threadQueue.queueAndWait(OSGetCurrentThread());
+			PPCCore_switchToSchedulerWithLock();
 			coreinit::OSHostAlarmDestroy(hostAlarm);
 			if (data.hasTimeout)
 			{
@@ -124,20 +196,22 @@ namespace coreinit
 		{
 			// in auto mode wake up one thread or if there is none then set signaled
 			if (event->threadQueue.isEmpty())
-				event->state = OSEvent::EVENT_STATE::STATE_SIGNALED;
+				_OSEventState(event)->store(OSEvent::EVENT_STATE::STATE_SIGNALED);
 			else
 				event->threadQueue.wakeupSingleThreadWaitQueue(true);
 		}
 		else
 		{
 			// in manual mode wake up all threads and set to signaled
-			event->state = OSEvent::EVENT_STATE::STATE_SIGNALED;
+			_OSEventState(event)->store(OSEvent::EVENT_STATE::STATE_SIGNALED);
 			event->threadQueue.wakeupEntireWaitQueue(true);
 		}
 	}
 
 	void OSSignalEvent(OSEvent* event)
 	{
+		if (_OSEventSignalFast(event, false))
+			return;
 		__OSLockScheduler();
 		OSSignalEventInternal(event);
 		__OSUnlockScheduler();
@@ -153,20 +227,22 @@ namespace coreinit
 		{
 			// in auto mode wake up one thread or if there is none then set signaled
 			if (event->threadQueue.isEmpty())
-				event->state = OSEvent::EVENT_STATE::STATE_SIGNALED;
+				_OSEventState(event)->store(OSEvent::EVENT_STATE::STATE_SIGNALED);
 			else
 				event->threadQueue.wakeupEntireWaitQueue(true);
 		}
 		else
 		{
 			// in manual mode wake up all threads and set to signaled
-			event->state = OSEvent::EVENT_STATE::STATE_SIGNALED;
+			_OSEventState(event)->store(OSEvent::EVENT_STATE::STATE_SIGNALED);
 			event->threadQueue.wakeupEntireWaitQueue(true);
 		}
 	}
 
 	void OSSignalEventAll(OSEvent* event)
 	{
+		if (_OSEventSignalFast(event, true))
+			return;
 		__OSLockScheduler();
 		OSSignalEventAllInternal(event);
 		__OSUnlockScheduler();
@@ -228,41 +304,67 @@ namespace coreinit
 		OSInitMutexEx(mutex, nullptr);
 	}
 
+	// the owner field is also modified without holding the scheduler lock
+	// uncontended and recursive lock and unlock operations only touch the mutex and the owned mutex queue of the current thread and use atomics instead of the scheduler lock
+	// like with OSEvent, a thread which starts waiting publishes itself in the wait queue before checking the owner again and a lock-free unlock checks the wait queue after clearing the owner
+
+	// returns false if the mutex is owned by another thread
+	bool _OSMutexTryAcquire(OSMutex* mutex, OSThread_t* currentThread)
+	{
+		if (mutex->owner.atomic_compare_exchange(nullptr, currentThread))
+		{
+			cemu_assert_debug(mutex->lockCount == 0);
+			mutex->lockCount = 1;
+			// cemu_assert_debug(mutex->next == nullptr && mutex->prev == nullptr); -> not zero initialized
+			currentThread->mutexQueue.addMutex(mutex);
+			return true;
+		}
+		else if (mutex->owner == currentThread)
+		{
+			mutex->lockCount = mutex->lockCount + 1;
+			return true;
+		}
+		return false;
+	}
+
+	// returns true if there are threads which need to be woken up
+	bool _OSMutexRelease(OSMutex* mutex, OSThread_t* currentThread)
+	{
+		mutex->lockCount = 0;
+		currentThread->mutexQueue.removeMutex(mutex);
+		if (!mutex->owner.atomic_compare_exchange(currentThread, nullptr))
+		{
+			cemu_assert_debug(false); // should never happen
+		}
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		return !mutex->threadQueue.head.IsNull();
+	}
+
 	void OSLockMutexInternal(OSMutex* mutex)
 	{
 		OSThread_t* currentThread = OSGetCurrentThread();
 		int_fast32_t failedAttempts = 0;
-		while (true)
+		while (!_OSMutexTryAcquire(mutex, currentThread))
 		{
-			if (mutex->owner == nullptr)
-			{
-				// acquire lock
-				mutex->owner = currentThread;
-				cemu_assert_debug(mutex->lockCount == 0);
-				mutex->lockCount = 1;
-				// cemu_assert_debug(mutex->next == nullptr && mutex->prev == nullptr); -> not zero initialized
-				currentThread->mutexQueue.addMutex(mutex);
-				break;
-			}
-			else if (mutex->owner == currentThread)
-			{
-				mutex->lockCount = mutex->lockCount + 1;
-				break;
-			}
+			if (failedAttempts >= 0x800)
+				cemuLog_log(LogType::Force, "Detected long-term contested OSLockMutex");
+			currentThread->waitingForMutex = mutex;
+			mutex->threadQueue.queueOnly(currentThread);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (mutex->owner.IsNull())
+				mutex->threadQueue.undoQueueOnly(currentThread); // released concurrently
 			else
-			{
-				if (failedAttempts >= 0x800)
-					cemuLog_log(LogType::Force, "Detected long-term contested OSLockMutex");
-				currentThread->waitingForMutex = mutex;
-				mutex->threadQueue.queueAndWait(currentThread);
-				currentThread->waitingForMutex = nullptr;
-				failedAttempts++;
-			}
+				PPCCore_switchToSchedulerWithLock();
+			currentThread->waitingForMutex = nullptr;
+			failedAttempts++;
 		}
 	}
 
 	void OSLockMutex(OSMutex* mutex)
 	{
+		OSThread_t* currentThread = OSGetCurrentThread();
+		if (currentThread->requestFlags != OSThread_t::REQUEST_FLAG_CANCEL && _OSMutexTryAcquire(mutex, currentThread))
+			return;
 		__OSLockScheduler();
 		OSTestThreadCancelInternal();
 		OSLockMutexInternal(mutex);
@@ -272,29 +374,13 @@ namespace coreinit
 	bool OSTryLockMutex(OSMutex* mutex)
 	{
 		OSThread_t* currentThread = OSGetCurrentThread();
+		if (currentThread->requestFlags != OSThread_t::REQUEST_FLAG_CANCEL)
+			return _OSMutexTryAcquire(mutex, currentThread);
 		__OSLockScheduler();
 		OSTestThreadCancelInternal();
-		if (mutex->owner == nullptr)
-		{
-			// acquire lock
-			mutex->owner = currentThread;
-			cemu_assert_debug(mutex->lockCount == 0);
-			mutex->lockCount = 1;
-			// cemu_assert_debug(mutex->next == nullptr && mutex->prev == nullptr); -> not zero initialized
-			currentThread->mutexQueue.addMutex(mutex);
-			// currentThread->cancelState = currentThread->cancelState | 0x10000;
-		}
-		else if (mutex->owner == currentThread)
-		{
-			mutex->lockCount = mutex->lockCount + 1;
-		}
-		else
-		{
-			__OSUnlockScheduler();
-			return false;
-		}
+		bool r = _OSMutexTryAcquire(mutex, currentThread);
 		__OSUnlockScheduler();
-		return true;
+		return r;
 	}
 
 	void OSUnlockMutexInternal(OSMutex* mutex)
@@ -302,21 +388,31 @@ namespace coreinit
 		OSThread_t* currentThread = OSGetCurrentThread();
 		cemu_assert_debug(mutex->owner == currentThread);
 		cemu_assert_debug(mutex->lockCount > 0);
-		mutex->lockCount = mutex->lockCount - 1;
-		if (mutex->lockCount == 0)
+		if (mutex->lockCount > 1)
 		{
-			currentThread->mutexQueue.removeMutex(mutex);
-			mutex->owner = nullptr;
-			if (!mutex->threadQueue.isEmpty())
-				mutex->threadQueue.wakeupSingleThreadWaitQueue(true, true);
+			mutex->lockCount = mutex->lockCount - 1;
+			return;
 		}
+		if (_OSMutexRelease(mutex, currentThread) && !mutex->threadQueue.isEmpty())
+			mutex->threadQueue.wakeupSingleThreadWaitQueue(true, true);
 		// currentThread->cancelState = currentThread->cancelState & ~0x10000;
 	}
 
 	void OSUnlockMutex(OSMutex* mutex)
 	{
+		OSThread_t* currentThread = OSGetCurrentThread();
+		cemu_assert_debug(mutex->owner == currentThread);
+		cemu_assert_debug(mutex->lockCount > 0);
+		if (mutex->lockCount > 1)
+		{
+			mutex->lockCount = mutex->lockCount - 1;
+			return;
+		}
+		if (!_OSMutexRelease(mutex, currentThread))
+			return;
 		__OSLockScheduler();
-		OSUnlockMutexInternal(mutex);
+		if (!mutex->threadQueue.isEmpty())
+			mutex->threadQueue.wakeupSingleThreadWaitQueue(true, true);
 		__OSUnlockScheduler();
 	}
 
@@ -350,10 +446,7 @@ namespace coreinit
 		cemu_assert_debug(mutex->owner == currentThread);
 		sint32 prevLockCount = mutex->lockCount;
 		// unlock mutex
-		mutex->lockCount = 0;
-		currentThread->mutexQueue.removeMutex(mutex);
-		mutex->owner = nullptr;
-		if (!mutex->threadQueue.isEmpty())
+		if (_OSMutexRelease(mutex, currentThread) && !mutex->threadQueue.isEmpty())
 			mutex->threadQueue.wakeupEntireWaitQueue(false);
 		// wait on condition
 		cond->threadQueue.queueAndWait(currentThread);
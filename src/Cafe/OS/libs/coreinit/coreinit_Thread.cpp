@@ -8,12 +8,18 @@
 #include "Cafe/HW/Espresso/Debugger/GDBStub.h"
 #include "Cafe/HW/Espresso/Interpreter/PPCInterpreterInternal.h"
 #include "Cafe/HW/Espresso/Recompiler/PPCRecompiler.h"
+#include "Cafe/HW/Espresso/Recompiler/PPCRecompilerCodeHeap.h"
 
 #include "util/helpers/Semaphore.h"
 #include "util/helpers/ConcurrentQueue.h"
 #include "util/Fiber/Fiber.h"
 
 #include "util/helpers/helpers.h"
+#include "config/ActiveSettings.h"
+
+#if BOOST_OS_WINDOWS
+#include <timeapi.h>
+#endif
 
 SlimRWLock srwlock_activeThreadList;
 
@@ -39,9 +45,19 @@ namespace coreinit
 
 	SysAllocator<OSThreadQueue> g_activeThreadQueue; // list of all threads (can include non-detached inactive threads)
 
-	SysAllocator<OSThreadQueue, 3> g_coreRunQueue;
+	// each core has one run queue per effective priority. Driver, IO and app threads each occupy a range of 32 priorities
+	// a bitmap of non-empty queues allows picking the next thread without scanning all runable threads
+	#define OS_RUN_QUEUE_PRIORITY_COUNT	(96)
+
+	SysAllocator<OSThreadQueue, PPC_CORE_COUNT * OS_RUN_QUEUE_PRIORITY_COUNT> g_coreRunQueue;
+	uint64 g_coreRunQueuePriorityMask[PPC_CORE_COUNT][2];
 	CounterSemaphore g_coreRunQueueThreadCount[3];
 
+	// work stealing (opt-in per game profile, multi-core only)
+	bool g_workStealingEnabled;
+	std::atomic<sint32> g_stealableThreadCount; // queued threads with HOST_FLAG_DEFAULT_AFFINITY
+	std::atomic<uint64> g_stolenThreadCount;
+
 	bool g_isMulticoreMode;
 
 	thread_local uint32 t_assignedCoreIndex;
@@ -61,6 +77,7 @@ namespace coreinit
 		uint8  padding[1024 * 128];
 		PPCInterpreter_t ppcInstance;
 		uint32 selectedCore;
+		bool resumeWithGlobalLock{}; // lock that __OSThreadSwitchToNext() was entered with
 	};
 
 	std::unordered_map<OSThread_t*, OSHostThread*> s_threadToFiber;
@@ -98,6 +115,8 @@ namespace coreinit
 
 		auto hostThread = s_threadToFiber[thread];
 		s_threadToFiber.erase(thread);
+		// threads can exit or be cancelled while inside recompiled code (e.g. OSExitThread is called from it), they will never leave it
+		PPCRecompilerCodeHeap_releaseThread(&hostThread->ppcInstance);
 		_deleteQueue = hostThread;
 	}
 
@@ -352,7 +371,10 @@ namespace coreinit
 		thread->coretimeSumQuantumStart = 0;
 		thread->totalCycles = 0;
 
-		for(auto& it : thread->padding68C)
+		thread->hostFlags = OSThread_t::HOST_FLAG_NONE;
+		thread->hostQuantum = 0;
+		thread->hostQuantumScore = 0;
+		for(auto& it : thread->padding698)
 			it = 0;
 	}
 
@@ -438,7 +460,10 @@ namespace coreinit
 		thread->context.affinity = attrBits & 7;
 		thread->attr = attrBits;
 		if ((attrBits & 7) == 0) // if no explicit affinity is given, use the current core
+		{
 			SetThreadAffinityToCore(thread, OSGetCoreId());
+			thread->hostFlags |= OSThread_t::HOST_FLAG_DEFAULT_AFFINITY;
+		}
 		if(currentThread)
 		{
 			for(sint32 i=0; i<Espresso::CORE_COUNT; i++)
@@ -639,6 +664,9 @@ namespace coreinit
 
 	void OSYieldThread()
 	{
+		// no other thread to yield to
+		if (__OSThreadCanKeepRunning(OSGetCurrentThread()))
+			return;
 		PPCCore_switchToScheduler();
 	}
 
@@ -720,41 +748,121 @@ namespace coreinit
 		return true;
 	}
 
+	uint32 __OSGetRunQueuePriority(OSThread_t* thread)
+	{
+		sint32 priority = thread->effectivePriority;
+		cemu_assert_debug(priority >= 0 && priority < OS_RUN_QUEUE_PRIORITY_COUNT);
+		return (uint32)std::clamp<sint32>(priority, 0, OS_RUN_QUEUE_PRIORITY_COUNT - 1);
+	}
+
+	OSThreadQueue* __OSGetRunQueue(uint32 coreIndex, uint32 priority)
+	{
+		return g_coreRunQueue.GetPtr() + coreIndex * OS_RUN_QUEUE_PRIORITY_COUNT + priority;
+	}
+
+	void __OSWakeupIdleCoresForStealing();
+
 	// adds the thread to each core's run queue if in runable state
 	void __OSAddReadyThreadToRunQueue(OSThread_t* thread)
 	{
         cemu_assert_debug(MMU_IsInPPCMemorySpace(thread));
         cemu_assert_debug(thread->IsValidMagic());
-		cemu_assert_debug(__OSHasSchedulerLock());
+		cemu_assert_debug(__OSHasAnySchedulerLock());
 
 		if (thread->state != OSThread_t::THREAD_STATE::STATE_READY)
 			return;
 		if (thread->suspendCounter != 0)
 			return;
+		uint32 priority = __OSGetRunQueuePriority(thread);
+		bool wasQueued = false;
+		bool isQueued = false;
 		for (sint32 i = 0; i < PPC_CORE_COUNT; i++)
 		{
 			if (thread->currentRunQueue[i] != nullptr)
+			{
+				wasQueued = true;
 				continue; // already on the queue
+			}
 			// check affinity
 			if(!thread->context.hasCoreAffinitySet(i))
 				continue;
-			g_coreRunQueue.GetPtr()[i].addThread(thread, thread->linkRun + i);
-			thread->currentRunQueue[i] = (g_coreRunQueue.GetPtr() + i);
+			cemu_assert_debug(__OSHasSchedulerCoreLock(i));
+			// appending to the tail keeps threads of equal priority in FIFO order
+			OSThreadQueue* runQueue = __OSGetRunQueue(i, priority);
+			runQueue->addThread(thread, thread->linkRun + i);
+			thread->currentRunQueue[i] = runQueue;
+			g_coreRunQueuePriorityMask[i][priority / 64] |= (1ull << (priority & 63));
 			g_coreRunQueueThreadCount[i].increment();
+			if (!g_isMulticoreMode || i == 1)
+				__OSWakeupIdleMainCore();
+			isQueued = true;
+		}
+		if (isQueued && !wasQueued && (thread->hostFlags & OSThread_t::HOST_FLAG_DEFAULT_AFFINITY))
+		{
+			g_stealableThreadCount++;
+			if (g_workStealingEnabled)
+				__OSWakeupIdleCoresForStealing();
 		}
 	}
 
 	void __OSRemoveThreadFromRunQueues(OSThread_t* thread)
 	{
-		cemu_assert_debug(__OSHasSchedulerLock());
+		cemu_assert_debug(__OSHasAnySchedulerLock());
+		bool wasQueued = false;
 		for (sint32 i = 0; i < PPC_CORE_COUNT; i++)
 		{
 			if(thread->currentRunQueue[i] == nullptr)
 				continue;
-			g_coreRunQueue.GetPtr()[i].removeThread(thread, thread->linkRun + i);
+			cemu_assert_debug(__OSHasSchedulerCoreLock(i));
+			wasQueued = true;
+			OSThreadQueue* runQueue = thread->currentRunQueue[i].GetPtr();
+			runQueue->removeThread(thread, thread->linkRun + i);
+			if (runQueue->head == nullptr)
+			{
+				uint32 priority = (uint32)(runQueue - __OSGetRunQueue(i, 0));
+				cemu_assert_debug(priority < OS_RUN_QUEUE_PRIORITY_COUNT);
+				g_coreRunQueuePriorityMask[i][priority / 64] &= ~(1ull << (priority & 63));
+			}
 			thread->currentRunQueue[i] = nullptr;
 			g_coreRunQueueThreadCount[i].decrement();
 		}
+		if (wasQueued && (thread->hostFlags & OSThread_t::HOST_FLAG_DEFAULT_AFFINITY))
+			g_stealableThreadCount--;
+	}
+
+	bool __OSIsThreadQueued(OSThread_t* thread)
+	{
+		for (sint32 i = 0; i < PPC_CORE_COUNT; i++)
+		{
+			if (thread->currentRunQueue[i] != nullptr)
+				return true;
+		}
+		return false;
+	}
+
+	void __OSClearDefaultAffinityFlag(OSThread_t* thread)
+	{
+		cemu_assert_debug(__OSHasSchedulerLock());
+		if ((thread->hostFlags & OSThread_t::HOST_FLAG_DEFAULT_AFFINITY) == 0)
+			return;
+		// the flag must not change while the thread is queued, otherwise g_stealableThreadCount gets out of sync
+		bool isQueued = __OSIsThreadQueued(thread);
+		if (isQueued)
+			__OSRemoveThreadFromRunQueues(thread);
+		thread->hostFlags &= ~OSThread_t::HOST_FLAG_DEFAULT_AFFINITY;
+		if (isQueued)
+			__OSAddReadyThreadToRunQueue(thread);
+	}
+
+	void __OSWakeupIdleCoresForStealing()
+	{
+		for (sint32 i = 0; i < PPC_CORE_COUNT; i++)
+		{
+			if (i == 1)
+				__OSWakeupIdleMainCore();
+			else
+				g_coreRunQueueThreadCount[i].wakeup();
+		}
 	}
 
 	// returns true if thread runs on same core and has higher priority
@@ -865,6 +973,7 @@ namespace coreinit
 	{
 		cemu_assert_debug((affinityMask & ~7) == 0);
 		__OSLockScheduler();
+		__OSClearDefaultAffinityFlag(thread); // explicit affinity is never ignored by work stealing
 		uint32 prevAffinityMask = thread->context.getAffinity();
 		if (thread->state == OSThread_t::THREAD_STATE::STATE_RUNNING)
 		{
@@ -925,13 +1034,17 @@ namespace coreinit
 
 	void __OSUpdateThreadEffectivePriority(OSThread_t* thread)
 	{
-		if (thread->context.boostCount != 0)
-		{
-			// temporarily boosted threads have their priority set to 0 (maximum)
-			thread->effectivePriority = 0;
+		// temporarily boosted threads have their priority set to 0 (maximum)
+		sint32 newPriority = thread->context.boostCount != 0 ? 0 : (sint32)thread->basePriority;
+		if (thread->effectivePriority == newPriority)
 			return;
-		}
-		thread->effectivePriority = thread->basePriority;
+		// queued threads need to be moved to the run queue matching their new priority
+		bool isQueued = __OSIsThreadQueued(thread);
+		if (isQueued)
+			__OSRemoveThreadFromRunQueues(thread);
+		thread->effectivePriority = newPriority;
+		if (isQueued)
+			__OSAddReadyThreadToRunQueue(thread);
 	}
 
 	bool OSSetThreadPriority(OSThread_t* thread, sint32 newPriority)
@@ -1027,13 +1140,57 @@ namespace coreinit
 		__OSUnlockScheduler();
 	}
 
-	void __OSSwitchToThreadFiber(OSThread_t* thread, uint32 coreIndex)
+	// scheduler locking for thread switches
+	// in multi-core mode a thread which can only run on the current core is switched while holding just the lock of that core. Other cores access it, and the core's run queue, only with the global lock
+	// everything else needs the global lock, e.g. threads linked into the run queues of multiple cores or threads running on another core's behalf (work stealing)
+	bool __OSIsCoreLocalThread(OSThread_t* thread)
 	{
-		cemu_assert_debug(__OSHasSchedulerLock());
+		return g_isMulticoreMode && thread->context.getAffinity() == (1u << t_assignedCoreIndex);
+	}
+
+	void __OSLockSchedulerForThreadSwitch(OSThread_t* thread)
+	{
+		if (__OSIsCoreLocalThread(thread))
+		{
+			__OSLockSchedulerCore(t_assignedCoreIndex);
+			// affinity changes require the global lock, so once the core lock is held the result is stable
+			if (__OSIsCoreLocalThread(thread))
+				return;
+			__OSUnlockSchedulerCore(t_assignedCoreIndex);
+		}
+		__OSLockScheduler();
+	}
+
+	// the lock is handed over to the fiber which is switched to. If that fiber doesn't need the global lock, only the lock of the current core is kept
+	// until the switch has completed, no other core may be able to pick up the outgoing thread. It must not be queued on another core and it must not be exiting, since exited threads get their host thread deleted
+	void __OSThreadSwitchReleaseGlobalLock(OSThread_t* outgoingThread, uint32 coreIndex)
+	{
+		if (!g_isMulticoreMode || !__OSHasSchedulerLock())
+			return;
+		if (outgoingThread)
+		{
+			if (outgoingThread->state != OSThread_t::THREAD_STATE::STATE_READY && outgoingThread->state != OSThread_t::THREAD_STATE::STATE_WAITING)
+				return;
+			for (uint32 i = 0; i < PPC_CORE_COUNT; i++)
+			{
+				if (i != coreIndex && outgoingThread->currentRunQueue[i] != nullptr)
+					return;
+			}
+		}
+		__OSDowngradeSchedulerLock(coreIndex);
+	}
+
+	// outgoingThread is null when switching from the idle fiber
+	void __OSSwitchToThreadFiber(OSThread_t* thread, uint32 coreIndex, OSThread_t* outgoingThread)
+	{
+		cemu_assert_debug(__OSHasSchedulerCoreLock(coreIndex));
 		cemu_assert_debug(s_threadToFiber.find(thread) != s_threadToFiber.end());
 
 		OSHostThread* hostThread = s_threadToFiber.find(thread)->second;
+		cemu_assert_debug(!hostThread->resumeWithGlobalLock || __OSHasSchedulerLock()); // see __OSGetNextRunableThread
 		hostThread->selectedCore = coreIndex;
+		if (!hostThread->resumeWithGlobalLock)
+			__OSThreadSwitchReleaseGlobalLock(outgoingThread, coreIndex);
 		Fiber::Switch(hostThread->m_fiber);
 	}
 
@@ -1095,8 +1252,69 @@ namespace coreinit
 		thread->context.srr0 = hCPU->instructionPointer;
 	}
 
+	// adaptive thread quantum
+	// threads which keep running until their quantum is exhausted get a longer quantum (fewer context switches), threads which block or yield early stay at the base quantum
+	// while a thread of equal or higher priority is waiting on the same core the base quantum is used, so waiting threads are not delayed by more than one extended timeslice
+	#define OS_ADAPTIVE_QUANTUM_MAX_SCALE	(4)
+	#define OS_ADAPTIVE_QUANTUM_SCORE_MAX	(256)
+
+	uint32 __OSThreadGetQuantum(OSThread_t* thread)
+	{
+		if (!ppcThreadQuantumAdaptive || thread->hostQuantum == 0)
+			return ppcThreadQuantum;
+		return thread->hostQuantum;
+	}
+
+	bool __OSHasWaitingThreadWithPriority(uint32 coreIndex, sint32 maxPriority)
+	{
+		uint32 priority = (uint32)std::clamp<sint32>(maxPriority, 0, OS_RUN_QUEUE_PRIORITY_COUNT - 1);
+		const uint64* priorityMask = g_coreRunQueuePriorityMask[coreIndex];
+		if (priority < 64)
+			return (priorityMask[0] & (~0ull >> (63 - priority))) != 0;
+		return priorityMask[0] != 0 || (priorityMask[1] & (~0ull >> (127 - priority))) != 0;
+	}
+
+	// called at the end of each timeslice, before the thread is put back on the run queue
+	void __OSThreadUpdateAdaptiveQuantum(OSThread_t* thread, PPCInterpreter_t* hCPU)
+	{
+		if (!ppcThreadQuantumAdaptive)
+			return;
+		// blocking or yielding leaves cycles unused, PPCInterpreter_relinquishTimeslice() marks them as skipped
+		bool quantumExhausted = hCPU->remainingCycles < 0 && hCPU->skippedCycles == 0;
+		uint32 score = thread->hostQuantumScore;
+		if (quantumExhausted)
+			score += (OS_ADAPTIVE_QUANTUM_SCORE_MAX - score) / 4;
+		else
+			score -= score / 4;
+		thread->hostQuantumScore = score;
+		// in single-core mode threads of all cores share the same host thread
+		bool hasWaitingThreads = false;
+		for (uint32 i = 0; i < PPC_CORE_COUNT; i++)
+		{
+			if (g_isMulticoreMode && i != PPCInterpreter_getCoreIndex(hCPU))
+				continue;
+			hasWaitingThreads |= __OSHasWaitingThreadWithPriority(i, thread->effectivePriority);
+		}
+		uint32 quantum = ppcThreadQuantum;
+		if (!hasWaitingThreads)
+			quantum += (uint32)((uint64)ppcThreadQuantum * (OS_ADAPTIVE_QUANTUM_MAX_SCALE - 1) * score / OS_ADAPTIVE_QUANTUM_SCORE_MAX);
+		thread->hostQuantum = quantum;
+	}
+
+	void __OSThreadAccountExecutedCycles(OSThread_t* thread, PPCInterpreter_t* hCPU)
+	{
+		sint64 executedCycles = (sint64)thread->quantumTicks - (sint64)hCPU->remainingCycles;
+		executedCycles = std::max<sint64>(executedCycles, 0);
+		if (executedCycles < (sint64)hCPU->skippedCycles)
+			executedCycles = 0;
+		else
+			executedCycles -= hCPU->skippedCycles;
+		thread->totalCycles += (uint64)executedCycles;
+	}
+
 	void __OSStoreThread(OSThread_t* thread, PPCInterpreter_t* hCPU)
 	{
+		__OSThreadUpdateAdaptiveQuantum(thread, hCPU);
 		if (thread->state == OSThread_t::THREAD_STATE::STATE_RUNNING)
 		{
 			thread->state = OSThread_t::THREAD_STATE::STATE_READY;
@@ -1114,13 +1332,7 @@ namespace coreinit
 		thread->requestFlags = (OSThread_t::REQUEST_FLAG_BIT)(thread->requestFlags & OSThread_t::REQUEST_FLAG_CANCEL); // remove all flags except cancel flag
 
 		// update total cycles
-		sint64 executedCycles = (sint64)thread->quantumTicks - (sint64)hCPU->remainingCycles;
-		executedCycles = std::max<sint64>(executedCycles, 0);
-		if (executedCycles < (sint64)hCPU->skippedCycles)
-			executedCycles = 0;
-		else
-			executedCycles -= hCPU->skippedCycles;
-		thread->totalCycles += (uint64)executedCycles;
+		__OSThreadAccountExecutedCycles(thread, hCPU);
 		// store context and set current thread to null
 		__OSThreadStoreContext(hCPU, thread);
 		OSSetCurrentThread(OSGetCoreId(), nullptr);
@@ -1139,7 +1351,7 @@ namespace coreinit
 		OSSetCurrentThread(OSGetCoreId(), thread);
 		__OSThreadLoadContext(hCPU, thread);
 		thread->context.upir = coreIndex;
-		thread->quantumTicks = ppcThreadQuantum;
+		thread->quantumTicks = __OSThreadGetQuantum(thread);
 		// statistics
 		thread->wakeUpTime = PPCInterpreter_getMainCoreCycleCounter();
 		thread->wakeUpCount = thread->wakeUpCount + 1;
@@ -1151,7 +1363,7 @@ namespace coreinit
 	{
 		uint32 coreIndex = PPCInterpreter_getCoreIndex(hCPU);
 		// run one timeslice
-		hCPU->remainingCycles = ppcThreadQuantum;
+		hCPU->remainingCycles = (sint32)(uint64)thread->quantumTicks;
 		hCPU->skippedCycles = 0;
 		// we add a slight randomized variance to the thread quantum to avoid getting stuck in repeated code sequences where one or multiple threads always unload inside a lock
 		// this was seen in Mario Party 10 during early boot where several OSLockMutex operations would align in such a way that one thread would never successfully acquire the lock
@@ -1161,24 +1373,90 @@ namespace coreinit
 		s_lehmer_lcg[coreIndex] = (uint32)((uint64)s_lehmer_lcg[coreIndex] * 279470273ull % 0xfffffffbull);
 	}
 
-	OSThread_t* __OSGetNextRunableThread(uint32 coreIndex)
+	// core local fast path for rescheduling. If no other thread is runnable on this core the current thread would be picked again, so it keeps running without taking the scheduler lock
+	// not used for the main core since it has to go through the idle loop to process system events
+	bool __OSThreadCanKeepRunning(OSThread_t* thread)
 	{
-		cemu_assert_debug(__OSHasSchedulerLock());
-		// pick thread, then remove from run queue
-		OSThreadQueue* runQueue = g_coreRunQueue.GetPtr() + coreIndex;
+		if (!g_isMulticoreMode || t_assignedCoreIndex == 1)
+			return false;
+		if (!g_coreRunQueueThreadCount[t_assignedCoreIndex].isZero())
+			return false;
+		if (!sSchedulerActive.load(std::memory_order::relaxed))
+			return false;
+		// suspend, cancel and affinity changes made by other cores are handled by the regular path
+		if (thread->state != OSThread_t::THREAD_STATE::STATE_RUNNING || thread->requestFlags != OSThread_t::REQUEST_FLAG_NONE || thread->suspendCounter != 0)
+			return false;
+		if (!thread->context.hasCoreAffinitySet(t_assignedCoreIndex))
+			return false;
+		return true;
+	}
 
-		OSThread_t* threadItr = runQueue->head.GetPtr();
-		OSThread_t* selectedThread = nullptr;
-		if (!threadItr)
-			return nullptr;
-		selectedThread = threadItr;
+	void __OSThreadContinueTimeslice(OSThread_t* thread, PPCInterpreter_t* hCPU)
+	{
+		__OSThreadAccountExecutedCycles(thread, hCPU);
+		__OSThreadUpdateAdaptiveQuantum(thread, hCPU);
+		thread->quantumTicks = __OSThreadGetQuantum(thread);
+		__OSThreadStartTimeslice(thread, hCPU);
+	}
 
-		while (threadItr)
+	bool __OSCanStealThreads()
+	{
+		return g_workStealingEnabled && g_stealableThreadCount.load(std::memory_order::relaxed) > 0;
+	}
+
+	// work stealing: an idle core picks the highest priority thread without explicit affinity that is queued on another core which is busy
+	// the thread goes back to its own core's run queue at the end of the timeslice
+	OSThread_t* __OSStealRunableThread(uint32 coreIndex)
+	{
+		cemu_assert_debug(__OSHasSchedulerLock());
+		OSThread_t* selectedThread = nullptr;
+		uint32 selectedPriority = OS_RUN_QUEUE_PRIORITY_COUNT;
+		for (uint32 victimCoreIndex = 0; victimCoreIndex < PPC_CORE_COUNT; victimCoreIndex++)
 		{
-			if (threadItr->effectivePriority < selectedThread->effectivePriority)
-				selectedThread = threadItr;
-			threadItr = threadItr->linkRun[coreIndex].next.GetPtr();
+			if (victimCoreIndex == coreIndex || __currentCoreThread[victimCoreIndex] == nullptr)
+				continue; // an idle core runs its own threads
+			for (uint32 priority = 0; priority < selectedPriority; priority++)
+			{
+				if ((g_coreRunQueuePriorityMask[victimCoreIndex][priority / 64] & (1ull << (priority & 63))) == 0)
+					continue;
+				OSThread_t* threadItr = __OSGetRunQueue(victimCoreIndex, priority)->head.GetPtr();
+				while (threadItr && (threadItr->hostFlags & OSThread_t::HOST_FLAG_DEFAULT_AFFINITY) == 0)
+					threadItr = threadItr->linkRun[victimCoreIndex].next.GetPtr();
+				if (threadItr)
+				{
+					selectedThread = threadItr;
+					selectedPriority = priority;
+					break;
+				}
+			}
 		}
+		if (selectedThread)
+			g_stolenThreadCount++;
+		return selectedThread;
+	}
+
+	// with only the core lock held this returns null if the next thread would need the global lock, the caller has to retry with the global lock
+	// this includes threads which were switched out while holding the global lock (e.g. woken up waiters). The lock is handed over to them and can't be upgraded without a window in which other cores could modify the thread
+	OSThread_t* __OSGetNextRunableThread(uint32 coreIndex)
+	{
+		cemu_assert_debug(__OSHasSchedulerCoreLock(coreIndex));
+		bool hasGlobalLock = __OSHasSchedulerLock();
+		// pick the oldest thread from the highest priority non-empty queue, then remove it from all run queues
+		uint64* priorityMask = g_coreRunQueuePriorityMask[coreIndex];
+		OSThread_t* selectedThread;
+		if (priorityMask[0] != 0)
+			selectedThread = __OSGetRunQueue(coreIndex, std::countr_zero(priorityMask[0]))->head.GetPtr();
+		else if (priorityMask[1] != 0)
+			selectedThread = __OSGetRunQueue(coreIndex, 64 + std::countr_zero(priorityMask[1]))->head.GetPtr();
+		else if (__OSCanStealThreads() && hasGlobalLock)
+			selectedThread = __OSStealRunableThread(coreIndex);
+		else
+			return nullptr;
+		if (!selectedThread)
+			return nullptr;
+		// a thread that can run on other cores is linked into their run queues as well
+		if (!hasGlobalLock && (selectedThread->context.getAffinity() != (1u << coreIndex) || s_threadToFiber.find(selectedThread)->second->resumeWithGlobalLock))
+			return nullptr;
 
 		cemu_assert_debug(selectedThread->state == OSThread_t::THREAD_STATE::STATE_READY);
 
@@ -1212,59 +1490,152 @@ namespace coreinit
 
 	Fiber* g_idleLoopFiber[3]{};
 
+	// instead of polling system events in a busy loop the idle main core can sleep until the next alarm or AX update is due
+	// threads becoming runnable and alarms with an earlier deadline wake it up. The sleep duration is capped so that events without a wakeup (e.g. NFP) are still polled regularly
+	#define OS_IDLE_WAIT_MAX_SLEEP_US	(2000)
+	#define OS_IDLE_WAIT_MIN_SLEEP_US	(200) // shorter waits are not worth the wakeup latency
+
+	// the idle core registers itself as sleeper, then reads the wakeup sequence before it determines the sleep duration and only sleeps if the sequence is unchanged
+	// wakers bump the sequence and only take the mutex to notify if a sleeper is registered. Both sides are sequentially consistent, so either the sleeper sees the new sequence or the waker sees the sleeper
+	// this way a wakeup (e.g. an alarm with an earlier deadline) can't get lost between the check and the sleep, and run queue inserts don't touch the mutex while the main core is busy
+	bool g_idleWaitEnabled;
+	std::mutex g_idleWaitMutex;
+	std::condition_variable g_idleWaitCond;
+	std::atomic_bool g_idleWaitHasSleeper;
+	std::atomic<uint64> g_idleWaitWakeupSequence;
+	uint64 g_idleWaitSleepCount; // only accessed by the main core
+	uint64 g_idleWaitSleptUs; // only accessed by the main core
+
+	bool __OSMainCoreHasRunnableThreads()
+	{
+		if (g_isMulticoreMode)
+			return !g_coreRunQueueThreadCount[1].isZero();
+		for (sint32 i = 0; i < PPC_CORE_COUNT; i++)
+		{
+			if (!g_coreRunQueueThreadCount[i].isZero())
+				return true;
+		}
+		return false;
+	}
+
+	void __OSWakeupIdleMainCore()
+	{
+		if (!g_idleWaitEnabled)
+			return;
+		g_idleWaitWakeupSequence.fetch_add(1, std::memory_order_seq_cst);
+		if (!g_idleWaitHasSleeper.load(std::memory_order_seq_cst))
+			return;
+		std::unique_lock _l(g_idleWaitMutex);
+		g_idleWaitCond.notify_one();
+	}
+
+	void __OSThreadMainCoreIdleSleep(uint64 wakeupSequence)
+	{
+		std::chrono::nanoseconds timeout = std::min<std::chrono::nanoseconds>(snd_core::AXOut_getTimeUntilNextUpdate(), std::chrono::microseconds(OS_IDLE_WAIT_MAX_SLEEP_US));
+		uint64 currentTick = OSGetTime();
+		uint64 soonestAlarm = OSHostAlarmGetSoonestFireTick();
+		if (soonestAlarm <= currentTick)
+			return;
+		if (soonestAlarm - currentTick < (uint64)EspressoTime::ConvertNsToTimerTicks(OS_IDLE_WAIT_MAX_SLEEP_US * 1000ull))
+			timeout = std::min<std::chrono::nanoseconds>(timeout, std::chrono::nanoseconds((soonestAlarm - currentTick) * 1000000000ull / EspressoTime::GetTimerClock()));
+		if (timeout < std::chrono::microseconds(OS_IDLE_WAIT_MIN_SLEEP_US))
+			return;
+		std::unique_lock _l(g_idleWaitMutex);
+		auto sleepStart = std::chrono::steady_clock::now();
+		g_idleWaitCond.wait_for(_l, timeout, [wakeupSequence]() { return g_idleWaitWakeupSequence.load(std::memory_order_seq_cst) != wakeupSequence || __OSMainCoreHasRunnableThreads() || !sSchedulerActive.load(std::memory_order::relaxed); });
+		_l.unlock();
+		g_idleWaitSleepCount++;
+		g_idleWaitSleptUs += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sleepStart).count();
+	}
+
+	void __OSThreadMainCoreIdleWait()
+	{
+		g_idleWaitHasSleeper.store(true, std::memory_order_seq_cst);
+		uint64 wakeupSequence = g_idleWaitWakeupSequence.load(std::memory_order_seq_cst);
+		__OSThreadMainCoreIdleSleep(wakeupSequence);
+		g_idleWaitHasSleeper.store(false, std::memory_order_relaxed);
+	}
+
 	// idle fiber per core if no thread is runnable
 	// this is necessary since we can't block in __OSThreadSwitchToNext() (__OSStoreThread + thread switch must happen inside same scheduler lock)
 	void __OSThreadCoreIdle(void* unusedParam)
 	{
 		bool isMainCore = g_isMulticoreMode == false || t_assignedCoreIndex == 1;
 		sint32 coreIndex = t_assignedCoreIndex;
-		__OSUnlockScheduler();
+		__OSUnlockSchedulerHeld();
 		while (true)
 		{
-			if (!g_coreRunQueueThreadCount[coreIndex].isZero()) // avoid hammering the lock on the main core if there is no runable thread
+			if (!g_coreRunQueueThreadCount[coreIndex].isZero() || __OSCanStealThreads()) // avoid hammering the lock on the main core if there is no runable thread
 			{
-				__OSLockScheduler();
-				OSThread_t* nextThread = __OSGetNextRunableThread(coreIndex);
+				OSThread_t* nextThread = nullptr;
+				if (g_isMulticoreMode)
+				{
+					__OSLockSchedulerCore(coreIndex);
+					nextThread = __OSGetNextRunableThread(coreIndex);
+					if (!nextThread && (!g_coreRunQueueThreadCount[coreIndex].isZero() || __OSCanStealThreads()))
+					{
+						// the next thread is also queued on other cores or has to be stolen
+						__OSUnlockSchedulerCore(coreIndex);
+						__OSLockScheduler();
+						nextThread = __OSGetNextRunableThread(coreIndex);
+					}
+				}
+				else
+				{
+					__OSLockScheduler();
+					nextThread = __OSGetNextRunableThread(coreIndex);
+				}
 				if (nextThread)
 				{
 					cemu_assert_debug(nextThread->state == OSThread_t::THREAD_STATE::STATE_RUNNING);
-					__OSSwitchToThreadFiber(nextThread, coreIndex);
+					__OSSwitchToThreadFiber(nextThread, coreIndex, nullptr);
 				}
-				__OSUnlockScheduler();
+				__OSUnlockSchedulerHeld();
 			}
 			if (isMainCore)
 			{
 				__OSCheckSystemEvents();
 				if(g_isMulticoreMode == false)
 					coreIndex = (coreIndex + 1) % 3;
+				if (g_idleWaitEnabled && !__OSMainCoreHasRunnableThreads())
+					__OSThreadMainCoreIdleWait();
 			}
 			else
 			{
 				// wait for semaphore (only in multicore mode)
-				g_coreRunQueueThreadCount[t_assignedCoreIndex].waitUntilNonZero();
+				if (g_workStealingEnabled)
+					g_coreRunQueueThreadCount[t_assignedCoreIndex].waitUntilNonZeroOrWakeup(); // also woken up when a stealable thread is queued on another core
+				else
+					g_coreRunQueueThreadCount[t_assignedCoreIndex].waitUntilNonZero();
 				if (!sSchedulerActive.load(std::memory_order::relaxed))
 					Fiber::Switch(*t_schedulerFiber); // switch back to original thread to exit
 			}
 		}
 	}
 
+	// called with either the global lock or, for threads which are local to the current core, the lock of the current core (see __OSLockSchedulerForThreadSwitch)
+	// returns holding at least the same lock
 	void __OSThreadSwitchToNext()
 	{
-		cemu_assert_debug(__OSHasSchedulerLock());
-
 		OSHostThread* hostThread = (OSHostThread*)Fiber::GetFiberPrivateData();
         cemu_assert_debug(hostThread);
+		OSThread_t* currentThread = OSGetCurrentThread();
+		hostThread->resumeWithGlobalLock = __OSHasSchedulerLock();
+		cemu_assert_debug(hostThread->resumeWithGlobalLock || (__OSHasSchedulerCoreLock(t_assignedCoreIndex) && __OSIsCoreLocalThread(currentThread)));
 
 		//if (ppcInterpreterCurrentInstance)
 		//	debug_printf("Core %d store thread %08x (t = %d)\n", hostThread->ppcInstance.sprNew.UPIR, memory_getVirtualOffsetFromPointer(hostThread->thread), t_assignedCoreIndex);
 
+		// blocking HLE calls switch out of recompiled code, don't let the parked thread stall the reuse of freed code
+		PPCRecompilerCodeHeap_park(&hostThread->ppcInstance);
+
 		// store context of current thread
-		__OSStoreThread(OSGetCurrentThread(), &hostThread->ppcInstance);
+		__OSStoreThread(currentThread, &hostThread->ppcInstance);
 		cemu_assert_debug(PPCInterpreter_getCurrentInstance() == nullptr);
 
 		if (!sSchedulerActive.load(std::memory_order::relaxed))
 		{
-			__OSUnlockScheduler();
+			__OSUnlockSchedulerHeld();
 			Fiber::Switch(*t_schedulerFiber); // switch back to original thread entry for it to exit
 		}
 		// choose core
@@ -1284,24 +1655,27 @@ namespace coreinit
 
 		// find next thread to run
 		// for main thread we force switching to the idle loop since it calls __OSCheckSystemEvents()
-		if(isMainThread)
-			Fiber::Switch(*g_idleLoopFiber[t_assignedCoreIndex]);
-		else if (OSThread_t* nextThread = __OSGetNextRunableThread(coreIndex))
+		// the idle loop also retries with the global lock if the next thread can't be picked with just the core lock
+		OSThread_t* nextThread = isMainThread ? nullptr : __OSGetNextRunableThread(coreIndex);
+		if (nextThread)
 		{
 			cemu_assert_debug(nextThread->state == OSThread_t::THREAD_STATE::STATE_RUNNING);
-			__OSSwitchToThreadFiber(nextThread, coreIndex);
+			__OSSwitchToThreadFiber(nextThread, coreIndex, currentThread);
 		}
 		else
 		{
+			__OSThreadSwitchReleaseGlobalLock(currentThread, coreIndex);
 			Fiber::Switch(*g_idleLoopFiber[t_assignedCoreIndex]);
 		}
 
-		cemu_assert_debug(__OSHasSchedulerLock());	
+		cemu_assert_debug(__OSHasAnySchedulerLock());
 		cemu_assert_debug(g_isMulticoreMode == false || hostThread->selectedCore == t_assignedCoreIndex);
 
 		// received next time slice, load self again
 		__OSLoadThread(hostThread->m_thread, &hostThread->ppcInstance, hostThread->selectedCore);
 		__OSThreadStartTimeslice(hostThread->m_thread, &hostThread->ppcInstance);
+		PPCRecompilerCodeHeap_unpark(&hostThread->ppcInstance);
+		cemu_assert_debug(!hostThread->resumeWithGlobalLock || __OSHasSchedulerLock());
 	}
 
 	void __OSFiberThreadEntry(void* _thread)
@@ -1315,7 +1689,7 @@ namespace coreinit
 		PPCInterpreter_t* hCPU = &hostThread->ppcInstance;
 		__OSLoadThread(hostThread->m_thread, hCPU, hostThread->selectedCore);
 		__OSThreadStartTimeslice(hostThread->m_thread, &hostThread->ppcInstance);
-		__OSUnlockScheduler(); // lock is always held when switching to a fiber, so we need to unlock it here
+		__OSUnlockSchedulerHeld(); // lock is always held when switching to a fiber, so we need to unlock it here
 		while (true)
 		{
 			if (hCPU->remainingCycles > 0)
@@ -1332,9 +1706,14 @@ namespace coreinit
 			hCPU->reservedMemValue = 0;
 
 			// reschedule
-			__OSLockScheduler();
+			if (__OSThreadCanKeepRunning(hostThread->m_thread))
+			{
+				__OSThreadContinueTimeslice(hostThread->m_thread, hCPU);
+				continue;
+			}
+			__OSLockSchedulerForThreadSwitch(hostThread->m_thread);
 			__OSThreadSwitchToNext();
-			__OSUnlockScheduler();
+			__OSUnlockSchedulerHeld();
 		}
 	}
 
@@ -1356,6 +1735,7 @@ namespace coreinit
 	{
 		SetThreadName(fmt::format("OSSched[core={}]", (uintptr_t)_assignedCoreIndex).c_str());
 		t_assignedCoreIndex = (sint32)(uintptr_t)_assignedCoreIndex;
+		__OSSetSchedulerLockStatsCore(t_assignedCoreIndex);
         #if defined(ARCH_X86_64)
 		_mm_setcsr(_mm_getcsr() | 0x8000); // flush denormals to zero
         #endif
@@ -1383,7 +1763,7 @@ namespace coreinit
 		__OSLockScheduler();
 		Fiber::Switch(*g_idleLoopFiber[t_assignedCoreIndex]);
 		// returned from scheduler loop, exit thread
-		cemu_assert_debug(!__OSHasSchedulerLock());
+		cemu_assert_debug(!__OSHasAnySchedulerLock());
 	}
 
 	std::vector<std::thread::native_handle_type> g_schedulerThreadHandles;
@@ -1401,6 +1781,15 @@ namespace coreinit
 			return;
 		cemu_assert_debug(numCPUEmulationThreads == 1 || numCPUEmulationThreads == 3);
 		g_isMulticoreMode = numCPUEmulationThreads > 1;
+		g_idleWaitEnabled = ActiveSettings::GetCPUIdleWait();
+		g_idleWaitSleepCount = 0;
+		g_idleWaitSleptUs = 0;
+		g_workStealingEnabled = g_isMulticoreMode && ppcThreadWorkStealing;
+		g_stolenThreadCount = 0;
+#if BOOST_OS_WINDOWS
+		if (g_idleWaitEnabled)
+			timeBeginPeriod(1); // the default timer resolution is too coarse for sub-frame sleeps
+#endif
 		if (numCPUEmulationThreads == 1)
 			sSchedulerThreads.emplace_back(OSSchedulerCoreEmulationThread, (void*)0);
 		else if (numCPUEmulationThreads == 3)
@@ -1421,11 +1810,28 @@ namespace coreinit
 		sSchedulerActive.store(false);
 		for (size_t i = 0; i < Espresso::CORE_COUNT; i++)
 			g_coreRunQueueThreadCount[i].increment(); // make sure to wake up cores if they are paused and waiting for runnable threads
+		__OSWakeupIdleMainCore();
 		// wait for threads to stop execution
 		for (auto& threadItr : sSchedulerThreads)
 			threadItr.join();
 		sSchedulerThreads.clear();
 		g_schedulerThreadHandles.clear();
+		for (sint32 i = 0; i <= Espresso::CORE_COUNT; i++)
+		{
+			OSSchedulerLockStats lockStats = __OSGetSchedulerLockStats(i);
+			if (lockStats.acquisitions == 0 && lockStats.coreAcquisitions == 0)
+				continue;
+			cemuLog_log(LogType::Statistics, "Scheduler lock ({}): {} acquisitions, {} contended, {}ms waited. Core lock: {} acquisitions, {} contended, {}ms waited", i < Espresso::CORE_COUNT ? fmt::format("core {}", i) : "other", lockStats.acquisitions, lockStats.contendedAcquisitions, lockStats.contendedWaitUs / 1000, lockStats.coreAcquisitions, lockStats.coreContendedAcquisitions, lockStats.coreContendedWaitUs / 1000);
+		}
+		__OSResetSchedulerLockStats();
+		if (g_idleWaitEnabled)
+			cemuLog_log(LogType::Statistics, "Idle wait: main core slept {} times for a total of {}ms", g_idleWaitSleepCount, g_idleWaitSleptUs / 1000);
+		if (g_workStealingEnabled)
+			cemuLog_log(LogType::Statistics, "Work stealing: {} timeslices ran on a core other than the thread's own", g_stolenThreadCount.load());
+#if BOOST_OS_WINDOWS
+		if (g_idleWaitEnabled)
+			timeEndPeriod(1);
+#endif
 #if BOOST_OS_LINUX
 		{
 			std::lock_guard schedulerThreadIdsLockGuard(g_schedulerThreadIdsLock);
@@ -1597,8 +2003,11 @@ namespace coreinit
 		cafeExportRegister("coreinit", OSInitThreadQueueEx, LogType::CoreinitThread);
 
 		OSInitThreadQueue(g_activeThreadQueue.GetPtr());
-		for (sint32 i = 0; i < PPC_CORE_COUNT; i++)
+		for (sint32 i = 0; i < PPC_CORE_COUNT * OS_RUN_QUEUE_PRIORITY_COUNT; i++)
 			OSInitThreadQueue(g_coreRunQueue.GetPtr() + i);
+		for (sint32 i = 0; i < PPC_CORE_COUNT; i++)
+			g_coreRunQueuePriorityMask[i][0] = g_coreRunQueuePriorityMask[i][1] = 0;
+		g_stealableThreadCount = 0;
 
 		for (sint32 i = 0; i < PPC_CORE_COUNT; i++)
 			__currentCoreThread[i] = nullptr;
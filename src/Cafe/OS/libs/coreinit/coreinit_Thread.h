@@ -123,6 +123,8 @@ namespace coreinit
 		// always uses thread->waitQueueLink
 		void queueAndWait(OSThread_t* thread);
 		void queueOnly(OSThread_t* thread);
+		// reverts queueOnly if the thread no longer needs to wait before it switched out
+		void undoQueueOnly(OSThread_t* thread);
 
 		// counterparts for queueAndWait
 		void cancelWait(OSThread_t* thread);
@@ -132,7 +134,7 @@ namespace coreinit
 	private:
 		OSThread_t* takeFirstFromQueue(size_t linkOffset)
 		{
-			cemu_assert_debug(__OSHasSchedulerLock());
+			cemu_assert_debug(__OSHasAnySchedulerLock());
 			if (head == nullptr)
 				return nullptr;
 			OSThread_t* thread = head.GetPtr();
@@ -223,9 +225,9 @@ namespace coreinit
 			return head.IsNull();
 		}
 
+		// the owned mutex queue is only modified by the owning thread itself, OSLockMutex and OSUnlockMutex do this without holding the scheduler lock
 		void addMutex(OSMutex* mutex)
 		{
-			cemu_assert_debug(__OSHasSchedulerLock());
 			// insert at end
 			if (tail.IsNull())
 			{
@@ -245,7 +247,6 @@ namespace coreinit
 
 		void removeMutex(OSMutex* mutex)
 		{
-			cemu_assert_debug(__OSHasSchedulerLock());
 			cemu_assert_debug(!head.IsNull() && !tail.IsNull());
 			if (mutex->prev)
 				mutex->prev->next = mutex->next;
@@ -393,6 +394,13 @@ struct OSThread_t
 		ATTR_UKN_010		= 0x10,
 	};
 
+	// not part of COS, only used by the emulator
+	enum HOST_FLAG_BIT : uint32
+	{
+		HOST_FLAG_NONE = 0,
+		HOST_FLAG_DEFAULT_AFFINITY = 1, // created without explicit affinity, can be run by other cores in work stealing mode
+	};
+
 	enum REQUEST_FLAG_BIT : uint32
 	{
 		REQUEST_FLAG_NONE = 0,
@@ -497,7 +505,10 @@ struct OSThread_t
 	/* +0x678 */ coreinit::OSFastMutexLink			ownedFastMutex;
 	/* +0x680 */ MEMPTR<void>						alignmentExceptionCallback[Espresso::CORE_COUNT];
 
-	/* +0x68C */ uint32								padding68C[20 / 4];
+	/* +0x68C */ uint32								hostFlags;							// HOST_FLAG_BIT, stored in padding
+	/* +0x690 */ uint32								hostQuantum;						// adaptive quantum for the next timeslice, zero if not yet determined
+	/* +0x694 */ uint32								hostQuantumScore;					// grows when timeslices run until the quantum is exhausted, decays when the thread blocks or yields early
+	/* +0x698 */ uint32								padding698[8 / 4];
 };
 static_assert(sizeof(OSThread_t) == 0x6A0);
 
@@ -613,6 +624,10 @@ namespace coreinit
 	void __OSAddReadyThreadToRunQueue(OSThread_t* thread);
 	bool __OSCoreShouldSwitchToThread(OSThread_t* currentThread, OSThread_t* newThread, bool sharedPriorityAndAffinityWorkaround);
 	void __OSQueueThreadDeallocation(OSThread_t* thread);
+	bool __OSThreadCanKeepRunning(OSThread_t* thread);
+	void __OSLockSchedulerForThreadSwitch(OSThread_t* thread);
+	uint32 __OSThreadGetQuantum(OSThread_t* thread);
+	void __OSWakeupIdleMainCore();
 
     bool __OSIsThreadActive(OSThread_t* thread);
 	void __OSDeleteAllActivePPCThreads();
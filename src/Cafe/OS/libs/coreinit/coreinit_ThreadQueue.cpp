@@ -29,6 +29,16 @@ namespace coreinit
 		thread->state = OSThread_t::THREAD_STATE::STATE_WAITING;
 	}
 
+	void OSThreadQueueInternal::undoQueueOnly(OSThread_t* thread)
+	{
+		cemu_assert_debug(__OSHasSchedulerLock());
+		cemu_assert_debug(thread->state == OSThread_t::THREAD_STATE::STATE_WAITING);
+		cemu_assert_debug(thread->currentWaitQueue == this);
+		this->removeThread(thread, &thread->waitQueueLink);
+		thread->state = OSThread_t::THREAD_STATE::STATE_RUNNING;
+		thread->currentWaitQueue = nullptr;
+	}
+
 	// remove thread from wait queue and wake it up
 	void OSThreadQueueInternal::cancelWait(OSThread_t* thread)
 	{
@@ -42,7 +52,7 @@ namespace coreinit
 
 	void OSThreadQueueInternal::addThread(OSThread_t* thread, OSThreadLink* threadLink)
 	{
-		cemu_assert_debug(__OSHasSchedulerLock());
+		cemu_assert_debug(__OSHasAnySchedulerLock()); // run queues only need the lock of their core
 		size_t linkOffset = getLinkOffset(thread, threadLink);
 		// insert after tail
 		if (tail.IsNull())
@@ -110,7 +120,7 @@ namespace coreinit
 
 	void OSThreadQueueInternal::removeThread(OSThread_t* thread, OSThreadLink* threadLink)
 	{
-		cemu_assert_debug(__OSHasSchedulerLock());
+		cemu_assert_debug(__OSHasAnySchedulerLock()); // run queues only need the lock of their core
 		size_t linkOffset = getLinkOffset(thread, threadLink);
 		_debugCheckChain(thread, threadLink);
 		if (threadLink->prev)
@@ -1534,7 +1534,9 @@ bossBufferVector->buffer = (uint8*)bossRequest;
 			}
 			// read
 			fsc_setFileSeek(fscStorageFile, (uint32)_swapEndianU64(nsData->readIndex));
+			bool isTrackedWrite = memory_writeTrackingBeginHostWrite(buffer, readBytes);
 			fsc_readFile(fscStorageFile, buffer, readBytes);
+			memory_writeTrackingEndHostWrite(isTrackedWrite);
 			nsData->readIndex = _swapEndianU64((sint32)_swapEndianU64(nsData->readIndex) + readBytes);
 
 			// close file
@@ -1,4 +1,5 @@
 #include "BackendLibusb.h"
+#include "Cafe/HW/MMU/MMU.h"
 
 namespace nsyshid::backend::libusb
 {
@@ -504,17 +505,28 @@ namespace nsyshid::backend::libusb
 		const unsigned int timeout = 50;
 		int actualLength = 0;
 		int ret = 0;
+		// the guest buffer can be write protected by write tracking, libusb writes to it outside of our fault handler
+		// so receive into a host buffer and only hold the host write lock for the copy, not for the blocking transfer
+		static thread_local std::vector<uint8> s_readBuffer;
+		if (s_readBuffer.size() < message->length)
+			s_readBuffer.resize(message->length);
 		do
 		{
 			ret = libusb_interrupt_transfer(handleLock->GetHandle(),
 											this->m_libusbEndpointIn,
-											message->data,
+											s_readBuffer.data(),
 											message->length,
 											&actualLength,
 											timeout);
 		}
 		while (ret == LIBUSB_ERROR_TIMEOUT && actualLength == 0 && IsOpened());
 
+		if (actualLength > 0)
+		{
+			bool isTrackedWrite = memory_writeTrackingBeginHostWrite(message->data, actualLength);
+			memcpy(message->data, s_readBuffer.data(), actualLength);
+			memory_writeTrackingEndHostWrite(isTrackedWrite);
+		}
 		if (ret == 0 || ret == LIBUSB_ERROR_TIMEOUT)
 		{
 			// success
@@ -1024,6 +1024,24 @@ void nsysnetExport_send(PPCInterpreter_t* hCPU)
 	osLib_returnFromFunction(hCPU, r);
 }
 
+// the data is received into a host buffer and only the copy to guest memory happens inside the host write scope of the write tracking
+// a recv can block and the buffer cache is not able to arm pages while a host write is in progress
+sint32 _nsysnet_recvIntoGuestMemory(SOCKET s, char* msg, sint32 len, int hostFlags, sockaddr* fromAddr, socklen_t* fromLen, sint32& errorOut)
+{
+	static thread_local std::vector<char> s_recvBuffer;
+	if (len > 0 && s_recvBuffer.size() < (size_t)len)
+		s_recvBuffer.resize(len);
+	sint32 r = recvfrom(s, s_recvBuffer.data(), len, hostFlags, fromAddr, fromLen);
+	errorOut = GETLASTERR;
+	if (r > 0)
+	{
+		bool isTrackedWrite = memory_writeTrackingBeginHostWrite(msg, r);
+		memcpy(msg, s_recvBuffer.data(), r);
+		memory_writeTrackingEndHostWrite(isTrackedWrite);
+	}
+	return r;
+}
+
 void nsysnetExport_recv(PPCInterpreter_t* hCPU)
 {
 	cemuLog_log(LogType::Socket, "recv({},0x{:08x},{},0x{:x})", hCPU->gpr[3], hCPU->gpr[4], hCPU->gpr[5], hCPU->gpr[6]);
@@ -1076,8 +1094,9 @@ void nsysnetExport_recv(PPCInterpreter_t* hCPU)
 		_setSocketSendRecvNonBlockingMode(vs->s, requestIsNonBlocking);
 	}
 	// receive
-	sint32 hr = recv(vs->s, msg, len, hostFlags);
-	_translateError(hr <= 0 ? -1 : 0, GETLASTERR);
+	sint32 recvError = 0;
+	sint32 hr = _nsysnet_recvIntoGuestMemory(vs->s, msg, len, hostFlags, nullptr, nullptr, recvError);
+	_translateError(hr <= 0 ? -1 : 0, recvError);
 	if (requestIsNonBlocking != vs->isNonBlocking)
 		_setSocketSendRecvNonBlockingMode(vs->s, vs->isNonBlocking);
 	cemuLog_log(LogType::Socket, "Received {} bytes", hr);
@@ -1648,8 +1667,7 @@ void nsysnetExport_recvfrom(PPCInterpreter_t* hCPU)
 			if (FD_ISSET(vs->s, &fd_read))
 			{
 				// data available
-				r = recvfrom(vs->s, msg, len, hostFlags, &fromAddrHost, &fromLenHost);
-				wsaError = GETLASTERR;
+				r = _nsysnet_recvIntoGuestMemory(vs->s, msg, len, hostFlags, &fromAddrHost, &fromLenHost, wsaError);
 				if (r < 0)
 					cemu_assert_debug(false);
 				cemuLog_logDebug(LogType::Force, "recvfrom returned {} bytes", r);
@@ -1689,8 +1707,7 @@ void nsysnetExport_recvfrom(PPCInterpreter_t* hCPU)
 		_setSocketSendRecvNonBlockingMode(vs->s, true);
 		while (true)
 		{
-			r = recvfrom(vs->s, msg, len, hostFlags, &fromAddrHost, &fromLenHost);
-			wsaError = GETLASTERR;
+			r = _nsysnet_recvIntoGuestMemory(vs->s, msg, len, hostFlags, &fromAddrHost, &fromLenHost, wsaError);
 			if (r < 0)
 			{
 				if (wsaError != WSAEWOULDBLOCK)
@@ -1803,8 +1820,7 @@ void nsysnetExport_recvfrom_ex(PPCInterpreter_t* hCPU)
 			if (FD_ISSET(vs->s, &fd_read))
 			{
 				// data available
-				r = recvfrom(vs->s, msg, len, hostFlags, &fromAddrHost, &fromLenHost);
-				wsaError = GETLASTERR;
+				r = _nsysnet_recvIntoGuestMemory(vs->s, msg, len, hostFlags, &fromAddrHost, &fromLenHost, wsaError);
 				if (r < 0)
 				{
 					cemu_assert_debug(false);
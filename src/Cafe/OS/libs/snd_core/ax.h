@@ -388,6 +388,7 @@ namespace snd_core
 	void AXOut_init();
 	void AXOut_reset();
 	void AXOut_update();
+	std::chrono::nanoseconds AXOut_getTimeUntilNextUpdate();
 
 	void Initialize();
 }
\ No newline at end of file
@@ -464,13 +464,21 @@ namespace snd_core
 		}
 	}
 
+	constexpr static auto kAXUpdateTimeout = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(((IAudioAPI::kBlockCount * 3) / 4) * (AX_FRAMES_PER_GROUP * 3)));
+	constexpr static auto kAXUpdateWaitDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(3));
+	constexpr static auto kAXUpdateWaitDurationFast = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::microseconds(2900));
+	constexpr static auto kAXUpdateWaitDurationMinimum = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::microseconds(1700));
+
+	// s_ax_interval_timer increases by the wait period
+	// it can lag behind by multiple periods (up to kAXUpdateTimeout) if there is minor stutter in the CPU thread
+	// s_last_check is always set to the timestamp at the time of firing
+	// it's used to enforce the minimum wait delay (we want to avoid calling AX update in quick succession because other threads may need to do work first) 
+	static auto s_ax_interval_timer = now_cached() - kAXUpdateWaitDuration;
+	static auto s_last_check = now_cached();
+
 	// called periodically to check for AX updates
 	void AXOut_update()
 	{
-		constexpr static auto kTimeout = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(((IAudioAPI::kBlockCount * 3) / 4) * (AX_FRAMES_PER_GROUP * 3)));
-		constexpr static auto kWaitDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(3));
-		constexpr static auto kWaitDurationFast = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::microseconds(2900));
-		constexpr static auto kWaitDurationMinimum = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::microseconds(1700));
 
 		// if we haven't buffered any blocks, we will wait less time than usual
 		bool additional_blocks_required = false;
@@ -480,15 +488,7 @@ namespace snd_core
 				additional_blocks_required = (g_tvAudio && g_tvAudio->NeedAdditionalBlocks()) || (g_padAudio && g_padAudio->NeedAdditionalBlocks());
 		}
 
-		const auto wait_duration = additional_blocks_required ? kWaitDurationFast : kWaitDuration;
-
-		// s_ax_interval_timer increases by the wait period
-		// it can lag behind by multiple periods (up to kTimeout) if there is minor stutter in the CPU thread
-		// s_last_check is always set to the timestamp at the time of firing
-		// it's used to enforce the minimum wait delay (we want to avoid calling AX update in quick succession because other threads may need to do work first) 
-
-		static auto s_ax_interval_timer = now_cached() - kWaitDuration;
-		static auto s_last_check = now_cached();
+		const auto wait_duration = additional_blocks_required ? kAXUpdateWaitDurationFast : kAXUpdateWaitDuration;
 
 		const auto now = now_cached();
 		const auto diff = (now - s_ax_interval_timer);
@@ -497,12 +497,12 @@ namespace snd_core
 			return;
 
 		// handle minimum wait time (1.7MS)
-		if ((now - s_last_check) < kWaitDurationMinimum)
+		if ((now - s_last_check) < kAXUpdateWaitDurationMinimum)
 			return;
 		s_last_check = now;
 
 		// if we're too far behind, skip forward
-		if (diff >= kTimeout)
+		if (diff >= kAXUpdateTimeout)
 			s_ax_interval_timer = (now - wait_duration);
 		else
 			s_ax_interval_timer += wait_duration;
@@ -519,4 +519,14 @@ namespace snd_core
 		}
 	}
 
+	// time until AXOut_update() will queue the next frame, used by the idle loop to decide how long it can sleep
+	std::chrono::nanoseconds AXOut_getTimeUntilNextUpdate()
+	{
+		const auto now = now_cached();
+		// assume the shorter interval since we don't know whether additional blocks will be required by then
+		auto remaining = kAXUpdateWaitDurationFast - (now - s_ax_interval_timer);
+		remaining = std::max<std::chrono::nanoseconds>(remaining, kAXUpdateWaitDurationMinimum - (now - s_last_check));
+		return std::max<std::chrono::nanoseconds>(remaining, std::chrono::nanoseconds::zero());
+	}
+
 }
@@ -40,6 +40,8 @@ enum class LogType : sint32
 
 	TextureReadback = 29,
 
+	Statistics = 27, // performance counters of the scheduler, recompiler and FSA, logged when emulation stops
+
 	ProcUi = 39,
 	nlibcurl = 41,
 
@@ -8,6 +8,7 @@
 
 #include "Cafe/HW/Espresso/Debugger/GDBStub.h"
 #include "Cafe/HW/Espresso/Debugger/GDBBreakpoints.h"
+#include "Cafe/HW/MMU/MMU.h"
 
 #if BOOST_OS_LINUX
 #include "ELFSymbolTable.h"
@@ -64,6 +65,10 @@ void DemangleAndPrintBacktrace(char** backtrace, size_t size)
 // handle signals that would dump core, print stacktrace and then dump depending on config
 void handlerDumpingSignal(int sig, siginfo_t *info, void *context)
 {
+	// write to guest memory which is write protected for tracking purposes
+	if ((sig == SIGSEGV || sig == SIGBUS) && memory_writeTrackingHandleFault(info->si_addr))
+		return;
+
 #if defined(ARCH_X86_64) && BOOST_OS_LINUX
 	// Check for hardware breakpoints
 	if (info->si_signo == SIGTRAP && info->si_code == TRAP_HWBKPT)
@@ -11,6 +11,7 @@
 #include "Cafe/OS/libs/coreinit/coreinit_Thread.h"
 #include "Cafe/HW/Espresso/PPCState.h"
 #include "Cafe/HW/Espresso/Debugger/GDBStub.h"
+#include "Cafe/HW/MMU/MMU.h"
 
 LONG handleException_SINGLE_STEP(PEXCEPTION_POINTERS pExceptionInfo)
 {
@@ -270,6 +271,12 @@ LONG WINAPI VectoredExceptionHandler(PEXCEPTION_POINTERS pExceptionInfo)
 			g_gdbstub->HandleAccessException(pExceptionInfo->ContextRecord->Dr6);
 		return EXCEPTION_CONTINUE_EXECUTION;
 	}
+	if (pExceptionInfo->ExceptionRecord->ExceptionCode == EXCEPTION_ACCESS_VIOLATION && pExceptionInfo->ExceptionRecord->ExceptionInformation[0] == 1)
+	{
+		// write to guest memory which is write protected for tracking purposes
+		if (memory_writeTrackingHandleFault((void*)pExceptionInfo->ExceptionRecord->ExceptionInformation[1]))
+			return EXCEPTION_CONTINUE_EXECUTION;
+	}
 	return EXCEPTION_CONTINUE_SEARCH;
 }
 
@@ -25,6 +25,18 @@ inline void cpuidex(int cpuInfo[4], int functionId, int subFunctionId) {
 #error No definition for cpuidex
 #endif
 }
+
+inline uint64_t xgetbv(uint32_t index) {
+#if defined(_MSC_VER)
+	return _xgetbv(index);
+#elif defined(__GNUC__)
+	uint32_t eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+	return ((uint64_t)edx << 32) | eax;
+#else
+#error No definition for xgetbv
+#endif
+}
 #endif
 
 
@@ -40,8 +52,12 @@ CPUFeaturesImpl::CPUFeaturesImpl()
 	x86.aesni = ((cpuInfo[2] >> 25) & 1) != 0;
 	x86.ssse3 = ((cpuInfo[2] >> 9) & 1) != 0;
 	x86.sse4_1 = ((cpuInfo[2] >> 19) & 1) != 0;
+	bool osxsave = ((cpuInfo[2] >> 27) & 1) != 0;
 	cpuidex(cpuInfo, 0x7, 0);
 	x86.avx2 = ((cpuInfo[1] >> 5) & 1) != 0;
+	// AVX-512 also requires the OS to save the opmask and upper ZMM registers
+	if (osxsave && ((cpuInfo[1] >> 16) & 1) != 0)
+		x86.avx512f = (xgetbv(0) & 0xE6) == 0xE6;
 	x86.bmi2 = ((cpuInfo[1] >> 8) & 1) != 0;
 	cpuid(cpuInfo, 0x80000007);
 	x86.invariant_tsc = ((cpuInfo[3] >> 8) & 1);
@@ -85,6 +101,8 @@ std::string CPUFeaturesImpl::GetCommaSeparatedExtensionList()
 		appendExt("AVX");
 	if (x86.avx2)
 		appendExt("AVX2");
+	if (x86.avx512f)
+		appendExt("AVX512F");
 	if (x86.lzcnt)
 		appendExt("LZCNT");
 	if (x86.movbe)
@@ -1,10 +1,12 @@
 
 #ifdef __GNUC__
 #define ATTRIBUTE_AVX2 __attribute__((target("avx2")))
+#define ATTRIBUTE_AVX512 __attribute__((target("avx512f")))
 #define ATTRIBUTE_SSE41 __attribute__((target("sse4.1")))
 #define ATTRIBUTE_AESNI __attribute__((target("aes")))
 #else
 #define ATTRIBUTE_AVX2
+#define ATTRIBUTE_AVX512
 #define ATTRIBUTE_SSE41
 #define ATTRIBUTE_AESNI
 #endif
@@ -23,6 +25,7 @@ public:
 		bool sse4_1{ false };
 		bool avx{ false };
 		bool avx2{ false };
+		bool avx512f{ false };
 		bool lzcnt{ false };
 		bool movbe{ false };
 		bool bmi2{ false };
@@ -30,6 +30,10 @@
 #define ARCH_X86_64
 #endif
 
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define ARCH_AARCH64
+#endif
+
 // c includes
 #include <cstdint>
 #include <cstdlib>
@@ -526,7 +530,7 @@ std::atomic<T>* _rawPtrToAtomic(T* ptr)
     return reinterpret_cast<std::atomic<T>*>(ptr);
 }
 
-#if defined(__GNUC__)
+#if defined(__GNUC__) && defined(ARCH_X86_64)
 #define ATTR_MS_ABI __attribute__((ms_abi))
 #else
 #define ATTR_MS_ABI
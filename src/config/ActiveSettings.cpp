@@ -90,6 +90,31 @@ uint8 ActiveSettings::GetTimerShiftFactor()
 	return s_timer_shift;
 }
 
+uint32 ActiveSettings::GetRecompilerInlineBudget()
+{
+	return GetConfig().recompiler_inline_budget;
+}
+
+uint32 ActiveSettings::GetRecompilerCodeCacheSize()
+{
+	return GetConfig().recompiler_code_cache_size;
+}
+
+bool ActiveSettings::GetRecompilerCodeCacheCompaction()
+{
+	return GetConfig().recompiler_code_cache_compaction;
+}
+
+bool ActiveSettings::GetRecompilerDualMapping()
+{
+	return GetConfig().recompiler_dual_mapping;
+}
+
+bool ActiveSettings::GetCPUIdleWait()
+{
+	return GetConfig().cpu_idle_wait;
+}
+
 void ActiveSettings::SetTimerShiftFactor(uint8 shiftFactor)
 {
 	s_timer_shift = shiftFactor;
@@ -110,6 +135,11 @@ bool ActiveSettings::WaitForGX2DrawDoneEnabled()
 	return GetConfig().gx2drawdone_sync;
 }
 
+uint32 ActiveSettings::GetTextureDecodeParallelThreshold()
+{
+	return GetConfig().texture_decode_parallel_threshold;
+}
+
 GraphicAPI ActiveSettings::GetGraphicsAPI()
 {
 	GraphicAPI api = g_current_game_profile->GetGraphicsAPI().value_or(GetConfig().graphic_api);
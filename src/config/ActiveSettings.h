@@ -88,6 +88,11 @@ public:
 	// cpu
 	[[nodiscard]] static CPUMode GetCPUMode();
 	[[nodiscard]] static uint8 GetTimerShiftFactor();
+	[[nodiscard]] static uint32 GetRecompilerInlineBudget();
+	[[nodiscard]] static uint32 GetRecompilerCodeCacheSize();
+	[[nodiscard]] static bool GetRecompilerCodeCacheCompaction();
+	[[nodiscard]] static bool GetRecompilerDualMapping();
+	[[nodiscard]] static bool GetCPUIdleWait();
 
 	static void SetTimerShiftFactor(uint8 shiftFactor);
 	
@@ -95,6 +100,7 @@ public:
 	[[nodiscard]] static PrecompiledShaderOption GetPrecompiledShadersOption();
 	[[nodiscard]] static bool RenderUpsideDownEnabled();
 	[[nodiscard]] static bool WaitForGX2DrawDoneEnabled();
+	[[nodiscard]] static uint32 GetTextureDecodeParallelThreshold();
 	[[nodiscard]] static GraphicAPI GetGraphicsAPI();
 
 	// audio
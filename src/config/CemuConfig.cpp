@@ -220,6 +220,7 @@ void CemuConfig::Load(XMLConfigParser& parser)
 	downscale_filter = graphic.get("DownscaleFilter", kLinearFilter);
 	fullscreen_scaling = graphic.get("FullscreenScaling", kKeepAspectRatio);
 	async_compile = graphic.get("AsyncCompile", async_compile);
+	texture_decode_parallel_threshold = graphic.get("TextureDecodeParallelThreshold", texture_decode_parallel_threshold);
 	vk_accurate_barriers = graphic.get("vkAccurateBarriers", true); // this used to be "VulkanAccurateBarriers" but because we changed the default to true in 1.27.1 the option name had to be changed
 
 	auto overlay_node = graphic.get("Overlay");
@@ -336,6 +337,11 @@ void CemuConfig::Load(XMLConfigParser& parser)
 	crash_dump = debug.get("CrashDumpUnix", crash_dump);
 #endif
 	gdb_port = debug.get("GDBPort", 1337);
+	recompiler_inline_budget = debug.get("RecompilerInlineBudget", recompiler_inline_budget);
+	recompiler_code_cache_size = debug.get("RecompilerCodeCacheSize", recompiler_code_cache_size);
+	recompiler_code_cache_compaction = debug.get("RecompilerCodeCacheCompaction", recompiler_code_cache_compaction);
+	recompiler_dual_mapping = debug.get("RecompilerDualMapping", recompiler_dual_mapping);
+	cpu_idle_wait = debug.get("CPUIdleWait", cpu_idle_wait);
 
 	// input
 	auto input = parser.get("Input");
@@ -478,6 +484,7 @@ void CemuConfig::Save(XMLConfigParser& parser)
 	graphic.set("DownscaleFilter", downscale_filter);
 	graphic.set("FullscreenScaling", fullscreen_scaling);
 	graphic.set("AsyncCompile", async_compile.GetValue());
+	graphic.set("TextureDecodeParallelThreshold", texture_decode_parallel_threshold.GetValue());
 	graphic.set("vkAccurateBarriers", vk_accurate_barriers);
 
 	auto overlay_node = graphic.set("Overlay");
@@ -537,6 +544,11 @@ void CemuConfig::Save(XMLConfigParser& parser)
 	debug.set("CrashDumpUnix", crash_dump.GetValue());
 #endif
 	debug.set("GDBPort", gdb_port);
+	debug.set("RecompilerInlineBudget", recompiler_inline_budget.GetValue());
+	debug.set("RecompilerCodeCacheSize", recompiler_code_cache_size.GetValue());
+	debug.set("RecompilerCodeCacheCompaction", recompiler_code_cache_compaction.GetValue());
+	debug.set("RecompilerDualMapping", recompiler_dual_mapping.GetValue());
+	debug.set("CPUIdleWait", cpu_idle_wait.GetValue());
 
 	// input
 	auto input = config.set("Input");
@@ -444,6 +444,7 @@ struct CemuConfig
 	ConfigValue<bool> gx2drawdone_sync {true};
 	ConfigValue<bool> render_upside_down{ false };
 	ConfigValue<bool> async_compile{ true };
+	ConfigValueBounds<uint32> texture_decode_parallel_threshold{ 0, 1024, 256 * 1024 }; // decoded size in KB from which textures are decoded by multiple threads, 0 disables parallel decoding
 
 	ConfigValue<bool> vk_accurate_barriers{ true };
 
@@ -502,6 +503,11 @@ struct CemuConfig
 	// debug
 	ConfigValueBounds<CrashDump> crash_dump{ CrashDump::Disabled };
 	ConfigValue<uint16> gdb_port{ 1337 };
+	ConfigValueBounds<uint32> recompiler_inline_budget{ 0, 12, 32 }; // max instruction count of leaf functions inlined by the PPC recompiler, 0 disables inlining
+	ConfigValueBounds<uint32> recompiler_code_cache_size{ 0, 512, 4096 }; // size limit of the recompiled code in MB, 0 means unlimited
+	ConfigValue<bool> recompiler_code_cache_compaction{ true }; // flush and recompile all functions when the code cache is full but fragmented
+	ConfigValue<bool> recompiler_dual_mapping{ false }; // map recompiled code twice (RW and RX) instead of RWX. Used automatically if RWX memory is not available
+	ConfigValue<bool> cpu_idle_wait{ true }; // let the idle main core sleep until the next system event instead of polling
 
 	void Load(XMLConfigParser& parser);
 	void Save(XMLConfigParser& parser);
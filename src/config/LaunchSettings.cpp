@@ -14,7 +14,22 @@
 
 #include "Cafe/Filesystem/FST/FST.h"
 
-void requireConsole();
+static bool isConsoleConnected = false;
+static void requireConsole()
+{
+	#if BOOST_OS_WINDOWS
+	if (isConsoleConnected)
+		return;
+
+	if (AttachConsole(ATTACH_PARENT_PROCESS) != FALSE)
+	{
+		freopen("CONIN$", "r", stdin);
+		freopen("CONOUT$", "w", stdout);
+		freopen("CONOUT$", "w", stderr);
+		isConsoleConnected = true;
+	}
+	#endif
+}
 
 bool LaunchSettings::HandleCommandline(const wchar_t* lpCmdLine)
 {
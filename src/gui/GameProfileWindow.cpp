@@ -81,6 +81,13 @@ GameProfileWindow::GameProfileWindow(wxWindow* parent, uint64_t title_id)
 
 			box_sizer->Add(first_row, 0, wxEXPAND, 5);
 
+			m_work_stealing = new wxCheckBox(box, wxID_ANY, _("Work stealing"));
+			m_work_stealing->SetToolTip(_("EXPERT OPTION\nAllows idle cores to run threads which were created without an explicit core affinity. Only used by the multi-core recompiler"));
+			box_sizer->Add(m_work_stealing, 0, wxALL, 5);
+
+			m_adaptive_quantum = new wxCheckBox(box, wxID_ANY, _("Adaptive thread quantum"));
+			m_adaptive_quantum->SetToolTip(_("EXPERT OPTION\nGives threads which rarely yield a longer timeslice, up to 4x the thread quantum. Falls back to the thread quantum while a thread of equal or higher priority is waiting"));
+			box_sizer->Add(m_adaptive_quantum, 0, wxALL, 5);
 
 			sizer->Add(box_sizer, 0, wxEXPAND, 5);
 		}
@@ -131,6 +138,9 @@ GameProfileWindow::GameProfileWindow(wxWindow* parent, uint64_t title_id)
 
 		sizer->Add(first_row, 0, wxEXPAND, 5);
 
+		m_buffer_write_tracking = new wxCheckBox(panel, wxID_ANY, _("Buffer cache write tracking"));
+		m_buffer_write_tracking->SetToolTip(_("EXPERT OPTION\nDetects CPU writes to cached GPU buffers with memory page protection instead of comparing checksums. Can reduce CPU usage of the GPU thread in games with many large buffers.\n\nRecommended: false"));
+		sizer->Add(m_buffer_write_tracking, 0, wxALL, 5);
 
 		panel->SetSizer(sizer);
 		panel->Layout();
@@ -262,6 +272,8 @@ void GameProfileWindow::ApplyProfile()
 	}
 	
 	m_thread_quantum->SetStringSelection(fmt::format("{}", m_game_profile.m_threadQuantum));
+	m_work_stealing->SetValue(m_game_profile.m_workStealing);
+	m_adaptive_quantum->SetValue(m_game_profile.m_adaptiveThreadQuantum);
 
 	// gpu
 	if (!m_game_profile.m_graphics_api.has_value())
@@ -269,6 +281,7 @@ void GameProfileWindow::ApplyProfile()
 	else
 		m_graphic_api->SetSelection(1 + m_game_profile.m_graphics_api.value()); // "", OpenGL, Vulkan
 	m_shader_mul_accuracy->SetSelection((int)m_game_profile.m_accurateShaderMul);
+	m_buffer_write_tracking->SetValue(m_game_profile.m_bufferCacheWriteTracking);
 
 	//// audio
 	//m_disable_audio->Set3StateValue(GetCheckboxState(m_game_profile.disableAudio));
@@ -325,6 +338,8 @@ void GameProfileWindow::SaveProfile()
 		m_game_profile.m_threadQuantum = std::min<uint32>(m_game_profile.m_threadQuantum, 536870912);
 		m_game_profile.m_threadQuantum = std::max<uint32>(m_game_profile.m_threadQuantum, 5000);
 	}
+	m_game_profile.m_workStealing = m_work_stealing->GetValue();
+	m_game_profile.m_adaptiveThreadQuantum = m_adaptive_quantum->GetValue();
 
 	// gpu
 	m_game_profile.m_accurateShaderMul = (AccurateShaderMulOption)m_shader_mul_accuracy->GetSelection();
@@ -335,6 +350,7 @@ void GameProfileWindow::SaveProfile()
 		m_game_profile.m_graphics_api = {};
 	else
 		m_game_profile.m_graphics_api = (GraphicAPI)(m_graphic_api->GetSelection() - 1);  // "", OpenGL, Vulkan
+	m_game_profile.m_bufferCacheWriteTracking = m_buffer_write_tracking->GetValue();
 
 	// controller
 	for (int i = 0; i < 8; ++i)
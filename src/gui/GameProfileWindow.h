@@ -33,6 +33,8 @@ private:
 	// cpu
 	wxChoice *m_cpu_mode;
 	wxChoice* m_thread_quantum;
+	wxCheckBox* m_work_stealing;
+	wxCheckBox* m_adaptive_quantum;
 
 	// gpu
 	//wxCheckBox* m_extended_texture_readback;
@@ -41,6 +43,7 @@ private:
 
 	wxChoice* m_shader_mul_accuracy;
 	//wxChoice* m_cache_accuracy;
+	wxCheckBox* m_buffer_write_tracking;
 
 	// audio
 	//wxCheckBox* m_disable_audio;
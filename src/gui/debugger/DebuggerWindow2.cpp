@@ -17,6 +17,7 @@
 #include "gui/debugger/SymbolWindow.h"
 #include "gui/debugger/BreakpointWindow.h"
 #include "gui/debugger/ModuleWindow.h"
+#include "gui/debugger/RecompilerStatsWindow.h"
 #include "util/helpers/helpers.h"
 
 #include "resource/embedded/resources.h"
@@ -35,6 +36,7 @@ enum
 	MENU_ID_WINDOW_BREAKPOINTS,
 	MENU_ID_WINDOW_MODULE,
 	MENU_ID_WINDOW_SYMBOL,
+	MENU_ID_WINDOW_RECOMPILER_STATS,
 
 	// tool
 	TOOL_ID_GOTO,
@@ -85,6 +87,7 @@ void DebuggerConfig::Load(XMLConfigParser& parser)
 	show_breakpoints = window_parser.get("Breakpoints", true);
 	show_modules = window_parser.get("Modules", true);
 	show_symbols = window_parser.get("Symbols", true);
+	show_recompiler_stats = window_parser.get("RecompilerStats", false);
 }
 
 void DebuggerConfig::Save(XMLConfigParser& parser)
@@ -99,6 +102,7 @@ void DebuggerConfig::Save(XMLConfigParser& parser)
 	window_parser.set("Breakpoints", show_breakpoints);
 	window_parser.set("Modules", show_modules);
 	window_parser.set("Symbols", show_symbols);
+	window_parser.set("RecompilerStats", show_recompiler_stats);
 }
 
 void DebuggerModuleStorage::Load(XMLConfigParser& parser)
@@ -324,6 +328,7 @@ DebuggerWindow2::DebuggerWindow2(wxFrame& parent, const wxRect& display_size)
 	m_breakpoint_window = new BreakpointWindow(*this, m_main_position, m_main_size);
 	m_module_window = new ModuleWindow(*this, m_main_position, m_main_size);
 	m_symbol_window = new SymbolWindow(*this, m_main_position, m_main_size);
+	m_recompiler_stats_window = new RecompilerStatsWindow(*this, m_main_position, m_main_size);
 
 	const bool value = m_config.data().pin_to_main;
 	m_config.data().pin_to_main = true;
@@ -364,6 +369,9 @@ DebuggerWindow2::~DebuggerWindow2()
 	if (m_symbol_window && m_symbol_window->IsShown())
 		m_symbol_window->Close(true);
 
+	if (m_recompiler_stats_window && m_recompiler_stats_window->IsShown())
+		m_recompiler_stats_window->Close(true);
+
 	m_config.Save();
 }
 
@@ -410,6 +418,7 @@ void DebuggerWindow2::OnParentMove(const wxPoint& main_position, const wxSize& m
 	m_breakpoint_window->OnMainMove(main_position, main_size);
 	m_module_window->OnMainMove(main_position, main_size);
 	m_symbol_window->OnMainMove(main_position, main_size);
+	m_recompiler_stats_window->OnMainMove(main_position, main_size);
 }
 
 void DebuggerWindow2::OnNotifyModuleLoaded(wxCommandEvent& event)
@@ -462,6 +471,7 @@ bool DebuggerWindow2::Show(bool show)
 		m_breakpoint_window->Show(m_config.data().show_breakpoints);
 		m_module_window->Show(m_config.data().show_modules);
 		m_symbol_window->Show(m_config.data().show_symbols);
+		m_recompiler_stats_window->Show(m_config.data().show_recompiler_stats);
 	}
 	else
 	{
@@ -470,6 +480,7 @@ bool DebuggerWindow2::Show(bool show)
 		m_breakpoint_window->Show(false);
 		m_module_window->Show(false);
 		m_symbol_window->Show(false);
+		m_recompiler_stats_window->Show(false);
 	}
 
 	return result;
@@ -601,6 +612,13 @@ void DebuggerWindow2::OnWindowMenu(wxCommandEvent& event)
 		m_symbol_window->Show(value);
 		break;
 	}
+	case MENU_ID_WINDOW_RECOMPILER_STATS:
+	{
+		const bool value = !m_config.data().show_recompiler_stats;
+		m_config.data().show_recompiler_stats = value;
+		m_recompiler_stats_window->Show(value);
+		break;
+	}
 	default:
 		return;
 	}
@@ -655,6 +673,7 @@ void DebuggerWindow2::CreateMenuBar()
 	window_menu->Append(MENU_ID_WINDOW_BREAKPOINTS, _("&Breakpoints"), wxEmptyString, wxITEM_CHECK)->Check(m_config.data().show_breakpoints);
 	window_menu->Append(MENU_ID_WINDOW_MODULE, _("Module&list"), wxEmptyString, wxITEM_CHECK)->Check(m_config.data().show_modules);
 	window_menu->Append(MENU_ID_WINDOW_SYMBOL, _("&Symbols"), wxEmptyString, wxITEM_CHECK)->Check(m_config.data().show_symbols);
+	window_menu->Append(MENU_ID_WINDOW_RECOMPILER_STATS, _("Recompiler s&tatistics"), wxEmptyString, wxITEM_CHECK)->Check(m_config.data().show_recompiler_stats);
 	
 	menu_bar->Append(window_menu, _("&Window"));
 
@@ -14,6 +14,7 @@ class RegisterWindow;
 class DumpWindow;
 class ModuleWindow;
 class SymbolWindow;
+class RecompilerStatsWindow;
 class wxStaticText;
 
 wxDECLARE_EVENT(wxEVT_UPDATE_VIEW, wxCommandEvent);
@@ -27,7 +28,7 @@ wxDECLARE_EVENT(wxEVT_NOTIFY_MODULE_UNLOADED, wxCommandEvent);
 struct DebuggerConfig
 {
 	DebuggerConfig()
-	: pin_to_main(true), break_on_start(true), show_register(true), show_dump(true), show_stack(true), show_breakpoints(true), show_modules(true), show_symbols(true) {}
+	: pin_to_main(true), break_on_start(true), show_register(true), show_dump(true), show_stack(true), show_breakpoints(true), show_modules(true), show_symbols(true), show_recompiler_stats(false) {}
 	
 	bool pin_to_main;
 	bool break_on_start;
@@ -38,6 +39,7 @@ struct DebuggerConfig
 	bool show_breakpoints;
 	bool show_modules;
 	bool show_symbols;
+	bool show_recompiler_stats;
 
 	void Load(XMLConfigParser& parser);
 	void Save(XMLConfigParser& parser);
@@ -103,6 +105,7 @@ private:
 	BreakpointWindow* m_breakpoint_window;
 	ModuleWindow* m_module_window;
 	SymbolWindow* m_symbol_window;
+	RecompilerStatsWindow* m_recompiler_stats_window;
 
 	DisasmCtrl* m_disasm_ctrl;
 
@@ -0,0 +1,156 @@
+#include "gui/wxgui.h"
+#include "gui/guiWrapper.h"
+#include "gui/debugger/RecompilerStatsWindow.h"
+
+#include "gui/debugger/DebuggerWindow2.h"
+#include "Cafe/HW/Espresso/Debugger/Debugger.h"
+#include "Cafe/HW/Espresso/Recompiler/PPCRecompilerStats.h"
+#include "Cafe/OS/RPL/rpl_symbol_storage.h"
+
+enum ItemColumns
+{
+	ColumnAddress = 0,
+	ColumnSamples,
+	ColumnShare,
+	ColumnSymbol,
+};
+
+#define RECOMPILER_STATS_MAX_EXITS	(100)
+
+RecompilerStatsWindow::RecompilerStatsWindow(DebuggerWindow2& parent, const wxPoint& main_position, const wxSize& main_size)
+	: wxFrame(&parent, wxID_ANY, _("Recompiler statistics"), wxDefaultPosition, wxSize(420, 400), wxSYSTEM_MENU | wxCAPTION | wxCLIP_CHILDREN | wxRESIZE_BORDER | wxFRAME_FLOAT_ON_PARENT)
+{
+	this->SetSizeHints(wxDefaultSize, wxDefaultSize);
+
+	this->wxWindowBase::SetBackgroundColour(*wxWHITE);
+
+	wxBoxSizer* main_sizer = new wxBoxSizer(wxVERTICAL);
+
+	m_summary = new wxStaticText(this, wxID_ANY, wxEmptyString);
+	main_sizer->Add(m_summary, 0, wxEXPAND | wxALL, 5);
+
+	m_histogram = new wxStaticText(this, wxID_ANY, wxEmptyString);
+	main_sizer->Add(m_histogram, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 5);
+
+	m_exits = new wxListView(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxLC_REPORT);
+
+	wxListItem col0;
+	col0.SetId(ColumnAddress);
+	col0.SetText(_("Exit address"));
+	col0.SetWidth(85);
+	m_exits->InsertColumn(ColumnAddress, col0);
+
+	wxListItem col1;
+	col1.SetId(ColumnSamples);
+	col1.SetText(_("Samples"));
+	col1.SetWidth(65);
+	col1.SetAlign(wxLIST_FORMAT_RIGHT);
+	m_exits->InsertColumn(ColumnSamples, col1);
+
+	wxListItem col2;
+	col2.SetId(ColumnShare);
+	col2.SetText(_("Share"));
+	col2.SetWidth(55);
+	col2.SetAlign(wxLIST_FORMAT_RIGHT);
+	m_exits->InsertColumn(ColumnShare, col2);
+
+	wxListItem col3;
+	col3.SetId(ColumnSymbol);
+	col3.SetText(_("Symbol"));
+	col3.SetWidth(200);
+	m_exits->InsertColumn(ColumnSymbol, col3);
+
+	main_sizer->Add(m_exits, 1, wxEXPAND);
+
+	this->SetSizer(main_sizer);
+	this->wxWindowBase::Layout();
+
+	this->Centre(wxBOTH);
+
+	if (parent.GetConfig().data().pin_to_main)
+		OnMainMove(main_position, main_size);
+
+	m_exits->Bind(wxEVT_LEFT_DCLICK, &RecompilerStatsWindow::OnLeftDClick, this);
+
+	m_timer = new wxTimer(this);
+	this->Bind(wxEVT_TIMER, &RecompilerStatsWindow::OnTimer, this);
+	m_timer->Start(1000);
+
+	OnUpdateView();
+}
+
+RecompilerStatsWindow::~RecompilerStatsWindow()
+{
+	m_timer->Stop();
+}
+
+void RecompilerStatsWindow::OnMainMove(const wxPoint& main_position, const wxSize& main_size)
+{
+	wxSize size(420, 400);
+	this->SetSize(size);
+
+	wxPoint position = main_position;
+	position.x += main_size.x;
+	position.y += main_size.y - 400;
+	this->SetPosition(position);
+}
+
+void RecompilerStatsWindow::OnTimer(wxTimerEvent& event)
+{
+	if (IsShown())
+		OnUpdateView();
+}
+
+void RecompilerStatsWindow::OnUpdateView()
+{
+	const auto stats = PPCRecompilerStats_getSnapshot(RECOMPILER_STATS_MAX_EXITS);
+
+	const double avgCompileTime = stats.functionsCompiled != 0 ? (double)stats.totalCompileTimeUs / (double)stats.functionsCompiled : 0.0;
+	m_summary->SetLabel(wxString::Format(_("Compiled: %llu  Failed: %llu  Avg. compile time: %.1fus\nCode cache: %.2f MB  Exits to interpreter: %llu (sampled 1/%d)"),
+		(unsigned long long)stats.functionsCompiled, (unsigned long long)stats.functionsFailed, avgCompileTime, (double)stats.codeBytesAllocated / (1024.0 * 1024.0), (unsigned long long)stats.exitCount, PPC_REC_STATS_EXIT_SAMPLE_RATE));
+
+	wxString histogram = _("Compile time histogram:");
+	for (sint32 i = 0; i < PPC_REC_STATS_HISTOGRAM_BUCKETS; i++)
+	{
+		if (stats.compileTimeHistogram[i] == 0)
+			continue;
+		if (i == PPC_REC_STATS_HISTOGRAM_BUCKETS - 1)
+			histogram.Append(wxString::Format("  >=%uus: %u", 1u << (i - 1), stats.compileTimeHistogram[i]));
+		else
+			histogram.Append(wxString::Format("  <%uus: %u", 1u << i, stats.compileTimeHistogram[i]));
+	}
+	m_histogram->SetLabel(histogram);
+	m_histogram->Wrap(this->GetClientSize().GetWidth() - 10);
+
+	Freeze();
+	m_exits->DeleteAllItems();
+	for (size_t i = 0; i < stats.topExits.size(); i++)
+	{
+		const auto& exit = stats.topExits[i];
+		wxListItem item;
+		item.SetId((long)i);
+		item.SetText(wxString::Format("%08x", exit.address));
+		const auto index = m_exits->InsertItem(item);
+		m_exits->SetItem(index, ColumnSamples, wxString::Format("%llu", (unsigned long long)exit.sampleCount));
+		const double share = stats.exitSampleCount != 0 ? (double)exit.sampleCount * 100.0 / (double)stats.exitSampleCount : 0.0;
+		m_exits->SetItem(index, ColumnShare, wxString::Format("%.1f%%", share));
+		RPLStoredSymbol* symbol = rplSymbolStorage_getByClosestAddress(exit.address);
+		if (symbol)
+			m_exits->SetItem(index, ColumnSymbol, wxString::Format("%s+0x%x", (const char*)symbol->symbolName, exit.address - symbol->address));
+	}
+	Thaw();
+	this->Layout();
+}
+
+void RecompilerStatsWindow::OnLeftDClick(wxMouseEvent& event)
+{
+	long selected = m_exits->GetFirstSelected();
+	if (selected == -1)
+		return;
+	const auto text = m_exits->GetItemText(selected, ColumnAddress);
+	const auto address = std::stoul(text.ToStdString(), nullptr, 16);
+	if (address == 0)
+		return;
+	debuggerState.debugSession.instructionPointer = address;
+	debuggerWindow_moveIP();
+}
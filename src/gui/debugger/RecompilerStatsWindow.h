@@ -0,0 +1,22 @@
+#pragma once
+
+class DebuggerWindow2;
+
+class RecompilerStatsWindow : public wxFrame
+{
+public:
+	RecompilerStatsWindow(DebuggerWindow2& parent, const wxPoint& main_position, const wxSize& main_size);
+	virtual ~RecompilerStatsWindow();
+
+	void OnMainMove(const wxPoint& position, const wxSize& main_size);
+	void OnUpdateView();
+
+private:
+	void OnTimer(wxTimerEvent& event);
+	void OnLeftDClick(wxMouseEvent& event);
+
+	wxStaticText* m_summary;
+	wxStaticText* m_histogram;
+	wxListView* m_exits;
+	wxTimer* m_timer;
+};
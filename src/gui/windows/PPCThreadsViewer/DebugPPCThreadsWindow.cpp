@@ -87,31 +87,36 @@ DebugPPCThreadsWindow::DebugPPCThreadsWindow(wxFrame& parent)
 	colPriority.SetText("Priority");
 	colPriority.SetWidth(80);
 	m_thread_list->InsertColumn(7, colPriority);
+	wxListItem colQuantum;
+	colQuantum.SetId(8);
+	colQuantum.SetText("Quantum");
+	colQuantum.SetWidth(70);
+	m_thread_list->InsertColumn(8, colQuantum);
 	wxListItem col6;
-	col6.SetId(8);
+	col6.SetId(9);
 	col6.SetText("SliceStart");
 	col6.SetWidth(110);
-	m_thread_list->InsertColumn(8, col6);
+	m_thread_list->InsertColumn(9, col6);
 	wxListItem col7;
-	col7.SetId(9);
+	col7.SetId(10);
 	col7.SetText("SumWakeTime");
 	col7.SetWidth(110);
-	m_thread_list->InsertColumn(9, col7);
+	m_thread_list->InsertColumn(10, col7);
 	wxListItem col8;
-	col8.SetId(10);
+	col8.SetId(11);
 	col8.SetText("ThreadName");
 	col8.SetWidth(180);
-	m_thread_list->InsertColumn(10, col8);
+	m_thread_list->InsertColumn(11, col8);
 	wxListItem col9;
-	col9.SetId(11);
+	col9.SetId(12);
 	col9.SetText("GPR");
 	col9.SetWidth(180);
-	m_thread_list->InsertColumn(11, col9);
+	m_thread_list->InsertColumn(12, col9);
 	wxListItem col10;
-	col10.SetId(12);
+	col10.SetId(13);
 	col10.SetText("Extra info");
 	col10.SetWidth(180);
-	m_thread_list->InsertColumn(12, col10);
+	m_thread_list->InsertColumn(13, col10);
 
 	sizer->Add(m_thread_list, 1, wxEXPAND | wxALL, 5);
 
@@ -123,6 +128,9 @@ DebugPPCThreadsWindow::DebugPPCThreadsWindow(wxFrame& parent)
 	m_auto_refresh->SetValue(true);
 	row->Add(m_auto_refresh, 0, wxEXPAND | wxALL, 5);
 
+	m_scheduler_lock_stats = new wxStaticText(this, wxID_ANY, wxEmptyString);
+	row->Add(m_scheduler_lock_stats, 1, wxALIGN_CENTER_VERTICAL | wxALL, 5);
+
 	sizer->Add(row, 0, wxEXPAND | wxALL, 5);
 
 	m_thread_list->Connect(wxEVT_RIGHT_DOWN, wxMouseEventHandler(DebugPPCThreadsWindow::OnThreadListRightClick), nullptr, this);
@@ -238,22 +246,25 @@ void DebugPPCThreadsWindow::RefreshThreadList()
             sint32 effectivePriority = cafeThread->effectivePriority;
             sprintf(tempStr, "%d", effectivePriority);
             m_thread_list->SetItem(i, 7, tempStr);
+            // quantum of the next timeslice (changes over time in adaptive mode)
+            sprintf(tempStr, "%u", coreinit::__OSThreadGetQuantum(cafeThread));
+            m_thread_list->SetItem(i, 8, tempStr);
             // last awake in cycles
             uint64 lastWakeUpTime = cafeThread->wakeUpTime;
             sprintf(tempStr, "%" PRIu64, lastWakeUpTime);
-            m_thread_list->SetItem(i, 8, tempStr);
+            m_thread_list->SetItem(i, 9, tempStr);
             // awake time in cycles
             uint64 awakeTime = cafeThread->totalCycles;
             sprintf(tempStr, "%" PRIu64, awakeTime);
-            m_thread_list->SetItem(i, 9, tempStr);
+            m_thread_list->SetItem(i, 10, tempStr);
             // thread name
             const char* threadName = "NULL";
             if (!cafeThread->threadName.IsNull())
                 threadName = cafeThread->threadName.GetPtr();
-            m_thread_list->SetItem(i, 10, threadName);
+            m_thread_list->SetItem(i, 11, threadName);
             // GPR
             sprintf(tempStr, "r3 %08x r4 %08x r5 %08x r6 %08x r7 %08x", _r(3), _r(4), _r(5), _r(6), _r(7));
-            m_thread_list->SetItem(i, 11, tempStr);
+            m_thread_list->SetItem(i, 12, tempStr);
             // waiting condition / extra info
             coreinit::OSMutex* mutex = cafeThread->waitingForMutex;
             if (mutex)
@@ -265,7 +276,7 @@ void DebugPPCThreadsWindow::RefreshThreadList()
             if (cafeThread->requestFlags & OSThread_t::REQUEST_FLAG_CANCEL)
                 strcat(tempStr, "[Cancel requested]");
 
-            m_thread_list->SetItem(i, 12, tempStr);
+            m_thread_list->SetItem(i, 13, tempStr);
 
             if(selected_thread != 0 && selected_thread == (long)threadItrMPTR)
                 m_thread_list->SetItemState(i, wxLIST_STATE_FOCUSED | wxLIST_STATE_SELECTED, wxLIST_STATE_FOCUSED | wxLIST_STATE_SELECTED);
@@ -275,6 +286,22 @@ void DebugPPCThreadsWindow::RefreshThreadList()
     }
 
 	m_thread_list->SetScrollPos(0, scrollPos, true);
+
+	RefreshSchedulerLockStats();
+}
+
+void DebugPPCThreadsWindow::RefreshSchedulerLockStats()
+{
+	wxString text = _("Scheduler lock contention:");
+	for (sint32 i = 0; i <= Espresso::CORE_COUNT; i++)
+	{
+		OSSchedulerLockStats lockStats = __OSGetSchedulerLockStats(i);
+		double contendedPercentage = lockStats.acquisitions != 0 ? (double)lockStats.contendedAcquisitions * 100.0 / (double)lockStats.acquisitions : 0.0;
+		wxString slotName = i < Espresso::CORE_COUNT ? wxString::Format(_("Core %d"), i) : _("Other");
+		double coreContendedPercentage = lockStats.coreAcquisitions != 0 ? (double)lockStats.coreContendedAcquisitions * 100.0 / (double)lockStats.coreAcquisitions : 0.0;
+		text.append(wxString::Format(" %s %.1f%% (%llu/%llu) core %.1f%% (%llu/%llu)", slotName, contendedPercentage, (unsigned long long)lockStats.contendedAcquisitions, (unsigned long long)lockStats.acquisitions, coreContendedPercentage, (unsigned long long)lockStats.coreContendedAcquisitions, (unsigned long long)lockStats.coreAcquisitions));
+	}
+	m_scheduler_lock_stats->SetLabel(text);
 }
 
 void DebugPPCThreadsWindow::DumpStackTrace(OSThread_t* thread)
@@ -12,6 +12,7 @@ public:
 	void OnRefreshButton(wxCommandEvent& event);
 	void OnClose(wxCloseEvent& event);
 	void RefreshThreadList();
+	void RefreshSchedulerLockStats();
 	void OnThreadListPopupClick(wxCommandEvent &evt);
 	void OnThreadListRightClick(wxMouseEvent& event);
 
@@ -25,6 +26,7 @@ private:
 
     wxListCtrl* m_thread_list;
 	wxCheckBox* m_auto_refresh;
+	wxStaticText* m_scheduler_lock_stats;
 	wxTimer* m_timer;
 
 	void OnTimer(wxTimerEvent& event);
@@ -0,0 +1,47 @@
+#pragma once
+#include "util/highresolutiontimer/HighResolutionTimer.h"
+
+struct PPCInterpreter_t;
+struct OSThread_t;
+
+// CemuBenchmark is a standalone tool for benchmarks and self checks which run without a title, renderer or GPU (configure with -DENABLE_BENCHMARKS=ON)
+// every suite parses its own arguments and returns the process exit code, checks return 1 if any mismatch was found
+
+// suites
+int BenchmarkSuite_TextureDecode(int argc, char* argv[]);
+int BenchmarkSuite_TextureSIMDCheck(int argc, char* argv[]);
+int BenchmarkSuite_Hash(int argc, char* argv[]);
+int BenchmarkSuite_ExpHeap(int argc, char* argv[]);
+int BenchmarkSuite_Interpreter(int argc, char* argv[]);
+int BenchmarkSuite_Sync(int argc, char* argv[]);
+int BenchmarkSuite_Yield(int argc, char* argv[]);
+int BenchmarkSuite_CodeHeap(int argc, char* argv[]);
+
+// maps the guest memory ranges of a title (MEM2 at 0x10000000 etc.) so suites can place data in guest memory
+void Benchmark_InitGuestMemory();
+
+// boots a minimal Cafe OS (PPC core, HLE coreinit and the thread scheduler) without a title and runs func on a PPC thread of the main core
+// numCPUEmulationThreads is passed to the scheduler (1 or 3). Returns the result of func. Can only be used once per process
+int Benchmark_RunOnPPCThread(int (*func)(), sint32 numCPUEmulationThreads);
+// bump allocator for MEM2, only valid after Benchmark_RunOnPPCThread started. Memory is never freed
+void* Benchmark_AllocGuestMemory(uint32 size, uint32 alignment);
+// creates and resumes a PPC thread with priority 16 which runs func with numParam in r3. The thread exits when func returns via osLib_returnFromFunction
+// affinityMask uses the OSCreateThread attribute bits (1 << coreIndex)
+OSThread_t* Benchmark_CreatePPCThread(void (*func)(PPCInterpreter_t* hCPU), uint32 affinityMask, sint32 numParam);
+
+// runs func once to warm up caches, then returns the best time of the given number of runs
+template<typename TFunc>
+double Benchmark_MeasureBestMilliseconds(sint32 iterations, TFunc&& func)
+{
+	func();
+	double bestMilliseconds = std::numeric_limits<double>::max();
+	for (sint32 i = 0; i < iterations; i++)
+	{
+		BenchmarkTimer timer;
+		timer.Start();
+		func();
+		timer.Stop();
+		bestMilliseconds = std::min(bestMilliseconds, timer.GetElapsedMilliseconds());
+	}
+	return bestMilliseconds;
+}
@@ -0,0 +1,80 @@
+#include "tools/benchmark/Benchmark.h"
+#include "Cafe/OS/common/OSCommon.h"
+#include "Cafe/OS/libs/coreinit/coreinit.h"
+#include "Cafe/OS/libs/coreinit/coreinit_Thread.h"
+#include "Cafe/OS/RPL/rpl.h"
+#include "Cafe/HW/MMU/MMU.h"
+
+// minimal Cafe OS environment for suites which exercise coreinit or the PPC core
+// only the HLE coreinit module is loaded, there is no title, no RPL module and no GPU. Since nothing else lives in MEM2 the suites can use all of it
+
+static struct
+{
+	bool isInitialized{false};
+	bool hasRun{false};
+	int (*func)();
+	int exitCode{0};
+	std::atomic_bool isDone{false};
+	uint32 guestAllocOffset{0};
+}s_benchmarkCafeOS;
+
+static void _BenchmarkInitCafeOS()
+{
+	if (s_benchmarkCafeOS.isInitialized)
+		return;
+	// measures the RDTSC frequency asynchronously, this takes a few seconds
+	PPCTimer_init();
+	Benchmark_InitGuestMemory();
+	PPCCore_init();
+	RPLLoader_InitState();
+	// allocate memory for all SysAllocators, must happen before coreinit is initialized
+	SysAllocatorContainer::GetInstance().Initialize();
+	PPCTimer_waitForInit();
+	PPCTimer_start();
+	coreinit_load();
+	s_benchmarkCafeOS.isInitialized = true;
+}
+
+static void _BenchmarkPPCThreadEntry(PPCInterpreter_t* hCPU)
+{
+	s_benchmarkCafeOS.exitCode = s_benchmarkCafeOS.func();
+	s_benchmarkCafeOS.isDone.store(true);
+	s_benchmarkCafeOS.isDone.notify_all();
+	osLib_returnFromFunction(hCPU, 0); // returns into OSExitThread
+}
+
+int Benchmark_RunOnPPCThread(int (*func)(), sint32 numCPUEmulationThreads)
+{
+	// the scheduler deletes all PPC threads when it is shut down, running a second time would need a full reinitialization of coreinit
+	cemu_assert(!s_benchmarkCafeOS.hasRun);
+	s_benchmarkCafeOS.hasRun = true;
+	_BenchmarkInitCafeOS();
+	s_benchmarkCafeOS.func = func;
+	OSThread_t* thread = coreinit::OSGetDefaultThread(1);
+	coreinit::OSSetThreadPriority(thread, 16);
+	coreinit::OSRunThread(thread, PPCInterpreter_makeCallableExportDepr(_BenchmarkPPCThreadEntry), 0, nullptr);
+	coreinit::OSSchedulerBegin(numCPUEmulationThreads);
+	s_benchmarkCafeOS.isDone.wait(false);
+	coreinit::OSSchedulerEnd();
+	return s_benchmarkCafeOS.exitCode;
+}
+
+void* Benchmark_AllocGuestMemory(uint32 size, uint32 alignment)
+{
+	cemu_assert_debug(s_benchmarkCafeOS.isInitialized && std::has_single_bit(alignment));
+	uint32 offset = (s_benchmarkCafeOS.guestAllocOffset + alignment - 1) & ~(alignment - 1);
+	cemu_assert(offset + size <= mmuRange_MEM2.getSize());
+	s_benchmarkCafeOS.guestAllocOffset = offset + size;
+	return memory_getPointerFromVirtualOffset(mmuRange_MEM2.getBase() + offset);
+}
+
+OSThread_t* Benchmark_CreatePPCThread(void (*func)(PPCInterpreter_t* hCPU), uint32 affinityMask, sint32 numParam)
+{
+	constexpr uint32 stackSize = 0x4000;
+	OSThread_t* thread = (OSThread_t*)Benchmark_AllocGuestMemory(sizeof(OSThread_t), 8);
+	uint8* stack = (uint8*)Benchmark_AllocGuestMemory(stackSize, 16);
+	bool r = coreinit::OSCreateThreadType(thread, RPLLoader_MakePPCCallable(func), numParam, nullptr, stack + stackSize, stackSize, 16, affinityMask, OSThread_t::THREAD_TYPE::TYPE_APP);
+	cemu_assert(r);
+	coreinit::OSResumeThread(thread);
+	return thread;
+}
@@ -0,0 +1,57 @@
+#include "tools/benchmark/Benchmark.h"
+#include "Cafe/HW/MMU/MMU.h"
+
+// usage: CemuBenchmark <suite> [suite arguments]
+
+struct BenchmarkSuite
+{
+	const char* name;
+	const char* description;
+	int (*run)(int argc, char* argv[]);
+};
+
+static const BenchmarkSuite s_benchmarkSuites[] =
+{
+	{ "texture_decode", "texture decoders and AddrLib detiling for every tile mode", BenchmarkSuite_TextureDecode },
+	{ "texture_simd_check", "compares the vectorized BC1-BC5 and RGBA8 expansion kernels against the generic code", BenchmarkSuite_TextureSIMDCheck },
+	{ "hash", "buffer page and texture change detection hashes, all implementations and the previous scalar hashes", BenchmarkSuite_Hash },
+	{ "expheap", "ExpHeap free block index self check and allocations from a fragmented heap", BenchmarkSuite_ExpHeap },
+	{ "interpreter", "PPC interpreter throughput with and without the decode cache", BenchmarkSuite_Interpreter },
+	{ "sync", "OSMutex and OSEvent fast paths and a two thread event ping-pong", BenchmarkSuite_Sync },
+	{ "yield", "hundreds of PPC threads calling OSYieldThread, stresses the run queues", BenchmarkSuite_Yield },
+	{ "codeheap", "recompiler code reclamation while a PPC thread is blocked inside recompiled code", BenchmarkSuite_CodeHeap },
+};
+
+void Benchmark_InitGuestMemory()
+{
+	static bool s_isInitialized = false;
+	if (s_isInitialized)
+		return;
+	memory_init();
+	memory_mapForCurrentTitle(); // no graphic pack is active, so this maps the default layout
+	s_isInitialized = true;
+}
+
+static void PrintUsage(const char* executableName)
+{
+	fprintf(stderr, "Usage: %s <suite> [arguments]\nSuites:\n", executableName);
+	for (auto& suite : s_benchmarkSuites)
+		fprintf(stderr, "  %-24s %s\n", suite.name, suite.description);
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		PrintUsage(argv[0]);
+		return 1;
+	}
+	std::string_view suiteName = argv[1];
+	for (auto& suite : s_benchmarkSuites)
+	{
+		if (suiteName == suite.name)
+			return suite.run(argc - 1, argv + 1);
+	}
+	PrintUsage(argv[0]);
+	return 1;
+}
@@ -0,0 +1,133 @@
+#include "tools/benchmark/Benchmark.h"
+#include "Cafe/HW/Espresso/Recompiler/PPCRecompilerCodeHeap.h"
+
+// checks that freed recompiler code is reclaimed while a PPC thread is parked inside recompiled code (e.g. blocked in OSWaitEvent)
+// and that only the code its HLE call site returns to stays pinned. Also measures enter/leave and park/unpark
+// usage: CemuBenchmark codeheap [--iterations <count>]
+
+#define CODEHEAP_BENCHMARK_CODE_SIZE	(0x400)
+#define CODEHEAP_BENCHMARK_LOOP_COUNT	(1000000)
+
+static struct
+{
+	sint32 iterations{5};
+	sint32 errorCount{};
+}s_codeHeapBenchmark;
+
+static void _Check(bool condition, const char* description)
+{
+	printf("%-62s %s\n", description, condition ? "ok" : "FAILED");
+	if (!condition)
+		s_codeHeapBenchmark.errorCount++;
+}
+
+static uint64 _GetPendingFreeBytes()
+{
+	// reclaim advances the epoch at most twice per call
+	for (sint32 i = 0; i < 3; i++)
+		PPCRecompilerCodeHeap_reclaim();
+	return PPCRecompilerCodeHeap_getStats().pendingFreeBytes;
+}
+
+static int _RunCodeHeapBenchmark()
+{
+	PPCRecompilerCodeHeap_init(0, false, false);
+	PPCInterpreter_t* blockedThread = new PPCInterpreter_t();
+	PPCInterpreter_t* runningThread = new PPCInterpreter_t();
+
+	uint8* writable;
+	uint8* pinnedCode = PPCRecompilerCodeHeap_alloc(CODEHEAP_BENCHMARK_CODE_SIZE, writable);
+	uint8* otherCode = PPCRecompilerCodeHeap_alloc(CODEHEAP_BENCHMARK_CODE_SIZE, writable);
+
+	// the blocked thread made an HLE call from pinnedCode and was switched out
+	PPCRecompilerCodeHeapCallSite callSite{ pinnedCode + 0x20, nullptr };
+	PPCRecompilerCodeHeap_enter(blockedThread);
+	blockedThread->codeHeapCallSite = &callSite;
+	PPCRecompilerCodeHeap_park(blockedThread);
+
+	PPCRecompilerCodeHeap_free(pinnedCode);
+	PPCRecompilerCodeHeap_free(otherCode);
+	_Check(_GetPendingFreeBytes() == CODEHEAP_BENCHMARK_CODE_SIZE, "code is reclaimed while a thread is parked");
+
+	// after resuming, the thread returns into pinnedCode. It must stay alive until the thread left recompiled code
+	PPCRecompilerCodeHeap_unpark(blockedThread);
+	_Check(_GetPendingFreeBytes() == CODEHEAP_BENCHMARK_CODE_SIZE, "code of a call site is kept after the thread resumed");
+	blockedThread->codeHeapCallSite = nullptr;
+	PPCRecompilerCodeHeap_leave(blockedThread);
+	_Check(_GetPendingFreeBytes() == 0, "code of a call site is reclaimed once the thread left");
+
+	// a thread which is still running inside recompiled code delays reclamation as before
+	otherCode = PPCRecompilerCodeHeap_alloc(CODEHEAP_BENCHMARK_CODE_SIZE, writable);
+	PPCRecompilerCodeHeap_enter(runningThread);
+	PPCRecompilerCodeHeap_free(otherCode);
+	_Check(_GetPendingFreeBytes() == CODEHEAP_BENCHMARK_CODE_SIZE, "code is kept while a thread is running inside recompiled code");
+	PPCRecompilerCodeHeap_leave(runningThread);
+	_Check(_GetPendingFreeBytes() == 0, "code is reclaimed once the running thread left");
+
+	// a thread which is deleted while parked releases its call sites
+	pinnedCode = PPCRecompilerCodeHeap_alloc(CODEHEAP_BENCHMARK_CODE_SIZE, writable);
+	callSite.returnAddress = pinnedCode + 0x20;
+	PPCRecompilerCodeHeap_enter(blockedThread);
+	blockedThread->codeHeapCallSite = &callSite;
+	PPCRecompilerCodeHeap_park(blockedThread);
+	PPCRecompilerCodeHeap_free(pinnedCode);
+	_Check(_GetPendingFreeBytes() == CODEHEAP_BENCHMARK_CODE_SIZE, "code of a call site is pinned while the thread is parked");
+	blockedThread->codeHeapCallSite = nullptr;
+	PPCRecompilerCodeHeap_releaseThread(blockedThread);
+	_Check(_GetPendingFreeBytes() == 0, "code of a call site is reclaimed once the thread was deleted");
+
+	double enterMilliseconds = Benchmark_MeasureBestMilliseconds(s_codeHeapBenchmark.iterations, [&]() {
+		for (sint32 i = 0; i < CODEHEAP_BENCHMARK_LOOP_COUNT; i++)
+		{
+			PPCRecompilerCodeHeap_enter(runningThread);
+			PPCRecompilerCodeHeap_leave(runningThread);
+		}
+	});
+	printf("%-16s %8.3f ms %8.1f ns per call\n", "enter+leave", enterMilliseconds, enterMilliseconds * 1000000.0 / CODEHEAP_BENCHMARK_LOOP_COUNT);
+	PPCRecompilerCodeHeap_enter(runningThread);
+	runningThread->codeHeapCallSite = &callSite;
+	double parkMilliseconds = Benchmark_MeasureBestMilliseconds(s_codeHeapBenchmark.iterations, [&]() {
+		for (sint32 i = 0; i < CODEHEAP_BENCHMARK_LOOP_COUNT; i++)
+		{
+			PPCRecompilerCodeHeap_park(runningThread);
+			PPCRecompilerCodeHeap_unpark(runningThread);
+		}
+	});
+	runningThread->codeHeapCallSite = nullptr;
+	PPCRecompilerCodeHeap_leave(runningThread);
+	printf("%-16s %8.3f ms %8.1f ns per call\n", "park+unpark", parkMilliseconds, parkMilliseconds * 1000000.0 / CODEHEAP_BENCHMARK_LOOP_COUNT);
+
+	delete blockedThread;
+	delete runningThread;
+	PPCRecompilerCodeHeap_shutdown();
+	return s_codeHeapBenchmark.errorCount == 0 ? 0 : 1;
+}
+
+static bool ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view arg = argv[i];
+		bool hasValue = (i + 1) < argc;
+		if (arg == "--iterations" && hasValue)
+		{
+			s_codeHeapBenchmark.iterations = atoi(argv[++i]);
+			if (s_codeHeapBenchmark.iterations <= 0)
+				return false;
+		}
+		else
+			return false;
+	}
+	return true;
+}
+
+int BenchmarkSuite_CodeHeap(int argc, char* argv[])
+{
+	if (!ParseArguments(argc, argv))
+	{
+		fprintf(stderr, "Usage: CemuBenchmark codeheap [--iterations <count>]\n");
+		return 1;
+	}
+	// the code heap doesn't depend on the scheduler, the PPC threads are simulated with plain interpreter instances
+	return _RunCodeHeapBenchmark();
+}
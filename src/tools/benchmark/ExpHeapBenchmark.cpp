@@ -0,0 +1,102 @@
+#include "tools/benchmark/Benchmark.h"
+#include "Cafe/OS/libs/coreinit/coreinit_MEM_ExpHeap.h"
+
+// runs the randomized self check of the ExpHeap free block index (expheap_test) and measures allocations from a fragmented heap
+// usage: CemuBenchmark expheap [--iterations <count>]
+
+#define EXPHEAP_BENCHMARK_TEST_HEAP_SIZE	(0x01000000)
+#define EXPHEAP_BENCHMARK_HEAP_SIZE			(0x04000000)
+#define EXPHEAP_BENCHMARK_BLOCK_COUNT		(16 * 1024) // half of them are freed again to fragment the heap
+#define EXPHEAP_BENCHMARK_ALLOC_COUNT		(4096)
+
+static struct
+{
+	sint32 iterations{5};
+}s_expHeapBenchmark;
+
+static uint32 _Random(uint32& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+static int _RunExpHeapBenchmark()
+{
+	using namespace coreinit;
+	sint32 errorCount = expheap_test(Benchmark_AllocGuestMemory(EXPHEAP_BENCHMARK_TEST_HEAP_SIZE, 0x1000), EXPHEAP_BENCHMARK_TEST_HEAP_SIZE);
+	printf("Self check: %s (%d errors)\n", errorCount == 0 ? "ok" : "FAILED", errorCount);
+
+	// fill the heap with small blocks and free every second one, this leaves thousands of small free blocks in front of the large free block at the end
+	MEMHeapHandle heap = MEMCreateExpHeapEx(Benchmark_AllocGuestMemory(EXPHEAP_BENCHMARK_HEAP_SIZE, 0x1000), EXPHEAP_BENCHMARK_HEAP_SIZE, 0);
+	uint32 rngState = 0x12345678;
+	std::vector<void*> blocks;
+	for (sint32 i = 0; i < EXPHEAP_BENCHMARK_BLOCK_COUNT; i++)
+		blocks.emplace_back(MEMAllocFromExpHeapEx(heap, (_Random(rngState) % 0x400 + 1) * 4, 4));
+	for (sint32 i = 0; i < EXPHEAP_BENCHMARK_BLOCK_COUNT; i += 2)
+		MEMFreeToExpHeap(heap, blocks[i]);
+	// mostly sizes which fit into few of the free blocks, so a linear search has to walk far
+	uint32 allocSizes[EXPHEAP_BENCHMARK_ALLOC_COUNT];
+	for (auto& size : allocSizes)
+		size = (_Random(rngState) % 8 == 0) ? ((_Random(rngState) % 0x400 + 1) * 4) : ((_Random(rngState) % 0x400 + 0x380) * 4);
+
+	struct
+	{
+		const char* name;
+		uint16 allocMode;
+		bool fromTail;
+	}const benchmarkModes[] =
+	{
+		{ "first fit, head", MEM_EXPHEAP_ALLOC_MODE_FIRST, false },
+		{ "first fit, tail", MEM_EXPHEAP_ALLOC_MODE_FIRST, true },
+		{ "best fit, head", MEM_EXPHEAP_ALLOC_MODE_NEAR, false },
+		{ "best fit, tail", MEM_EXPHEAP_ALLOC_MODE_NEAR, true },
+	};
+	void* allocations[EXPHEAP_BENCHMARK_ALLOC_COUNT];
+	for (auto& mode : benchmarkModes)
+	{
+		MEMSetAllocModeForExpHeap(heap, mode.allocMode);
+		double milliseconds = Benchmark_MeasureBestMilliseconds(s_expHeapBenchmark.iterations, [&]() {
+			for (sint32 i = 0; i < EXPHEAP_BENCHMARK_ALLOC_COUNT; i++)
+				allocations[i] = MEMAllocFromExpHeapEx(heap, allocSizes[i], mode.fromTail ? -32 : 32);
+			for (sint32 i = EXPHEAP_BENCHMARK_ALLOC_COUNT - 1; i >= 0; i--)
+			{
+				if (allocations[i])
+					MEMFreeToExpHeap(heap, allocations[i]);
+			}
+		});
+		printf("%-16s %8.3f ms %8.1f ns per alloc+free\n", mode.name, milliseconds, milliseconds * 1000000.0 / EXPHEAP_BENCHMARK_ALLOC_COUNT);
+	}
+	MEMDestroyExpHeap(heap);
+	return errorCount == 0 ? 0 : 1;
+}
+
+static bool ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view arg = argv[i];
+		bool hasValue = (i + 1) < argc;
+		if (arg == "--iterations" && hasValue)
+		{
+			s_expHeapBenchmark.iterations = atoi(argv[++i]);
+			if (s_expHeapBenchmark.iterations <= 0)
+				return false;
+		}
+		else
+			return false;
+	}
+	return true;
+}
+
+int BenchmarkSuite_ExpHeap(int argc, char* argv[])
+{
+	if (!ParseArguments(argc, argv))
+	{
+		fprintf(stderr, "Usage: CemuBenchmark expheap [--iterations <count>]\n");
+		return 1;
+	}
+	// heap operations take coreinit spinlocks which require a current PPC thread
+	return Benchmark_RunOnPPCThread(_RunExpHeapBenchmark, 1);
+}
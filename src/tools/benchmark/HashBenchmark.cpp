@@ -0,0 +1,202 @@
+#include "tools/benchmark/Benchmark.h"
+#include "Cafe/HW/Latte/Core/LatteHash.h"
+#include "Common/cpu_features.h"
+
+// microbenchmark for the change detection hashes of the buffer cache (1KB pages) and texture cache (4K textures)
+// every implementation supported by the CPU is forced in turn, the scalar hashes which were used before LatteHash are measured as a baseline
+// also verifies that all implementations produce identical hashes
+// usage: CemuBenchmark hash [--iterations <count>]
+
+#define HASH_BENCHMARK_PAGE_SIZE		(0x400) // CACHE_PAGE_SIZE of the buffer cache
+#define HASH_BENCHMARK_PAGE_COUNT		(64 * 1024)
+#define HASH_BENCHMARK_TEXTURE_WIDTH	(3840)
+#define HASH_BENCHMARK_TEXTURE_HEIGHT	(2160)
+#define HASH_BENCHMARK_SAMPLE_STRIDE	(256) // stride used by the texture cache for huge textures
+
+struct HashBenchmarkImplementation
+{
+	const char* name;
+	bool avx2;
+	bool avx512f;
+};
+
+static const HashBenchmarkImplementation s_hashImplementations[] =
+{
+#if defined(ARCH_X86_64)
+	{ "SSE2", false, false },
+	{ "AVX2", true, false },
+	{ "AVX-512", true, true },
+#else
+	{ "Generic", false, false },
+#endif
+};
+
+static struct
+{
+	sint32 iterations{10};
+	std::vector<uint8> pageData;
+	std::vector<uint8> textureData;
+	bool hashesMatch{true};
+	uint64 pageHashSum;
+	uint64 textureHash;
+	uint64 textureSampledHash;
+}s_hashBenchmark;
+
+// previous buffer cache page hash, four interleaved rotate-add lanes
+static uint32 _legacyHashPage(const uint8* mem)
+{
+	const uint32* ptr = (const uint32*)mem;
+	const uint32* end = ptr + HASH_BENCHMARK_PAGE_SIZE / 4;
+	uint32 h0 = 0, h1 = 0, h2 = 0, h3 = 0;
+	while (ptr < end)
+	{
+		h0 = std::rotr(h0, 7) + ptr[0] * 0x55F23EAD;
+		h1 = std::rotr(h1, 7) + ptr[1] * 0x185FDC6D;
+		h2 = std::rotr(h2, 7) + ptr[2] * 0xF7431F49;
+		h3 = std::rotr(h3, 7) + ptr[3] * 0xA4C7AE9D;
+		ptr += 4;
+	}
+	return h0 + h1 + h2 + h3;
+}
+
+// previous texture hash for huge textures, one uint64 every 256 bytes
+static uint32 _legacyHashHugeTexture(const uint8* mem, uint32 size)
+{
+	const uint64* ptr = (const uint64*)mem;
+	const uint64* end = ptr + size / 8;
+	uint64 h64 = 0;
+	while (ptr < end)
+	{
+		h64 += *ptr;
+		h64 = std::rotl(h64, 3);
+		ptr += 32;
+	}
+	return (uint32)h64 ^ (uint32)(h64 >> 32);
+}
+
+static void PrintResult(const char* implName, const char* name, double milliseconds, size_t bytesRead, const char* unitName, size_t unitCount)
+{
+	double gbPerSecond = ((double)bytesRead / (1024.0 * 1024.0 * 1024.0)) / (milliseconds / 1000.0);
+	printf("%-8s %-22s %10.3f ms %9.2f GB/s %10.1f ns/%s\n", implName, name, milliseconds, gbPerSecond, milliseconds * 1000000.0 / (double)unitCount, unitName);
+}
+
+static void RunLegacyBaseline()
+{
+	const uint8* pages = s_hashBenchmark.pageData.data();
+	volatile uint32 pageResult = 0;
+	double pageMilliseconds = Benchmark_MeasureBestMilliseconds(s_hashBenchmark.iterations, [&]() {
+		uint32 h = 0;
+		for (uint32 i = 0; i < HASH_BENCHMARK_PAGE_COUNT; i++)
+			h += _legacyHashPage(pages + i * HASH_BENCHMARK_PAGE_SIZE);
+		pageResult = h;
+	});
+	PrintResult("Legacy", "buffer pages (1KB)", pageMilliseconds, s_hashBenchmark.pageData.size(), "page", HASH_BENCHMARK_PAGE_COUNT);
+
+	const uint8* texture = s_hashBenchmark.textureData.data();
+	uint32 textureSize = (uint32)s_hashBenchmark.textureData.size();
+	volatile uint32 textureResult = 0;
+	double textureMilliseconds = Benchmark_MeasureBestMilliseconds(s_hashBenchmark.iterations, [&]() { textureResult = _legacyHashHugeTexture(texture, textureSize); });
+	// each sample still pulls in a full cache line
+	PrintResult("Legacy", "4K texture (sampled)", textureMilliseconds, textureSize / HASH_BENCHMARK_SAMPLE_STRIDE * 64, "texture", 1);
+}
+
+static void RunImplementation(const HashBenchmarkImplementation& impl, bool isFirst)
+{
+	const uint8* pages = s_hashBenchmark.pageData.data();
+	uint64 pageHashSum = 0;
+	double pageMilliseconds = Benchmark_MeasureBestMilliseconds(s_hashBenchmark.iterations, [&]() {
+		uint64 h = 0;
+		for (uint32 i = 0; i < HASH_BENCHMARK_PAGE_COUNT; i++)
+			h += LatteHash_Compute(pages + i * HASH_BENCHMARK_PAGE_SIZE, HASH_BENCHMARK_PAGE_SIZE);
+		pageHashSum = h;
+	});
+	PrintResult(impl.name, "buffer pages (1KB)", pageMilliseconds, s_hashBenchmark.pageData.size(), "page", HASH_BENCHMARK_PAGE_COUNT);
+
+	const uint8* texture = s_hashBenchmark.textureData.data();
+	uint32 textureSize = (uint32)s_hashBenchmark.textureData.size();
+	uint64 textureHash = 0;
+	double textureMilliseconds = Benchmark_MeasureBestMilliseconds(s_hashBenchmark.iterations, [&]() { textureHash = LatteHash_Compute(texture, textureSize); });
+	PrintResult(impl.name, "4K texture (full)", textureMilliseconds, textureSize, "texture", 1);
+
+	uint64 textureSampledHash = 0;
+	double sampledMilliseconds = Benchmark_MeasureBestMilliseconds(s_hashBenchmark.iterations, [&]() { textureSampledHash = LatteHash_ComputeSampled(texture, textureSize, HASH_BENCHMARK_SAMPLE_STRIDE); });
+	PrintResult(impl.name, "4K texture (sampled)", sampledMilliseconds, textureSize / HASH_BENCHMARK_SAMPLE_STRIDE * LATTE_HASH_STRIPE_SIZE, "texture", 1);
+
+	if (isFirst)
+	{
+		s_hashBenchmark.pageHashSum = pageHashSum;
+		s_hashBenchmark.textureHash = textureHash;
+		s_hashBenchmark.textureSampledHash = textureSampledHash;
+	}
+	else if (pageHashSum != s_hashBenchmark.pageHashSum || textureHash != s_hashBenchmark.textureHash || textureSampledHash != s_hashBenchmark.textureSampledHash)
+	{
+		printf("MISMATCH %s: hashes differ from %s\n", impl.name, s_hashImplementations[0].name);
+		s_hashBenchmark.hashesMatch = false;
+	}
+}
+
+static bool ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view arg = argv[i];
+		bool hasValue = (i + 1) < argc;
+		if (arg == "--iterations" && hasValue)
+		{
+			s_hashBenchmark.iterations = atoi(argv[++i]);
+			if (s_hashBenchmark.iterations <= 0)
+				return false;
+		}
+		else
+			return false;
+	}
+	return true;
+}
+
+int BenchmarkSuite_Hash(int argc, char* argv[])
+{
+	if (!ParseArguments(argc, argv))
+	{
+		fprintf(stderr, "Usage: CemuBenchmark hash [--iterations <count>]\n");
+		return 1;
+	}
+	// random content, so that no implementation can benefit from the data
+	uint32 rngState = 0x12345678;
+	auto fillRandom = [&](std::vector<uint8>& data, size_t size) {
+		data.resize(size);
+		for (size_t i = 0; i < size; i += 4)
+		{
+			rngState ^= rngState << 13;
+			rngState ^= rngState >> 17;
+			rngState ^= rngState << 5;
+			memcpy(data.data() + i, &rngState, 4);
+		}
+	};
+	fillRandom(s_hashBenchmark.pageData, HASH_BENCHMARK_PAGE_SIZE * HASH_BENCHMARK_PAGE_COUNT);
+	fillRandom(s_hashBenchmark.textureData, HASH_BENCHMARK_TEXTURE_WIDTH * HASH_BENCHMARK_TEXTURE_HEIGHT * 4);
+
+	RunLegacyBaseline();
+#if defined(ARCH_X86_64)
+	auto hostFeatures = g_CPUFeatures.x86;
+#endif
+	bool isFirst = true;
+	for (auto& impl : s_hashImplementations)
+	{
+#if defined(ARCH_X86_64)
+		if ((impl.avx2 && !hostFeatures.avx2) || (impl.avx512f && !hostFeatures.avx512f))
+		{
+			printf("%-8s skipped, not supported by this CPU\n", impl.name);
+			continue;
+		}
+		g_CPUFeatures.x86.avx2 = impl.avx2;
+		g_CPUFeatures.x86.avx512f = impl.avx512f;
+#endif
+		cemu_assert(strcmp(LatteHash_GetImplementationName(), impl.name) == 0);
+		RunImplementation(impl, isFirst);
+		isFirst = false;
+	}
+#if defined(ARCH_X86_64)
+	g_CPUFeatures.x86 = hostFeatures;
+#endif
+	return s_hashBenchmark.hashesMatch ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+#include "tools/benchmark/Benchmark.h"
+#include "Cafe/HW/Espresso/PPCState.h"
+#include "Cafe/HW/MMU/MMU.h"
+
+// compares the pre-decoded interpreter (decode cache) against the switch decoder on a synthetic integer loop
+// usage: CemuBenchmark interpreter [--instructions <count>] [--iterations <count>]
+
+static struct
+{
+	uint32 instructionCount{50000000};
+	sint32 iterations{3};
+}s_interpreterBenchmark;
+
+static bool ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view arg = argv[i];
+		bool hasValue = (i + 1) < argc;
+		if (arg == "--instructions" && hasValue)
+		{
+			s_interpreterBenchmark.instructionCount = (uint32)strtoul(argv[++i], nullptr, 0);
+			if (s_interpreterBenchmark.instructionCount == 0)
+				return false;
+		}
+		else if (arg == "--iterations" && hasValue)
+		{
+			s_interpreterBenchmark.iterations = atoi(argv[++i]);
+			if (s_interpreterBenchmark.iterations <= 0)
+				return false;
+		}
+		else
+			return false;
+	}
+	return true;
+}
+
+int BenchmarkSuite_Interpreter(int argc, char* argv[])
+{
+	if (!ParseArguments(argc, argv))
+	{
+		fprintf(stderr, "Usage: CemuBenchmark interpreter [--instructions <count>] [--iterations <count>]\n");
+		return 1;
+	}
+	Benchmark_InitGuestMemory();
+	// the decode cache only covers the code area below MEM2
+	MPTR scratchAddress = mmuRange_TEXT_AREA.getBase();
+	double bestSwitchMIPS = 0.0, bestCachedMIPS = 0.0;
+	for (sint32 i = 0; i < s_interpreterBenchmark.iterations; i++)
+	{
+		double switchMIPS, cachedMIPS;
+		PPCInterpreter_benchmarkDecodeCache(scratchAddress, s_interpreterBenchmark.instructionCount, switchMIPS, cachedMIPS);
+		bestSwitchMIPS = std::max(bestSwitchMIPS, switchMIPS);
+		bestCachedMIPS = std::max(bestCachedMIPS, cachedMIPS);
+	}
+	printf("Switch decoder %8.1f MIPS\n", bestSwitchMIPS);
+	printf("Decode cache   %8.1f MIPS (%.2fx)\n", bestCachedMIPS, bestSwitchMIPS > 0.0 ? bestCachedMIPS / bestSwitchMIPS : 0.0);
+	return 0;
+}
@@ -0,0 +1,127 @@
+#include "tools/benchmark/Benchmark.h"
+#include "Cafe/OS/common/OSCommon.h"
+#include "Cafe/OS/libs/coreinit/coreinit_Thread.h"
+#include "Cafe/OS/libs/coreinit/coreinit_Scheduler.h"
+
+// microbenchmark for OSMutex and OSEvent. The uncontended operations use the lock-free fast paths (_OSMutexTryAcquire, _OSEventSignalFast)
+// and should not acquire the scheduler lock at all, the ping-pong between two threads measures the slow path with a thread switch per handoff
+// usage: CemuBenchmark sync [--iterations <count>] [--multicore]
+
+#define SYNC_BENCHMARK_OPERATION_COUNT	(1000000)
+#define SYNC_BENCHMARK_PINGPONG_COUNT	(20000)
+
+static struct
+{
+	sint32 iterations{5};
+	bool multicore{false};
+	coreinit::OSMutex* mutex;
+	coreinit::OSEvent* manualEvent;
+	coreinit::OSEvent* autoEvent;
+	coreinit::OSEvent* pingEvent;
+	coreinit::OSEvent* pongEvent;
+}s_syncBenchmark;
+
+static uint64 _GetSchedulerLockAcquisitions()
+{
+	uint64 acquisitions = 0;
+	for (sint32 i = 0; i <= Espresso::CORE_COUNT; i++)
+	{
+		OSSchedulerLockStats stats = __OSGetSchedulerLockStats(i);
+		acquisitions += stats.acquisitions + stats.coreAcquisitions;
+	}
+	return acquisitions;
+}
+
+template<typename TFunc>
+static void _MeasureOperation(const char* name, sint32 operationCount, TFunc&& func)
+{
+	uint64 acquisitionsBefore = _GetSchedulerLockAcquisitions();
+	double milliseconds = Benchmark_MeasureBestMilliseconds(s_syncBenchmark.iterations, [&]() {
+		for (sint32 i = 0; i < operationCount; i++)
+			func();
+	});
+	// the measurement runs the operations once more for warm up
+	uint64 totalOperations = (uint64)operationCount * (s_syncBenchmark.iterations + 1);
+	double acquisitionsPerOperation = (double)(_GetSchedulerLockAcquisitions() - acquisitionsBefore) / (double)totalOperations;
+	printf("%-36s %9.1f ns/op %8.3f scheduler locks/op\n", name, milliseconds * 1000000.0 / operationCount, acquisitionsPerOperation);
+}
+
+static void _PongThreadEntry(PPCInterpreter_t* hCPU)
+{
+	sint32 count = (sint32)hCPU->gpr[3];
+	for (sint32 i = 0; i < count; i++)
+	{
+		coreinit::OSWaitEvent(s_syncBenchmark.pingEvent);
+		coreinit::OSSignalEvent(s_syncBenchmark.pongEvent);
+	}
+	osLib_returnFromFunction(hCPU, 0);
+}
+
+static int _RunSyncBenchmark()
+{
+	using namespace coreinit;
+	s_syncBenchmark.mutex = (OSMutex*)Benchmark_AllocGuestMemory(sizeof(OSMutex), 8);
+	s_syncBenchmark.manualEvent = (OSEvent*)Benchmark_AllocGuestMemory(sizeof(OSEvent), 8);
+	s_syncBenchmark.autoEvent = (OSEvent*)Benchmark_AllocGuestMemory(sizeof(OSEvent), 8);
+	s_syncBenchmark.pingEvent = (OSEvent*)Benchmark_AllocGuestMemory(sizeof(OSEvent), 8);
+	s_syncBenchmark.pongEvent = (OSEvent*)Benchmark_AllocGuestMemory(sizeof(OSEvent), 8);
+	OSInitMutex(s_syncBenchmark.mutex);
+	OSInitEvent(s_syncBenchmark.manualEvent, OSEvent::EVENT_STATE::STATE_NOT_SIGNALED, OSEvent::EVENT_MODE::MODE_MANUAL);
+	OSInitEvent(s_syncBenchmark.autoEvent, OSEvent::EVENT_STATE::STATE_NOT_SIGNALED, OSEvent::EVENT_MODE::MODE_AUTO);
+	OSInitEvent(s_syncBenchmark.pingEvent, OSEvent::EVENT_STATE::STATE_NOT_SIGNALED, OSEvent::EVENT_MODE::MODE_AUTO);
+	OSInitEvent(s_syncBenchmark.pongEvent, OSEvent::EVENT_STATE::STATE_NOT_SIGNALED, OSEvent::EVENT_MODE::MODE_AUTO);
+
+	OSMutex* mutex = s_syncBenchmark.mutex;
+	_MeasureOperation("OSLockMutex + OSUnlockMutex", SYNC_BENCHMARK_OPERATION_COUNT, [&]() { OSLockMutex(mutex); OSUnlockMutex(mutex); });
+	_MeasureOperation("OSTryLockMutex + OSUnlockMutex", SYNC_BENCHMARK_OPERATION_COUNT, [&]() { OSTryLockMutex(mutex); OSUnlockMutex(mutex); });
+	OSLockMutex(mutex);
+	_MeasureOperation("recursive OSLockMutex + OSUnlockMutex", SYNC_BENCHMARK_OPERATION_COUNT, [&]() { OSLockMutex(mutex); OSUnlockMutex(mutex); });
+	OSUnlockMutex(mutex);
+
+	OSEvent* manualEvent = s_syncBenchmark.manualEvent;
+	OSEvent* autoEvent = s_syncBenchmark.autoEvent;
+	_MeasureOperation("OSSignalEvent + OSResetEvent (manual)", SYNC_BENCHMARK_OPERATION_COUNT, [&]() { OSSignalEvent(manualEvent); OSResetEvent(manualEvent); });
+	_MeasureOperation("OSSignalEventAll + OSResetEvent", SYNC_BENCHMARK_OPERATION_COUNT, [&]() { OSSignalEventAll(manualEvent); OSResetEvent(manualEvent); });
+	OSSignalEvent(manualEvent);
+	_MeasureOperation("OSWaitEvent (manual, signaled)", SYNC_BENCHMARK_OPERATION_COUNT, [&]() { OSWaitEvent(manualEvent); });
+	OSResetEvent(manualEvent);
+	_MeasureOperation("OSSignalEvent + OSWaitEvent (auto)", SYNC_BENCHMARK_OPERATION_COUNT, [&]() { OSSignalEvent(autoEvent); OSWaitEvent(autoEvent); });
+
+	// every handoff blocks one thread and wakes the other one
+	uint32 pongAffinity = s_syncBenchmark.multicore ? (1 << 0) : (1 << 1);
+	sint32 pingPongRuns = s_syncBenchmark.iterations + 1;
+	OSThread_t* pongThread = Benchmark_CreatePPCThread(_PongThreadEntry, pongAffinity, SYNC_BENCHMARK_PINGPONG_COUNT * pingPongRuns);
+	_MeasureOperation("event ping-pong between two threads", SYNC_BENCHMARK_PINGPONG_COUNT, [&]() { OSSignalEvent(s_syncBenchmark.pingEvent); OSWaitEvent(s_syncBenchmark.pongEvent); });
+	OSJoinThread(pongThread, nullptr);
+	return 0;
+}
+
+static bool ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view arg = argv[i];
+		bool hasValue = (i + 1) < argc;
+		if (arg == "--iterations" && hasValue)
+		{
+			s_syncBenchmark.iterations = atoi(argv[++i]);
+			if (s_syncBenchmark.iterations <= 0)
+				return false;
+		}
+		else if (arg == "--multicore")
+			s_syncBenchmark.multicore = true;
+		else
+			return false;
+	}
+	return true;
+}
+
+int BenchmarkSuite_Sync(int argc, char* argv[])
+{
+	if (!ParseArguments(argc, argv))
+	{
+		fprintf(stderr, "Usage: CemuBenchmark sync [--iterations <count>] [--multicore]\n");
+		return 1;
+	}
+	return Benchmark_RunOnPPCThread(_RunSyncBenchmark, s_syncBenchmark.multicore ? 3 : 1);
+}
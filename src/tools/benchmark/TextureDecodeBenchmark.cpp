@@ -0,0 +1,291 @@
+#include "tools/benchmark/Benchmark.h"
+#include "Cafe/HW/Latte/Core/LatteTextureLoader.h"
+#include "Cafe/HW/MMU/MMU.h"
+
+// benchmark for the texture decoders and the AddrLib detiling code
+// synthetic surfaces are placed in guest memory and decoded for every decoder and hardware tile mode. Results are written to stdout as CSV or JSON
+// usage: CemuBenchmark texture_decode [--json] [--size <width>x<height>] [--iterations <count>] [--filter <name>]
+
+struct TextureDecodeBenchmarkDecoder
+{
+	const char* name;
+	Latte::E_GX2SURFFMT format;
+	const char* formatName;
+	TextureDecoder* decoder;
+};
+
+#define BENCHMARK_DECODER(__name, __format) { #__name, Latte::E_GX2SURFFMT::__format, #__format, TextureDecoder_##__name::getInstance() }
+
+static const TextureDecodeBenchmarkDecoder s_benchmarkDecoders[] =
+{
+	BENCHMARK_DECODER(R16_G16_B16_A16_FLOAT, R16_G16_B16_A16_FLOAT),
+	BENCHMARK_DECODER(R16_G16_FLOAT, R16_G16_FLOAT),
+	BENCHMARK_DECODER(R16_SNORM, R16_SNORM),
+	BENCHMARK_DECODER(R16_FLOAT, R16_FLOAT),
+	BENCHMARK_DECODER(R32_FLOAT, R32_FLOAT),
+	BENCHMARK_DECODER(R32_G32_FLOAT, R32_G32_FLOAT),
+	BENCHMARK_DECODER(R32_G32_UINT, R32_G32_UINT),
+	BENCHMARK_DECODER(R32_UINT, R32_UINT),
+	BENCHMARK_DECODER(R16_UINT, R16_UINT),
+	BENCHMARK_DECODER(R8_UINT, R8_UINT),
+	BENCHMARK_DECODER(R32_G32_B32_A32_FLOAT, R32_G32_B32_A32_FLOAT),
+	BENCHMARK_DECODER(R32_G32_B32_A32_UINT, R32_G32_B32_A32_UINT),
+	BENCHMARK_DECODER(R16_G16_B16_A16_UINT, R16_G16_B16_A16_UINT),
+	BENCHMARK_DECODER(R8_G8_B8_A8_UINT, R8_G8_B8_A8_UINT),
+	BENCHMARK_DECODER(R24_X8, R24_X8_UNORM),
+	BENCHMARK_DECODER(X24_G8_UINT, X24_G8_UINT),
+	BENCHMARK_DECODER(D32_S8_UINT_X24, D32_S8_FLOAT),
+	BENCHMARK_DECODER(R4_G4_UNORM_To_RGBA4, R4_G4_UNORM),
+	BENCHMARK_DECODER(R4_G4_UNORM_To_RGBA4_vk, R4_G4_UNORM),
+	BENCHMARK_DECODER(R4G4_UNORM_To_RGBA8, R4_G4_UNORM),
+	BENCHMARK_DECODER(R4_G4_B4_A4_UNORM, R4_G4_B4_A4_UNORM),
+	BENCHMARK_DECODER(R4G4B4A4_UNORM_To_RGBA8, R4_G4_B4_A4_UNORM),
+	BENCHMARK_DECODER(R8_G8_B8_A8, R8_G8_B8_A8_UNORM),
+	BENCHMARK_DECODER(D24_S8, D24_S8_UNORM),
+	BENCHMARK_DECODER(NullData32, R32_FLOAT),
+	BENCHMARK_DECODER(NullData64, R32_G32_FLOAT),
+	BENCHMARK_DECODER(R8, R8_UNORM),
+	BENCHMARK_DECODER(R8_G8, R8_G8_UNORM),
+	BENCHMARK_DECODER(R4_G4, R4_G4_UNORM),
+	BENCHMARK_DECODER(R16_UNORM, R16_UNORM),
+	BENCHMARK_DECODER(R16_G16_B16_A16, R16_G16_B16_A16_UNORM),
+	BENCHMARK_DECODER(R16_G16, R16_G16_UNORM),
+	BENCHMARK_DECODER(R5_G6_B5, R5_G6_B5_UNORM),
+	BENCHMARK_DECODER(R5_G6_B5_swappedRB, R5_G6_B5_UNORM),
+	BENCHMARK_DECODER(R5G6B5_UNORM_To_RGBA8, R5_G6_B5_UNORM),
+	BENCHMARK_DECODER(R5_G5_B5_A1_UNORM, R5_G5_B5_A1_UNORM),
+	BENCHMARK_DECODER(R5_G5_B5_A1_UNORM_swappedRB, R5_G5_B5_A1_UNORM),
+	BENCHMARK_DECODER(R5_G5_B5_A1_UNORM_swappedRB_To_RGBA8, R5_G5_B5_A1_UNORM),
+	BENCHMARK_DECODER(R5_G5_B5_A1_UNORM_swappedOpenGL, R5_G5_B5_A1_UNORM),
+	BENCHMARK_DECODER(A1_B5_G5_R5_UNORM, A1_B5_G5_R5_UNORM),
+	BENCHMARK_DECODER(A1_B5_G5_R5_UNORM_vulkan, A1_B5_G5_R5_UNORM),
+	BENCHMARK_DECODER(A1_B5_G5_R5_UNORM_vulkan_To_RGBA8, A1_B5_G5_R5_UNORM),
+	BENCHMARK_DECODER(R10_G10_B10_A2_UNORM, R10_G10_B10_A2_UNORM),
+	BENCHMARK_DECODER(R10_G10_B10_A2_SNORM_To_RGBA16, R10_G10_B10_A2_SNORM),
+	BENCHMARK_DECODER(A2_B10_G10_R10_UNORM_To_RGBA16, A2_B10_G10_R10_UNORM),
+	BENCHMARK_DECODER(R11_G11_B10_FLOAT, R11_G11_B10_FLOAT),
+	BENCHMARK_DECODER(BC1_UNORM_uncompress, BC1_UNORM),
+	BENCHMARK_DECODER(BC1_SRGB_uncompress, BC1_SRGB),
+	BENCHMARK_DECODER(BC1, BC1_UNORM),
+	BENCHMARK_DECODER(BC2, BC2_UNORM),
+	BENCHMARK_DECODER(BC2_UNORM_uncompress, BC2_UNORM),
+	BENCHMARK_DECODER(BC2_SRGB_uncompress, BC2_SRGB),
+	BENCHMARK_DECODER(BC3_UNORM_uncompress, BC3_UNORM),
+	BENCHMARK_DECODER(BC3_SRGB_uncompress, BC3_SRGB),
+	BENCHMARK_DECODER(BC3, BC3_UNORM),
+	BENCHMARK_DECODER(BC4_UNORM_uncompress, BC4_UNORM),
+	BENCHMARK_DECODER(BC4, BC4_UNORM),
+	BENCHMARK_DECODER(BC5_UNORM_uncompress, BC5_UNORM),
+	BENCHMARK_DECODER(BC5_SNORM_uncompress, BC5_SNORM),
+	BENCHMARK_DECODER(BC5, BC5_UNORM),
+};
+
+// formats used for the per-texel AddrLib detiling path, one per texel size
+static const std::pair<Latte::E_GX2SURFFMT, const char*> s_benchmarkDetileFormats[] =
+{
+	{ Latte::E_GX2SURFFMT::R8_UNORM, "R8_UNORM" },
+	{ Latte::E_GX2SURFFMT::R8_G8_UNORM, "R8_G8_UNORM" },
+	{ Latte::E_GX2SURFFMT::R8_G8_B8_A8_UNORM, "R8_G8_B8_A8_UNORM" },
+	{ Latte::E_GX2SURFFMT::R32_G32_FLOAT, "R32_G32_FLOAT" },
+	{ Latte::E_GX2SURFFMT::R32_G32_B32_A32_FLOAT, "R32_G32_B32_A32_FLOAT" },
+	{ Latte::E_GX2SURFFMT::BC1_UNORM, "BC1_UNORM" },
+	{ Latte::E_GX2SURFFMT::BC3_UNORM, "BC3_UNORM" },
+};
+
+struct TextureDecodeBenchmarkResult
+{
+	const char* kind;
+	const char* name;
+	const char* formatName;
+	Latte::E_HWTILEMODE tileMode;
+	Latte::E_HWTILEMODE hwTileMode; // tile mode chosen by AddrLib, small surfaces fall back to micro tiling
+	sint32 width;
+	sint32 height;
+	uint32 inputSize;
+	uint32 outputSize;
+	double bestMilliseconds;
+};
+
+struct
+{
+	sint32 width{1024};
+	sint32 height{1024};
+	sint32 iterations{5};
+	bool json{false};
+	std::string filter;
+	MPTR surfaceAddress;
+	uint32 initializedSize{};
+	std::vector<uint8> outputBuffer;
+	std::vector<TextureDecodeBenchmarkResult> results;
+}s_benchmark;
+
+static bool IsThickTileMode(Latte::E_HWTILEMODE tileMode)
+{
+	return tileMode == Latte::E_HWTILEMODE::TM_1D_TILED_THICK || tileMode == Latte::E_HWTILEMODE::TM_2D_TILED_THICK || tileMode == Latte::E_HWTILEMODE::TM_2B_TILED_THICK ||
+		tileMode == Latte::E_HWTILEMODE::TM_3D_TILED_THICK || tileMode == Latte::E_HWTILEMODE::TM_3B_TILED_THICK;
+}
+
+// set up a surface in guest memory and fill it with pseudo random data. Thick tile modes use a 3D surface with 4 slices
+static bool PrepareSurface(LatteTextureLoaderCtx* textureLoader, Latte::E_GX2SURFFMT format, Latte::E_HWTILEMODE tileMode)
+{
+	bool isThick = IsThickTileMode(tileMode);
+	Latte::E_DIM dim = isThick ? Latte::E_DIM::DIM_3D : Latte::E_DIM::DIM_2D;
+	uint32 depth = isThick ? 4 : 1;
+	LatteAddrLib::AddrSurfaceInfo_OUT surfaceInfo;
+	LatteAddrLib::GX2CalculateSurfaceInfo(format, s_benchmark.width, s_benchmark.height, depth, dim, Latte::MakeGX2TileMode(tileMode), 0, 0, &surfaceInfo);
+	uint32 surfaceSize = (uint32)surfaceInfo.surfSize;
+	if (surfaceSize > mmuRange_MEM2.getSize())
+		return false;
+	if (surfaceSize > s_benchmark.initializedSize)
+	{
+		uint32 seed = 0x12345678;
+		uint32* memPtr = (uint32*)memory_getPointerFromPhysicalOffset(s_benchmark.surfaceAddress);
+		for (uint32 i = 0; i < surfaceSize / 4; i++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			memPtr[i] = seed;
+		}
+		s_benchmark.initializedSize = surfaceSize;
+	}
+	LatteTextureLoader_begin(textureLoader, 0, 0, s_benchmark.surfaceAddress, s_benchmark.surfaceAddress, format, dim, s_benchmark.width, s_benchmark.height, depth, 1, surfaceInfo.pitch, tileMode, 0);
+	return true;
+}
+
+static bool MatchesFilter(const char* name, const char* formatName)
+{
+	if (s_benchmark.filter.empty())
+		return true;
+	return strstr(name, s_benchmark.filter.c_str()) != nullptr || strstr(formatName, s_benchmark.filter.c_str()) != nullptr;
+}
+
+static void BenchmarkDecoder(const TextureDecodeBenchmarkDecoder& decoderInfo, Latte::E_HWTILEMODE tileMode)
+{
+	LatteTextureLoaderCtx textureLoader{};
+	if (!PrepareSurface(&textureLoader, decoderInfo.format, tileMode))
+		return;
+	TextureDecoder* decoder = decoderInfo.decoder;
+	textureLoader.decodedTexelCountX = decoder->getTexelCountX(&textureLoader);
+	textureLoader.decodedTexelCountY = decoder->getTexelCountY(&textureLoader);
+	uint32 imageSize = decoder->calculateImageSize(&textureLoader);
+	if (s_benchmark.outputBuffer.size() < imageSize)
+		s_benchmark.outputBuffer.resize(imageSize);
+	uint8* outputData = s_benchmark.outputBuffer.data();
+	// decode on the calling thread only, so the results do not depend on the parallel decode settings
+	double bestMilliseconds = Benchmark_MeasureBestMilliseconds(s_benchmark.iterations, [&]() { decoder->decode(&textureLoader, outputData); });
+	uint32 blocksX = (textureLoader.width + textureLoader.stepX - 1) / textureLoader.stepX;
+	uint32 blocksY = (textureLoader.height + textureLoader.stepY - 1) / textureLoader.stepY;
+	s_benchmark.results.push_back(TextureDecodeBenchmarkResult{ "decode", decoderInfo.name, decoderInfo.formatName, tileMode, textureLoader.tileMode, textureLoader.width, textureLoader.height, blocksX * blocksY * textureLoader.bpp / 8, imageSize, bestMilliseconds });
+}
+
+// copy every texel (or block) to a linear buffer using the generic per-texel AddrLib address calculation
+static void BenchmarkAddrLibDetile(Latte::E_GX2SURFFMT format, const char* formatName, Latte::E_HWTILEMODE tileMode)
+{
+	LatteTextureLoaderCtx textureLoader{};
+	if (!PrepareSurface(&textureLoader, format, tileMode))
+		return;
+	uint32 bytesPerBlock = textureLoader.bpp / 8;
+	uint32 blocksX = (textureLoader.width + textureLoader.stepX - 1) / textureLoader.stepX;
+	uint32 blocksY = (textureLoader.height + textureLoader.stepY - 1) / textureLoader.stepY;
+	uint32 imageSize = blocksX * blocksY * bytesPerBlock;
+	if (s_benchmark.outputBuffer.size() < imageSize)
+		s_benchmark.outputBuffer.resize(imageSize);
+	uint8* outputData = s_benchmark.outputBuffer.data();
+	double bestMilliseconds = Benchmark_MeasureBestMilliseconds(s_benchmark.iterations, [&]() {
+		uint8* output = outputData;
+		for (sint32 y = 0; y < textureLoader.height; y += textureLoader.stepY)
+		{
+			for (sint32 x = 0; x < textureLoader.width; x += textureLoader.stepX)
+			{
+				memcpy(output, LatteTextureLoader_GetInput(&textureLoader, x, y), bytesPerBlock);
+				output += bytesPerBlock;
+			}
+		}
+	});
+	s_benchmark.results.push_back(TextureDecodeBenchmarkResult{ "addrlib_detile", formatName, formatName, tileMode, textureLoader.tileMode, textureLoader.width, textureLoader.height, imageSize, imageSize, bestMilliseconds });
+}
+
+static double CalcMegabytesPerSecond(uint32 size, double milliseconds)
+{
+	if (milliseconds <= 0.0)
+		return 0.0;
+	return ((double)size / (1024.0 * 1024.0)) / (milliseconds / 1000.0);
+}
+
+static void PrintResults()
+{
+	if (s_benchmark.json)
+	{
+		printf("{\n\t\"simd\": \"%s\",\n\t\"iterations\": %d,\n\t\"results\": [\n", LatteTextureLoader_getSIMDImplementationName(), s_benchmark.iterations);
+		for (size_t i = 0; i < s_benchmark.results.size(); i++)
+		{
+			auto& r = s_benchmark.results[i];
+			printf("\t\t{ \"kind\": \"%s\", \"name\": \"%s\", \"format\": \"%s\", \"tilemode\": %d, \"hw_tilemode\": %d, \"width\": %d, \"height\": %d, \"input_bytes\": %u, \"output_bytes\": %u, \"best_ms\": %.4f, \"input_mb_per_s\": %.2f, \"output_mb_per_s\": %.2f }%s\n",
+				r.kind, r.name, r.formatName, (int)r.tileMode, (int)r.hwTileMode, r.width, r.height, r.inputSize, r.outputSize, r.bestMilliseconds,
+				CalcMegabytesPerSecond(r.inputSize, r.bestMilliseconds), CalcMegabytesPerSecond(r.outputSize, r.bestMilliseconds), (i + 1) < s_benchmark.results.size() ? "," : "");
+		}
+		printf("\t]\n}\n");
+		return;
+	}
+	printf("kind,name,format,tilemode,hw_tilemode,width,height,input_bytes,output_bytes,best_ms,input_mb_per_s,output_mb_per_s,simd\n");
+	for (auto& r : s_benchmark.results)
+	{
+		printf("%s,%s,%s,%d,%d,%d,%d,%u,%u,%.4f,%.2f,%.2f,%s\n",
+			r.kind, r.name, r.formatName, (int)r.tileMode, (int)r.hwTileMode, r.width, r.height, r.inputSize, r.outputSize, r.bestMilliseconds,
+			CalcMegabytesPerSecond(r.inputSize, r.bestMilliseconds), CalcMegabytesPerSecond(r.outputSize, r.bestMilliseconds), LatteTextureLoader_getSIMDImplementationName());
+	}
+}
+
+static bool ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view arg = argv[i];
+		bool hasValue = (i + 1) < argc;
+		if (arg == "--json")
+			s_benchmark.json = true;
+		else if (arg == "--size" && hasValue)
+		{
+			if (sscanf(argv[++i], "%dx%d", &s_benchmark.width, &s_benchmark.height) != 2 || s_benchmark.width <= 0 || s_benchmark.height <= 0 || s_benchmark.width > 8192 || s_benchmark.height > 8192)
+				return false;
+		}
+		else if (arg == "--iterations" && hasValue)
+		{
+			s_benchmark.iterations = atoi(argv[++i]);
+			if (s_benchmark.iterations <= 0)
+				return false;
+		}
+		else if (arg == "--filter" && hasValue)
+			s_benchmark.filter = argv[++i];
+		else
+			return false;
+	}
+	return true;
+}
+
+int BenchmarkSuite_TextureDecode(int argc, char* argv[])
+{
+	if (!ParseArguments(argc, argv))
+	{
+		fprintf(stderr, "Usage: CemuBenchmark texture_decode [--json] [--size <width>x<height>] [--iterations <count>] [--filter <name>]\n");
+		return 1;
+	}
+	Benchmark_InitGuestMemory();
+	s_benchmark.surfaceAddress = mmuRange_MEM2.getBase();
+
+	for (sint32 t = 0; t < 16; t++)
+	{
+		Latte::E_HWTILEMODE tileMode = (Latte::E_HWTILEMODE)t;
+		for (auto& decoderInfo : s_benchmarkDecoders)
+		{
+			if (MatchesFilter(decoderInfo.name, decoderInfo.formatName))
+				BenchmarkDecoder(decoderInfo, tileMode);
+		}
+		for (auto& it : s_benchmarkDetileFormats)
+		{
+			if (MatchesFilter("addrlib_detile", it.second))
+				BenchmarkAddrLibDetile(it.first, it.second, tileMode);
+		}
+	}
+	PrintResults();
+	return 0;
+}
@@ -0,0 +1,309 @@
+#include "tools/benchmark/Benchmark.h"
+#include "Cafe/HW/Latte/Core/LatteTextureLoader.h"
+#include "Cafe/HW/MMU/MMU.h"
+#include "Common/cpu_features.h"
+
+// randomized equivalence check for the vectorized texture decoding kernels (LatteTextureLoaderSIMD)
+// every implementation supported by the CPU is forced in turn and compared against the generic implementation, which uses the scalar BC block decoders
+// the RGBA8 expansion tables are additionally checked against the scalar bit replication for every possible texel value
+// usage: CemuBenchmark texture_simd_check [--seed <seed>] [--rounds <count>]
+
+struct TextureSIMDCheckImplementation
+{
+	const char* name;
+	bool sse4_1;
+	bool avx2;
+};
+
+static const TextureSIMDCheckImplementation s_simdImplementations[] =
+{
+	{ "Generic", false, false },
+	{ "SSE4.1", true, false },
+	{ "AVX2", true, true },
+};
+
+// reference expansion of a single texel, matches the scalar decoders before the expansion was table driven
+using TextureExpandReferenceFunc = void(*)(uint32 texel, uint8* rgba);
+
+static uint8 _replicate4(uint32 v) { return (uint8)((v << 4) | v); }
+static uint8 _replicate5(uint32 v) { return (uint8)((v << 3) | (v >> 2)); }
+static uint8 _replicate6(uint32 v) { return (uint8)((v << 2) | (v >> 4)); }
+static uint8 _replicate5Shift3(uint32 v) { return (uint8)((v << 3) | (v >> 3)); } // R5G6B5 has always been expanded this way
+
+struct TextureSIMDCheckDecoder
+{
+	const char* name;
+	Latte::E_GX2SURFFMT format;
+	TextureDecoder* decoder;
+	TextureExpandReferenceFunc expandReference; // only set for the RGBA8 expanding decoders
+};
+
+static const TextureSIMDCheckDecoder s_checkDecoders[] =
+{
+	{ "R4G4_UNORM_To_RGBA8", Latte::E_GX2SURFFMT::R4_G4_UNORM, TextureDecoder_R4G4_UNORM_To_RGBA8::getInstance(), [](uint32 v, uint8* rgba)
+		{ rgba[0] = _replicate4((v >> 4) & 0xF); rgba[1] = _replicate4(v & 0xF); rgba[2] = 0; rgba[3] = 255; } },
+	{ "R4G4B4A4_UNORM_To_RGBA8", Latte::E_GX2SURFFMT::R4_G4_B4_A4_UNORM, TextureDecoder_R4G4B4A4_UNORM_To_RGBA8::getInstance(), [](uint32 v, uint8* rgba)
+		{ rgba[0] = _replicate4(v & 0xF); rgba[1] = _replicate4((v >> 4) & 0xF); rgba[2] = _replicate4((v >> 8) & 0xF); rgba[3] = _replicate4((v >> 12) & 0xF); } },
+	{ "R5G6B5_UNORM_To_RGBA8", Latte::E_GX2SURFFMT::R5_G6_B5_UNORM, TextureDecoder_R5G6B5_UNORM_To_RGBA8::getInstance(), [](uint32 v, uint8* rgba)
+		{ rgba[0] = _replicate5Shift3(v & 0x1F); rgba[1] = _replicate6((v >> 5) & 0x3F); rgba[2] = _replicate5Shift3((v >> 11) & 0x1F); rgba[3] = 255; } },
+	{ "R5_G5_B5_A1_UNORM_swappedRB_To_RGBA8", Latte::E_GX2SURFFMT::R5_G5_B5_A1_UNORM, TextureDecoder_R5_G5_B5_A1_UNORM_swappedRB_To_RGBA8::getInstance(), [](uint32 v, uint8* rgba)
+		{ rgba[0] = _replicate5(v & 0x1F); rgba[1] = _replicate5((v >> 5) & 0x1F); rgba[2] = _replicate5((v >> 10) & 0x1F); rgba[3] = (v >> 15) ? 255 : 0; } },
+	{ "A1_B5_G5_R5_UNORM_vulkan_To_RGBA8", Latte::E_GX2SURFFMT::A1_B5_G5_R5_UNORM, TextureDecoder_A1_B5_G5_R5_UNORM_vulkan_To_RGBA8::getInstance(), [](uint32 v, uint8* rgba)
+		{ rgba[0] = _replicate5((v >> 11) & 0x1F); rgba[1] = _replicate5((v >> 6) & 0x1F); rgba[2] = _replicate5((v >> 1) & 0x1F); rgba[3] = (v & 1) ? 255 : 0; } },
+	{ "BC1_UNORM_uncompress", Latte::E_GX2SURFFMT::BC1_UNORM, TextureDecoder_BC1_UNORM_uncompress::getInstance(), nullptr },
+	{ "BC2_UNORM_uncompress", Latte::E_GX2SURFFMT::BC2_UNORM, TextureDecoder_BC2_UNORM_uncompress::getInstance(), nullptr },
+	{ "BC3_UNORM_uncompress", Latte::E_GX2SURFFMT::BC3_UNORM, TextureDecoder_BC3_UNORM_uncompress::getInstance(), nullptr },
+	{ "BC4_UNORM_uncompress", Latte::E_GX2SURFFMT::BC4_UNORM, TextureDecoder_BC4_UNORM_uncompress::getInstance(), nullptr },
+	{ "BC5_UNORM_uncompress", Latte::E_GX2SURFFMT::BC5_UNORM, TextureDecoder_BC5_UNORM_uncompress::getInstance(), nullptr },
+	{ "BC5_SNORM_uncompress", Latte::E_GX2SURFFMT::BC5_SNORM, TextureDecoder_BC5_SNORM_uncompress::getInstance(), nullptr },
+};
+
+using TextureBlockDecodeFunc = void(*)(uint8* blockData, float* output, sint32 pitch, sint32 sizeX, sint32 sizeY);
+
+struct TextureSIMDCheckBlockDecoder
+{
+	const char* name;
+	TextureBlockDecodeFunc decode;
+	uint32 blockSize;
+	sint32 channelCount;
+};
+
+static const TextureSIMDCheckBlockDecoder s_checkBlockDecoders[] =
+{
+	{ "BC1ToRGBA32F", LatteTextureLoader_decodeBC1ToRGBA32F, 8, 4 },
+	{ "BC2ToRGBA32F", LatteTextureLoader_decodeBC2ToRGBA32F, 16, 4 },
+	{ "BC3ToRGBA32F", LatteTextureLoader_decodeBC3ToRGBA32F, 16, 4 },
+	{ "BC4ToRG32F", LatteTextureLoader_decodeBC4ToRG32F, 8, 2 },
+	{ "BC5ToRG32F", LatteTextureLoader_decodeBC5ToRG32F, 16, 2 },
+	{ "BC5SNormToRG32F", LatteTextureLoader_decodeBC5SNormToRG32F, 16, 2 },
+};
+
+#define SIMD_CHECK_BLOCK_PITCH	(7) // in pixels, wider than a block so that writes outside of the block are detected
+#define SIMD_CHECK_GUARD_VALUE	(-1234.5f)
+
+struct
+{
+	uint32 seed{0x5EED1234};
+	sint32 rounds{200};
+	uint32 rngState;
+	MPTR surfaceAddress;
+	sint32 mismatchCount{};
+}s_simdCheck;
+
+static uint32 _Random()
+{
+	// xorshift32
+	uint32 x = s_simdCheck.rngState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	s_simdCheck.rngState = x;
+	return x;
+}
+
+static void _FillRandom(uint8* data, uint32 size)
+{
+	for (uint32 i = 0; i < size; i++)
+		data[i] = (uint8)_Random();
+}
+
+static void SetImplementation(const TextureSIMDCheckImplementation& impl)
+{
+	g_CPUFeatures.x86.sse4_1 = impl.sse4_1;
+	g_CPUFeatures.x86.avx2 = impl.avx2;
+	cemu_assert(strcmp(LatteTextureLoader_getSIMDImplementationName(), impl.name) == 0);
+}
+
+static void ReportMismatch(const char* implName, const char* name, const std::string& details)
+{
+	if (s_simdCheck.mismatchCount < 32)
+		printf("MISMATCH %s %s: %s\n", implName, name, details.c_str());
+	s_simdCheck.mismatchCount++;
+}
+
+// BC block corner cases: equal and swapped endpoints select the 3 color (BC1) and 6 value (BC3 alpha, BC4, BC5) modes, SNORM endpoints of -128 and -127 both map to -1.0
+static void _RandomizeBlock(uint8* block, uint32 blockSize)
+{
+	_FillRandom(block, blockSize);
+	uint32 variant = _Random() % 4;
+	if (variant == 0)
+	{
+		// identical endpoints in every 8 byte half, covers both the alpha/red endpoints (bytes 0-1) and the color endpoints (bytes 0-3)
+		for (uint32 i = 0; i < blockSize; i += 8)
+			block[i + 1] = block[i + 2] = block[i + 3] = block[i + 0];
+	}
+	else if (variant == 1)
+	{
+		for (uint32 i = 0; i < blockSize; i += 8)
+		{
+			block[i + 0] = (_Random() & 1) ? 0x80 : 0x81;
+			block[i + 1] = (_Random() & 1) ? 0x7F : 0x80;
+		}
+	}
+}
+
+static void CheckBlockDecoders(const TextureSIMDCheckImplementation& impl)
+{
+	uint8 block[16];
+	float reference[4 * SIMD_CHECK_BLOCK_PITCH * 4];
+	float result[4 * SIMD_CHECK_BLOCK_PITCH * 4];
+	for (auto& blockDecoder : s_checkBlockDecoders)
+	{
+		for (sint32 round = 0; round < s_simdCheck.rounds * 16; round++)
+		{
+			_RandomizeBlock(block, blockDecoder.blockSize);
+			// full blocks take the vectorized path, blocks clipped at the surface border use the scalar decoder in every implementation
+			sint32 sizeX = (round & 3) == 0 ? (sint32)(_Random() % 4) + 1 : 4;
+			sint32 sizeY = (round & 3) == 0 ? (sint32)(_Random() % 4) + 1 : 4;
+			std::fill(std::begin(reference), std::end(reference), SIMD_CHECK_GUARD_VALUE);
+			std::fill(std::begin(result), std::end(result), SIMD_CHECK_GUARD_VALUE);
+			SetImplementation(s_simdImplementations[0]);
+			blockDecoder.decode(block, reference, SIMD_CHECK_BLOCK_PITCH, sizeX, sizeY);
+			SetImplementation(impl);
+			blockDecoder.decode(block, result, SIMD_CHECK_BLOCK_PITCH, sizeX, sizeY);
+			if (memcmp(reference, result, sizeof(reference)) != 0)
+			{
+				std::string blockHex;
+				for (uint32 i = 0; i < blockDecoder.blockSize; i++)
+					blockHex.append(fmt::format("{:02x}", block[i]));
+				ReportMismatch(impl.name, blockDecoder.name, fmt::format("block {} size {}x{}", blockHex, sizeX, sizeY));
+			}
+		}
+	}
+}
+
+static uint32 PrepareSurface(LatteTextureLoaderCtx* textureLoader, Latte::E_GX2SURFFMT format, Latte::E_HWTILEMODE tileMode, sint32 width, sint32 height)
+{
+	LatteAddrLib::AddrSurfaceInfo_OUT surfaceInfo;
+	LatteAddrLib::GX2CalculateSurfaceInfo(format, width, height, 1, Latte::E_DIM::DIM_2D, Latte::MakeGX2TileMode(tileMode), 0, 0, &surfaceInfo);
+	cemu_assert(surfaceInfo.surfSize <= mmuRange_MEM2.getSize());
+	LatteTextureLoader_begin(textureLoader, 0, 0, s_simdCheck.surfaceAddress, s_simdCheck.surfaceAddress, format, Latte::E_DIM::DIM_2D, width, height, 1, 1, surfaceInfo.pitch, tileMode, 0);
+	return (uint32)surfaceInfo.surfSize;
+}
+
+static void DecodeSurface(const TextureSIMDCheckDecoder& decoderInfo, Latte::E_HWTILEMODE tileMode, sint32 width, sint32 height, const TextureSIMDCheckImplementation& impl, const std::vector<uint8>* surfaceData)
+{
+	LatteTextureLoaderCtx textureLoader{};
+	uint32 surfaceSize = PrepareSurface(&textureLoader, decoderInfo.format, tileMode, width, height);
+	uint8* surfacePtr = memory_getPointerFromPhysicalOffset(s_simdCheck.surfaceAddress);
+	_FillRandom(surfacePtr, surfaceSize);
+	if (surfaceData)
+		memcpy(surfacePtr, surfaceData->data(), std::min<size_t>(surfaceSize, surfaceData->size()));
+	textureLoader.decodedTexelCountX = decoderInfo.decoder->getTexelCountX(&textureLoader);
+	textureLoader.decodedTexelCountY = decoderInfo.decoder->getTexelCountY(&textureLoader);
+	std::vector<uint8> reference(decoderInfo.decoder->calculateImageSize(&textureLoader));
+	std::vector<uint8> result(reference.size());
+	SetImplementation(s_simdImplementations[0]);
+	decoderInfo.decoder->decode(&textureLoader, reference.data());
+	SetImplementation(impl);
+	decoderInfo.decoder->decode(&textureLoader, result.data());
+	if (reference != result)
+		ReportMismatch(impl.name, decoderInfo.name, fmt::format("tilemode {} size {}x{}", (int)tileMode, width, height));
+	if (!decoderInfo.expandReference)
+		return;
+	// compare against the scalar expansion
+	uint8* output = result.data();
+	for (sint32 y = 0; y < textureLoader.height; y++)
+	{
+		for (sint32 x = 0; x < textureLoader.width; x++)
+		{
+			uint8* texelData = LatteTextureLoader_GetInput(&textureLoader, x, y);
+			uint32 texel = textureLoader.bpp == 16 ? *(uint16*)texelData : *texelData;
+			uint8 rgba[4];
+			decoderInfo.expandReference(texel, rgba);
+			if (memcmp(rgba, output + (x + y * textureLoader.width) * 4, 4) != 0)
+			{
+				ReportMismatch(impl.name, decoderInfo.name, fmt::format("texel 0x{:04x} at {},{} tilemode {} size {}x{}", texel, x, y, (int)tileMode, width, height));
+				return;
+			}
+		}
+	}
+}
+
+// a linear surface which contains every possible texel value once
+static void CheckExpandTablesExhaustive(const TextureSIMDCheckImplementation& impl)
+{
+	for (auto& decoderInfo : s_checkDecoders)
+	{
+		if (!decoderInfo.expandReference)
+			continue;
+		// rows of 256 texels, the pitch of a linear surface with this width needs no padding
+		uint32 texelSize = Latte::GetFormatBits(decoderInfo.format) / 8;
+		sint32 height = texelSize == 1 ? 1 : 256;
+		std::vector<uint8> surfaceData(256 * height * texelSize);
+		for (uint32 i = 0; i < 256 * (uint32)height; i++)
+		{
+			if (texelSize == 1)
+				surfaceData[i] = (uint8)i;
+			else
+				*(uint16*)(surfaceData.data() + i * 2) = (uint16)i;
+		}
+		DecodeSurface(decoderInfo, Latte::E_HWTILEMODE::TM_LINEAR_ALIGNED, 256, height, impl, &surfaceData);
+	}
+}
+
+// random surface sizes cover the vector tails and the detiling paths of every tile mode
+static void CheckDecodersRandomized(const TextureSIMDCheckImplementation& impl)
+{
+	for (sint32 round = 0; round < s_simdCheck.rounds; round++)
+	{
+		for (auto& decoderInfo : s_checkDecoders)
+		{
+			Latte::E_HWTILEMODE tileMode = (Latte::E_HWTILEMODE)(_Random() % 16);
+			if (tileMode == Latte::E_HWTILEMODE::TM_1D_TILED_THICK || tileMode == Latte::E_HWTILEMODE::TM_2D_TILED_THICK || tileMode == Latte::E_HWTILEMODE::TM_2B_TILED_THICK ||
+				tileMode == Latte::E_HWTILEMODE::TM_3D_TILED_THICK || tileMode == Latte::E_HWTILEMODE::TM_3B_TILED_THICK)
+				tileMode = Latte::E_HWTILEMODE::TM_2D_TILED_THIN1; // thick modes require 3D surfaces
+			sint32 width = (sint32)(_Random() % 96) + 1;
+			sint32 height = (sint32)(_Random() % 48) + 1;
+			DecodeSurface(decoderInfo, tileMode, width, height, impl, nullptr);
+		}
+	}
+}
+
+static bool ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view arg = argv[i];
+		bool hasValue = (i + 1) < argc;
+		if (arg == "--seed" && hasValue)
+			s_simdCheck.seed = (uint32)strtoul(argv[++i], nullptr, 0);
+		else if (arg == "--rounds" && hasValue)
+		{
+			s_simdCheck.rounds = atoi(argv[++i]);
+			if (s_simdCheck.rounds <= 0)
+				return false;
+		}
+		else
+			return false;
+	}
+	return s_simdCheck.seed != 0; // xorshift requires a non-zero state
+}
+
+int BenchmarkSuite_TextureSIMDCheck(int argc, char* argv[])
+{
+	if (!ParseArguments(argc, argv))
+	{
+		fprintf(stderr, "Usage: CemuBenchmark texture_simd_check [--seed <non-zero seed>] [--rounds <count>]\n");
+		return 1;
+	}
+	Benchmark_InitGuestMemory();
+	s_simdCheck.surfaceAddress = mmuRange_MEM2.getBase();
+	auto hostFeatures = g_CPUFeatures.x86;
+	for (auto& impl : s_simdImplementations)
+	{
+		if ((impl.sse4_1 && !hostFeatures.sse4_1) || (impl.avx2 && !hostFeatures.avx2))
+		{
+			printf("%-8s skipped, not supported by this CPU\n", impl.name);
+			continue;
+		}
+		s_simdCheck.rngState = s_simdCheck.seed;
+		sint32 previousMismatchCount = s_simdCheck.mismatchCount;
+		CheckBlockDecoders(impl);
+		CheckExpandTablesExhaustive(impl);
+		CheckDecodersRandomized(impl);
+		printf("%-8s %s (%d mismatches)\n", impl.name, s_simdCheck.mismatchCount == previousMismatchCount ? "ok" : "FAILED", s_simdCheck.mismatchCount - previousMismatchCount);
+	}
+	g_CPUFeatures.x86 = hostFeatures;
+	return s_simdCheck.mismatchCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+#include "tools/benchmark/Benchmark.h"
+#include "Cafe/OS/common/OSCommon.h"
+#include "Cafe/OS/libs/coreinit/coreinit_Thread.h"
+#include "Cafe/OS/libs/coreinit/coreinit_Scheduler.h"
+
+// stress test for the run queues, hundreds of PPC threads with mixed priorities call OSYieldThread in a loop
+// every yield puts the thread at the end of its priority bucket and picks the next runable thread
+// usage: CemuBenchmark yield [--threads <count>] [--yields <count>] [--multicore]
+
+static struct
+{
+	sint32 threadCount{300};
+	sint32 yieldCount{2000};
+	bool multicore{false};
+}s_yieldBenchmark;
+
+static void _YieldThreadEntry(PPCInterpreter_t* hCPU)
+{
+	sint32 count = (sint32)hCPU->gpr[3];
+	for (sint32 i = 0; i < count; i++)
+		coreinit::OSYieldThread();
+	osLib_returnFromFunction(hCPU, 0);
+}
+
+static int _RunYieldBenchmark()
+{
+	using namespace coreinit;
+	sint32 coreCount = s_yieldBenchmark.multicore ? Espresso::CORE_COUNT : 1;
+	std::vector<OSSchedulerLockStats> statsBefore;
+	for (sint32 i = 0; i <= Espresso::CORE_COUNT; i++)
+		statsBefore.emplace_back(__OSGetSchedulerLockStats(i));
+	std::vector<OSThread_t*> threads;
+	BenchmarkTimer timer;
+	timer.Start();
+	for (sint32 i = 0; i < s_yieldBenchmark.threadCount; i++)
+	{
+		uint32 affinityMask = s_yieldBenchmark.multicore ? (1 << (i % Espresso::CORE_COUNT)) : (1 << 1);
+		OSThread_t* thread = Benchmark_CreatePPCThread(_YieldThreadEntry, affinityMask, s_yieldBenchmark.yieldCount);
+		// mix a few priorities so that more than one bucket is in use. Lower priorities only run once the higher ones have finished
+		OSSetThreadPriority(thread, 16 + (i % 4));
+		threads.emplace_back(thread);
+	}
+	for (auto& thread : threads)
+		OSJoinThread(thread, nullptr);
+	timer.Stop();
+
+	double milliseconds = timer.GetElapsedMilliseconds();
+	uint64 totalYields = (uint64)s_yieldBenchmark.threadCount * s_yieldBenchmark.yieldCount;
+	printf("%d threads on %d core(s), %d yields each\n", s_yieldBenchmark.threadCount, coreCount, s_yieldBenchmark.yieldCount);
+	printf("Total: %.1f ms, %.1f ns per yield, %.2f M yields/s\n", milliseconds, milliseconds * 1000000.0 / (double)totalYields, (double)totalYields / (milliseconds * 1000.0));
+	for (sint32 i = 0; i <= Espresso::CORE_COUNT; i++)
+	{
+		OSSchedulerLockStats stats = __OSGetSchedulerLockStats(i);
+		uint64 acquisitions = stats.acquisitions - statsBefore[i].acquisitions;
+		uint64 coreAcquisitions = stats.coreAcquisitions - statsBefore[i].coreAcquisitions;
+		if (acquisitions == 0 && coreAcquisitions == 0)
+			continue;
+		uint64 contended = stats.contendedAcquisitions - statsBefore[i].contendedAcquisitions;
+		uint64 waitUs = stats.contendedWaitUs - statsBefore[i].contendedWaitUs;
+		uint64 coreContended = stats.coreContendedAcquisitions - statsBefore[i].coreContendedAcquisitions;
+		uint64 coreWaitUs = stats.coreContendedWaitUs - statsBefore[i].coreContendedWaitUs;
+		if (i < Espresso::CORE_COUNT)
+			printf("Scheduler lock core %d: %llu acquisitions, %llu contended, %.1f ms waited\n", i, (unsigned long long)acquisitions, (unsigned long long)contended, (double)waitUs / 1000.0);
+		else
+			printf("Scheduler lock other: %llu acquisitions, %llu contended, %.1f ms waited\n", (unsigned long long)acquisitions, (unsigned long long)contended, (double)waitUs / 1000.0);
+		if (coreAcquisitions != 0)
+			printf("  core lock only: %llu acquisitions, %llu contended, %.1f ms waited\n", (unsigned long long)coreAcquisitions, (unsigned long long)coreContended, (double)coreWaitUs / 1000.0);
+	}
+	return 0;
+}
+
+static bool ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view arg = argv[i];
+		bool hasValue = (i + 1) < argc;
+		if (arg == "--threads" && hasValue)
+		{
+			s_yieldBenchmark.threadCount = atoi(argv[++i]);
+			if (s_yieldBenchmark.threadCount <= 0 || s_yieldBenchmark.threadCount > 2000)
+				return false;
+		}
+		else if (arg == "--yields" && hasValue)
+		{
+			s_yieldBenchmark.yieldCount = atoi(argv[++i]);
+			if (s_yieldBenchmark.yieldCount <= 0)
+				return false;
+		}
+		else if (arg == "--multicore")
+			s_yieldBenchmark.multicore = true;
+		else
+			return false;
+	}
+	return true;
+}
+
+int BenchmarkSuite_Yield(int argc, char* argv[])
+{
+	if (!ParseArguments(argc, argv))
+	{
+		fprintf(stderr, "Usage: CemuBenchmark yield [--threads <count, max 2000>] [--yields <count>] [--multicore]\n");
+		return 1;
+	}
+	return Benchmark_RunOnPPCThread(_RunYieldBenchmark, s_yieldBenchmark.multicore ? 3 : 1);
+}
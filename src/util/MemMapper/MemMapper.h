@@ -16,9 +16,17 @@ namespace MemMapper
 
 	size_t GetPageSize();
 
+	// ReserveMemory and AllocateMemory return nullptr on failure
 	void* ReserveMemory(void* baseAddr, size_t size, PAGE_PERMISSION permissionFlags);
 	void FreeReservation(void* baseAddr, size_t size);
 
 	void* AllocateMemory(void* baseAddr, size_t size, PAGE_PERMISSION permissionFlags, bool fromReservation = false);
 	void FreeMemory(void* baseAddr, size_t size, bool fromReservation = false);
+	// change the permissions of already allocated memory. Can be called from a signal handler
+	bool ProtectMemory(void* baseAddr, size_t size, PAGE_PERMISSION permissionFlags);
+
+	// map the same physical memory twice, once as read+write and once as read+execute
+	// for systems which do not allow memory that is writable and executable at the same time
+	bool AllocateDualMappedMemory(size_t size, void*& viewRX, void*& viewRW);
+	void FreeDualMappedMemory(void* viewRX, void* viewRW, size_t size);
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "util/MemMapper/MemMapper.h"
 
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/mman.h>
 
 namespace MemMapper
@@ -32,7 +33,8 @@ namespace MemMapper
 
 	void* ReserveMemory(void* baseAddr, size_t size, PAGE_PERMISSION permissionFlags)
 	{
-		return mmap(baseAddr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		void* r = mmap(baseAddr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		return r != MAP_FAILED ? r : nullptr;
 	}
 
 	void FreeReservation(void* baseAddr, size_t size)
@@ -51,7 +53,11 @@ namespace MemMapper
                 r = nullptr;
 		}
 		else
+		{
 			r = mmap(baseAddr, size, GetProt(permissionFlags), MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (r == MAP_FAILED)
+				r = nullptr;
+		}
 		return r;
 	}
 
@@ -63,4 +69,55 @@ namespace MemMapper
 			munmap(baseAddr, size);
 	}
 
+	bool ProtectMemory(void* baseAddr, size_t size, PAGE_PERMISSION permissionFlags)
+	{
+		return mprotect(baseAddr, size, GetProt(permissionFlags)) == 0;
+	}
+
+	int CreateSharedMemoryFile()
+	{
+#if BOOST_OS_LINUX
+		return memfd_create("cemu_jit", MFD_CLOEXEC);
+#else
+		static std::atomic<uint32> sCounter{0};
+		std::string name = fmt::format("/cemu_jit_{}_{}", getpid(), sCounter.fetch_add(1));
+		int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		if (fd >= 0)
+			shm_unlink(name.c_str());
+		return fd;
+#endif
+	}
+
+	bool AllocateDualMappedMemory(size_t size, void*& viewRX, void*& viewRW)
+	{
+		int fd = CreateSharedMemoryFile();
+		if (fd < 0)
+			return false;
+		if (ftruncate(fd, size) != 0)
+		{
+			close(fd);
+			return false;
+		}
+		void* rw = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		void* rx = mmap(nullptr, size, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+		close(fd); // the mappings keep the memory alive
+		if (rw == MAP_FAILED || rx == MAP_FAILED)
+		{
+			if (rw != MAP_FAILED)
+				munmap(rw, size);
+			if (rx != MAP_FAILED)
+				munmap(rx, size);
+			return false;
+		}
+		viewRX = rx;
+		viewRW = rw;
+		return true;
+	}
+
+	void FreeDualMappedMemory(void* viewRX, void* viewRW, size_t size)
+	{
+		munmap(viewRW, size);
+		munmap(viewRX, size);
+	}
+
 };
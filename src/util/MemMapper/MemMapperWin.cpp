@@ -60,4 +60,37 @@ namespace MemMapper
 			VirtualFree(baseAddr, size, MEM_RELEASE);
 	}
 
+	bool ProtectMemory(void* baseAddr, size_t size, PAGE_PERMISSION permissionFlags)
+	{
+		DWORD oldProtection;
+		return VirtualProtect(baseAddr, size, GetPageProtection(permissionFlags), &oldProtection) != 0;
+	}
+
+	bool AllocateDualMappedMemory(size_t size, void*& viewRX, void*& viewRW)
+	{
+		HANDLE hMapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_EXECUTE_READWRITE | SEC_COMMIT, (DWORD)((uint64)size >> 32), (DWORD)size, nullptr);
+		if (!hMapping)
+			return false;
+		void* rw = MapViewOfFile(hMapping, FILE_MAP_WRITE, 0, 0, size);
+		void* rx = MapViewOfFile(hMapping, FILE_MAP_READ | FILE_MAP_EXECUTE, 0, 0, size);
+		CloseHandle(hMapping); // the views keep the mapping alive
+		if (!rw || !rx)
+		{
+			if (rw)
+				UnmapViewOfFile(rw);
+			if (rx)
+				UnmapViewOfFile(rx);
+			return false;
+		}
+		viewRX = rx;
+		viewRW = rw;
+		return true;
+	}
+
+	void FreeDualMappedMemory(void* viewRX, void* viewRW, size_t size)
+	{
+		UnmapViewOfFile(viewRW);
+		UnmapViewOfFile(viewRX);
+	}
+
 };
@@ -2,6 +2,7 @@
 
 #include <mutex>
 #include <condition_variable>
+#include <chrono>
 
 class Semaphore
 {
@@ -24,6 +25,17 @@ public:
 		--m_count;
 	}
 
+	// returns false if the timeout expired before the semaphore could be acquired
+	template<typename TRep, typename TPeriod>
+	bool wait_for(const std::chrono::duration<TRep, TPeriod>& timeout)
+	{
+		std::unique_lock lock(m_mutex);
+		if (!m_condition.wait_for(lock, timeout, [this] { return m_count != 0; }))
+			return false;
+		--m_count;
+		return true;
+	}
+
 	bool try_wait() 
 	{
 		std::lock_guard lock(m_mutex);
@@ -112,6 +124,22 @@ public:
 			m_condition.wait(lock);
 	}
 
+	// like waitUntilNonZero() but also returns when wakeup() is called
+	void waitUntilNonZeroOrWakeup()
+	{
+		std::unique_lock lock(m_mutex);
+		while (m_count == 0 && !m_wakeupRequested)
+			m_condition.wait(lock);
+		m_wakeupRequested = false;
+	}
+
+	void wakeup()
+	{
+		std::lock_guard lock(m_mutex);
+		m_wakeupRequested = true;
+		m_condition.notify_all();
+	}
+
 	bool isZero() const
 	{
 		return m_count == 0;
@@ -121,6 +149,7 @@ private:
 	std::mutex m_mutex;
 	std::condition_variable m_condition;
 	sint64 m_count = 0;
+	bool m_wakeupRequested = false;
 };
 
 template<typename T>